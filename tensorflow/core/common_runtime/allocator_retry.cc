@@ -67,6 +67,11 @@ void* AllocatorRetry::AllocateRaw(
       if (first) {
         deadline_micros = now + max_millis_to_wait * 1000;
         first = false;
+        // Memory returned from now on notifies this call even where
+        // HasWaiters() is checked, so try once more for memory returned
+        // before.
+        num_waiters_.fetch_add(1, std::memory_order_seq_cst);
+        continue;
       }
       if (now < deadline_micros) {
         tracker.Enable();
@@ -74,10 +79,14 @@ void* AllocatorRetry::AllocateRaw(
         WaitForMilliseconds(&l, &memory_returned_,
                             (deadline_micros - now) / 1000);
       } else {
-        return alloc_func(alignment, num_bytes, true);
+        ptr = alloc_func(alignment, num_bytes, true);
+        break;
       }
     }
   }
+  if (!first) {
+    num_waiters_.fetch_sub(1, std::memory_order_seq_cst);
+  }
   return ptr;
 }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATOR_RETRY_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATOR_RETRY_H_
 
+#include <atomic>
+
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -43,10 +45,17 @@ class AllocatorRetry {
   // Called to notify clients that some memory was returned.
   void NotifyDealloc();
 
+  // Returns true if some call to AllocateRaw() may be waiting for memory, so
+  // that hot deallocation paths can skip NotifyDealloc() otherwise.
+  bool HasWaiters() const {
+    return num_waiters_.load(std::memory_order_seq_cst) > 0;
+  }
+
  private:
   Env* env_;
   mutex mu_;
   condition_variable memory_returned_;
+  std::atomic<int> num_waiters_{0};
 };
 
 // Implementation details below
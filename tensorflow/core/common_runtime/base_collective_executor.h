@@ -18,7 +18,9 @@ limitations under the License.
 #include <memory>
 #include <string>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
+#include "tensorflow/core/common_runtime/collective_fusion_buffer.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
@@ -104,7 +106,14 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
         dev_mgr_(dev_mgr),
         remote_access_(remote_access),
         gpu_ring_order_(gpu_ring_order),
-        work_queue_(std::move(work_queue)) {}
+        work_queue_(std::move(work_queue)),
+        fusion_buffer_(absl::make_unique<CollectiveFusionBuffer>(
+            this, dev_mgr,
+            [this](OpKernelContext* ctx, const CollectiveParams& col_params,
+                   const string& exec_key, const Tensor* input, Tensor* output,
+                   const StatusCallback& done) {
+              RunCollective(ctx, col_params, exec_key, input, output, done);
+            })) {}
 
   ~BaseCollectiveExecutor() override;
 
@@ -150,10 +159,16 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unordered_map<int32, int32> launched_ TF_GUARDED_BY(launch_mu_);
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
+  // Fuses the small reductions of the groups whose params enable it.
+  std::unique_ptr<CollectiveFusionBuffer> fusion_buffer_;
 
  private:
   Status CreateCollective(const CollectiveParams& col_params,
                           CollectiveImplementationInterface** col_impl);
+  // Runs the collective described by `col_params` from `input` to `output`.
+  void RunCollective(OpKernelContext* ctx, const CollectiveParams& col_params,
+                     const string& exec_key, const Tensor* input,
+                     Tensor* output, const StatusCallback& done);
   // Check if all ops on which this collective depends on have launched.
   bool CheckDependencies(const CollectiveParams& col_params)
       TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mu_);
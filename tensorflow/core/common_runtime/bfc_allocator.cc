@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #endif
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
@@ -37,6 +39,9 @@ limitations under the License.
 namespace tensorflow {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
+constexpr size_t BFCAllocator::kMaxCachedChunkBytes;
+constexpr int BFCAllocator::kNumCachedSizeClasses;
+constexpr int BFCAllocator::kNumCacheableShards;
 
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
@@ -228,9 +233,143 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
 }
 
+void BFCAllocator::EnableMagazineCache(size_t max_bytes_per_magazine) {
+  if (LogMemory::IsEnabled()) {
+    LOG(INFO) << "Not enabling magazine cache for " << Name()
+              << " because memory logging is enabled.";
+    return;
+  }
+  // CPU ids past the number of magazines wrap around, so this only has to be
+  // large enough to keep collisions rare.
+  const int num_magazines = std::max(port::MaxParallelism(), 1);
+  magazines_.reserve(num_magazines);
+  for (int i = 0; i < num_magazines; ++i) {
+    magazines_.emplace_back(new Magazine);
+  }
+  cacheable_shards_.reset(new CacheableShard[kNumCacheableShards]);
+  max_bytes_per_magazine_ = max_bytes_per_magazine;
+  VLOG(1) << "Enabled " << num_magazines << " magazines of "
+          << strings::HumanReadableNumBytes(max_bytes_per_magazine)
+          << " for " << Name();
+}
+
+BFCAllocator::Magazine* BFCAllocator::CurrentMagazine() {
+  int cpu = port::GetCurrentCPU();
+  if (cpu < 0) {
+    // The CPU is unknown on this platform: fall back to a per-thread choice.
+    static std::atomic<int> next_thread_index{0};
+    static thread_local int thread_index =
+        next_thread_index.fetch_add(1, std::memory_order_relaxed);
+    cpu = thread_index;
+  }
+  return magazines_[cpu % magazines_.size()].get();
+}
+
+BFCAllocator::CacheableShard* BFCAllocator::CacheableShardFor(
+    const void* ptr) {
+  // Chunks are kMinAllocationSize aligned, so the low bits carry no entropy.
+  uintptr_t p = reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits;
+  return &cacheable_shards_[(p ^ (p >> 7)) % kNumCacheableShards];
+}
+
+void* BFCAllocator::AllocateFromMagazine(size_t rounded_bytes) {
+  const int size_class = (rounded_bytes >> kMinAllocationBits) - 1;
+  Magazine* magazine = CurrentMagazine();
+  mutex_lock l(magazine->mu);
+  std::vector<void*>& chunks = magazine->chunks[size_class];
+  if (chunks.empty()) {
+    return nullptr;
+  }
+  void* ptr = chunks.back();
+  chunks.pop_back();
+  magazine->cached_bytes -= rounded_bytes;
+  bytes_in_cache_.fetch_sub(rounded_bytes, std::memory_order_relaxed);
+  return ptr;
+}
+
+bool BFCAllocator::DeallocateToMagazine(void* ptr) {
+  if (max_bytes_per_magazine_ == 0) {
+    return false;
+  }
+  CacheableShard* shard = CacheableShardFor(ptr);
+  size_t rounded_bytes;
+  {
+    mutex_lock l(shard->mu);
+    auto it = shard->rounded_bytes.find(ptr);
+    if (it == shard->rounded_bytes.end()) {
+      return false;
+    }
+    rounded_bytes = it->second;
+  }
+  if (timing_counter_ == nullptr) {
+    const int size_class = (rounded_bytes >> kMinAllocationBits) - 1;
+    Magazine* magazine = CurrentMagazine();
+    mutex_lock l(magazine->mu);
+    if (magazine->cached_bytes + rounded_bytes <= max_bytes_per_magazine_) {
+      magazine->chunks[size_class].push_back(ptr);
+      magazine->cached_bytes += rounded_bytes;
+      bytes_in_cache_.fetch_add(rounded_bytes, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  // The chunk goes back to the bins, so it is no longer outstanding.
+  mutex_lock l(shard->mu);
+  shard->rounded_bytes.erase(ptr);
+  return false;
+}
+
+bool BFCAllocator::FlushMagazines() {
+  std::vector<void*> flushed;
+  for (auto& magazine : magazines_) {
+    mutex_lock l(magazine->mu);
+    for (auto& chunks : magazine->chunks) {
+      flushed.insert(flushed.end(), chunks.begin(), chunks.end());
+      chunks.clear();
+    }
+    bytes_in_cache_.fetch_sub(magazine->cached_bytes,
+                              std::memory_order_relaxed);
+    magazine->cached_bytes = 0;
+  }
+  for (void* ptr : flushed) {
+    CacheableShard* shard = CacheableShardFor(ptr);
+    {
+      mutex_lock l(shard->mu);
+      shard->rounded_bytes.erase(ptr);
+    }
+    ReturnChunkToBins(ptr);
+  }
+  VLOG(1) << "Flushed " << flushed.size() << " chunks from the magazines of "
+          << Name();
+  return !flushed.empty();
+}
+
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const bool cacheable = num_bytes > 0 && num_bytes <= kMaxCachedChunkBytes &&
+                         UseMagazines(allocation_attr);
+  if (!cacheable) {
+    return AllocateRawFromBins(unused_alignment, num_bytes, allocation_attr);
+  }
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  void* ptr = AllocateFromMagazine(rounded_bytes);
+  if (ptr != nullptr) {
+    num_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+  }
+  num_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+  ptr = AllocateRawFromBins(unused_alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    CacheableShard* shard = CacheableShardFor(ptr);
+    mutex_lock l(shard->mu);
+    shard->rounded_bytes[ptr] = rounded_bytes;
+  }
+  return ptr;
+}
+
+void* BFCAllocator::AllocateRawFromBins(
+    size_t unused_alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
   if (!allocation_attr.retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -413,6 +552,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Chunks parked in the magazines are free in all but name; return them to
+  // the bins before resorting to region reshuffling.
+  if (!magazines_.empty() && FlushMagazines()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -618,6 +767,14 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  // A parked chunk is returned memory too: a waiter in retry_helper_ only
+  // retries, flushing the magazines, once notified or at its deadline.
+  if (ptr != nullptr && DeallocateToMagazine(ptr)) {
+    if (retry_helper_.HasWaiters()) {
+      retry_helper_.NotifyDealloc();
+    }
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -628,7 +785,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  ReturnChunkToBins(ptr);
+}
 
+void BFCAllocator::ReturnChunkToBins(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -1142,11 +1302,18 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.num_cache_hits = num_cache_hits_.load(std::memory_order_relaxed);
+  stats.num_cache_misses = num_cache_misses_.load(std::memory_order_relaxed);
+  stats.bytes_in_cache = bytes_in_cache_.load(std::memory_order_relaxed);
+  stats.num_allocs += stats.num_cache_hits;
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  num_cache_hits_.store(0, std::memory_order_relaxed);
+  num_cache_misses_.store(0, std::memory_order_relaxed);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -79,6 +80,18 @@ class BFCAllocator : public Allocator {
 
   void SetTimingCounter(SharedCounter* sc) { timing_counter_ = sc; }
 
+  // Enables per-CPU caches ("magazines") of freed small chunks. Allocations
+  // of up to kMaxCachedChunkBytes are then returned to, and reissued from,
+  // the magazine of the calling CPU without taking the allocator-wide lock.
+  // Each magazine parks at most 'max_bytes_per_magazine' bytes; parked chunks
+  // are handed back to the bins before an allocation is allowed to fail.
+  //
+  // Must be called before the first allocation. Ignored if memory logging is
+  // enabled. Caching is bypassed while a timing counter is set and for
+  // allocations with a freed_by_func. A chunk reissued from a magazine keeps
+  // the RequestedSize() and AllocationId() of its previous use.
+  void EnableMagazineCache(size_t max_bytes_per_magazine);
+
   void SetSafeFrontier(uint64 count) override;
 
   bool ShouldRecordOpName() const { return true; }
@@ -98,6 +111,13 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Allocates from the bins, ignoring the magazines.
+  void* AllocateRawFromBins(size_t alignment, size_t num_bytes,
+                            const AllocationAttributes& allocation_attr);
+
+  // Marks the in-use chunk at 'ptr' free and puts it back in the bins.
+  void ReturnChunkToBins(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -457,6 +477,46 @@ class BFCAllocator : public Allocator {
   // size over total free memory, and returns a value within [0, 1].
   double GetFragmentation() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Magazine support; see EnableMagazineCache(). Locks are only ever acquired
+  // in the order lock_, Magazine::mu, CacheableShard::mu, and no two magazine
+  // or shard locks are held at once.
+  static constexpr size_t kMaxCachedChunkBytes = 32 << 10;
+  static constexpr int kNumCachedSizeClasses =
+      kMaxCachedChunkBytes >> kMinAllocationBits;
+  static constexpr int kNumCacheableShards = 64;
+
+  // A cache of freed chunks, indexed by rounded size class.
+  struct Magazine {
+    mutex mu;
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+    std::vector<void*> chunks[kNumCachedSizeClasses] TF_GUARDED_BY(mu);
+  };
+
+  // Rounded sizes of outstanding allocations that may be parked in a magazine
+  // when freed, sharded by address so DeallocateRaw() can find them without
+  // taking lock_.
+  struct CacheableShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, size_t> rounded_bytes TF_GUARDED_BY(mu);
+  };
+
+  bool UseMagazines(const AllocationAttributes& allocation_attr) const {
+    return max_bytes_per_magazine_ > 0 && timing_counter_ == nullptr &&
+           allocation_attr.freed_by_func == nullptr;
+  }
+  Magazine* CurrentMagazine();
+  CacheableShard* CacheableShardFor(const void* ptr);
+
+  // Returns a chunk of 'rounded_bytes' from the current magazine, or nullptr.
+  void* AllocateFromMagazine(size_t rounded_bytes);
+
+  // Parks 'ptr' in the current magazine. Returns false if the caller must
+  // return it to the bins instead.
+  bool DeallocateToMagazine(void* ptr);
+
+  // Returns every parked chunk to the bins. Returns true if there were any.
+  bool FlushMagazines() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -534,6 +594,14 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Magazines, set up by EnableMagazineCache().
+  size_t max_bytes_per_magazine_ = 0;
+  std::vector<std::unique_ptr<Magazine>> magazines_;
+  std::unique_ptr<CacheableShard[]> cacheable_shards_;
+  std::atomic<int64> num_cache_hits_{0};
+  std::atomic<int64> num_cache_misses_{0};
+  std::atomic<int64> bytes_in_cache_{0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -0,0 +1,223 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+BFCAllocator* NewCPUBFCAllocator(size_t total_memory) {
+  return new BFCAllocator(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), total_memory,
+      true /*allow_growth*/, "cpu_bfc_test");
+}
+
+TEST(BFCAllocatorTest, MagazineCacheReusesChunks) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1 << 30));
+  a->EnableMagazineCache(1 << 20);
+
+  const int kIters = 100;
+  for (int i = 0; i < kIters; ++i) {
+    void* p = a->AllocateRaw(1, 1000);
+    ASSERT_NE(p, nullptr);
+    memset(p, 0xab, 1000);
+    a->DeallocateRaw(p);
+  }
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_cache_hits + stats->num_cache_misses, kIters);
+  EXPECT_EQ(stats->num_allocs, kIters);
+  // The thread may migrate between CPUs, but not on every iteration.
+  EXPECT_GT(stats->num_cache_hits, 0);
+  EXPECT_GT(stats->bytes_in_cache, 0);
+
+  // Large allocations bypass the magazines.
+  void* large = a->AllocateRaw(1, 1 << 20);
+  a->DeallocateRaw(large);
+  absl::optional<AllocatorStats> after = a->GetStats();
+  EXPECT_EQ(after->num_cache_hits + after->num_cache_misses, kIters);
+
+  a->ClearStats();
+  stats = a->GetStats();
+  EXPECT_EQ(stats->num_cache_hits, 0);
+  EXPECT_EQ(stats->num_cache_misses, 0);
+}
+
+TEST(BFCAllocatorTest, MagazineCacheDisabledByDefault) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1 << 30));
+  for (int i = 0; i < 10; ++i) {
+    a->DeallocateRaw(a->AllocateRaw(1, 1000));
+  }
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_cache_hits, 0);
+  EXPECT_EQ(stats->num_cache_misses, 0);
+  EXPECT_EQ(stats->bytes_in_cache, 0);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, MagazinesAreFlushedBeforeFailing) {
+  // A 1MiB allocator whose memory is entirely parked in magazines must still
+  // be able to satisfy a large request.
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1 << 20));
+  a->EnableMagazineCache(1 << 20);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    void* p = a->AllocateRaw(1, 32 << 10);
+    ASSERT_NE(p, nullptr);
+    ptrs.push_back(p);
+  }
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  EXPECT_EQ(a->GetStats()->bytes_in_cache, 16 * (32 << 10));
+
+  AllocationAttributes attr;
+  attr.retry_on_failure = false;
+  void* large = a->AllocateRaw(1, 768 << 10, attr);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(a->GetStats()->bytes_in_cache, 0);
+  a->DeallocateRaw(large);
+  EXPECT_EQ(a->GetStats()->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, ParkedChunksWakeWaiters) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1 << 20));
+  a->EnableMagazineCache(1 << 20);
+
+  // Use up all the memory.
+  AllocationAttributes no_retry;
+  no_retry.retry_on_failure = false;
+  std::vector<void*> ptrs;
+  while (void* p = a->AllocateRaw(1, 32 << 10, no_retry)) {
+    ptrs.push_back(p);
+  }
+  ASSERT_FALSE(ptrs.empty());
+
+  // The waiter gets the chunk parked in a magazine long before its 10s
+  // deadline.
+  Env* env = Env::Default();
+  const uint64 start_micros = env->NowMicros();
+  void* waited = nullptr;
+  std::unique_ptr<Thread> waiter(env->StartThread(
+      {}, "waiter", [&a, &waited]() { waited = a->AllocateRaw(1, 32 << 10); }));
+  env->SleepForMicroseconds(100 * 1000);
+  a->DeallocateRaw(ptrs.back());
+  ptrs.pop_back();
+  waiter.reset();
+  ASSERT_NE(waited, nullptr);
+  EXPECT_LT(env->NowMicros() - start_micros, 5 * 1000 * 1000);
+  ptrs.push_back(waited);
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+}
+
+TEST(BFCAllocatorTest, MagazineCacheConcurrentUse) {
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1 << 30));
+  a->EnableMagazineCache(64 << 10);
+
+  const int kThreads = 8;
+  thread::ThreadPool pool(Env::Default(), "test", kThreads);
+  BlockingCounter counter(kThreads);
+  for (int t = 0; t < kThreads; ++t) {
+    pool.Schedule([&a, &counter, t]() {
+      random::PhiloxRandom philox(123, t);
+      random::SimplePhilox rand(&philox);
+      std::vector<std::pair<char*, size_t>> live;
+      for (int i = 0; i < 2000; ++i) {
+        if (live.size() < 16 && rand.Uniform(2) == 0) {
+          size_t bytes = 1 + rand.Uniform(40 << 10);
+          char* p = static_cast<char*>(a->AllocateRaw(1, bytes));
+          CHECK(p != nullptr);
+          memset(p, t, bytes);
+          live.emplace_back(p, bytes);
+        } else if (!live.empty()) {
+          auto entry = live.back();
+          live.pop_back();
+          for (size_t j = 0; j < entry.second; j += 997) {
+            EXPECT_EQ(entry.first[j], static_cast<char>(t));
+          }
+          a->DeallocateRaw(entry.first);
+        }
+      }
+      for (const auto& entry : live) {
+        a->DeallocateRaw(entry.first);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  // Only parked chunks remain in use. A parked chunk may be larger than its
+  // size class when the bins did not split it.
+  EXPECT_GE(stats->bytes_in_use, stats->bytes_in_cache);
+  EXPECT_GT(stats->num_cache_hits, 0);
+}
+
+// Each of 'num_threads' threads repeatedly allocates and frees small buffers,
+// keeping a few of them live.
+static void BM_AllocationThreaded(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const bool use_magazines = state.range(1);
+  std::unique_ptr<BFCAllocator> a(NewCPUBFCAllocator(1uLL << 33));
+  if (use_magazines) {
+    a->EnableMagazineCache(1 << 20);
+  }
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+
+  for (auto s : state) {
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&a, &counter]() {
+        static const size_t kSizes[] = {64, 256, 1000, 4096, 16384};
+        void* live[4] = {};
+        for (int i = 0; i < 1000; ++i) {
+          void*& slot = live[i % 4];
+          if (slot != nullptr) a->DeallocateRaw(slot);
+          slot = a->AllocateRaw(1, kSizes[i % 5]);
+        }
+        for (void* p : live) a->DeallocateRaw(p);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(static_cast<int64>(state.iterations()) *
+                          num_threads * 1000);
+}
+BENCHMARK(BM_AllocationThreaded)
+    ->ArgPair(1, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 0)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,497 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_fusion_buffer.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace {
+
+// The most instances fused into one collective, which bounds the size of the
+// lists of instance keys sent by rank 0.
+constexpr int kMaxFusedInstances = 128;
+
+// How long rank 0 waits for more instances if the group params do not say.
+constexpr int64 kDefaultTimeoutMicros = 1000;
+
+string InstanceKeysBufKey(const string& bucket_name, int rank) {
+  return strings::StrCat("fusion:", bucket_name, ":", rank);
+}
+
+}  // namespace
+
+CollectiveFusionBuffer::CollectiveFusionBuffer(CollectiveExecutor* col_exec,
+                                               const DeviceMgr* dev_mgr,
+                                               RunCollectiveFn run_collective)
+    : col_exec_(col_exec),
+      dev_mgr_(dev_mgr),
+      run_collective_(std::move(run_collective)) {}
+
+CollectiveFusionBuffer::~CollectiveFusionBuffer() {
+  std::unique_ptr<Thread> timer_thread;
+  {
+    mutex_lock l(mu_);
+    timer_stopped_ = true;
+    timer_thread = std::move(timer_thread_);
+  }
+  timer_cv_.notify_all();
+  // Joins the thread, which drops the timeouts left.
+  timer_thread.reset();
+}
+
+bool CollectiveFusionBuffer::CanFuse(OpKernelContext* ctx,
+                                     const CollectiveParams& col_params,
+                                     const string& exec_key,
+                                     string* bucket_name) const {
+  if (col_params.group.fusion_threshold_bytes <= 0 ||
+      col_params.instance.type != REDUCTION_COLLECTIVE ||
+      col_params.group.device_type != DEVICE_CPU ||
+      col_params.group.group_size < 2 || col_params.default_rank < 0 ||
+      col_params.merge_op == nullptr ||
+      !col_params.instance.impl_details.dependencies.empty() ||
+      col_params.instance.impl_details.collective_name == "NcclReduce") {
+    return false;
+  }
+  const Tensor& input = ctx->input(0);
+  if (!DataTypeCanUseMemcpy(input.dtype()) ||
+      input.TotalBytes() >= col_params.group.fusion_threshold_bytes) {
+    return false;
+  }
+  // The bucket name must be the same in all the members of the group, so it
+  // takes the frame and iteration from the end of the execution key rather
+  // than from the ids local to `ctx`.
+  const string prefix = strings::StrCat(col_params.group.group_key, ":",
+                                        col_params.instance.instance_key, ":");
+  if (!absl::StartsWith(exec_key, prefix)) return false;
+  *bucket_name = strings::StrCat(
+      col_params.group.group_key, ":", exec_key.substr(prefix.size()), ":",
+      DataTypeString(input.dtype()), ":", col_params.merge_op->type_string(),
+      ":",
+      col_params.final_op ? col_params.final_op->type_string() : string("Id"));
+  return true;
+}
+
+bool CollectiveFusionBuffer::MaybeFuse(OpKernelContext* ctx,
+                                       const CollectiveParams& col_params,
+                                       const string& exec_key,
+                                       const StatusCallback& done) {
+  string bucket_name;
+  if (!CanFuse(ctx, col_params, exec_key, &bucket_name)) return false;
+  Device* device = nullptr;
+  if (!dev_mgr_
+           ->LookupDevice(
+               col_params.group.device_names[col_params.default_rank], &device)
+           .ok()) {
+    return false;
+  }
+
+  Status status;
+  Bucket* bucket = nullptr;
+  std::vector<Entry> fused;
+  std::shared_ptr<Tensor> send_keys;
+  std::vector<std::vector<Entry>> ready;
+  bool receive = false;
+  {
+    mutex_lock l(mu_);
+    status = status_;
+    if (status.ok()) {
+      const string key = strings::StrCat(device->name(), ";", bucket_name);
+      bucket = &buckets_[key];
+      if (bucket->device == nullptr) {
+        bucket->key = key;
+        bucket->name = bucket_name;
+        bucket->device = device;
+        bucket->rank = col_params.default_rank;
+        bucket->device_names = col_params.group.device_names;
+        bucket->task_names = col_params.group.task_names;
+        bucket->leader_is_local = col_params.task.is_local[0];
+        bucket->threshold_bytes = col_params.group.fusion_threshold_bytes;
+        bucket->timeout_micros = col_params.group.fusion_timeout_micros > 0
+                                     ? col_params.group.fusion_timeout_micros
+                                     : kDefaultTimeoutMicros;
+      }
+      bucket->pending.push_back(Entry{ctx, &col_params, exec_key, done});
+      bucket->pending_bytes += ctx->input(0).TotalBytes();
+      if (bucket->rank == 0) {
+        if (bucket->pending_bytes >= bucket->threshold_bytes) {
+          send_keys = TakePendingLocked(bucket, "bytes", &fused);
+        } else if (bucket->pending.size() >= kMaxFusedInstances) {
+          send_keys = TakePendingLocked(bucket, "count", &fused);
+        } else if (!bucket->has_timeout) {
+          if (timer_thread_ == nullptr) {
+            timer_env_ = device->env();
+            timer_thread_.reset(timer_env_->StartThread(
+                ThreadOptions(), "collective_fusion_timer",
+                [this]() { RunTimer(); }));
+          }
+          const uint64 deadline =
+              timer_env_->NowMicros() + bucket->timeout_micros;
+          bucket->has_timeout = true;
+          bucket->timeout = timeouts_.emplace(deadline, bucket);
+          // Only wakes the thread if it waits for a later timeout.
+          if (bucket->timeout == timeouts_.begin()) timer_cv_.notify_one();
+        }
+      } else {
+        TakeReadyLocked(bucket, &ready);
+        receive = MaybeReceiveLocked(bucket);
+        MaybeEraseLocked(bucket);
+      }
+    }
+  }
+  if (!status.ok()) {
+    done(status);
+    return true;
+  }
+  if (send_keys != nullptr) {
+    SendInstanceKeys(bucket, std::move(send_keys));
+  }
+  if (!fused.empty()) {
+    RunFused(std::move(fused));
+  }
+  for (std::vector<Entry>& entries : ready) {
+    RunFused(std::move(entries));
+  }
+  if (receive) {
+    ReceiveInstanceKeys(bucket);
+  }
+  return true;
+}
+
+void CollectiveFusionBuffer::StartAbort(const Status& s) {
+  std::vector<Entry> aborted;
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) return;
+    status_ = s;
+    for (auto& it : buckets_) {
+      Bucket* bucket = &it.second;
+      for (Entry& entry : bucket->pending) {
+        aborted.push_back(std::move(entry));
+      }
+      bucket->pending.clear();
+      bucket->pending_bytes = 0;
+      bucket->received.clear();
+    }
+  }
+  for (Entry& entry : aborted) {
+    entry.done(s);
+  }
+}
+
+int CollectiveFusionBuffer::num_buckets() {
+  mutex_lock l(mu_);
+  return buckets_.size();
+}
+
+std::shared_ptr<Tensor> CollectiveFusionBuffer::TakePendingLocked(
+    Bucket* bucket, const string& trigger, std::vector<Entry>* entries) {
+  metrics::RecordCollectiveFusionTrigger(trigger);
+  entries->swap(bucket->pending);
+  bucket->pending_bytes = 0;
+  if (bucket->has_timeout) {
+    timeouts_.erase(bucket->timeout);
+    bucket->has_timeout = false;
+  }
+
+  // The first element is the number of instance keys that follow.
+  auto keys =
+      std::make_shared<Tensor>(DT_INT64, TensorShape({kMaxFusedInstances + 1}));
+  auto keys_flat = keys->flat<int64>();
+  keys_flat.setZero();
+  keys_flat(0) = entries->size();
+  for (size_t i = 0; i < entries->size(); ++i) {
+    keys_flat(i + 1) = (*entries)[i].col_params->instance.instance_key;
+  }
+  if (bucket->num_receivers > 0) {
+    bucket->unsent.push_back(std::move(keys));
+    return nullptr;
+  }
+  // Until SendInstanceKeys() has posted the list to every other member, it
+  // counts as one more receiver, so that the bucket is not erased.
+  bucket->num_receivers = bucket->device_names.size();
+  return keys;
+}
+
+void CollectiveFusionBuffer::SendInstanceKeys(Bucket* bucket,
+                                              std::shared_ptr<Tensor> keys) {
+  for (size_t rank = 1; rank < bucket->device_names.size(); ++rank) {
+    // The send holds a reference on the executor, which owns this.
+    col_exec_->Ref();
+    col_exec_->remote_access()->PostToPeer(
+        bucket->device_names[rank], bucket->task_names[rank],
+        InstanceKeysBufKey(bucket->name, rank), bucket->device,
+        /*from_device_ctx=*/nullptr, AllocatorAttributes(), keys.get(),
+        bucket->device->attributes().locality(),
+        /*cancellation_manager=*/nullptr,
+        [this, bucket, keys](const Status& s) {
+          // A member that fails to receive the keys fails its collectives.
+          if (!s.ok()) VLOG(1) << "Failed to send fused instance keys: " << s;
+          CollectiveExecutor* col_exec = col_exec_;
+          OnInstanceKeysSent(bucket);
+          col_exec->Unref();
+        });
+  }
+  OnInstanceKeysSent(bucket);
+}
+
+void CollectiveFusionBuffer::OnInstanceKeysSent(Bucket* bucket) {
+  std::shared_ptr<Tensor> next_keys;
+  {
+    mutex_lock l(mu_);
+    if (--bucket->num_receivers > 0) return;
+    if (bucket->unsent.empty()) {
+      MaybeEraseLocked(bucket);
+      return;
+    }
+    // The other members receive every list under the same key, so the next
+    // one is only sent once they have all received this one.
+    next_keys = std::move(bucket->unsent.front());
+    bucket->unsent.pop_front();
+    bucket->num_receivers = bucket->device_names.size();
+  }
+  SendInstanceKeys(bucket, std::move(next_keys));
+}
+
+void CollectiveFusionBuffer::RunTimer() {
+  mutex_lock l(mu_);
+  while (!timer_stopped_) {
+    if (timeouts_.empty()) {
+      timer_cv_.wait(l);
+      continue;
+    }
+    const uint64 now = timer_env_->NowMicros();
+    auto first = timeouts_.begin();
+    if (first->first > now) {
+      timer_cv_.wait_for(l, std::chrono::microseconds(first->first - now));
+      continue;
+    }
+    Bucket* bucket = first->second;
+    timeouts_.erase(first);
+    bucket->has_timeout = false;
+    if (bucket->pending.empty()) {
+      // The pending collectives were failed by StartAbort().
+      MaybeEraseLocked(bucket);
+      continue;
+    }
+    auto fused = std::make_shared<std::vector<Entry>>();
+    std::shared_ptr<Tensor> send_keys =
+        TakePendingLocked(bucket, "timeout", fused.get());
+    // Runs the fusion on the work queue of the executor, so that releasing
+    // the last reference on the executor does not join this thread from
+    // itself. The closure holds a reference on the executor, which owns this.
+    col_exec_->Ref();
+    col_exec_->RunClosure([this, bucket, send_keys, fused]() {
+      CollectiveExecutor* col_exec = col_exec_;
+      if (send_keys != nullptr) {
+        SendInstanceKeys(bucket, send_keys);
+      }
+      RunFused(std::move(*fused));
+      col_exec->Unref();
+    });
+  }
+}
+
+bool CollectiveFusionBuffer::MaybeReceiveLocked(Bucket* bucket) {
+  if (bucket->receiving) return false;
+  for (const Entry& entry : bucket->pending) {
+    const int32 instance_key = entry.col_params->instance.instance_key;
+    bool in_received = false;
+    for (const std::vector<int32>& keys : bucket->received) {
+      if (std::find(keys.begin(), keys.end(), instance_key) != keys.end()) {
+        in_received = true;
+        break;
+      }
+    }
+    if (!in_received) {
+      bucket->receiving = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CollectiveFusionBuffer::ReceiveInstanceKeys(Bucket* bucket) {
+  Tensor* keys = new Tensor(DT_INT64, TensorShape({kMaxFusedInstances + 1}));
+  // The receive holds a reference on the executor, which owns this.
+  col_exec_->Ref();
+  col_exec_->remote_access()->RecvFromPeer(
+      bucket->device_names[0], bucket->task_names[0], bucket->leader_is_local,
+      InstanceKeysBufKey(bucket->name, bucket->rank), bucket->device,
+      /*to_device_ctx=*/nullptr, AllocatorAttributes(), keys,
+      bucket->device->attributes().locality(), 0 /*dev_to_dev_stream_index*/,
+      /*cancellation_manager=*/nullptr,
+      [this, bucket, keys](const Status& s) {
+        CollectiveExecutor* col_exec = col_exec_;
+        OnReceived(bucket, *keys, s);
+        delete keys;
+        col_exec->Unref();
+      });
+}
+
+void CollectiveFusionBuffer::OnReceived(Bucket* bucket, const Tensor& keys,
+                                        const Status& s) {
+  Status status = s;
+  const auto keys_flat = keys.flat<int64>();
+  if (status.ok() && (keys_flat(0) < 1 || keys_flat(0) > kMaxFusedInstances)) {
+    status = errors::Internal("Received ", keys_flat(0),
+                              " fused instance keys for ", bucket->name);
+  }
+  std::vector<Entry> failed;
+  std::vector<std::vector<Entry>> ready;
+  bool receive = false;
+  {
+    mutex_lock l(mu_);
+    bucket->receiving = false;
+    if (status.ok()) {
+      std::vector<int32> instance_keys;
+      for (int i = 1; i <= keys_flat(0); ++i) {
+        instance_keys.push_back(keys_flat(i));
+      }
+      bucket->received.push_back(std::move(instance_keys));
+      TakeReadyLocked(bucket, &ready);
+      receive = MaybeReceiveLocked(bucket);
+    } else {
+      failed.swap(bucket->pending);
+      bucket->pending.clear();
+      bucket->pending_bytes = 0;
+      bucket->received.clear();
+    }
+    MaybeEraseLocked(bucket);
+  }
+  for (Entry& entry : failed) {
+    entry.done(status);
+  }
+  for (std::vector<Entry>& entries : ready) {
+    RunFused(std::move(entries));
+  }
+  if (receive) {
+    ReceiveInstanceKeys(bucket);
+  }
+}
+
+void CollectiveFusionBuffer::TakeReadyLocked(
+    Bucket* bucket, std::vector<std::vector<Entry>>* fusions) {
+  for (auto keys = bucket->received.begin(); keys != bucket->received.end();) {
+    std::vector<std::vector<Entry>::iterator> found;
+    for (int32 instance_key : *keys) {
+      auto it = std::find_if(
+          bucket->pending.begin(), bucket->pending.end(),
+          [instance_key](const Entry& entry) {
+            return entry.col_params->instance.instance_key == instance_key;
+          });
+      if (it == bucket->pending.end()) break;
+      found.push_back(it);
+    }
+    if (found.size() < keys->size()) {
+      ++keys;
+      continue;
+    }
+    // Fuses the entries in the order of the list, which is that of rank 0.
+    std::vector<Entry> entries;
+    for (auto it : found) {
+      entries.push_back(std::move(*it));
+    }
+    std::sort(found.begin(), found.end());
+    for (auto it = found.rbegin(); it != found.rend(); ++it) {
+      bucket->pending.erase(*it);
+    }
+    fusions->push_back(std::move(entries));
+    keys = bucket->received.erase(keys);
+  }
+}
+
+void CollectiveFusionBuffer::MaybeEraseLocked(Bucket* bucket) {
+  if (bucket->pending.empty() && !bucket->has_timeout &&
+      bucket->num_receivers == 0 && bucket->received.empty() &&
+      !bucket->receiving) {
+    buckets_.erase(bucket->key);
+  }
+}
+
+void CollectiveFusionBuffer::RunFused(std::vector<Entry> entries) {
+  if (entries.size() == 1) {
+    // Runs a lone instance on its own.
+    Entry& entry = entries[0];
+    run_collective_(entry.ctx, *entry.col_params, entry.exec_key,
+                    &entry.ctx->input(0), entry.ctx->mutable_output(0),
+                    entry.done);
+    return;
+  }
+  struct Fused {
+    std::vector<Entry> entries;
+    CollectiveParams col_params;
+    Tensor buffer;
+  };
+  auto* fused = new Fused;
+  fused->entries = std::move(entries);
+  const Entry& first = fused->entries[0];
+  int64 num_elements = 0;
+  for (const Entry& entry : fused->entries) {
+    num_elements += entry.ctx->input(0).NumElements();
+  }
+  fused->col_params = *first.col_params;
+  fused->col_params.name = strings::StrCat(first.col_params->name, "_fused_",
+                                           fused->entries.size());
+  fused->col_params.instance.shape = TensorShape({num_elements});
+  fused->buffer =
+      Tensor(first.ctx->device()->GetAllocator(AllocatorAttributes()),
+             first.ctx->input(0).dtype(), TensorShape({num_elements}));
+
+  char* buffer_base = static_cast<char*>(DMAHelper::base(&fused->buffer));
+  int64 offset = 0;
+  for (const Entry& entry : fused->entries) {
+    const Tensor& input = entry.ctx->input(0);
+    memcpy(buffer_base + offset, DMAHelper::base(&input), input.TotalBytes());
+    offset += input.TotalBytes();
+  }
+  metrics::RecordCollectiveFusion(fused->entries.size(), offset);
+  VLOG(2) << "Fusing " << fused->entries.size() << " collectives of " << offset
+          << " bytes into " << fused->col_params.name;
+
+  // The fused collective takes the execution key of the first instance, which
+  // is not otherwise used.
+  run_collective_(
+      first.ctx, fused->col_params, strings::StrCat(first.exec_key, ":fused"),
+      &fused->buffer, &fused->buffer, [fused, buffer_base](const Status& s) {
+        int64 offset = 0;
+        for (const Entry& entry : fused->entries) {
+          Tensor* output = entry.ctx->mutable_output(0);
+          if (s.ok()) {
+            memcpy(DMAHelper::base(output), buffer_base + offset,
+                   output->TotalBytes());
+          }
+          offset += output->TotalBytes();
+        }
+        for (const Entry& entry : fused->entries) {
+          entry.done(s);
+        }
+        delete fused;
+      });
+}
+
+}  // namespace tensorflow
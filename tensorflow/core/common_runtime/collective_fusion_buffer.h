@@ -0,0 +1,185 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_FUSION_BUFFER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_FUSION_BUFFER_H_
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+class Device;
+class DeviceMgr;
+
+// Coalesces small all-reduces that are pending at the same time into one
+// all-reduce of a packed buffer, so that they pay the latency of a single
+// collective.
+//
+// All the members of a group must fuse the same instances in the same order,
+// which they cannot decide independently because instances reach each of them
+// at different times. The member with rank 0 decides: it packs the instances
+// pending on it once they add up to the byte threshold, or after a timeout
+// from the first one, and sends the list of their instance keys to the other
+// members through the CollectiveRemoteAccess. The other members wait for that
+// list and for the instances in it before running the fused collective.
+//
+// The timeouts of all the buckets are run by one thread, started with the Env
+// of the first device that needs one and joined when this object is deleted.
+//
+// Rank 0 sends one list at a time to each member under the same buffer key,
+// so that a bucket keeps no state once it is idle and can be erased.
+//
+// Only CPU reductions are fused, in groups whose params enable it. The group
+// leader sets the threshold and timeout in the group params from its
+// ConfigProto, so that every member fuses the same instances.
+class CollectiveFusionBuffer {
+ public:
+  // Runs a collective like CollectiveExecutor::ExecuteAsync, with the given
+  // input and output in place of those of `ctx`.
+  typedef std::function<void(OpKernelContext* ctx,
+                             const CollectiveParams& col_params,
+                             const string& exec_key, const Tensor* input,
+                             Tensor* output, const StatusCallback& done)>
+      RunCollectiveFn;
+
+  // `col_exec` owns this object.
+  CollectiveFusionBuffer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+                         RunCollectiveFn run_collective);
+  ~CollectiveFusionBuffer();
+
+  // Returns false if the collective cannot be fused, and must be run by the
+  // caller. Otherwise calls `done` once it has been run as part of a fused
+  // collective. `ctx` and `col_params` must live until then.
+  bool MaybeFuse(OpKernelContext* ctx, const CollectiveParams& col_params,
+                 const string& exec_key, const StatusCallback& done);
+
+  // Fails all the pending collectives, and any that are fused afterwards.
+  void StartAbort(const Status& s);
+
+  // Returns the number of buckets, which are erased once idle. For testing.
+  int num_buckets() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    OpKernelContext* ctx;
+    const CollectiveParams* col_params;
+    string exec_key;
+    StatusCallback done;
+  };
+
+  struct Bucket;
+  // Buckets by the time in microseconds at which rank 0 stops waiting for
+  // more collectives to fuse with their pending ones.
+  typedef std::multimap<uint64, Bucket*> TimeoutMap;
+
+  // The fusable collectives of one device with the same group, frame,
+  // iteration, type and reduction. Only `pending` and the fields after it
+  // change after the bucket is created. The bucket is erased once they show
+  // that it is idle.
+  struct Bucket {
+    string key;   // In buckets_.
+    string name;  // The same in all the members of the group.
+    Device* device = nullptr;
+    int rank = -1;
+    std::vector<string> device_names;
+    std::vector<string> task_names;
+    bool leader_is_local = false;
+    int64 threshold_bytes = 0;
+    int64 timeout_micros = 0;
+    // Collectives yet to run, in arrival order.
+    std::vector<Entry> pending;
+    int64 pending_bytes = 0;
+    // Rank 0 only: whether the bucket is in timeouts_, and where. The
+    // timeout is cancelled when the pending collectives are fused before it.
+    bool has_timeout = false;
+    TimeoutMap::iterator timeout;
+    // Rank 0 only: the number of members yet to receive the list of instance
+    // keys being sent, and the lists to send after it.
+    int num_receivers = 0;
+    std::deque<std::shared_ptr<Tensor>> unsent;
+    // Other ranks only: lists received from rank 0 that wait for some of
+    // their instances, and whether the next list is being received.
+    std::vector<std::vector<int32>> received;
+    bool receiving = false;
+  };
+
+  bool CanFuse(OpKernelContext* ctx, const CollectiveParams& col_params,
+               const string& exec_key, string* bucket_name) const;
+
+  // Rank 0: takes the pending collectives of `bucket` to fuse them. Returns
+  // the list of their instance keys if it is to be sent now, or nullptr if it
+  // is queued behind the list being sent.
+  std::shared_ptr<Tensor> TakePendingLocked(Bucket* bucket,
+                                            const string& trigger,
+                                            std::vector<Entry>* entries)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Rank 0: sends `keys` to the other members, and the lists queued after it
+  // once they have all received it.
+  void SendInstanceKeys(Bucket* bucket, std::shared_ptr<Tensor> keys)
+      TF_LOCKS_EXCLUDED(mu_);
+  void OnInstanceKeysSent(Bucket* bucket) TF_LOCKS_EXCLUDED(mu_);
+  // Body of timer_thread_: fuses the pending collectives of the buckets whose
+  // timeouts expire, until timer_stopped_.
+  void RunTimer() TF_LOCKS_EXCLUDED(mu_);
+
+  // Other ranks: returns true if the next list of instance keys is to be
+  // received, i.e. if some pending collective is in no list received yet.
+  bool MaybeReceiveLocked(Bucket* bucket) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void ReceiveInstanceKeys(Bucket* bucket) TF_LOCKS_EXCLUDED(mu_);
+  void OnReceived(Bucket* bucket, const Tensor& keys, const Status& s)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Moves the collectives of the received lists that no longer wait for any
+  // to `fusions`.
+  void TakeReadyLocked(Bucket* bucket, std::vector<std::vector<Entry>>* fusions)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Erases `bucket` if it has nothing left to run, send or receive.
+  void MaybeEraseLocked(Bucket* bucket) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Runs `entries` as one collective and calls their callbacks.
+  void RunFused(std::vector<Entry> entries);
+
+  CollectiveExecutor* const col_exec_;  // Not owned
+  const DeviceMgr* const dev_mgr_;      // Not owned
+  const RunCollectiveFn run_collective_;
+
+  mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+  // Buckets by device and bucket name.
+  std::unordered_map<string, Bucket> buckets_ TF_GUARDED_BY(mu_);
+  TimeoutMap timeouts_ TF_GUARDED_BY(mu_);
+  Env* timer_env_ TF_GUARDED_BY(mu_) = nullptr;
+  condition_variable timer_cv_;
+  bool timer_stopped_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> timer_thread_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CollectiveFusionBuffer);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_FUSION_BUFFER_H_
@@ -0,0 +1,429 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_fusion_buffer.h"
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kStepId = 123;
+constexpr int kGroupKey = 5;
+constexpr int kGroupSize = 4;
+constexpr int kThresholdBytes = 256;
+constexpr int kTimeoutMicros = 100 * 1000;
+
+// Records the keys of the buffers that devices provide to their peers.
+class RecordingRMA : public CollectiveRemoteAccessLocal {
+ public:
+  RecordingRMA(const DeviceMgr* dev_mgr, DeviceResolverInterface* dev_resolver)
+      : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, kStepId) {}
+
+  void PostToPeer(const string& peer_device, const string& peer_task,
+                  const string& key, Device* from_device,
+                  DeviceContext* from_device_ctx,
+                  const AllocatorAttributes& from_alloc_attr,
+                  const Tensor* from_tensor,
+                  const DeviceLocality& client_locality,
+                  CancellationManager* cancellation_manager,
+                  const StatusCallback& done) override {
+    {
+      mutex_lock l(mu_);
+      keys_.push_back(key);
+    }
+    CollectiveRemoteAccessLocal::PostToPeer(
+        peer_device, peer_task, key, from_device, from_device_ctx,
+        from_alloc_attr, from_tensor, client_locality, cancellation_manager,
+        done);
+  }
+
+  std::vector<string> keys() {
+    mutex_lock l(mu_);
+    return keys_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<string> keys_ TF_GUARDED_BY(mu_);
+};
+
+// Counts the timer threads that the fusion buffer starts with the Env of the
+// devices, and the closures scheduled to run after a delay.
+class CountingEnv : public EnvWrapper {
+ public:
+  CountingEnv() : EnvWrapper(Env::Default()) {}
+
+  Thread* StartThread(const ThreadOptions& thread_options, const string& name,
+                      std::function<void()> fn) override {
+    if (name == "collective_fusion_timer") {
+      mutex_lock l(mu_);
+      ++num_timer_threads_;
+    }
+    return EnvWrapper::StartThread(thread_options, name, std::move(fn));
+  }
+
+  void SchedClosureAfter(int64 micros, std::function<void()> closure) override {
+    {
+      mutex_lock l(mu_);
+      ++num_delayed_closures_;
+    }
+    EnvWrapper::SchedClosureAfter(micros, std::move(closure));
+  }
+
+  int num_timer_threads() {
+    mutex_lock l(mu_);
+    return num_timer_threads_;
+  }
+
+  int num_delayed_closures() {
+    mutex_lock l(mu_);
+    return num_delayed_closures_;
+  }
+
+ private:
+  mutex mu_;
+  int num_timer_threads_ TF_GUARDED_BY(mu_) = 0;
+  int num_delayed_closures_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Exposes the fusion buffer of the executor to the tests.
+class TestCollectiveExecutor : public BaseCollectiveExecutor {
+ public:
+  using BaseCollectiveExecutor::BaseCollectiveExecutor;
+
+  int num_fusion_buckets() { return fusion_buffer_->num_buckets(); }
+};
+
+std::unique_ptr<OpKernel> GetKernel(const NodeDef& node, DeviceBase* device) {
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node,
+      TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class CollectiveFusionBufferTest : public ::testing::Test {
+ protected:
+  // One all-reduce on one device, run through the collective executor.
+  struct Instance {
+    CollectiveParams col_params;
+    Tensor tensor;
+    std::unique_ptr<OpKernel> op;
+    OpKernelContext::Params op_params;
+    gtl::InlinedVector<TensorValue, 4> inputs;
+    gtl::InlinedVector<AllocatorAttributes, 4> input_attrs;
+    int forward_from = 0;
+    AllocatorAttributes output_attrs;
+    std::unique_ptr<OpKernelContext> ctx;
+    Notification done;
+    Status status;
+  };
+
+  CollectiveFusionBufferTest() {
+    std::vector<std::unique_ptr<Device>> devices;
+    SessionOptions options;
+    options.env = &env_;
+    for (int rank = 0; rank < kGroupSize; ++rank) {
+      devices.push_back(absl::make_unique<ThreadPoolDevice>(
+          options, DeviceName(rank), Bytes(4 << 20), DeviceLocality(),
+          cpu_allocator()));
+    }
+    dev_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    rma_ = new RecordingRMA(dev_mgr_.get(), dev_resolver_.get());
+    col_exec_ = new TestCollectiveExecutor(
+        &col_exec_mgr_, rma_, kStepId, dev_mgr_.get(), &gpu_ring_order_,
+        std::make_shared<UnboundedWorkQueue>(Env::Default(), "test"));
+    for (int rank = 0; rank < kGroupSize; ++rank) {
+      Device* device;
+      TF_CHECK_OK(dev_mgr_->LookupDevice(DeviceName(rank), &device));
+      NodeDef node_def;
+      TF_CHECK_OK(NodeDefBuilder("add", "Add")
+                      .Attr("T", DT_FLOAT)
+                      .Input(FakeInput(DT_FLOAT))
+                      .Input(FakeInput(DT_FLOAT))
+                      .Finalize(&node_def));
+      merge_ops_.push_back(GetKernel(node_def, device));
+    }
+  }
+
+  ~CollectiveFusionBufferTest() override {
+    for (const auto& instance : instances_) {
+      instance->done.WaitForNotification();
+    }
+    col_exec_->Unref();
+  }
+
+  static string DeviceName(int rank) {
+    return strings::StrCat("/job:worker/replica:0/task:0/device:CPU:", rank);
+  }
+
+  // Starts the all-reduce `instance_key` of `num_elements` on `rank`, in
+  // iteration `iter` of the root frame.
+  Instance* Start(int rank, int instance_key, int num_elements, int iter = 0) {
+    Device* device;
+    TF_CHECK_OK(dev_mgr_->LookupDevice(DeviceName(rank), &device));
+    instances_.push_back(absl::make_unique<Instance>());
+    Instance* instance = instances_.back().get();
+    CollectiveParams& cp = instance->col_params;
+    cp.name = "fused_all_reduce";
+    cp.group.group_key = kGroupKey;
+    cp.group.group_size = kGroupSize;
+    cp.group.device_type = DEVICE_CPU;
+    cp.group.num_tasks = 1;
+    cp.group.fusion_threshold_bytes = threshold_bytes_;
+    cp.group.fusion_timeout_micros = kTimeoutMicros;
+    for (int r = 0; r < kGroupSize; ++r) {
+      cp.group.device_names.push_back(DeviceName(r));
+      cp.group.task_names.push_back("/job:worker/replica:0/task:0");
+      cp.task.is_local.push_back(true);
+    }
+    cp.group.num_devices_per_task["/job:worker/replica:0/task:0"] = kGroupSize;
+    cp.instance.type = REDUCTION_COLLECTIVE;
+    cp.instance.instance_key = instance_key;
+    cp.instance.data_type = DT_FLOAT;
+    cp.instance.shape = TensorShape({num_elements});
+    cp.instance.impl_details.collective_name = "RingReduce";
+    cp.instance.impl_details.subdiv_offsets.push_back(0);
+    cp.default_rank = rank;
+    cp.merge_op = merge_ops_[rank].get();
+    CollectiveImplementationInterface* col_impl;
+    TF_CHECK_OK(CollectiveRegistry::LookupParamResolverInstance("RingReduce",
+                                                                &col_impl));
+    TF_CHECK_OK(col_impl->InitializeCollectiveParams(&cp));
+
+    instance->tensor = Tensor(DT_FLOAT, TensorShape({num_elements}));
+    for (int i = 0; i < num_elements; ++i) {
+      instance->tensor.flat<float>()(i) = Value(rank, instance_key, i);
+    }
+    NodeDef node_def;
+    TF_CHECK_OK(
+        NodeDefBuilder(strings::StrCat("reduce_", rank, "_", instance_key),
+                       "CollectiveReduce")
+            .Attr("T", DT_FLOAT)
+            .Attr("merge_op", "Add")
+            .Attr("final_op", "Id")
+            .Attr("group_size", kGroupSize)
+            .Attr("group_key", kGroupKey)
+            .Attr("instance_key", instance_key)
+            .Attr("subdiv_offsets", std::vector<int>({0}))
+            .Input(FakeInput(DT_FLOAT))
+            .Finalize(&node_def));
+    instance->op = GetKernel(node_def, device);
+    OpKernelContext::Params& op_params = instance->op_params;
+    op_params.step_id = kStepId;
+    op_params.device = device;
+    op_params.op_kernel = instance->op.get();
+    op_params.collective_executor = col_exec_;
+    instance->inputs.push_back(TensorValue(&instance->tensor));
+    op_params.inputs = &instance->inputs;
+    instance->input_attrs.push_back(AllocatorAttributes());
+    op_params.input_alloc_attrs = &instance->input_attrs;
+    op_params.forward_from_array = &instance->forward_from;
+    op_params.output_attr_array = &instance->output_attrs;
+    instance->ctx = absl::make_unique<OpKernelContext>(&op_params, 1);
+    Tensor* output = nullptr;
+    TF_CHECK_OK(instance->ctx->forward_input_or_allocate_output(
+        {0}, 0, instance->tensor.shape(), &output));
+
+    const string exec_key =
+        strings::StrCat(kGroupKey, ":", instance_key, ":0:", iter);
+    col_exec_->ExecuteAsync(instance->ctx.get(), cp, exec_key,
+                            [instance](const Status& s) {
+                              instance->status = s;
+                              instance->done.Notify();
+                            });
+    return instance;
+  }
+
+  static float Value(int rank, int instance_key, int i) {
+    return rank * 1000 + instance_key * 10 + i;
+  }
+
+  // Checks that every instance completed with the sum of its inputs.
+  void ExpectReduced() {
+    for (const auto& instance : instances_) {
+      instance->done.WaitForNotification();
+      TF_ASSERT_OK(instance->status);
+      const Tensor& output = *instance->ctx->mutable_output(0);
+      for (int i = 0; i < output.NumElements(); ++i) {
+        float expected = 0;
+        for (int rank = 0; rank < kGroupSize; ++rank) {
+          expected +=
+              Value(rank, instance->col_params.instance.instance_key, i);
+        }
+        EXPECT_FLOAT_EQ(expected, output.flat<float>()(i))
+            << "instance " << instance->col_params.instance.instance_key
+            << " index " << i;
+      }
+    }
+  }
+
+  // Returns the number of lists of fused instances sent by rank 0, and of
+  // buffers posted by all-reduces that are not fused.
+  void CountKeys(int* num_fusion_keys, int* num_unfused_keys) {
+    *num_fusion_keys = 0;
+    *num_unfused_keys = 0;
+    for (const string& key : rma_->keys()) {
+      if (absl::StartsWith(key, "fusion:")) {
+        ++*num_fusion_keys;
+      } else if (!absl::StrContains(key, ":fused")) {
+        ++*num_unfused_keys;
+      }
+    }
+  }
+
+  // Outlives the devices and the executor.
+  CountingEnv env_;
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  RecordingRMA* rma_;  // Owned by col_exec_
+  TestCollectiveExecutor* col_exec_;
+  const string gpu_ring_order_;
+  std::vector<std::unique_ptr<OpKernel>> merge_ops_;
+  std::vector<std::unique_ptr<Instance>> instances_;
+  // As set by the group leader.
+  int64 threshold_bytes_ = kThresholdBytes;
+};
+
+TEST_F(CollectiveFusionBufferTest, FusesOnceThresholdIsReached) {
+  // Each all-reduce is 64 bytes, so rank 0 fuses them four at a time. The
+  // other ranks start them in other orders.
+  for (int i = 0; i < 8; ++i) {
+    for (int rank = 0; rank < kGroupSize; ++rank) {
+      Start(rank, 100 + (i + rank * 3) % 8, 16);
+    }
+  }
+  ExpectReduced();
+  int num_fusion_keys, num_unfused_keys;
+  CountKeys(&num_fusion_keys, &num_unfused_keys);
+  EXPECT_EQ(2 * (kGroupSize - 1), num_fusion_keys);
+  EXPECT_EQ(0, num_unfused_keys);
+}
+
+TEST_F(CollectiveFusionBufferTest, FusesOnTimeout) {
+  for (int rank = kGroupSize - 1; rank >= 0; --rank) {
+    for (int instance_key = 200; instance_key < 203; ++instance_key) {
+      Start(rank, instance_key, 7);
+    }
+  }
+  ExpectReduced();
+  int num_fusion_keys, num_unfused_keys;
+  CountKeys(&num_fusion_keys, &num_unfused_keys);
+  EXPECT_EQ(kGroupSize - 1, num_fusion_keys);
+  EXPECT_EQ(0, num_unfused_keys);
+}
+
+TEST_F(CollectiveFusionBufferTest, TimeoutsShareOneThread) {
+  // Each iteration fuses into a bucket of its own on a timeout, after the
+  // previous one has completed.
+  for (int iter = 0; iter < 3; ++iter) {
+    for (int rank = 0; rank < kGroupSize; ++rank) {
+      for (int instance_key = 700; instance_key < 702; ++instance_key) {
+        Start(rank, instance_key, 7, iter);
+      }
+    }
+    ExpectReduced();
+  }
+  int num_fusion_keys, num_unfused_keys;
+  CountKeys(&num_fusion_keys, &num_unfused_keys);
+  EXPECT_EQ(3 * (kGroupSize - 1), num_fusion_keys);
+  EXPECT_EQ(1, env_.num_timer_threads());
+  EXPECT_EQ(0, env_.num_delayed_closures());
+}
+
+TEST_F(CollectiveFusionBufferTest, DoesNotFuseLargeReductions) {
+  for (int rank = 0; rank < kGroupSize; ++rank) {
+    Start(rank, 300, kThresholdBytes / sizeof(float));
+  }
+  ExpectReduced();
+  int num_fusion_keys, num_unfused_keys;
+  CountKeys(&num_fusion_keys, &num_unfused_keys);
+  EXPECT_EQ(0, num_fusion_keys);
+  EXPECT_GT(num_unfused_keys, 0);
+}
+
+TEST_F(CollectiveFusionBufferTest, DoesNotFuseWithoutThreshold) {
+  threshold_bytes_ = 0;
+  for (int rank = 0; rank < kGroupSize; ++rank) {
+    Start(rank, 500, 4);
+  }
+  ExpectReduced();
+  int num_fusion_keys, num_unfused_keys;
+  CountKeys(&num_fusion_keys, &num_unfused_keys);
+  EXPECT_EQ(0, num_fusion_keys);
+  EXPECT_GT(num_unfused_keys, 0);
+  EXPECT_EQ(0, col_exec_->num_fusion_buckets());
+}
+
+TEST_F(CollectiveFusionBufferTest, ErasesIdleBuckets) {
+  // As in a while loop, each iteration fuses into a bucket of its own.
+  for (int iter = 0; iter < 5; ++iter) {
+    for (int rank = 0; rank < kGroupSize; ++rank) {
+      for (int instance_key = 600; instance_key < 604; ++instance_key) {
+        Start(rank, instance_key, 16, iter);
+      }
+    }
+  }
+  ExpectReduced();
+  int num_fusion_keys, num_unfused_keys;
+  CountKeys(&num_fusion_keys, &num_unfused_keys);
+  EXPECT_EQ(5 * (kGroupSize - 1), num_fusion_keys);
+  // The buckets are erased once the callbacks of the fused reductions and
+  // of the posted instance keys have run, which may be after `done`.
+  for (int i = 0; i < 100 && col_exec_->num_fusion_buckets() > 0; ++i) {
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+  }
+  EXPECT_EQ(0, col_exec_->num_fusion_buckets());
+}
+
+TEST_F(CollectiveFusionBufferTest, AbortFailsPendingReductions) {
+  // Rank 0 never starts the reduction, so the others wait for it.
+  for (int rank = 1; rank < kGroupSize; ++rank) {
+    Start(rank, 400, 4);
+  }
+  col_exec_->StartAbort(errors::Internal("Deliberate failure"));
+  for (const auto& instance : instances_) {
+    instance->done.WaitForNotification();
+    EXPECT_NE(instance->status.error_message().find("Deliberate failure"),
+              string::npos)
+        << instance->status;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -42,6 +42,12 @@ CollectiveParamResolverLocal::CollectiveParamResolverLocal(
     const ConfigProto& config, const DeviceMgr* dev_mgr,
     DeviceResolverInterface* dev_resolver, const string& task_name)
     : nccl_(config.experimental().collective_nccl()),
+      halving_doubling_max_bytes_(
+          config.experimental().collective_halving_doubling_max_bytes()),
+      fusion_threshold_bytes_(
+          config.experimental().collective_fusion_threshold_bytes()),
+      fusion_timeout_micros_(
+          config.experimental().collective_fusion_timeout_micros()),
       dev_mgr_(dev_mgr),
       dev_resolver_(dev_resolver),
       task_name_(task_name) {}
@@ -56,13 +62,34 @@ void CollectiveParamResolverLocal::CompleteGroupAsync(
 }
 
 namespace {
+// Returns true if the reduction of `cp` should use recursive halving-doubling,
+// which takes fewer steps than a ring but only supports CPU groups whose size
+// is a power of two. The group leader sets the size limit for the whole
+// group, so that every member makes the same choice.
+bool UseHalvingDoubling(const CollectiveParams* cp) {
+  const int group_size = cp->group.group_size;
+  if (cp->group.halving_doubling_max_bytes <= 0 ||
+      cp->group.device_type != "CPU" ||
+      cp->instance.impl_details.communication_hint == "ring" ||
+      group_size < 2 || (group_size & (group_size - 1)) != 0 ||
+      cp->instance.shape.num_elements() * DataTypeSize(cp->instance.data_type) >
+          cp->group.halving_doubling_max_bytes) {
+    return false;
+  }
+  CollectiveImplementationInterface* col_impl;
+  return CollectiveRegistry::LookupParamResolverInstance(
+             "HalvingDoublingReduce", &col_impl)
+      .ok();
+}
+
 const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   switch (cp->instance.type) {
     case BROADCAST_COLLECTIVE:
       return "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      return UseHalvingDoubling(cp) ? "HalvingDoublingReduce" : "RingReduce";
 
     case GATHER_COLLECTIVE:
       return "RingGather";
@@ -102,6 +129,9 @@ void CollectiveParamResolverLocal::CompleteGroupLocal(
       gr->group.group_size = cp->group.group_size;
       gr->group.device_type = cp->group.device_type;
       gr->group.gpu_ring_order = cp->group.gpu_ring_order;
+      gr->group.halving_doubling_max_bytes = halving_doubling_max_bytes_;
+      gr->group.fusion_threshold_bytes = fusion_threshold_bytes_;
+      gr->group.fusion_timeout_micros = fusion_timeout_micros_;
 
       // Initialize group runtime details.
       CollectiveImplementationInterface* col_impl;
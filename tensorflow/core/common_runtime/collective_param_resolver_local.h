@@ -181,6 +181,9 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
       TF_LOCKS_EXCLUDED(status_mu_, group_mu_, instance_mu_);
 
   const bool nccl_;
+  const int64 halving_doubling_max_bytes_;
+  const int64 fusion_threshold_bytes_;
+  const int64 fusion_timeout_micros_;
   const DeviceMgr* dev_mgr_;
   DeviceResolverInterface* dev_resolver_;  // Not owned.
   string task_name_;
@@ -52,12 +52,51 @@ class CollectiveParamResolverLocalTest : public ::testing::Test {
     ResetParamResolver();
   }
 
-  void ResetParamResolver() {
-    ConfigProto cp;
-    prl_.reset(new CollectiveParamResolverLocal(cp, device_mgr_.get(),
+  void ResetParamResolver(const ConfigProto& config = ConfigProto()) {
+    prl_.reset(new CollectiveParamResolverLocal(config, device_mgr_.get(),
                                                 drl_.get(), task_name_));
   }
 
+  // Completes the params of an all-reduce of `num_elements` floats by the
+  // first `group_size` devices, and returns the implementation picked for it.
+  string ReductionName(int group_size, int64 num_elements,
+                       const string& communication_hint) {
+    std::vector<CollectiveParams> cps(group_size);
+    std::vector<Status> statuses(group_size);
+    BlockingCounter counter(group_size);
+    ++instance_key_;
+    for (int i = 0; i < group_size; ++i) {
+      CollectiveParams* cp = &cps[i];
+      cp->group.group_key = group_size;
+      cp->group.group_size = group_size;
+      cp->group.device_type = DeviceType("CPU");
+      cp->group.num_tasks = 1;
+      cp->instance.instance_key = instance_key_;
+      cp->instance.type = REDUCTION_COLLECTIVE;
+      cp->instance.data_type = DataType(DT_FLOAT);
+      cp->instance.shape = TensorShape({num_elements});
+      cp->instance.impl_details.subdiv_offsets.push_back(0);
+      cp->instance.impl_details.communication_hint = communication_hint;
+      Env::Default()->SchedClosure([this, i, cp, &statuses, &counter]() {
+        string device =
+            strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i);
+        prl_->CompleteParamsAsync(GetDeviceAttributes(device), cp,
+                                  nullptr /*CancellationManager*/,
+                                  [&statuses, &counter, i](const Status& s) {
+                                    statuses[i] = s;
+                                    counter.DecrementCount();
+                                  });
+      });
+    }
+    counter.Wait();
+    for (int i = 0; i < group_size; ++i) {
+      TF_EXPECT_OK(statuses[i]);
+      EXPECT_EQ(cps[i].instance.impl_details.collective_name,
+                cps[0].instance.impl_details.collective_name);
+    }
+    return cps[0].instance.impl_details.collective_name;
+  }
+
   void RunCompleteDefaultRanking(
       CollGroupParams group, const std::vector<DeviceAttributes>& attributes,
       const std::vector<int32>& gpu_ring_order,
@@ -86,6 +125,7 @@ class CollectiveParamResolverLocalTest : public ::testing::Test {
   std::unique_ptr<DeviceMgr> device_mgr_;
   std::unique_ptr<DeviceResolverLocal> drl_;
   std::unique_ptr<CollectiveParamResolverLocal> prl_;
+  int32 instance_key_ = 0;
 };
 
 TEST_F(CollectiveParamResolverLocalTest, CompleteDefaultRanking) {
@@ -206,6 +246,28 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   }
 }
 
+TEST_F(CollectiveParamResolverLocalTest, HalvingDoublingIsOptIn) {
+  EXPECT_EQ(ReductionName(/*group_size=*/2, /*num_elements=*/16, ""),
+            "RingReduce");
+}
+
+TEST_F(CollectiveParamResolverLocalTest, HalvingDoublingSelection) {
+  ConfigProto config;
+  config.mutable_experimental()->set_collective_halving_doubling_max_bytes(64);
+  ResetParamResolver(config);
+  EXPECT_EQ(ReductionName(/*group_size=*/2, /*num_elements=*/16, ""),
+            "HalvingDoublingReduce");
+  // Larger than the limit.
+  EXPECT_EQ(ReductionName(/*group_size=*/2, /*num_elements=*/17, ""),
+            "RingReduce");
+  // Asks for a ring.
+  EXPECT_EQ(ReductionName(/*group_size=*/2, /*num_elements=*/16, "ring"),
+            "RingReduce");
+  // Not a power of two.
+  EXPECT_EQ(ReductionName(/*group_size=*/3, /*num_elements=*/16, ""),
+            "RingReduce");
+}
+
 void InitializeCollectiveParamsForBroadcast(int instance_key, int device_idx,
                                             bool is_source,
                                             CollectiveParams* cp) {
@@ -103,6 +103,7 @@ Status NewThreadPoolFromThreadPoolOptions(
     *pool = new thread::ThreadPool(
         options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
         num_threads, !options.config.experimental().disable_thread_spinning(),
+        options.config.experimental().use_numa_worker_groups(),
         /*allocator=*/nullptr);
     *owned = true;
     return Status::OK();
@@ -120,6 +121,7 @@ Status NewThreadPoolFromThreadPoolOptions(
     mvalue->second = new thread::ThreadPool(
         options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
         num_threads, !options.config.experimental().disable_thread_spinning(),
+        options.config.experimental().use_numa_worker_groups(),
         /*allocator=*/nullptr);
   } else {
     if (mvalue->first != thread_pool_options.num_threads()) {
@@ -1377,6 +1379,8 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.batch_inexpensive_nodes =
+        options_.config.graph_options().batch_inexpensive_nodes();
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
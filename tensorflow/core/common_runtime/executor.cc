@@ -142,7 +142,9 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p)
+      : immutable_state_(p),
+        batch_inexpensive_nodes_(p.batch_inexpensive_nodes) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -216,6 +218,10 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // When set, inexpensive nodes that become ready together outside of an
+  // inline chain (the root nodes, and the successors of asynchronous kernels)
+  // are run from a single closure instead of one closure each.
+  const bool batch_inexpensive_nodes_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -274,7 +280,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool batch_inexpensive_nodes);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -291,6 +298,11 @@ class ExecutorState {
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_nsec);
 
+  // Process the `num_nodes` ready nodes starting at `nodes` in current thread,
+  // in order, along with the inexpensive nodes they make ready.
+  void ProcessNodes(const TaggedNode* nodes, size_t num_nodes,
+                    int64 scheduled_nsec);
+
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
@@ -371,6 +383,7 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  const bool batch_inexpensive_nodes_;
 
   PropagatorStateType propagator_;
 
@@ -392,7 +405,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool batch_inexpensive_nodes)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -415,6 +428,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      batch_inexpensive_nodes_(batch_inexpensive_nodes),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
@@ -670,6 +684,15 @@ void ExecutorState<PropagatorStateType>::ProcessConstTensor(
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
                                                  int64 scheduled_nsec) {
+  ProcessNodes(&tagged_node, 1, scheduled_nsec);
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ProcessNodes(const TaggedNode* nodes,
+                                                      size_t num_nodes,
+                                                      int64 scheduled_nsec) {
+  DCHECK_GT(num_nodes, 0);
+  TaggedNode tagged_node = nodes[0];
   profiler::TraceMeConsumer activity(
       // From TraceMeProducer in DirectSession::RunInternal,
       // GraphMgr::ExecuteAsync, or FunctionLibraryRuntime::Run.
@@ -747,7 +770,9 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   EntryVector outputs(1);
 
   bool completed = false;
-  inline_ready.push_back(tagged_node);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    inline_ready.push_back(nodes[i]);
+  }
   while (!inline_ready.empty()) {
     tagged_node = inline_ready.front();
     inline_ready.pop_front();
@@ -1172,7 +1197,26 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     }
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
-    if (inline_ready == nullptr) {
+    if (inline_ready == nullptr && batch_inexpensive_nodes_) {
+      // Schedule the expensive ops in thread pool, one closure each, and run
+      // the inexpensive ones together from a single closure. The expensive
+      // nodes they make ready will still be dispatched to other threads, since
+      // that closure has inline work queued.
+      TaggedNodeSeq inexpensive_nodes;
+      for (auto& tagged_node : *ready) {
+        const NodeItem& item = *tagged_node.node_item;
+        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+          inexpensive_nodes.push_back(tagged_node);
+        } else {
+          RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+        }
+      }
+      if (!inexpensive_nodes.empty()) {
+        RunTask([this, nodes = std::move(inexpensive_nodes), scheduled_nsec]() {
+          ProcessNodes(nodes.data(), nodes.size(), scheduled_nsec);
+        });
+      }
+    } else if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
         RunTask([=]() { Process(tagged_node, scheduled_nsec); });
@@ -1345,11 +1389,12 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        batch_inexpensive_nodes_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, batch_inexpensive_nodes_))
         ->RunAsync(std::move(done));
   }
 }
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -67,10 +68,12 @@ class ExecutorTest : public ::testing::Test {
   }
 
   // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  void Create(std::unique_ptr<const Graph> graph,
+              bool batch_inexpensive_nodes = false) {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.batch_inexpensive_nodes = batch_inexpensive_nodes;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -430,6 +433,54 @@ TEST_F(ExecutorTest, NoInputTensors) {
   TF_ASSERT_OK(Run(rendez_));
 }
 
+class BatchInexpensiveNodesTest : public ExecutorTest {
+ protected:
+  // Runs out = sum(identity^4(i) for i in [0, 16)), where the 16 constants
+  // are all root nodes, and returns the number of closures that the last step
+  // scheduled.
+  int64 RunAndCountClosures(bool batch_inexpensive_nodes) {
+    auto g = absl::make_unique<Graph>(OpRegistry::Global());
+    Node* sum = nullptr;
+    for (int i = 0; i < 16; ++i) {
+      Node* v = test::graph::Constant(g.get(), V(i));
+      for (int j = 0; j < 4; ++j) {
+        v = test::graph::Identity(g.get(), v);
+      }
+      sum = sum ? test::graph::Add(g.get(), sum, v) : v;
+    }
+    test::graph::Send(g.get(), sum, "out", BOB, 1, ALICE);
+    Create(std::move(g), batch_inexpensive_nodes);
+    std::atomic<int64> num_closures(0);
+    runner_ = [this, &num_closures](std::function<void()> fn) {
+      ++num_closures;
+      thread_pool_->Schedule(fn);
+    };
+    // Enough steps for the measured cost of `Add` to mark it inexpensive.
+    for (int step = 0; step < 200; ++step) {
+      num_closures = 0;
+      TF_EXPECT_OK(Run(rendez_));
+      Rendezvous::Args args;
+      Tensor out = V(-1);
+      bool is_dead = false;
+      TF_EXPECT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "out"), args,
+                                 &out, &is_dead));
+      EXPECT_EQ(120.0, V(out));
+    }
+    return num_closures;
+  }
+};
+
+TEST_F(BatchInexpensiveNodesTest, Disabled) {
+  // Every root constant gets its own closure.
+  EXPECT_GE(RunAndCountClosures(/*batch_inexpensive_nodes=*/false), 16);
+}
+
+TEST_F(BatchInexpensiveNodesTest, Enabled) {
+  // All the roots are inexpensive, so they share a single closure, and so do
+  // their inexpensive successors.
+  EXPECT_LT(RunAndCountClosures(/*batch_inexpensive_nodes=*/true), 16);
+}
+
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
@@ -484,6 +535,137 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+// Runs a graph of `width` independent chains of `depth` scalar additions on an
+// inter-op pool with or without NUMA worker groups.
+static void BM_InterOpPoolHelper(::testing::benchmark::State& state,
+                                 bool numa_worker_groups) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  for (int i = 0; i < width; ++i) {
+    Node* v = test::graph::Constant(g, V(i));
+    for (int j = 0; j < depth; ++j) {
+      v = test::graph::Add(g, v, v);
+    }
+  }
+  FixupSourceAndSinkEdges(g);
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_worker_groups(
+      numa_worker_groups);
+  test::Benchmark("cpu", g, &options, /*init=*/nullptr, /*rendez=*/nullptr,
+                  /*executor_type=*/"", /*old_benchmark_api=*/false)
+      .Run(state);
+
+  state.SetLabel(strings::StrCat("Nodes = ", width * (depth + 1)));
+  state.SetItemsProcessed(width * (depth + 1) *
+                          static_cast<int64>(state.iterations()));
+}
+
+static void BM_executor_inter_op_pool(::testing::benchmark::State& state) {
+  BM_InterOpPoolHelper(state, /*numa_worker_groups=*/false);
+}
+BENCHMARK(BM_executor_inter_op_pool)
+    ->UseRealTime()
+    ->ArgPair(256, 16)
+    ->ArgPair(4096, 1);
+
+static void BM_executor_numa_worker_groups(::testing::benchmark::State& state) {
+  BM_InterOpPoolHelper(state, /*numa_worker_groups=*/true);
+}
+BENCHMARK(BM_executor_numa_worker_groups)
+    ->UseRealTime()
+    ->ArgPair(256, 16)
+    ->ArgPair(4096, 1);
+
+// Runs a graph of `width` independent chains of `depth` scalar additions, and
+// reports the median and 99th percentile step latency.
+static void BM_StepLatencyHelper(::testing::benchmark::State& state,
+                                 bool batch_inexpensive_nodes) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+
+  Graph g(OpRegistry::Global());
+  for (int i = 0; i < width; ++i) {
+    Node* v = test::graph::Constant(&g, V(i));
+    for (int j = 0; j < depth; ++j) {
+      v = test::graph::Add(&g, v, v);
+    }
+  }
+  FixupSourceAndSinkEdges(&g);
+
+  std::unique_ptr<Device> device = DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0");
+  thread::ThreadPool pool(Env::Default(), "executor_step_latency",
+                          port::MaxParallelism());
+  const int version = g.versions().producer();
+  LocalExecutorParams params;
+  params.device = device.get();
+  params.create_kernel =
+      [&device, version](const std::shared_ptr<const NodeProperties>& props,
+                         OpKernel** kernel) {
+        return CreateNonCachedKernel(device.get(), nullptr, props, version,
+                                     kernel);
+      };
+  params.delete_kernel = [](OpKernel* kernel) {
+    DeleteNonCachedKernel(kernel);
+  };
+  params.batch_inexpensive_nodes = batch_inexpensive_nodes;
+  Executor* exec = nullptr;
+  TF_CHECK_OK(NewLocalExecutor(params, g, &exec));
+
+  Rendezvous* rendez = NewLocalRendezvous();
+  Executor::Args args;
+  args.rendezvous = rendez;
+  args.runner = [&pool](std::function<void()> fn) { pool.Schedule(fn); };
+  // Lets the executor measure the cost of every kernel before timing.
+  for (int i = 0; i < 200; ++i) {
+    TF_CHECK_OK(exec->Run(args));
+  }
+
+  std::vector<uint64> latencies_nsec;
+  for (auto s : state) {
+    const uint64 start_nsec = Env::Default()->NowNanos();
+    TF_CHECK_OK(exec->Run(args));
+    latencies_nsec.push_back(Env::Default()->NowNanos() - start_nsec);
+  }
+  delete exec;
+  rendez->Unref();
+
+  std::sort(latencies_nsec.begin(), latencies_nsec.end());
+  auto percentile_usec = [&latencies_nsec](double p) {
+    if (latencies_nsec.empty()) return 0.0;
+    const size_t index = std::min<size_t>(latencies_nsec.size() - 1,
+                                          p * latencies_nsec.size());
+    return latencies_nsec[index] / 1000.0;
+  };
+  state.SetLabel(strings::StrCat("Nodes = ", width * (depth + 1),
+                                 " p50 = ", percentile_usec(0.5),
+                                 "us p99 = ", percentile_usec(0.99), "us"));
+  state.SetItemsProcessed(width * (depth + 1) *
+                          static_cast<int64>(state.iterations()));
+}
+
+static void BM_executor_step_latency(::testing::benchmark::State& state) {
+  BM_StepLatencyHelper(state, /*batch_inexpensive_nodes=*/false);
+}
+BENCHMARK(BM_executor_step_latency)
+    ->UseRealTime()
+    ->ArgPair(64, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(1024, 2);
+
+static void BM_executor_step_latency_batched(
+    ::testing::benchmark::State& state) {
+  BM_StepLatencyHelper(state, /*batch_inexpensive_nodes=*/true);
+}
+BENCHMARK(BM_executor_step_latency_batched)
+    ->UseRealTime()
+    ->ArgPair(64, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(1024, 2);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
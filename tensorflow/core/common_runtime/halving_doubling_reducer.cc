@@ -0,0 +1,241 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/halving_doubling_reducer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+string HalvingDoublingBufKey(const string& exec_key, int pass, int step,
+                             int source_rank) {
+  return strings::StrCat(exec_key, ":hd:", pass, ":", step, ":", source_rank);
+}
+
+}  // namespace
+
+Status HalvingDoublingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HalvingDoublingReduce does not implement ",
+                            col_params->ToString());
+  }
+  const int group_size = col_params->group.group_size;
+  if (group_size < 1 || (group_size & (group_size - 1)) != 0) {
+    return errors::InvalidArgument(
+        "HalvingDoublingReduce requires a group size that is a power of two, "
+        "got ",
+        group_size);
+  }
+  return Status::OK();
+}
+
+Status HalvingDoublingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HalvingDoublingReducer::Run(StatusCallback done) {
+  // Like RingReducer, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  Status s = CopyInputToOutput();
+  if (s.ok()) {
+    const int group_size = col_params_->group.group_size;
+    AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+    ca_.reset(MakeCollectiveAdapter(col_ctx_->output, group_size,
+                                    col_ctx_->device->GetAllocator(attr)));
+    const int64 element_bytes = DataTypeSize(ca_->Value().dtype());
+    chunk_starts_.assign(1, 0);
+    for (int i = 0; i < group_size; ++i) {
+      chunk_starts_.push_back(chunk_starts_.back() +
+                              ca_->ChunkBytes(i) / element_bytes);
+    }
+    s = RunSteps();
+    ca_->ConsumeFinalValue(col_ctx_->output);
+    ca_.reset();
+  }
+  done(s);
+}
+
+Status HalvingDoublingReducer::CopyInputToOutput() {
+  if ((col_ctx_->input == col_ctx_->output) ||
+      (DMAHelper::base(col_ctx_->input) == DMAHelper::base(col_ctx_->output))) {
+    return Status::OK();
+  }
+  Notification note;
+  Status status;
+  profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+      col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+      col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+      [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HalvingDoublingReducer::RunSteps() {
+  const int group_size = col_params_->group.group_size;
+  const int rank = col_params_->default_rank;
+  int step = 0;
+  // The chunks [begin, end) that this device is reducing, and then holds.
+  int begin = 0;
+  int end = group_size;
+
+  // First pass: each step sends the half of the chunks that the peer keeps
+  // reducing, and merges the other half with the peer's copy of it.
+  for (int distance = group_size / 2; distance >= 1; distance /= 2, ++step) {
+    const int mid = begin + distance;
+    const bool keep_upper = (rank & distance) != 0;
+    const int keep_begin = keep_upper ? mid : begin;
+    const int keep_end = keep_upper ? end : mid;
+    Tensor received(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        ca_->Value().dtype(),
+        TensorShape({chunk_starts_[keep_end] - chunk_starts_[keep_begin]}));
+    TF_RETURN_IF_ERROR(Exchange(/*pass=*/0, step, rank ^ distance,
+                                keep_upper ? begin : mid,
+                                keep_upper ? mid : end, &received));
+    Tensor kept = ChunksAlias(keep_begin, keep_end);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &kept, &received));
+    begin = keep_begin;
+    end = keep_end;
+  }
+
+  if (col_params_->final_op) {
+    Tensor group_size_tensor = ca_->Scalar(group_size);
+    Tensor reduced = ChunksAlias(begin, end);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &reduced, &group_size_tensor));
+  }
+
+  // Second pass: each step exchanges all the chunks held with the same peers
+  // as the first pass, in reverse order.
+  for (int distance = 1; distance < group_size; distance *= 2, ++step) {
+    const bool peer_below = (rank & distance) != 0;
+    const int peer_begin = peer_below ? begin - distance : end;
+    const int peer_end = peer_below ? begin : end + distance;
+    Tensor received = ChunksAlias(peer_begin, peer_end);
+    TF_RETURN_IF_ERROR(
+        Exchange(/*pass=*/1, step, rank ^ distance, begin, end, &received));
+    begin = std::min(begin, peer_begin);
+    end = std::max(end, peer_end);
+  }
+  VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
+          << " final value " << ca_->DebugString();
+  return Status::OK();
+}
+
+Tensor HalvingDoublingReducer::ChunksAlias(int begin, int end) const {
+  const int64 start = chunk_starts_[begin];
+  const int64 limit = chunk_starts_[end];
+  // Like CollectiveAdapter::ChunkAlias, takes empty slices from the front of
+  // the tensor.
+  return (limit > start) ? ca_->Value().Slice(start, limit)
+                         : ca_->Value().Slice(0, 0);
+}
+
+Status HalvingDoublingReducer::Exchange(int pass, int step, int peer_rank,
+                                        int send_begin, int send_end,
+                                        Tensor* recv_tensor) {
+  const int rank = col_params_->default_rank;
+  const string& peer_device = col_params_->group.device_names[peer_rank];
+  const string& peer_task = col_params_->group.task_names[peer_rank];
+  VLOG(3) << "Exchange rank=" << rank << " peer=" << peer_rank << " pass "
+          << pass << " step " << step << " sends chunks [" << send_begin
+          << ", " << send_end << ")";
+  CollectiveRemoteAccess* remote_access = col_ctx_->col_exec->remote_access();
+  OpKernelContext* op_ctx = col_ctx_->op_ctx;
+
+  // A failed transfer aborts the other one, which otherwise may wait for a
+  // peer that never takes part in it.
+  Tensor send_tensor = ChunksAlias(send_begin, send_end);
+  Notification send_done;
+  Status send_status;
+  remote_access->PostToPeer(
+      peer_device, peer_task,
+      HalvingDoublingBufKey(col_ctx_->exec_key, pass, step, rank),
+      col_ctx_->device, op_ctx->op_device_context(),
+      op_ctx->output_alloc_attr(0), &send_tensor, col_ctx_->device_locality,
+      op_ctx->cancellation_manager(),
+      [this, &send_done, &send_status](const Status& s) {
+        if (!s.ok()) StartAbort(s);
+        send_status = s;
+        send_done.Notify();
+      });
+
+  Notification recv_done;
+  Status recv_status;
+  remote_access->RecvFromPeer(
+      peer_device, peer_task, col_params_->task.is_local[peer_rank],
+      HalvingDoublingBufKey(col_ctx_->exec_key, pass, step, peer_rank),
+      col_ctx_->device, op_ctx->op_device_context(),
+      op_ctx->output_alloc_attr(0), recv_tensor, col_ctx_->device_locality,
+      0 /*dev_to_dev_stream_index*/, op_ctx->cancellation_manager(),
+      [this, &recv_done, &recv_status](const Status& s) {
+        if (!s.ok()) StartAbort(s);
+        recv_status = s;
+        recv_done.Notify();
+      });
+
+  recv_done.WaitForNotification();
+  send_done.WaitForNotification();
+  return recv_status.ok() ? send_status : recv_status;
+}
+
+void HalvingDoublingReducer::StartAbort(const Status& s) {
+  LOG(ERROR) << "Aborting HalvingDoublingReduce with " << s;
+  // Cancellation already aborts all the pending transfers.
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  if (cancel_mgr == nullptr ||
+      (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HalvingDoublingReduce, HalvingDoublingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,85 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HALVING_DOUBLING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HALVING_DOUBLING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Recursive halving-doubling implementation of collective all-reduce, for
+// groups whose size is a power of two.
+//
+// The tensor is divided into group_size chunks. In each of the log2(group_size)
+// steps of the first pass, every device exchanges half of the chunks it is
+// still reducing with a partner and keeps reducing the other half, until it
+// holds one fully reduced chunk. The second pass doubles the chunks held in
+// each step by exchanging them with the same partners in reverse order.
+//
+// Each device takes 2*log2(group_size) steps, against the 2*(group_size-1) of
+// the ring algorithm, which makes it faster for tensors small enough that the
+// latency of each step dominates the time spent transferring bytes.
+class HalvingDoublingReducer : public CollectiveImplementationInterface {
+ public:
+  HalvingDoublingReducer() = default;
+  ~HalvingDoublingReducer() override = default;
+
+  // Returns an error if the group size is not a power of two.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Runs the all-reduce to completion before calling `done`, so it must be
+  // called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  Status CopyInputToOutput();
+  Status RunSteps();
+
+  // Returns a tensor that aliases chunks [begin, end) of the output.
+  Tensor ChunksAlias(int begin, int end) const;
+
+  // Sends chunks [send_begin, send_end) to `peer_rank` and receives the
+  // tensor that it sends in the same step into *recv_tensor.
+  Status Exchange(int pass, int step, int peer_rank, int send_begin,
+                  int send_end, Tensor* recv_tensor);
+
+  // Aborts the pending transfers of all the devices in the group.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  // The first element of each chunk of the output, and the number of
+  // elements of the output at the end.
+  std::vector<int64> chunk_starts_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HALVING_DOUBLING_REDUCER_H_
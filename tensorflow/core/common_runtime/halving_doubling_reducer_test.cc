@@ -0,0 +1,325 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/halving_doubling_reducer.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+// Wraps CollectiveRemoteAccessLocal with the ability to return an
+// error status to the N'th action.
+class FailTestRMA : public CollectiveRemoteAccessLocal {
+ public:
+  FailTestRMA(const DeviceMgr* dev_mgr, DeviceResolverInterface* dev_resolver,
+              int64 step_id, int fail_after)
+      : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, step_id),
+        fail_after_(fail_after) {}
+
+  bool MaybeFail(const StatusCallback& done) {
+    bool fail_now = false;
+    {
+      mutex_lock l(mu_);
+      if (fail_after_ > 0) {
+        fail_now = (--fail_after_ == 0);
+      }
+    }
+    if (fail_now) {
+      done(errors::Internal("Deliberate failure"));
+      return true;
+    }
+    return false;
+  }
+
+  void RecvFromPeer(const string& peer_device, const string& peer_task,
+                    bool peer_is_local, const string& key, Device* to_device,
+                    DeviceContext* to_device_ctx,
+                    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+                    const DeviceLocality& client_locality,
+                    int dev_to_dev_stream_index,
+                    CancellationManager* cancellation_manager,
+                    const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::RecvFromPeer(
+        peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
+        to_alloc_attr, to_tensor, client_locality, dev_to_dev_stream_index,
+        cancellation_manager, done);
+  }
+
+  void PostToPeer(const string& peer_device, const string& peer_task,
+                  const string& key, Device* from_device,
+                  DeviceContext* from_device_ctx,
+                  const AllocatorAttributes& from_alloc_attr,
+                  const Tensor* from_tensor,
+                  const DeviceLocality& client_locality,
+                  CancellationManager* cancellation_manager,
+                  const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::PostToPeer(
+        peer_device, peer_task, key, from_device, from_device_ctx,
+        from_alloc_attr, from_tensor, client_locality, cancellation_manager,
+        done);
+  }
+
+  mutex mu_;
+  int fail_after_ TF_GUARDED_BY(mu_);
+};
+
+std::unique_ptr<OpKernel> GetKernel(const NodeDef& node, DeviceBase* device) {
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node,
+      TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, device);
+}
+
+static int64 kStepId = 123;
+
+class HalvingDoublingReducerTest : public ::testing::Test {
+ protected:
+  ~HalvingDoublingReducerTest() override {
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  void Init(int num_devices, DataType dtype, int fail_after) {
+    std::vector<std::unique_ptr<Device>> local_devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    const string task_name = "/job:worker/replica:0/task:0";
+    for (int di = 0; di < num_devices; ++di) {
+      local_devices.push_back(absl::make_unique<ThreadPoolDevice>(
+          sess_opts, strings::StrCat(task_name, "/cpu:", di), Bytes(4 << 20),
+          DeviceLocality(), cpu_allocator()));
+    }
+    dev_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(local_devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    work_queue_ = std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
+    col_exec_ = new BaseCollectiveExecutor(
+        &col_exec_mgr_,
+        new FailTestRMA(dev_mgr_.get(), dev_resolver_.get(), kStepId,
+                        fail_after),
+        kStepId, dev_mgr_.get(), &gpu_ring_order_, work_queue_);
+    col_params_.name = "test_collective";
+    col_params_.group.group_key = 5;
+    col_params_.group.device_type = DEVICE_CPU;
+    col_params_.group.group_size = num_devices;
+    col_params_.group.num_tasks = 1;
+    col_params_.group.num_devices_per_task[task_name] = num_devices;
+    col_params_.instance.instance_key = 17;
+    col_params_.instance.type = REDUCTION_COLLECTIVE;
+    col_params_.instance.impl_details.collective_name =
+        "HalvingDoublingReduce";
+    col_params_.instance.data_type = dtype;
+    for (int di = 0; di < num_devices; ++di) {
+      col_params_.group.device_names.push_back(
+          strings::StrCat(task_name, "/cpu:", di));
+      col_params_.group.task_names.push_back(task_name);
+      col_params_.task.is_local.push_back(true);
+    }
+  }
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_devices, int tensor_len,
+               int fail_after) {
+    Init(num_devices, dtype, fail_after);
+    std::vector<T> expected(tensor_len, 0);
+    tensors_.clear();
+    for (int di = 0; di < num_devices; ++di) {
+      Tensor t(dtype, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        t.flat<T>()(i) = static_cast<T>(di * 10 + i);
+        expected[i] += static_cast<T>(di * 10 + i);
+      }
+      tensors_.push_back(t);
+    }
+    std::vector<Status> statuses(num_devices);
+    BlockingCounter counter(num_devices);
+    for (int di = 0; di < num_devices; ++di) {
+      SchedClosure([this, di, &statuses, &counter] {
+        statuses[di] = DoReduce(di);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (int di = 0; di < num_devices; ++di) {
+      if (fail_after > 0) {
+        EXPECT_NE(statuses[di].error_message().find("Deliberate failure"),
+                  string::npos)
+            << statuses[di];
+        continue;
+      }
+      TF_EXPECT_OK(statuses[di]);
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_EQ(expected[i] / static_cast<T>(num_devices),
+                  tensors_[di].flat<T>()(i))
+            << "Mismatch at device " << di << " index " << i;
+      }
+    }
+  }
+
+  Status DoReduce(int rank) {
+    Device* device;
+    TF_RETURN_IF_ERROR(dev_mgr_->LookupDevice(
+        col_params_.group.device_names[rank], &device));
+    Tensor* tensor = &tensors_[rank];
+    CollectiveParams col_params;
+    col_params.name = col_params_.name;
+    col_params.group = col_params_.group;
+    col_params.instance = col_params_.instance;
+    col_params.task = col_params_.task;
+    col_params.default_rank = rank;
+    std::unique_ptr<OpKernel> merge_op =
+        GetBinOp("Add", tensor->dtype(), device);
+    std::unique_ptr<OpKernel> final_op =
+        GetBinOp("Div", tensor->dtype(), device);
+    col_params.merge_op = merge_op.get();
+    col_params.final_op = final_op.get();
+
+    OpKernelContext::Params op_params;
+    op_params.step_id = kStepId;
+    op_params.device = device;
+    op_params.cancellation_manager = &cancellation_manager_;
+    gtl::InlinedVector<TensorValue, 4> inputs({TensorValue(tensor)});
+    op_params.inputs = &inputs;
+    gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+        {AllocatorAttributes()});
+    op_params.input_alloc_attrs = &input_aa;
+    DeviceContext* dev_ctx = new DeviceContext;
+    core::ScopedUnref unref_dev_ctx(dev_ctx);
+    op_params.op_device_context = dev_ctx;
+    int forward_from = 0;
+    op_params.forward_from_array = &forward_from;
+    AllocatorAttributes generic_alloc_attr;
+    op_params.output_attr_array = &generic_alloc_attr;
+    NodeDef node_def;
+    TF_CHECK_OK(NodeDefBuilder(strings::StrCat("collective_reduce_", rank),
+                               "CollectiveReduce")
+                    .Attr("T", tensor->dtype())
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Div")
+                    .Attr("group_size", col_params.group.group_size)
+                    .Attr("group_key", col_params.group.group_key)
+                    .Attr("instance_key", col_params.instance.instance_key)
+                    .Attr("subdiv_offsets", std::vector<int>())
+                    .Input(FakeInput(tensor->dtype()))
+                    .Finalize(&node_def));
+    std::unique_ptr<OpKernel> op = GetKernel(node_def, device);
+    op_params.op_kernel = op.get();
+    OpKernelContext ctx(&op_params, 1);
+
+    // We never actually execute the kernel, so we need to do the output
+    // allocation it would do, ourselves.
+    Tensor* output = nullptr;
+    TF_RETURN_IF_ERROR(ctx.forward_input_or_allocate_output(
+        {0}, 0, tensor->shape(), &output));
+
+    HalvingDoublingReducer* reducer = new HalvingDoublingReducer;
+    core::ScopedUnref unref(reducer);
+    TF_RETURN_IF_ERROR(reducer->InitializeCollectiveParams(&col_params));
+    auto col_ctx = std::make_shared<CollectiveContext>(
+        col_exec_, /*nccl_communicator*/ nullptr, dev_mgr_.get(), &ctx,
+        &op_params, col_params,
+        strings::StrCat(col_params.instance.instance_key, ":0:0"), kStepId,
+        tensor, tensor);
+    TF_RETURN_IF_ERROR(reducer->InitializeCollectiveContext(col_ctx));
+    Status status;
+    reducer->Run([&status](const Status& s) { status = s; });
+    return status;
+  }
+
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  const string gpu_ring_order_;
+  CollectiveParams col_params_;
+  std::vector<Tensor> tensors_;
+  CancellationManager cancellation_manager_;
+};
+
+TEST_F(HalvingDoublingReducerTest, InitializeParamsRejectsGroupSize) {
+  CollectiveParams cp;
+  cp.instance.type = REDUCTION_COLLECTIVE;
+  HalvingDoublingReducer* reducer = new HalvingDoublingReducer;
+  core::ScopedUnref unref(reducer);
+  for (int group_size : {1, 2, 4, 16}) {
+    cp.group.group_size = group_size;
+    TF_EXPECT_OK(reducer->InitializeCollectiveParams(&cp));
+  }
+  for (int group_size : {0, 3, 6, 12}) {
+    cp.group.group_size = group_size;
+    EXPECT_TRUE(
+        errors::IsInvalidArgument(reducer->InitializeCollectiveParams(&cp)));
+  }
+}
+
+#define DEF_TEST(B, T, D, L, A)                                           \
+  TEST_F(HalvingDoublingReducerTest, DaTy##B##_Dev##D##_Len##L##_Abrt##A) { \
+    RunTest<T>(DT_##B, D, L, A);                                          \
+  }
+
+// Lengths below the group size leave some devices with empty chunks.
+DEF_TEST(FLOAT, float, 1, 16, 0)
+DEF_TEST(FLOAT, float, 2, 1, 0)
+DEF_TEST(FLOAT, float, 2, 1001, 0)
+DEF_TEST(FLOAT, float, 4, 3, 0)
+DEF_TEST(FLOAT, float, 8, 5, 0)
+DEF_TEST(FLOAT, float, 8, 4096, 0)
+DEF_TEST(FLOAT, float, 16, 9408, 0)
+DEF_TEST(DOUBLE, double, 8, 1001, 0)
+DEF_TEST(INT32, int32, 4, 1001, 0)
+DEF_TEST(INT64, int64, 16, 4095, 0)
+
+// Failure tests
+DEF_TEST(FLOAT, float, 2, 128, 1)
+DEF_TEST(FLOAT, float, 8, 128, 5)
+DEF_TEST(FLOAT, float, 8, 4095, 11)
+
+}  // namespace
+}  // namespace tensorflow
@@ -72,8 +72,11 @@ Benchmark::Benchmark(const string& device, Graph* g,
   device_ = device_mgr_->ListDevices()[0];
   CHECK(device_) << "Could not create a " << device << " device";
 
-  pool_ =
-      new thread::ThreadPool(options->env, "blocking", port::MaxParallelism());
+  pool_ = new thread::ThreadPool(
+      options->env, ThreadOptions(), "blocking", port::MaxParallelism(),
+      /*low_latency_hint=*/true,
+      options->config.experimental().use_numa_worker_groups(),
+      /*allocator=*/nullptr);
 
   auto runner = [this](std::function<void()> closure) {
     pool_->Schedule(closure);
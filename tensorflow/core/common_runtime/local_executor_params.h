@@ -37,6 +37,10 @@ struct LocalExecutorParams {
 
   const SessionMetadata* session_metadata = nullptr;
 
+  // If true, inexpensive nodes that become ready together outside of an
+  // inline chain are run from a single closure instead of one closure each.
+  bool batch_inexpensive_nodes = false;
+
   // The library runtime support.
   FunctionLibraryRuntime* function_library = nullptr;
 
@@ -80,6 +80,7 @@ static thread::ThreadPool* InitComputePool(const SessionOptions& options) {
   return new thread::ThreadPool(
       Env::Default(), ThreadOptions(), "Compute", inter_op_parallelism_threads,
       !options.config.experimental().disable_thread_spinning(),
+      options.config.experimental().use_numa_worker_groups(),
       /*allocator=*/nullptr);
 }
 
@@ -160,6 +161,7 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
   return new thread::ThreadPool(
       options.env, ThreadOptions(), "Compute", num_threads,
       !options.config.experimental().disable_thread_spinning(),
+      options.config.experimental().use_numa_worker_groups(),
       /*allocator=*/nullptr);
 }
 
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 
@@ -212,8 +213,34 @@ bool RingReducer::RunAsyncParts() {
   int field_done_count = 0;
   int send_pending_count = 0;
   int recv_pending_count = 0;
+  int compute_pending_count = 0;
   std::atomic<bool> aborted(false);
 
+  // On CPU the reductions of fields run on the device's worker threads, so
+  // that this thread keeps dispatching the transfers of the other fields
+  // while they run. Elsewhere they are enqueued on the device's stream and
+  // run in order.
+  thread::ThreadPool* compute_pool = nullptr;
+  if (col_params_->group.device_type == "CPU" &&
+      col_ctx_->device->tensorflow_cpu_worker_threads() != nullptr) {
+    compute_pool = col_ctx_->device->tensorflow_cpu_worker_threads()->workers;
+  }
+  // Computes `op` on rf->chunk and `operand` on compute_pool, then requeues rf.
+  auto dispatch_bin_op = [this, compute_pool, &ready_queue, &aborted](
+                             RingField* rf, OpKernel* op, Tensor* operand) {
+    compute_pool->Schedule(
+        [this, rf, op, operand, &ready_queue, &aborted]() {
+          Status s = collective_util::ComputeBinOp(
+              col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device, op,
+              &rf->chunk, operand);
+          if (!s.ok()) {
+            aborted = true;
+            StartAbort(s);
+          }
+          ready_queue.Enqueue(rf);
+        });
+  };
+
   {
     profiler::TraceMe activity("Loop", profiler::TraceMeLevel::kInfo);
     // Loop until all RingFields have advanced to completion.
@@ -254,6 +281,12 @@ bool RingReducer::RunAsyncParts() {
             --recv_pending_count;
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
+              if (compute_pool != nullptr) {
+                dispatch_bin_op(rf, col_params_->merge_op, &rf->tmp_chunk);
+                dispatched = true;
+                ++compute_pending_count;
+                break;
+              }
               Status s = collective_util::ComputeBinOp(
                   col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
                   col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
@@ -266,9 +299,19 @@ bool RingReducer::RunAsyncParts() {
             }
             break;
           case RF_REDUCE:
+            if (compute_pool != nullptr) {
+              CHECK_GT(compute_pending_count, 0);
+              --compute_pending_count;
+            }
             if (!rf->second_pass && col_params_->final_op && rf->is_final) {
               rf->action = RF_FINALIZE;
               group_size_tensor_ready_.WaitForNotification();
+              if (compute_pool != nullptr) {
+                dispatch_bin_op(rf, col_params_->final_op, &group_size_tensor_);
+                dispatched = true;
+                ++compute_pending_count;
+                break;
+              }
               Status s = collective_util::ComputeBinOp(
                   col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
                   col_params_->final_op, &rf->chunk, &group_size_tensor_);
@@ -281,6 +324,10 @@ bool RingReducer::RunAsyncParts() {
             }
             break;
           case RF_FINALIZE:
+            if (compute_pool != nullptr) {
+              CHECK_GT(compute_pending_count, 0);
+              --compute_pending_count;
+            }
             rf->action = RF_DONE;
             break;
           case RF_SEND_READY:
@@ -324,7 +371,8 @@ bool RingReducer::RunAsyncParts() {
     if (aborted) {
       // All of the pending data actions should be aborted; field the
       // callbacks and clear the queue before quitting.
-      while ((send_pending_count > 0) || (recv_pending_count > 0)) {
+      while ((send_pending_count > 0) || (recv_pending_count > 0) ||
+             (compute_pending_count > 0)) {
         RingField* rf = ready_queue.Dequeue();
         switch (rf->action) {
           case RF_RECV:
@@ -333,6 +381,10 @@ bool RingReducer::RunAsyncParts() {
           case RF_SEND:
             --send_pending_count;
             break;
+          case RF_REDUCE:
+          case RF_FINALIZE:
+            if (compute_pool != nullptr) --compute_pending_count;
+            break;
           default: {
           }  // Ignore any other actions
         }
@@ -342,6 +394,7 @@ bool RingReducer::RunAsyncParts() {
 
   CHECK_EQ(send_pending_count, 0);
   CHECK_EQ(recv_pending_count, 0);
+  CHECK_EQ(compute_pending_count, 0);
 
   VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
           << " final value " << TensorDebugString(ca_->Value());
@@ -16,9 +16,11 @@ limitations under the License.
 #include "tensorflow/core/data/service/data_service.h"
 
 #include "grpcpp/create_channel.h"
+#include "grpcpp/impl/codegen/client_unary_call.h"
 #include "grpcpp/security/credentials.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
+#include "tensorflow/core/data/service/grpc_element_coding.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -239,24 +241,93 @@ Status DataServiceDispatcherClient::EnsureInitialized() {
 }
 
 Status DataServiceWorkerClient::GetElement(int64 task_id,
-                                           CompressedElement& element,
+                                           std::vector<Tensor>& element,
                                            bool& end_of_sequence) {
-  TF_RETURN_IF_ERROR(EnsureInitialized());
   GetElementRequest req;
   req.set_task_id(task_id);
+  if (std::shared_ptr<LocalWorker> local_worker = GetLocalWorker()) {
+    return local_worker->GetElement(&req, element, end_of_sequence);
+  }
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  if (!raw_unimplemented_) {
+    grpc::ClientContext ctx;
+    grpc::ByteBuffer resp;
+    grpc::Status s = grpc::internal::BlockingUnaryCall(
+        channel_.get(), *get_element_raw_method_, &ctx, req, &resp);
+    if (s.ok()) {
+      return DecodeElementFromByteBuffer(&resp, &element, &end_of_sequence);
+    }
+    if (s.error_code() != grpc::StatusCode::UNIMPLEMENTED) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    VLOG(1) << "Worker " << address_ << " does not serve GetElementRaw, "
+            << "falling back to GetElement";
+    raw_unimplemented_ = true;
+  }
   GetElementResponse resp;
   grpc::ClientContext ctx;
   grpc::Status s = stub_->GetElement(&ctx, req, &resp);
   if (!s.ok()) {
     return grpc_util::WrapError("Failed to get element", s);
   }
-  end_of_sequence = resp.end_of_sequence();
+  return ElementFromResponse(&resp, &element, &end_of_sequence);
+}
+
+Status DataServiceWorkerClient::GetElements(
+    int64 task_id, int64 max_elements, int64 max_bytes,
+    std::vector<std::vector<Tensor>>& elements, bool& end_of_sequence) {
+  GetElementsRequest req;
+  req.set_task_id(task_id);
+  req.set_max_elements(max_elements);
+  req.set_max_bytes(max_bytes);
+  if (std::shared_ptr<LocalWorker> local_worker = GetLocalWorker()) {
+    std::vector<std::vector<Tensor>> received;
+    TF_RETURN_IF_ERROR(
+        local_worker->GetElements(&req, received, end_of_sequence));
+    for (auto& element : received) {
+      elements.push_back(std::move(element));
+    }
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  if (!elements_unimplemented_) {
+    grpc::ClientContext ctx;
+    grpc::ByteBuffer resp;
+    grpc::Status s = grpc::internal::BlockingUnaryCall(
+        channel_.get(), *get_elements_raw_method_, &ctx, req, &resp);
+    if (s.ok()) {
+      std::vector<std::vector<Tensor>> received;
+      TF_RETURN_IF_ERROR(
+          DecodeElementsFromByteBuffer(&resp, &received, &end_of_sequence));
+      for (auto& element : received) {
+        elements.push_back(std::move(element));
+      }
+      return Status::OK();
+    }
+    if (s.error_code() != grpc::StatusCode::UNIMPLEMENTED) {
+      return grpc_util::WrapError("Failed to get elements", s);
+    }
+    VLOG(1) << "Worker " << address_ << " does not serve GetElementsRaw, "
+            << "falling back to GetElement";
+    elements_unimplemented_ = true;
+  }
+  std::vector<Tensor> element;
+  TF_RETURN_IF_ERROR(GetElement(task_id, element, end_of_sequence));
   if (!end_of_sequence) {
-    element = std::move(*resp.mutable_compressed_element());
+    elements.push_back(std::move(element));
   }
   return Status::OK();
 }
 
+std::shared_ptr<LocalWorker> DataServiceWorkerClient::GetLocalWorker() {
+  if (!local_reads_) {
+    return nullptr;
+  }
+  // Looked up on every request, so that reads fall back to gRPC once the
+  // worker is stopped.
+  return LocalWorkers::Get(address_);
+}
+
 Status DataServiceWorkerClient::EnsureInitialized() {
   mutex_lock l(mu_);
   if (stub_) {
@@ -267,8 +338,12 @@ Status DataServiceWorkerClient::EnsureInitialized() {
       CredentialsFactory::CreateClientCredentials(protocol_, &credentials));
   grpc::ChannelArguments args;
   args.SetMaxReceiveMessageSize(-1);
-  auto channel = grpc::CreateCustomChannel(address_, credentials, args);
-  stub_ = WorkerService::NewStub(channel);
+  channel_ = grpc::CreateCustomChannel(address_, credentials, args);
+  stub_ = WorkerService::NewStub(channel_);
+  get_element_raw_method_ = absl::make_unique<grpc::internal::RpcMethod>(
+      kGetElementRawMethod, grpc::internal::RpcMethod::NORMAL_RPC, channel_);
+  get_elements_raw_method_ = absl::make_unique<grpc::internal::RpcMethod>(
+      kGetElementsRawMethod, grpc::internal::RpcMethod::NORMAL_RPC, channel_);
   return Status::OK();
 }
 
@@ -283,9 +358,10 @@ Status CreateDataServiceDispatcherClient(
 }
 
 Status CreateDataServiceWorkerClient(
-    const std::string& address, const std::string& protocol,
+    const std::string& address, const std::string& protocol, bool local_reads,
     std::unique_ptr<DataServiceWorkerClient>& out) {
-  auto client = absl::make_unique<DataServiceWorkerClient>(address, protocol);
+  auto client = absl::make_unique<DataServiceWorkerClient>(address, protocol,
+                                                           local_reads);
   TF_RETURN_IF_ERROR(client->Initialize());
   out = std::move(client);
   return Status::OK();
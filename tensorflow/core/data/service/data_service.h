@@ -16,7 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_DATA_SERVICE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_DATA_SERVICE_H_
 
+#include <atomic>
+#include <memory>
+
+#include "grpcpp/impl/codegen/rpc_method.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
+#include "tensorflow/core/data/service/local_workers.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -134,24 +139,55 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
 // Client for communicating with the tf.data service worker.
 class DataServiceWorkerClient : public DataServiceClientBase {
  public:
+  // If `local_reads` is true and the worker runs in this process, elements
+  // are read from it directly instead of through gRPC.
   DataServiceWorkerClient(const std::string& address,
-                          const std::string& protocol)
-      : DataServiceClientBase(address, protocol) {}
+                          const std::string& protocol, bool local_reads = false)
+      : DataServiceClientBase(address, protocol), local_reads_(local_reads) {}
 
   // Fetches the next element for the specified task_id. The element's
-  // compressed tensors will be stored in `element`. If no element is available,
-  // `end_of_sequence` will be `true`, and `element` will be left unchanged.
-  Status GetElement(int64 task_id, CompressedElement& element,
+  // components will be stored in `element`; if the dataset was registered with
+  // compression, this is a single scalar variant tensor holding the
+  // CompressedElement. If no element is available, `end_of_sequence` will be
+  // `true`, and `element` will be empty.
+  //
+  // Elements of a worker in this process are the tensors it produced.
+  // Otherwise uncompressed components are read straight from the received
+  // gRPC slices into the tensor buffers, and workers that do not serve
+  // GetElementRaw fall back to the GetElement proto.
+  Status GetElement(int64 task_id, std::vector<Tensor>& element,
                     bool& end_of_sequence);
 
+  // Fetches up to `max_elements` elements for the specified task_id in one
+  // round trip, appending them to `elements`. The worker stops early once the
+  // elements add up to `max_bytes`, or when it reaches the end of the task, in
+  // which case `end_of_sequence` is set to `true` after the elements returned
+  // with it. Workers that do not serve GetElementsRaw fall back to fetching
+  // a single element with GetElement.
+  Status GetElements(int64 task_id, int64 max_elements, int64 max_bytes,
+                     std::vector<std::vector<Tensor>>& elements,
+                     bool& end_of_sequence);
+
  protected:
   Status EnsureInitialized() override;
 
  private:
+  // Returns the worker to read from directly, or nullptr if it does not run
+  // in this process.
+  std::shared_ptr<LocalWorker> GetLocalWorker();
+
+  const bool local_reads_;
   mutex mu_;
   // Initialization is guarded by `mu_`, but using the stub does not require
   // holding `mu_`
   std::unique_ptr<WorkerService::Stub> stub_;
+  std::shared_ptr<grpc::Channel> channel_;
+  std::unique_ptr<grpc::internal::RpcMethod> get_element_raw_method_;
+  std::unique_ptr<grpc::internal::RpcMethod> get_elements_raw_method_;
+  // Set once the worker responds that it does not serve GetElementRaw.
+  std::atomic<bool> raw_unimplemented_{false};
+  // Set once the worker responds that it does not serve GetElementsRaw.
+  std::atomic<bool> elements_unimplemented_{false};
 };
 
 // Creates and initializes a new tf.data service dispatcher client.
@@ -159,9 +195,10 @@ Status CreateDataServiceDispatcherClient(
     const std::string& address, const std::string& protocol,
     std::unique_ptr<DataServiceDispatcherClient>& out);
 
-// Creates and initializes a new tf.data service worker client.
+// Creates and initializes a new tf.data service worker client. See
+// DataServiceWorkerClient for `local_reads`.
 Status CreateDataServiceWorkerClient(
-    const std::string& address, const std::string& protocol,
+    const std::string& address, const std::string& protocol, bool local_reads,
     std::unique_ptr<DataServiceWorkerClient>& out);
 
 }  // namespace data
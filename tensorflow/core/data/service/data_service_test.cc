@@ -19,26 +19,100 @@ limitations under the License.
 #include "grpcpp/security/credentials.h"
 #include "absl/strings/str_split.h"
 #include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
+#include "tensorflow/core/data/service/grpc_element_coding.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/local_workers.h"
 #include "tensorflow/core/data/service/server_lib.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace data {
 
 namespace {
 constexpr const char kProtocol[] = "grpc+local";
+
+// Returns the graph of a dataset that repeats a float tensor of
+// `element_bytes` bytes `count` times, or forever if `count` is -1.
+GraphDef RepeatedTensorGraph(int64 element_bytes, int64 count = -1) {
+  using test::function::NDef;
+  const int64 num_floats = element_bytes / sizeof(float);
+  const std::vector<PartialTensorShape> output_shapes = {
+      PartialTensorShape({num_floats})};
+  return test::function::GDef({
+      NDef("dims", "Const", {},
+           {{"dtype", DT_INT64},
+            {"value", test::AsTensor<int64>({num_floats})}}),
+      NDef("fill_value", "Const", {},
+           {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(1.0)}}),
+      NDef("component", "Fill", {"dims", "fill_value"},
+           {{"T", DT_FLOAT}, {"index_type", DT_INT64}}),
+      NDef("tensor_dataset", "TensorDataset", {"component"},
+           {{"Toutput_types", DataTypeVector({DT_FLOAT})},
+            {"output_shapes", output_shapes}}),
+      NDef("count", "Const", {},
+           {{"dtype", DT_INT64}, {"value", test::AsScalar<int64>(count)}}),
+      NDef("repeat_dataset", "RepeatDataset", {"tensor_dataset", "count"},
+           {{"output_types", DataTypeVector({DT_FLOAT})},
+            {"output_shapes", output_shapes}}),
+      NDef("retval", "_Retval", {"repeat_dataset"},
+           {{"T", DT_VARIANT}, {"index", 0}}),
+  });
+}
+
+// Returns the graph of a dataset that produces `cardinality` float tensors of
+// 16 bytes and then fails, as it asserts a smaller cardinality than it has.
+GraphDef FailingGraph(int64 cardinality) {
+  using test::function::NDef;
+  GraphDef graph = RepeatedTensorGraph(/*element_bytes=*/16);
+  graph.mutable_node()->RemoveLast();  // The _Retval node.
+  const std::vector<PartialTensorShape> output_shapes = {
+      PartialTensorShape({4})};
+  *graph.add_node() = NDef(
+      "cardinality", "Const", {},
+      {{"dtype", DT_INT64}, {"value", test::AsScalar<int64>(cardinality)}});
+  *graph.add_node() = NDef("assert_cardinality_dataset",
+                           "AssertCardinalityDataset",
+                           {"repeat_dataset", "cardinality"},
+                           {{"output_types", DataTypeVector({DT_FLOAT})},
+                            {"output_shapes", output_shapes}});
+  *graph.add_node() = NDef("retval", "_Retval", {"assert_cardinality_dataset"},
+                           {{"T", DT_VARIANT}, {"index", 0}});
+  return graph;
 }
 
+// Registers `graph` with the dispatcher of `cluster` and returns the id of the
+// task created for its only worker.
+int64 CreateTask(TestCluster& cluster, const GraphDef& graph) {
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(),
+                                         kProtocol);
+  int64 dataset_id;
+  TF_CHECK_OK(dispatcher.RegisterDataset(graph, dataset_id));
+  int64 job_client_id;
+  TF_CHECK_OK(dispatcher.GetOrCreateJob(dataset_id,
+                                        ProcessingMode::PARALLEL_EPOCHS,
+                                        absl::nullopt, job_client_id));
+  std::vector<TaskInfo> tasks;
+  bool job_finished;
+  while (tasks.empty()) {
+    TF_CHECK_OK(dispatcher.GetTasks(job_client_id, tasks, job_finished));
+  }
+  return tasks[0].task_id();
+}
+}  // namespace
+
 TEST(DataService, ParseParallelEpochsProcessingMode) {
   ProcessingMode mode;
   TF_ASSERT_OK(ParseProcessingMode("parallel_epochs", mode));
@@ -74,5 +148,169 @@ TEST(DataService, GetWorkers) {
   EXPECT_EQ(1, workers.size());
 }
 
+TEST(DataService, GetElements) {
+  TestCluster cluster(1);
+  TF_ASSERT_OK(cluster.Initialize());
+  const int64 task_id = CreateTask(
+      cluster, RepeatedTensorGraph(/*element_bytes=*/16, /*count=*/10));
+  DataServiceWorkerClient worker(cluster.WorkerAddress(0), kProtocol,
+                                 /*local_reads=*/false);
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(worker.GetElements(task_id, /*max_elements=*/4,
+                                  /*max_bytes=*/0, elements, end_of_sequence));
+  EXPECT_EQ(elements.size(), 4);
+  EXPECT_FALSE(end_of_sequence);
+  TF_ASSERT_OK(worker.GetElements(task_id, /*max_elements=*/4,
+                                  /*max_bytes=*/0, elements, end_of_sequence));
+  EXPECT_EQ(elements.size(), 8);
+  EXPECT_FALSE(end_of_sequence);
+  // The last elements come back with end_of_sequence.
+  TF_ASSERT_OK(worker.GetElements(task_id, /*max_elements=*/4,
+                                  /*max_bytes=*/0, elements, end_of_sequence));
+  EXPECT_EQ(elements.size(), 10);
+  EXPECT_TRUE(end_of_sequence);
+  for (const auto& element : elements) {
+    ASSERT_EQ(element.size(), 1);
+    test::ExpectEqual(element[0],
+                      test::AsTensor<float>({1.0, 1.0, 1.0, 1.0}));
+  }
+}
+
+TEST(DataService, GetElementsStopsAtMaxBytes) {
+  TestCluster cluster(1);
+  TF_ASSERT_OK(cluster.Initialize());
+  const int64 task_id =
+      CreateTask(cluster, RepeatedTensorGraph(/*element_bytes=*/1024));
+  DataServiceWorkerClient worker(cluster.WorkerAddress(0), kProtocol,
+                                 /*local_reads=*/false);
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(worker.GetElements(task_id, /*max_elements=*/16,
+                                  /*max_bytes=*/2048, elements,
+                                  end_of_sequence));
+  EXPECT_EQ(elements.size(), 2);
+  EXPECT_FALSE(end_of_sequence);
+}
+
+TEST(DataService, GetElementsReturnsElementsBeforeError) {
+  TestCluster cluster(1);
+  TF_ASSERT_OK(cluster.Initialize());
+  const int64 task_id = CreateTask(cluster, FailingGraph(/*cardinality=*/3));
+  DataServiceWorkerClient worker(cluster.WorkerAddress(0), kProtocol,
+                                 /*local_reads=*/false);
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(worker.GetElements(task_id, /*max_elements=*/8,
+                                  /*max_bytes=*/0, elements, end_of_sequence));
+  EXPECT_EQ(elements.size(), 3);
+  EXPECT_FALSE(end_of_sequence);
+  // The error comes with the next request.
+  Status s = worker.GetElements(task_id, /*max_elements=*/8, /*max_bytes=*/0,
+                                elements, end_of_sequence);
+  EXPECT_EQ(s.code(), error::FAILED_PRECONDITION);
+  EXPECT_EQ(elements.size(), 3);
+}
+
+TEST(DataService, ReadsFromLocalWorker) {
+  TestCluster cluster(1);
+  TF_ASSERT_OK(cluster.Initialize());
+  ASSERT_NE(LocalWorkers::Get(cluster.WorkerAddress(0)), nullptr);
+  const int64 task_id = CreateTask(
+      cluster, RepeatedTensorGraph(/*element_bytes=*/16, /*count=*/3));
+  DataServiceWorkerClient worker(cluster.WorkerAddress(0), kProtocol,
+                                 /*local_reads=*/true);
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(worker.GetElement(task_id, element, end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  ASSERT_EQ(element.size(), 1);
+  test::ExpectEqual(element[0], test::AsTensor<float>({1.0, 1.0, 1.0, 1.0}));
+  std::vector<std::vector<Tensor>> elements;
+  TF_ASSERT_OK(worker.GetElements(task_id, /*max_elements=*/4,
+                                  /*max_bytes=*/0, elements, end_of_sequence));
+  EXPECT_EQ(elements.size(), 2);
+  EXPECT_TRUE(end_of_sequence);
+}
+
+// Fetches elements of `element_bytes` bytes from a worker in the same process,
+// either through the GetElement proto (`mode` = 0), through GetElementRaw
+// (`mode` = 1), or directly from the worker (`mode` = 2).
+void BM_GetElement(::testing::benchmark::State& state) {
+  const int64 element_bytes = state.range(0);
+  const int64 mode = state.range(1);
+
+  TestCluster cluster(1);
+  TF_CHECK_OK(cluster.Initialize());
+  const int64 task_id = CreateTask(cluster, RepeatedTensorGraph(element_bytes));
+
+  DataServiceWorkerClient worker(cluster.WorkerAddress(0), kProtocol,
+                                 /*local_reads=*/mode == 2);
+  std::shared_ptr<::grpc::ChannelCredentials> credentials;
+  TF_CHECK_OK(
+      CredentialsFactory::CreateClientCredentials(kProtocol, &credentials));
+  ::grpc::ChannelArguments args;
+  args.SetMaxReceiveMessageSize(-1);
+  std::unique_ptr<WorkerService::Stub> stub = WorkerService::NewStub(
+      ::grpc::CreateCustomChannel(cluster.WorkerAddress(0), credentials, args));
+
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  for (auto s : state) {
+    if (mode > 0) {
+      TF_CHECK_OK(worker.GetElement(task_id, element, end_of_sequence));
+    } else {
+      GetElementRequest request;
+      request.set_task_id(task_id);
+      GetElementResponse response;
+      ::grpc::ClientContext ctx;
+      CHECK(stub->GetElement(&ctx, request, &response).ok());
+      TF_CHECK_OK(ElementFromResponse(&response, &element, &end_of_sequence));
+    }
+    CHECK(!end_of_sequence);
+  }
+  state.SetBytesProcessed(state.iterations() * element_bytes);
+  state.SetLabel(mode == 0 ? "proto" : (mode == 1 ? "raw" : "local"));
+}
+
+BENCHMARK(BM_GetElement)
+    ->ArgPair(4 << 10, 0)
+    ->ArgPair(4 << 10, 1)
+    ->ArgPair(4 << 10, 2)
+    ->ArgPair(1 << 20, 0)
+    ->ArgPair(1 << 20, 1)
+    ->ArgPair(1 << 20, 2)
+    ->ArgPair(16 << 20, 0)
+    ->ArgPair(16 << 20, 1)
+    ->ArgPair(16 << 20, 2);
+
+// Fetches 4KB elements from a worker in the same process,
+// `elements_per_request` at a time.
+void BM_GetElements(::testing::benchmark::State& state) {
+  const int64 element_bytes = 4 << 10;
+  const int64 elements_per_request = state.range(0);
+
+  TestCluster cluster(1);
+  TF_CHECK_OK(cluster.Initialize());
+  const int64 task_id = CreateTask(cluster, RepeatedTensorGraph(element_bytes));
+  DataServiceWorkerClient worker(cluster.WorkerAddress(0), kProtocol,
+                                 /*local_reads=*/false);
+
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_sequence = false;
+  int64 num_elements = 0;
+  for (auto s : state) {
+    elements.clear();
+    TF_CHECK_OK(worker.GetElements(task_id, elements_per_request,
+                                   /*max_bytes=*/0, elements,
+                                   end_of_sequence));
+    CHECK(!end_of_sequence);
+    num_elements += elements.size();
+  }
+  state.SetBytesProcessed(num_elements * element_bytes);
+}
+
+BENCHMARK(BM_GetElements)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
 }  // namespace data
 }  // namespace tensorflow
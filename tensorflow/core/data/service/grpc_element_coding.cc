@@ -0,0 +1,494 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/grpc_element_coding.h"
+
+#include <climits>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "google/protobuf/wire_format_lite.h"
+#include "grpcpp/support/proto_buffer_reader.h"
+#include "grpcpp/support/slice.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::protobuf::internal::WireFormatLite;
+
+// Tensor buffers up to this size are copied into the response, larger ones
+// are shared with it.
+constexpr size_t kLargeTensorBytes = 1024;
+
+int64 VarLengthEncodingSize(int field_number, int64 bytes) {
+  return core::VarintLength(field_number << 3) + core::VarintLength(bytes) +
+         bytes;
+}
+
+void PutVarlengthBeginning(int field_number, uint32 length, std::string* dst) {
+  core::PutVarint32(dst, WireFormatLite::MakeTag(
+                             field_number,
+                             WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+  core::PutVarint32(dst, length);
+}
+
+const CompressedElement* GetCompressedElement(
+    const std::vector<Tensor>& element) {
+  if (element.size() != 1 || element[0].dtype() != DT_VARIANT ||
+      !TensorShapeUtils::IsScalar(element[0].shape())) {
+    return nullptr;
+  }
+  return element[0].scalar<Variant>()().get<CompressedElement>();
+}
+
+// Accumulates an encoded message as a sequence of slices. Small writes are
+// coalesced into one slice, while large tensor buffers get a slice of their
+// own that holds a reference to the buffer.
+class SliceWriter {
+ public:
+  void Append(StringPiece bytes) {
+    pending_.append(bytes.data(), bytes.size());
+  }
+
+  void AppendTensorData(const Tensor& tensor) {
+    StringPiece data = tensor.tensor_data();
+    if (data.size() <= kLargeTensorBytes) {
+      Append(data);
+      return;
+    }
+    Flush();
+    const TensorBuffer* buffer = DMAHelper::buffer(&tensor);
+    buffer->Ref();
+    slices_.emplace_back(
+        const_cast<char*>(data.data()), data.size(),
+        [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+        const_cast<TensorBuffer*>(buffer));
+  }
+
+  void Finish(::grpc::ByteBuffer* result) {
+    Flush();
+    ::grpc::ByteBuffer tmp(slices_.data(), slices_.size());
+    result->Swap(&tmp);
+  }
+
+ private:
+  void Flush() {
+    if (pending_.empty()) return;
+    slices_.emplace_back(pending_.data(), pending_.size());
+    pending_.clear();
+  }
+
+  std::string pending_;
+  std::vector<::grpc::Slice> slices_;
+};
+
+// The encoding of a component, except for the tensor data when it can be
+// shared.
+struct EncodedComponent {
+  // The encoded TensorProto, or its dtype and shape if `share_data` is true.
+  std::string header;
+  bool share_data = false;
+  int64 size = 0;
+};
+
+Status EncodeComponent(const Tensor& tensor, EncodedComponent* component) {
+  if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    proto.SerializeToString(&component->header);
+    component->size = component->header.size();
+    return Status::OK();
+  }
+  TensorProto skeleton;
+  skeleton.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(skeleton.mutable_tensor_shape());
+  skeleton.SerializeToString(&component->header);
+  component->size = component->header.size();
+  const int64 data_bytes = tensor.tensor_data().size();
+  if (data_bytes > 0) {
+    component->share_data = true;
+    component->size +=
+        VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
+                              data_bytes);
+  }
+  return Status::OK();
+}
+
+// Reads a TensorProto from `input`, which is limited to the encoded proto.
+//
+// The content of tensors that can be memcpy-ed is read directly into the
+// tensor buffer when the dtype and shape precede it, as they do in the
+// encodings produced by EncodeElementToByteBuffer and by the generated code.
+// Any other field makes the rest of the proto go through the generated code.
+Status ReadComponent(protobuf::io::CodedInputStream* input, Tensor* tensor) {
+  TensorProto proto;
+  bool has_tensor = false;
+  while (true) {
+    const uint32 tag = input->ReadTag();
+    if (tag == 0) break;
+    const int field_number = WireFormatLite::GetTagFieldNumber(tag);
+    const WireFormatLite::WireType wire_type =
+        WireFormatLite::GetTagWireType(tag);
+    if (field_number == TensorProto::kDtypeFieldNumber &&
+        wire_type == WireFormatLite::WIRETYPE_VARINT && !has_tensor) {
+      uint32 dtype;
+      if (!input->ReadVarint32(&dtype)) {
+        return errors::DataLoss("Failed to read the dtype of a component");
+      }
+      proto.set_dtype(static_cast<DataType>(dtype));
+      continue;
+    }
+    if (field_number == TensorProto::kTensorShapeFieldNumber &&
+        wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED &&
+        !has_tensor) {
+      if (!WireFormatLite::ReadMessage(input, proto.mutable_tensor_shape())) {
+        return errors::DataLoss("Failed to read the shape of a component");
+      }
+      continue;
+    }
+    if (field_number == TensorProto::kTensorContentFieldNumber &&
+        wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED &&
+        !has_tensor && DataTypeCanUseMemcpy(proto.dtype())) {
+      uint32 length;
+      if (!input->ReadVarint32(&length)) {
+        return errors::DataLoss("Failed to read the size of a component");
+      }
+      if (!TensorShape::IsValid(proto.tensor_shape())) {
+        return errors::DataLoss("Component has an invalid shape: ",
+                                proto.tensor_shape().DebugString());
+      }
+      Tensor t(proto.dtype(), TensorShape(proto.tensor_shape()));
+      StringPiece buffer = t.tensor_data();
+      if (buffer.size() != length) {
+        return errors::DataLoss("Component of shape ",
+                                t.shape().DebugString(), " and type ",
+                                DataTypeString(t.dtype()), " has ", length,
+                                " bytes of content, expected ", buffer.size());
+      }
+      if (!input->ReadRaw(const_cast<char*>(buffer.data()), length)) {
+        return errors::DataLoss("Failed to read the content of a component");
+      }
+      *tensor = std::move(t);
+      has_tensor = true;
+      continue;
+    }
+    if (has_tensor) {
+      proto.set_tensor_content(std::string(tensor->tensor_data()));
+      has_tensor = false;
+    }
+    std::string rest;
+    core::PutVarint32(&rest, tag);
+    std::string bytes;
+    if (!input->ReadString(&bytes, input->BytesUntilLimit()) ||
+        !proto.MergeFromString(rest + bytes)) {
+      return errors::DataLoss("Failed to parse a component");
+    }
+    break;
+  }
+  if (has_tensor) {
+    return Status::OK();
+  }
+  if (!tensor->FromProto(proto)) {
+    return errors::DataLoss("Failed to parse a component of type ",
+                            DataTypeString(proto.dtype()));
+  }
+  return Status::OK();
+}
+
+Status ReadUncompressedElement(protobuf::io::CodedInputStream* input,
+                               std::vector<Tensor>* element) {
+  while (true) {
+    const uint32 tag = input->ReadTag();
+    if (tag == 0) return Status::OK();
+    if (tag != WireFormatLite::MakeTag(
+                   UncompressedElement::kComponentsFieldNumber,
+                   WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+      if (!WireFormatLite::SkipField(input, tag)) {
+        return errors::DataLoss("Failed to parse an uncompressed element");
+      }
+      continue;
+    }
+    uint32 length;
+    if (!input->ReadVarint32(&length)) {
+      return errors::DataLoss("Failed to read the size of a component");
+    }
+    const protobuf::io::CodedInputStream::Limit limit =
+        input->PushLimit(length);
+    element->emplace_back();
+    TF_RETURN_IF_ERROR(ReadComponent(input, &element->back()));
+    if (input->BytesUntilLimit() != 0) {
+      return errors::DataLoss("Failed to read a component");
+    }
+    input->PopLimit(limit);
+  }
+}
+
+// Reads a GetElementResponse from `input`, up to its limit.
+Status ReadElement(protobuf::io::CodedInputStream* input,
+                   std::vector<Tensor>* element, bool* end_of_sequence) {
+  element->clear();
+  *end_of_sequence = false;
+  while (true) {
+    const uint32 tag = input->ReadTag();
+    if (tag == 0) return Status::OK();
+    const int field_number = WireFormatLite::GetTagFieldNumber(tag);
+    const WireFormatLite::WireType wire_type =
+        WireFormatLite::GetTagWireType(tag);
+    if (field_number == GetElementResponse::kEndOfSequenceFieldNumber &&
+        wire_type == WireFormatLite::WIRETYPE_VARINT) {
+      uint32 value;
+      if (!input->ReadVarint32(&value)) {
+        return errors::DataLoss("Failed to read end_of_sequence");
+      }
+      *end_of_sequence = value != 0;
+    } else if (field_number ==
+                   GetElementResponse::kCompressedElementFieldNumber &&
+               wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      CompressedElement compressed;
+      if (!WireFormatLite::ReadMessage(input, &compressed)) {
+        return errors::DataLoss("Failed to parse a compressed element");
+      }
+      element->clear();
+      element->emplace_back(DT_VARIANT, TensorShape({}));
+      element->back().scalar<Variant>()() = std::move(compressed);
+    } else if (field_number ==
+                   GetElementResponse::kUncompressedElementFieldNumber &&
+               wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      uint32 length;
+      if (!input->ReadVarint32(&length)) {
+        return errors::DataLoss("Failed to read the size of an element");
+      }
+      const protobuf::io::CodedInputStream::Limit limit =
+          input->PushLimit(length);
+      element->clear();
+      TF_RETURN_IF_ERROR(ReadUncompressedElement(input, element));
+      input->PopLimit(limit);
+    } else if (!WireFormatLite::SkipField(input, tag)) {
+      return errors::DataLoss("Failed to parse a GetElement response");
+    }
+  }
+}
+
+}  // namespace
+
+Status EncodeElementToByteBuffer(const std::vector<Tensor>& element,
+                                 bool end_of_sequence,
+                                 ::grpc::ByteBuffer* result) {
+  if (end_of_sequence) {
+    GetElementResponse response;
+    response.set_end_of_sequence(true);
+    ::grpc::Slice slice(response.ByteSizeLong());
+    response.SerializeWithCachedSizesToArray(
+        const_cast<uint8*>(reinterpret_cast<const uint8*>(slice.begin())));
+    ::grpc::ByteBuffer tmp(&slice, 1);
+    result->Swap(&tmp);
+    return Status::OK();
+  }
+  const CompressedElement* compressed = GetCompressedElement(element);
+  if (compressed != nullptr) {
+    // Serialized in place, to avoid copying the element into a response.
+    const size_t compressed_bytes = compressed->ByteSizeLong();
+    std::string header;
+    PutVarlengthBeginning(GetElementResponse::kCompressedElementFieldNumber,
+                          compressed_bytes, &header);
+    ::grpc::Slice slice(header.size() + compressed_bytes);
+    uint8* data = const_cast<uint8*>(slice.begin());
+    memcpy(data, header.data(), header.size());
+    compressed->SerializeWithCachedSizesToArray(data + header.size());
+    ::grpc::ByteBuffer tmp(&slice, 1);
+    result->Swap(&tmp);
+    return Status::OK();
+  }
+
+  std::vector<EncodedComponent> components(element.size());
+  int64 element_bytes = 0;
+  for (size_t i = 0; i < element.size(); ++i) {
+    TF_RETURN_IF_ERROR(EncodeComponent(element[i], &components[i]));
+    element_bytes +=
+        VarLengthEncodingSize(UncompressedElement::kComponentsFieldNumber,
+                              components[i].size);
+  }
+  if (element_bytes > INT_MAX) {
+    return errors::InvalidArgument(
+        "Cannot send an element of ", element_bytes,
+        " bytes, which exceeds the 2GB protobuf limit");
+  }
+
+  SliceWriter writer;
+  std::string header;
+  PutVarlengthBeginning(GetElementResponse::kUncompressedElementFieldNumber,
+                        element_bytes, &header);
+  writer.Append(header);
+  for (size_t i = 0; i < element.size(); ++i) {
+    const EncodedComponent& component = components[i];
+    header.clear();
+    PutVarlengthBeginning(UncompressedElement::kComponentsFieldNumber,
+                          component.size, &header);
+    header.append(component.header);
+    if (component.share_data) {
+      PutVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
+                            element[i].tensor_data().size(), &header);
+    }
+    writer.Append(header);
+    if (component.share_data) {
+      writer.AppendTensorData(element[i]);
+    }
+  }
+  writer.Finish(result);
+  return Status::OK();
+}
+
+Status DecodeElementFromByteBuffer(::grpc::ByteBuffer* buffer,
+                                   std::vector<Tensor>* element,
+                                   bool* end_of_sequence) {
+  ::grpc::ProtoBufferReader reader(buffer);
+  protobuf::io::CodedInputStream input(&reader);
+  input.SetTotalBytesLimit(INT_MAX);
+  return ReadElement(&input, element, end_of_sequence);
+}
+
+Status EncodeElementsToByteBuffer(
+    const std::vector<std::vector<Tensor>>& elements, bool end_of_sequence,
+    ::grpc::ByteBuffer* result) {
+  std::vector<::grpc::Slice> slices;
+  int64 total_bytes = 0;
+  for (const auto& element : elements) {
+    ::grpc::ByteBuffer encoded;
+    TF_RETURN_IF_ERROR(EncodeElementToByteBuffer(
+        element, /*end_of_sequence=*/false, &encoded));
+    std::string header;
+    PutVarlengthBeginning(GetElementsResponse::kElementsFieldNumber,
+                          encoded.Length(), &header);
+    slices.emplace_back(header.data(), header.size());
+    std::vector<::grpc::Slice> element_slices;
+    if (!encoded.Dump(&element_slices).ok()) {
+      return errors::Internal("Failed to read an encoded element");
+    }
+    for (auto& slice : element_slices) {
+      slices.push_back(std::move(slice));
+    }
+    total_bytes += header.size() + encoded.Length();
+  }
+  if (total_bytes > INT_MAX) {
+    return errors::InvalidArgument(
+        "Cannot send ", elements.size(), " elements of ", total_bytes,
+        " bytes, which exceeds the 2GB protobuf limit");
+  }
+  if (end_of_sequence) {
+    GetElementsResponse response;
+    response.set_end_of_sequence(true);
+    std::string serialized;
+    response.SerializeToString(&serialized);
+    slices.emplace_back(serialized.data(), serialized.size());
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+  return Status::OK();
+}
+
+Status DecodeElementsFromByteBuffer(::grpc::ByteBuffer* buffer,
+                                    std::vector<std::vector<Tensor>>* elements,
+                                    bool* end_of_sequence) {
+  elements->clear();
+  *end_of_sequence = false;
+  ::grpc::ProtoBufferReader reader(buffer);
+  protobuf::io::CodedInputStream input(&reader);
+  input.SetTotalBytesLimit(INT_MAX);
+  while (true) {
+    const uint32 tag = input.ReadTag();
+    if (tag == 0) return Status::OK();
+    const int field_number = WireFormatLite::GetTagFieldNumber(tag);
+    const WireFormatLite::WireType wire_type =
+        WireFormatLite::GetTagWireType(tag);
+    if (field_number == GetElementsResponse::kEndOfSequenceFieldNumber &&
+        wire_type == WireFormatLite::WIRETYPE_VARINT) {
+      uint32 value;
+      if (!input.ReadVarint32(&value)) {
+        return errors::DataLoss("Failed to read end_of_sequence");
+      }
+      *end_of_sequence = value != 0;
+    } else if (field_number == GetElementsResponse::kElementsFieldNumber &&
+               wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      uint32 length;
+      if (!input.ReadVarint32(&length)) {
+        return errors::DataLoss("Failed to read the size of an element");
+      }
+      const protobuf::io::CodedInputStream::Limit limit =
+          input.PushLimit(length);
+      elements->emplace_back();
+      bool element_end_of_sequence;
+      TF_RETURN_IF_ERROR(
+          ReadElement(&input, &elements->back(), &element_end_of_sequence));
+      if (input.BytesUntilLimit() != 0) {
+        return errors::DataLoss("Failed to read an element");
+      }
+      input.PopLimit(limit);
+    } else if (!WireFormatLite::SkipField(&input, tag)) {
+      return errors::DataLoss("Failed to parse a GetElements response");
+    }
+  }
+}
+
+Status ElementFromResponse(GetElementResponse* response,
+                           std::vector<Tensor>* element,
+                           bool* end_of_sequence) {
+  element->clear();
+  *end_of_sequence = response->end_of_sequence();
+  if (*end_of_sequence) {
+    return Status::OK();
+  }
+  if (response->has_compressed_element()) {
+    element->emplace_back(DT_VARIANT, TensorShape({}));
+    element->back().scalar<Variant>()() =
+        std::move(*response->mutable_compressed_element());
+    return Status::OK();
+  }
+  for (const TensorProto& proto :
+       response->uncompressed_element().components()) {
+    element->emplace_back();
+    if (!element->back().FromProto(proto)) {
+      return errors::DataLoss("Failed to parse a component of type ",
+                              DataTypeString(proto.dtype()));
+    }
+  }
+  return Status::OK();
+}
+
+Status ElementsFromResponse(GetElementsResponse* response,
+                            std::vector<std::vector<Tensor>>* elements,
+                            bool* end_of_sequence) {
+  elements->clear();
+  *end_of_sequence = response->end_of_sequence();
+  for (GetElementResponse& element_response :
+       *response->mutable_elements()) {
+    elements->emplace_back();
+    bool element_end_of_sequence;
+    TF_RETURN_IF_ERROR(ElementFromResponse(
+        &element_response, &elements->back(), &element_end_of_sequence));
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,85 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_GRPC_ELEMENT_CODING_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_GRPC_ELEMENT_CODING_H_
+
+#include <vector>
+
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// Name of the worker method that serves GetElement responses encoded by
+// EncodeElementToByteBuffer.
+constexpr char kGetElementRawMethod[] =
+    "/tensorflow.data.WorkerService/GetElementRaw";
+
+// Name of the worker method that serves GetElements responses encoded by
+// EncodeElementsToByteBuffer.
+constexpr char kGetElementsRawMethod[] =
+    "/tensorflow.data.WorkerService/GetElementsRaw";
+
+// Encodes a GetElementResponse holding `element` into `*result`.
+//
+// If `element` is a single scalar variant holding a CompressedElement, it is
+// sent as the response's `compressed_element`. Otherwise the components are
+// sent as the response's `uncompressed_element`, and the buffers of large
+// components that can be memcpy-ed are shared with the ByteBuffer instead of
+// being copied.
+Status EncodeElementToByteBuffer(const std::vector<Tensor>& element,
+                                 bool end_of_sequence,
+                                 ::grpc::ByteBuffer* result);
+
+// Decodes a GetElementResponse from `buffer`.
+//
+// Uncompressed components that can be memcpy-ed are read straight from the
+// received slices into the output tensor buffers. A compressed element is
+// returned as a single scalar variant tensor holding the CompressedElement.
+Status DecodeElementFromByteBuffer(::grpc::ByteBuffer* buffer,
+                                   std::vector<Tensor>* element,
+                                   bool* end_of_sequence);
+
+// Converts a GetElementResponse parsed by the generated proto code to the
+// output of DecodeElementFromByteBuffer.
+Status ElementFromResponse(GetElementResponse* response,
+                           std::vector<Tensor>* element,
+                           bool* end_of_sequence);
+
+// Encodes a GetElementsResponse holding `elements` into `*result`. Each
+// element is encoded as by EncodeElementToByteBuffer.
+Status EncodeElementsToByteBuffer(
+    const std::vector<std::vector<Tensor>>& elements, bool end_of_sequence,
+    ::grpc::ByteBuffer* result);
+
+// Decodes a GetElementsResponse from `buffer`. Each element is decoded as by
+// DecodeElementFromByteBuffer.
+Status DecodeElementsFromByteBuffer(::grpc::ByteBuffer* buffer,
+                                    std::vector<std::vector<Tensor>>* elements,
+                                    bool* end_of_sequence);
+
+// Converts a GetElementsResponse parsed by the generated proto code to the
+// output of DecodeElementsFromByteBuffer.
+Status ElementsFromResponse(GetElementsResponse* response,
+                            std::vector<std::vector<Tensor>>* elements,
+                            bool* end_of_sequence);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_GRPC_ELEMENT_CODING_H_
@@ -0,0 +1,203 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/grpc_element_coding.h"
+
+#include "grpcpp/support/proto_buffer_reader.h"
+#include "grpcpp/support/slice.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement() {
+  Tensor image(DT_FLOAT, TensorShape({64, 64, 3}));
+  image.flat<float>().setConstant(0.5);
+  return {image, test::AsTensor<int64>({1, 2, 3}),
+          test::AsTensor<tstring>({"a", "bc"}), test::AsScalar<int32>(7),
+          Tensor(DT_FLOAT, TensorShape({0, 4}))};
+}
+
+void ExpectElementsEqual(const std::vector<Tensor>& actual,
+                         const std::vector<Tensor>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    test::ExpectEqual(actual[i], expected[i]);
+  }
+}
+
+std::vector<::grpc::Slice> Slices(::grpc::ByteBuffer* buffer) {
+  std::vector<::grpc::Slice> slices;
+  EXPECT_TRUE(buffer->Dump(&slices).ok());
+  return slices;
+}
+
+TEST(GrpcElementCodingTest, RoundTrip) {
+  std::vector<Tensor> element = MakeElement();
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer(element, /*end_of_sequence=*/false,
+                                         &buffer));
+  std::vector<Tensor> decoded;
+  bool end_of_sequence = true;
+  TF_ASSERT_OK(DecodeElementFromByteBuffer(&buffer, &decoded,
+                                           &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  ExpectElementsEqual(decoded, element);
+}
+
+TEST(GrpcElementCodingTest, SharesLargeTensorBuffers) {
+  std::vector<Tensor> element = MakeElement();
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer(element, /*end_of_sequence=*/false,
+                                         &buffer));
+  // The image is sent from its own buffer, the other components are copied
+  // into the slices around it.
+  std::vector<::grpc::Slice> slices = Slices(&buffer);
+  ASSERT_EQ(slices.size(), 3);
+  EXPECT_EQ(static_cast<const void*>(slices[1].begin()),
+            element[0].tensor_data().data());
+  EXPECT_EQ(slices[1].size(), element[0].TotalBytes());
+}
+
+TEST(GrpcElementCodingTest, CompatibleWithGeneratedCode) {
+  std::vector<Tensor> element = MakeElement();
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer(element, /*end_of_sequence=*/false,
+                                         &buffer));
+  GetElementResponse response;
+  {
+    ::grpc::ProtoBufferReader reader(&buffer);
+    ASSERT_TRUE(response.ParseFromZeroCopyStream(&reader));
+  }
+  std::vector<Tensor> parsed;
+  bool end_of_sequence = true;
+  TF_ASSERT_OK(ElementFromResponse(&response, &parsed, &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  ExpectElementsEqual(parsed, element);
+
+  // Responses serialized by the generated code decode the same way.
+  std::string serialized;
+  ASSERT_TRUE(response.SerializeToString(&serialized));
+  ::grpc::Slice slice(serialized.data(), serialized.size());
+  ::grpc::ByteBuffer generated(&slice, 1);
+  std::vector<Tensor> decoded;
+  TF_ASSERT_OK(DecodeElementFromByteBuffer(&generated, &decoded,
+                                           &end_of_sequence));
+  ExpectElementsEqual(decoded, element);
+}
+
+TEST(GrpcElementCodingTest, CompressedElement) {
+  std::vector<Tensor> element = MakeElement();
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, &compressed));
+  Tensor variant(DT_VARIANT, TensorShape({}));
+  variant.scalar<Variant>()() = compressed;
+
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer({variant}, /*end_of_sequence=*/false,
+                                         &buffer));
+  std::vector<Tensor> decoded;
+  bool end_of_sequence = true;
+  TF_ASSERT_OK(DecodeElementFromByteBuffer(&buffer, &decoded,
+                                           &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  ASSERT_EQ(decoded.size(), 1);
+  const CompressedElement* decoded_compressed =
+      decoded[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(decoded_compressed, nullptr);
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(*decoded_compressed, &uncompressed));
+  ExpectElementsEqual(uncompressed, element);
+}
+
+TEST(GrpcElementCodingTest, EndOfSequence) {
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer({}, /*end_of_sequence=*/true,
+                                         &buffer));
+  std::vector<Tensor> decoded = MakeElement();
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(DecodeElementFromByteBuffer(&buffer, &decoded,
+                                           &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(GrpcElementCodingTest, TruncatedComponent) {
+  std::vector<Tensor> element = MakeElement();
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer(element, /*end_of_sequence=*/false,
+                                         &buffer));
+  // Drops the image data.
+  std::vector<::grpc::Slice> slices = Slices(&buffer);
+  ::grpc::ByteBuffer truncated(&slices[0], 1);
+  std::vector<Tensor> decoded;
+  bool end_of_sequence;
+  Status s = DecodeElementFromByteBuffer(&truncated, &decoded,
+                                         &end_of_sequence);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+TEST(GrpcElementCodingTest, MultipleElements) {
+  std::vector<std::vector<Tensor>> elements = {
+      MakeElement(), {test::AsScalar<int64>(1)}, MakeElement()};
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementsToByteBuffer(elements, /*end_of_sequence=*/true,
+                                          &buffer));
+  std::vector<std::vector<Tensor>> decoded;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(DecodeElementsFromByteBuffer(&buffer, &decoded,
+                                            &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  ASSERT_EQ(decoded.size(), elements.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    ExpectElementsEqual(decoded[i], elements[i]);
+  }
+
+  // The same bytes parse with the generated code.
+  GetElementsResponse response;
+  TF_ASSERT_OK(EncodeElementsToByteBuffer(elements, /*end_of_sequence=*/true,
+                                          &buffer));
+  {
+    ::grpc::ProtoBufferReader reader(&buffer);
+    ASSERT_TRUE(response.ParseFromZeroCopyStream(&reader));
+  }
+  std::vector<std::vector<Tensor>> parsed;
+  TF_ASSERT_OK(ElementsFromResponse(&response, &parsed, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  ASSERT_EQ(parsed.size(), elements.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    ExpectElementsEqual(parsed[i], elements[i]);
+  }
+}
+
+TEST(GrpcElementCodingTest, NoElements) {
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementsToByteBuffer({}, /*end_of_sequence=*/false,
+                                          &buffer));
+  std::vector<std::vector<Tensor>> decoded = {MakeElement()};
+  bool end_of_sequence = true;
+  TF_ASSERT_OK(DecodeElementsFromByteBuffer(&buffer, &decoded,
+                                            &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  EXPECT_TRUE(decoded.empty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -15,7 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/grpc_worker_impl.h"
 
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "grpcpp/impl/codegen/method_handler.h"
+#include "grpcpp/impl/codegen/rpc_service_method.h"
 #include "grpcpp/server_context.h"
+#include "tensorflow/core/data/service/grpc_element_coding.h"
+#include "tensorflow/core/data/service/local_workers.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
 namespace tensorflow {
@@ -26,25 +34,71 @@ using ::grpc::ServerContext;
 
 GrpcWorkerImpl::GrpcWorkerImpl(const experimental::WorkerConfig& config,
                                ServerBuilder& server_builder)
-    : impl_(config) {
+    : impl_(std::make_shared<DataServiceWorkerImpl>(config)) {
+  // The raw methods are not part of the generated service, since generated
+  // services only produce responses through the proto serializer.
+  AddMethod(new ::grpc::internal::RpcServiceMethod(
+      kGetElementRawMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+      new ::grpc::internal::RpcMethodHandler<
+          GrpcWorkerImpl, GetElementRequest, ::grpc::ByteBuffer>(
+          std::mem_fn(&GrpcWorkerImpl::GetElementRaw), this)));
+  AddMethod(new ::grpc::internal::RpcServiceMethod(
+      kGetElementsRawMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+      new ::grpc::internal::RpcMethodHandler<
+          GrpcWorkerImpl, GetElementsRequest, ::grpc::ByteBuffer>(
+          std::mem_fn(&GrpcWorkerImpl::GetElementsRaw), this)));
   server_builder.RegisterService(this);
   VLOG(1) << "Registered data service worker";
 }
 
+GrpcWorkerImpl::~GrpcWorkerImpl() { Stop(); }
+
 Status GrpcWorkerImpl::Start(const std::string& worker_address) {
-  return impl_.Start(worker_address);
+  worker_address_ = worker_address;
+  TF_RETURN_IF_ERROR(impl_->Start(worker_address));
+  LocalWorkers::Add(worker_address, impl_);
+  return Status::OK();
+}
+
+void GrpcWorkerImpl::Stop() {
+  LocalWorkers::Remove(worker_address_, impl_.get());
 }
 
 #define HANDLER(method)                                                 \
   ::grpc::Status GrpcWorkerImpl::method(ServerContext* context,         \
                                         const method##Request* request, \
                                         method##Response* response) {   \
-    return ToGrpcStatus(impl_.method(request, response));               \
+    return ToGrpcStatus(impl_->method(request, response));              \
   }
 HANDLER(ProcessTask);
 HANDLER(GetElement);
+HANDLER(GetElements);
 HANDLER(GetWorkerTasks);
 #undef HANDLER
 
+::grpc::Status GrpcWorkerImpl::GetElementRaw(ServerContext* context,
+                                             const GetElementRequest* request,
+                                             ::grpc::ByteBuffer* response) {
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  Status s = impl_->GetElement(request, element, end_of_sequence);
+  if (s.ok()) {
+    s = EncodeElementToByteBuffer(element, end_of_sequence, response);
+  }
+  return ToGrpcStatus(s);
+}
+
+::grpc::Status GrpcWorkerImpl::GetElementsRaw(
+    ServerContext* context, const GetElementsRequest* request,
+    ::grpc::ByteBuffer* response) {
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_sequence = false;
+  Status s = impl_->GetElements(request, elements, end_of_sequence);
+  if (s.ok()) {
+    s = EncodeElementsToByteBuffer(elements, end_of_sequence, response);
+  }
+  return ToGrpcStatus(s);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
 
 #include "grpcpp/server_builder.h"
+#include "grpcpp/support/byte_buffer.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker_impl.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
@@ -31,9 +32,13 @@ class GrpcWorkerImpl : public WorkerService::Service {
   // `server_builder`.
   explicit GrpcWorkerImpl(const experimental::WorkerConfig& config,
                           ::grpc::ServerBuilder& server_builder);
-  ~GrpcWorkerImpl() override {}
+  ~GrpcWorkerImpl() override;
 
+  // Starts the worker and registers it with LocalWorkers under
+  // `worker_address`.
   Status Start(const std::string& worker_address);
+  // Unregisters the worker from LocalWorkers.
+  void Stop();
 
 #define HANDLER(method)                                 \
   ::grpc::Status method(::grpc::ServerContext* context, \
@@ -41,11 +46,27 @@ class GrpcWorkerImpl : public WorkerService::Service {
                         method##Response* response) override;
   HANDLER(ProcessTask);
   HANDLER(GetElement);
+  HANDLER(GetElements);
   HANDLER(GetWorkerTasks);
 #undef HANDLER
 
+  // Serves GetElement under the name kGetElementRawMethod, encoding the
+  // response with EncodeElementToByteBuffer so that the tensor buffers of
+  // uncompressed elements are not copied into a proto.
+  ::grpc::Status GetElementRaw(::grpc::ServerContext* context,
+                               const GetElementRequest* request,
+                               ::grpc::ByteBuffer* response);
+
+  // Serves GetElements under the name kGetElementsRawMethod, encoding the
+  // response with EncodeElementsToByteBuffer.
+  ::grpc::Status GetElementsRaw(::grpc::ServerContext* context,
+                                const GetElementsRequest* request,
+                                ::grpc::ByteBuffer* response);
+
  private:
-  DataServiceWorkerImpl impl_;
+  std::string worker_address_;
+  // Shared with LocalWorkers.
+  std::shared_ptr<DataServiceWorkerImpl> impl_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerImpl);
 };
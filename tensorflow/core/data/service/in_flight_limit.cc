@@ -0,0 +1,63 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/in_flight_limit.h"
+
+#include <algorithm>
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Weight of a new latency in the moving average.
+constexpr double kAverageWeight = 0.2;
+// Factor by which the lowest latency drifts up with each recorded latency.
+constexpr double kMinLatencyDrift = 1.01;
+// The limit grows while the average latency is below this multiple of the
+// lowest latency, and shrinks when it is above `kShrinkRatio`.
+constexpr double kGrowRatio = 1.5;
+constexpr double kShrinkRatio = 2.0;
+
+}  // namespace
+
+InFlightLimit::InFlightLimit(int64 max_limit)
+    : max_limit_(std::max<int64>(max_limit, 1)) {}
+
+void InFlightLimit::RecordLatency(int64 latency_us, bool consumer_waited) {
+  const double latency = std::max<int64>(latency_us, 1);
+  if (average_latency_us_ < 0) {
+    min_latency_us_ = latency;
+    average_latency_us_ = latency;
+  } else {
+    min_latency_us_ = std::min(min_latency_us_ * kMinLatencyDrift, latency);
+    average_latency_us_ = kAverageWeight * latency +
+                          (1 - kAverageWeight) * average_latency_us_;
+  }
+  if (hold_ > 0) {
+    --hold_;
+    return;
+  }
+  if (average_latency_us_ > kShrinkRatio * min_latency_us_ && limit_ > 1) {
+    --limit_;
+    hold_ = limit_;
+  } else if (consumer_waited &&
+             average_latency_us_ < kGrowRatio * min_latency_us_ &&
+             limit_ < max_limit_) {
+    ++limit_;
+    hold_ = limit_;
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,60 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_IN_FLIGHT_LIMIT_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_IN_FLIGHT_LIMIT_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Decides how many requests a client keeps in flight to one worker, based on
+// the latencies of the requests it made.
+//
+// The limit starts at 1. It grows while the consumer is waiting for elements
+// and the latency stays close to the lowest latency seen, i.e. while the
+// worker keeps up with more concurrent requests. It shrinks when the latency
+// rises well above the lowest latency, i.e. when requests queue up at the
+// worker. After each change, the limit is held for as many requests as it
+// allows, so that the change shows in the latencies before the next one.
+//
+// InFlightLimit is not thread-safe.
+class InFlightLimit {
+ public:
+  explicit InFlightLimit(int64 max_limit);
+
+  // Returns the number of requests to keep in flight.
+  int64 limit() const { return limit_; }
+
+  // Records the latency of a request. `consumer_waited` tells whether the
+  // consumer ran out of elements while the request was in flight.
+  void RecordLatency(int64 latency_us, bool consumer_waited);
+
+ private:
+  const int64 max_limit_;
+  int64 limit_ = 1;
+  // The lowest latency seen. It drifts up slowly so that a single fast
+  // request does not hold the limit down forever.
+  double min_latency_us_ = -1;
+  // Exponentially weighted moving average of the latency.
+  double average_latency_us_ = -1;
+  // The number of latencies to record before changing the limit again.
+  int64 hold_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_IN_FLIGHT_LIMIT_H_
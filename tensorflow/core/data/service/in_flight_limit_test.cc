@@ -0,0 +1,72 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/in_flight_limit.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(InFlightLimitTest, StartsAtOne) {
+  InFlightLimit limit(/*max_limit=*/8);
+  EXPECT_EQ(limit.limit(), 1);
+}
+
+TEST(InFlightLimitTest, GrowsWhileConsumerWaits) {
+  InFlightLimit limit(/*max_limit=*/8);
+  for (int i = 0; i < 100; ++i) {
+    limit.RecordLatency(/*latency_us=*/1000, /*consumer_waited=*/true);
+  }
+  EXPECT_EQ(limit.limit(), 8);
+}
+
+TEST(InFlightLimitTest, StaysWhenConsumerDoesNotWait) {
+  InFlightLimit limit(/*max_limit=*/8);
+  for (int i = 0; i < 100; ++i) {
+    limit.RecordLatency(/*latency_us=*/1000, /*consumer_waited=*/false);
+  }
+  EXPECT_EQ(limit.limit(), 1);
+}
+
+TEST(InFlightLimitTest, ShrinksWhenLatencyRises) {
+  InFlightLimit limit(/*max_limit=*/8);
+  for (int i = 0; i < 100; ++i) {
+    limit.RecordLatency(/*latency_us=*/1000, /*consumer_waited=*/true);
+  }
+  ASSERT_EQ(limit.limit(), 8);
+  // Requests queue up at the worker: latency grows with the limit.
+  for (int i = 0; i < 100; ++i) {
+    limit.RecordLatency(/*latency_us=*/1000 * limit.limit(),
+                        /*consumer_waited=*/true);
+  }
+  EXPECT_LT(limit.limit(), 8);
+  EXPECT_GE(limit.limit(), 1);
+}
+
+TEST(InFlightLimitTest, HoldsAfterChange) {
+  InFlightLimit limit(/*max_limit=*/8);
+  limit.RecordLatency(/*latency_us=*/1000, /*consumer_waited=*/true);
+  EXPECT_EQ(limit.limit(), 2);
+  limit.RecordLatency(/*latency_us=*/1000, /*consumer_waited=*/true);
+  limit.RecordLatency(/*latency_us=*/1000, /*consumer_waited=*/true);
+  EXPECT_EQ(limit.limit(), 2);
+  limit.RecordLatency(/*latency_us=*/1000, /*consumer_waited=*/true);
+  EXPECT_EQ(limit.limit(), 3);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,61 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/local_workers.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+mutex mu(LINKER_INITIALIZED);
+
+absl::flat_hash_map<std::string, std::shared_ptr<LocalWorker>>& Workers()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+  static auto* workers =
+      new absl::flat_hash_map<std::string, std::shared_ptr<LocalWorker>>();
+  return *workers;
+}
+
+}  // namespace
+
+void LocalWorkers::Add(const std::string& worker_address,
+                       std::shared_ptr<LocalWorker> worker) {
+  mutex_lock l(mu);
+  Workers()[worker_address] = std::move(worker);
+}
+
+std::shared_ptr<LocalWorker> LocalWorkers::Get(
+    const std::string& worker_address) {
+  mutex_lock l(mu);
+  auto it = Workers().find(worker_address);
+  if (it == Workers().end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void LocalWorkers::Remove(const std::string& worker_address,
+                          const LocalWorker* worker) {
+  mutex_lock l(mu);
+  auto it = Workers().find(worker_address);
+  if (it != Workers().end() && it->second.get() == worker) {
+    Workers().erase(it);
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
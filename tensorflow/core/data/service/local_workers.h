@@ -0,0 +1,69 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_LOCAL_WORKERS_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_LOCAL_WORKERS_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// The part of a tf.data service worker that clients in the same process call
+// directly instead of going through gRPC. Elements are handed over as the
+// tensors produced by the worker, so their buffers are neither serialized nor
+// copied.
+class LocalWorker {
+ public:
+  virtual ~LocalWorker() = default;
+
+  // See DataServiceWorkerImpl.
+  virtual Status GetElement(const GetElementRequest* request,
+                            std::vector<Tensor>& element,
+                            bool& end_of_sequence) = 0;
+  virtual Status GetElements(const GetElementsRequest* request,
+                             std::vector<std::vector<Tensor>>& elements,
+                             bool& end_of_sequence) = 0;
+};
+
+// Registry of the tf.data service workers running in this process, keyed by
+// the addresses they registered with the dispatcher. This class is
+// thread-safe.
+class LocalWorkers {
+ public:
+  // Registers `worker` under `worker_address`, replacing any worker
+  // previously registered under it.
+  static void Add(const std::string& worker_address,
+                  std::shared_ptr<LocalWorker> worker);
+
+  // Returns the worker registered under `worker_address`, or nullptr if there
+  // is none.
+  static std::shared_ptr<LocalWorker> Get(const std::string& worker_address);
+
+  // Unregisters `worker` from `worker_address`, unless another worker was
+  // registered under it since.
+  static void Remove(const std::string& worker_address,
+                     const LocalWorker* worker);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_LOCAL_WORKERS_H_
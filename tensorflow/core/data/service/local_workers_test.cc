@@ -0,0 +1,62 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/local_workers.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class FakeWorker : public LocalWorker {
+ public:
+  Status GetElement(const GetElementRequest* request,
+                    std::vector<Tensor>& element,
+                    bool& end_of_sequence) override {
+    end_of_sequence = true;
+    return Status::OK();
+  }
+  Status GetElements(const GetElementsRequest* request,
+                     std::vector<std::vector<Tensor>>& elements,
+                     bool& end_of_sequence) override {
+    end_of_sequence = true;
+    return Status::OK();
+  }
+};
+
+TEST(LocalWorkersTest, AddAndRemove) {
+  auto worker = std::make_shared<FakeWorker>();
+  EXPECT_EQ(LocalWorkers::Get("localhost:1"), nullptr);
+  LocalWorkers::Add("localhost:1", worker);
+  EXPECT_EQ(LocalWorkers::Get("localhost:1"), worker);
+  EXPECT_EQ(LocalWorkers::Get("localhost:2"), nullptr);
+  LocalWorkers::Remove("localhost:1", worker.get());
+  EXPECT_EQ(LocalWorkers::Get("localhost:1"), nullptr);
+}
+
+TEST(LocalWorkersTest, RemoveKeepsReplacement) {
+  auto old_worker = std::make_shared<FakeWorker>();
+  auto new_worker = std::make_shared<FakeWorker>();
+  LocalWorkers::Add("localhost:3", old_worker);
+  LocalWorkers::Add("localhost:3", new_worker);
+  LocalWorkers::Remove("localhost:3", old_worker.get());
+  EXPECT_EQ(LocalWorkers::Get("localhost:3"), new_worker);
+  LocalWorkers::Remove("localhost:3", new_worker.get());
+  EXPECT_EQ(LocalWorkers::Get("localhost:3"), nullptr);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
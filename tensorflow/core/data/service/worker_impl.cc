@@ -49,6 +49,44 @@ auto* tf_data_service_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/data/service/created",
                                     "Whether a tf.data service server "
                                     "has been created.");
+
+// Moves `element` into `response`, as a compressed element if the dataset was
+// registered with compression.
+void MoveElementToResponse(std::vector<Tensor>& element,
+                           GetElementResponse* response) {
+  if (element.size() == 1 && element[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(element[0].shape())) {
+    Variant& variant = element[0].scalar<Variant>()();
+    CompressedElement* compressed = variant.get<CompressedElement>();
+    if (compressed != nullptr) {
+      compressed->Swap(response->mutable_compressed_element());
+      return;
+    }
+  }
+  // The dataset was registered without compression.
+  UncompressedElement* uncompressed = response->mutable_uncompressed_element();
+  for (const Tensor& component : element) {
+    component.AsProtoTensorContent(uncompressed->add_components());
+  }
+}
+
+// Returns the number of bytes of data in `element`.
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& component : element) {
+    if (component.dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(component.shape())) {
+      const CompressedElement* compressed =
+          component.scalar<Variant>()().get<CompressedElement>();
+      if (compressed != nullptr) {
+        bytes += compressed->data().size();
+        continue;
+      }
+    }
+    bytes += component.TotalBytes();
+  }
+  return bytes;
+}
 }  // namespace
 
 DataServiceWorkerImpl::DataServiceWorkerImpl(
@@ -177,9 +215,72 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
 
 Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
                                          GetElementResponse* response) {
-  VLOG(3) << "Received GetElement request for task " << request->task_id();
+  std::vector<Tensor> outputs;
   bool end_of_sequence = false;
-  std::vector<tensorflow::Tensor> outputs;
+  TF_RETURN_IF_ERROR(GetElement(request, outputs, end_of_sequence));
+  response->set_end_of_sequence(end_of_sequence);
+  if (end_of_sequence) {
+    return Status::OK();
+  }
+  VLOG(3) << "Producing an element for task " << request->task_id();
+  MoveElementToResponse(outputs, response);
+  return Status::OK();
+}
+
+Status DataServiceWorkerImpl::GetElements(const GetElementsRequest* request,
+                                          GetElementsResponse* response) {
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_sequence = false;
+  TF_RETURN_IF_ERROR(GetElements(request, elements, end_of_sequence));
+  for (auto& element : elements) {
+    MoveElementToResponse(element, response->add_elements());
+  }
+  response->set_end_of_sequence(end_of_sequence);
+  return Status::OK();
+}
+
+Status DataServiceWorkerImpl::GetElements(
+    const GetElementsRequest* request,
+    std::vector<std::vector<Tensor>>& elements, bool& end_of_sequence) {
+  if (request->max_elements() <= 0) {
+    return errors::InvalidArgument("max_elements must be positive, but was ",
+                                   request->max_elements());
+  }
+  GetElementRequest element_request;
+  element_request.set_task_id(request->task_id());
+  elements.clear();
+  end_of_sequence = false;
+  int64 bytes = 0;
+  while (static_cast<int64>(elements.size()) < request->max_elements() &&
+         (request->max_bytes() <= 0 || bytes < request->max_bytes())) {
+    std::vector<Tensor> element;
+    Status s = GetElement(&element_request, element, end_of_sequence);
+    if (!s.ok()) {
+      if (elements.empty()) {
+        return s;
+      }
+      // The elements produced so far would be lost with the error, so return
+      // them and fail the next request for the task instead.
+      mutex_lock l(mu_);
+      deferred_errors_[request->task_id()] = s;
+      break;
+    }
+    if (end_of_sequence) {
+      break;
+    }
+    bytes += ElementBytes(element);
+    elements.push_back(std::move(element));
+  }
+  VLOG(3) << "Producing " << elements.size() << " elements of " << bytes
+          << " bytes for task " << request->task_id();
+  return Status::OK();
+}
+
+Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
+                                         std::vector<Tensor>& element,
+                                         bool& end_of_sequence) {
+  VLOG(3) << "Received GetElement request for task " << request->task_id();
+  end_of_sequence = false;
   {
     mutex_lock l(mu_);
     if (!registered_) {
@@ -191,9 +292,15 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
     }
     auto it = tasks_.find(request->task_id());
     if (it == tasks_.end()) {
-      response->set_end_of_sequence(true);
+      end_of_sequence = true;
       return Status::OK();
     }
+    auto error_it = deferred_errors_.find(request->task_id());
+    if (error_it != deferred_errors_.end()) {
+      Status s = error_it->second;
+      deferred_errors_.erase(error_it);
+      return s;
+    }
     auto& task = it->second;
     TF_RETURN_IF_ERROR(EnsureTaskInitialized(*task));
     TaskRunner::Request get_next_request;
@@ -206,7 +313,7 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
       get_next_request.round_index = request->round_index();
     }
     TF_RETURN_IF_ERROR(
-        task->task_runner->GetNext(get_next_request, outputs, end_of_sequence));
+        task->task_runner->GetNext(get_next_request, element, end_of_sequence));
     if (end_of_sequence) {
       VLOG(3) << "Reached end_of_sequence for task " << request->task_id();
       pending_completed_tasks_.insert(request->task_id());
@@ -214,38 +321,6 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
     }
   }
 
-  if (!end_of_sequence) {
-    VLOG(3) << "Producing an element for task " << request->task_id();
-    if (outputs.size() != 1) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but the "
-          "dataset produced ",
-          outputs.size(), " outputs");
-    }
-    if (outputs[0].dtype() != DT_VARIANT) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but "
-          "the dataset produced a tensor with type ",
-          DataTypeString(outputs[0].dtype()));
-    }
-    if (!TensorShapeUtils::IsScalar(outputs[0].shape())) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but "
-          "the dataset produced a tensor with shape ",
-          outputs[0].shape());
-    }
-    Variant& variant = outputs[0].scalar<Variant>()();
-    CompressedElement* compressed = variant.get<CompressedElement>();
-    if (compressed == nullptr) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a CompressedElement variant tensor, but "
-          "it produced ",
-          variant.TypeName());
-    }
-    compressed->Swap(response->mutable_compressed_element());
-  }
-  response->set_end_of_sequence(end_of_sequence);
-
   return Status::OK();
 }
 
@@ -362,6 +437,7 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
     VLOG(3) << "Deleting task " << task_id
             << " at the request of the dispatcher";
     tasks_.erase(task_id);
+    deferred_errors_.erase(task_id);
   }
   return Status::OK();
 }
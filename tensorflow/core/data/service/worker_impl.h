@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
+#include "tensorflow/core/data/service/local_workers.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
@@ -29,11 +30,12 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
-// A TensorFlow DataService serves dataset elements over RPC.
-class DataServiceWorkerImpl {
+// A TensorFlow DataService serves dataset elements over RPC, and directly to
+// clients in the same process through LocalWorkers.
+class DataServiceWorkerImpl : public LocalWorker {
  public:
   explicit DataServiceWorkerImpl(const experimental::WorkerConfig& config);
-  ~DataServiceWorkerImpl();
+  ~DataServiceWorkerImpl() override;
 
   // Starts the worker. The worker needs to know its own address so that it can
   // register with the dispatcher. This is set in `Start` instead of in the
@@ -51,6 +53,18 @@ class DataServiceWorkerImpl {
   /// Client-facing API.
   Status GetElement(const GetElementRequest* request,
                     GetElementResponse* response);
+  // Like GetElement above, but returns the tensors produced by the task
+  // without copying them into a response. Used to serve GetElementRaw.
+  Status GetElement(const GetElementRequest* request,
+                    std::vector<Tensor>& element,
+                    bool& end_of_sequence) override;
+  Status GetElements(const GetElementsRequest* request,
+                     GetElementsResponse* response);
+  // Like GetElements above, but without copying the elements into a response.
+  // Used to serve GetElementsRaw.
+  Status GetElements(const GetElementsRequest* request,
+                     std::vector<std::vector<Tensor>>& elements,
+                     bool& end_of_sequence) override;
   Status GetWorkerTasks(const GetWorkerTasksRequest* request,
                         GetWorkerTasksResponse* response);
 
@@ -87,6 +101,9 @@ class DataServiceWorkerImpl {
   absl::flat_hash_map<int64, std::unique_ptr<Task>> tasks_ TF_GUARDED_BY(mu_);
   // Completed tasks which haven't yet been communicated to the dispatcher.
   absl::flat_hash_set<int64> pending_completed_tasks_ TF_GUARDED_BY(mu_);
+  // Errors that GetElements hit after producing some elements, keyed by task
+  // ids. They are returned by the next request for the task.
+  absl::flat_hash_map<int64, Status> deferred_errors_ TF_GUARDED_BY(mu_);
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
   // Whether the worker has registered with the dispatcher yet.
   bool registered_ TF_GUARDED_BY(mu_) = false;
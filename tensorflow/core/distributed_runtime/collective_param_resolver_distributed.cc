@@ -156,6 +156,11 @@ void CollectiveParamResolverDistributed::CompleteGroupAsync(
           }
           response->set_communicator_key(
               gr->group.runtime_details.communicator_key);
+          response->set_halving_doubling_max_bytes(
+              gr->group.halving_doubling_max_bytes);
+          response->set_fusion_threshold_bytes(
+              gr->group.fusion_threshold_bytes);
+          response->set_fusion_timeout_micros(gr->group.fusion_timeout_micros);
         } else {
           LOG(ERROR) << "Bad status from CompleteGroupDistributed: " << s;
         }
@@ -250,6 +255,9 @@ Status CollectiveParamResolverDistributed::UpdateGroupCache(
       gr->devices[device.name()] = device;
     }
     gr->group.runtime_details.communicator_key = resp.communicator_key();
+    gr->group.halving_doubling_max_bytes = resp.halving_doubling_max_bytes();
+    gr->group.fusion_threshold_bytes = resp.fusion_threshold_bytes();
+    gr->group.fusion_timeout_micros = resp.fusion_timeout_micros();
     FinishGroup(gr.get());
   }
   GroupRec* previous_gr = nullptr;
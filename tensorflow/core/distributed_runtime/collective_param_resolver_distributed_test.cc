@@ -142,6 +142,10 @@ class DeviceResDistTest : public ::testing::Test {
     config.mutable_experimental()->set_collective_group_leader(
         "/job:worker/replica:0/task:0");
     config.mutable_experimental()->set_collective_nccl(nccl);
+    if (worker_name == "/job:worker/replica:0/task:0") {
+      config.mutable_experimental()->set_collective_halving_doubling_max_bytes(
+          leader_halving_doubling_max_bytes_);
+    }
 
     std::vector<std::unique_ptr<Device>> devices;
     for (int i = 0; i < num_devices; ++i) {
@@ -293,6 +297,8 @@ class DeviceResDistTest : public ::testing::Test {
     }
   }
 
+  // Set in the ConfigProto of the group leader only.
+  int64 leader_halving_doubling_max_bytes_ = 0;
   FakeCache wc_;
   CancellationManager cm_;
   // Below are keyed by task names.
@@ -343,6 +349,22 @@ TEST_F(DeviceResDistTest, DifferentIncarnation) {
   EXPECT_TRUE(errors::IsFailedPrecondition(status_[device_name]));
 }
 
+TEST_F(DeviceResDistTest, HalvingDoublingMaxBytesFromLeader) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  leader_halving_doubling_max_bytes_ = 1 << 10;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  // The members that do not lead the group follow the leader.
+  for (const auto& item : cp_) {
+    EXPECT_EQ(item.second.group.halving_doubling_max_bytes, 1 << 10);
+    EXPECT_EQ(item.second.instance.impl_details.collective_name,
+              "HalvingDoublingReduce");
+  }
+}
+
 #if !GOOGLE_CUDA && !TENSORFLOW_USE_ROCM
 namespace {
 // A mock NcclReducer for testing group runtime details initialization with CPU
@@ -0,0 +1,341 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Runs the all-reduce implementations across tasks in this process, which
+// reach each other through CollectiveRemoteAccessDistributed and fake
+// workers, as they would across workers of a cluster.
+
+#include "absl/memory/memory.h"
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/distributed_runtime/collective_rma_distributed.h"
+#include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
+#include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kStepId = 123;
+
+// Serves the RecvBuf calls of peers from the buffers that a task provides.
+class FakeWorker : public TestWorkerInterface {
+ public:
+  explicit FakeWorker(CollectiveRemoteAccess* remote_access)
+      : remote_access_(remote_access) {}
+
+  void RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
+                    RecvBufResponse* response, StatusCallback done) override {
+    remote_access_->buf_rendezvous()->ConsumeBuf(
+        request->buf_rendezvous_key(), request->src_device(),
+        request->src_incarnation(),
+        [response, done](const Status& s, BufRendezvous::Hook* h) {
+          if (s.ok()) {
+            // Without RDMA the bytes are sent in the response.
+            RecvBufRespExtra extra;
+            extra.add_tensor_content(string(
+                reinterpret_cast<const char*>(DMAHelper::base(h->prod_value)),
+                h->prod_value->TotalBytes()));
+            response->mutable_transport_options()->PackFrom(extra);
+          }
+          done(s);
+          if (h) BufRendezvous::DoneWithHook(h);
+        },
+        nullptr /*cancellation_manager*/);
+  }
+
+ private:
+  CollectiveRemoteAccess* remote_access_;  // Not owned
+};
+
+std::unique_ptr<OpKernel> GetKernel(const NodeDef& node, Device* device) {
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node,
+      TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, device);
+}
+
+// Tasks with one CPU device each, whose collective executors reach each other
+// through CollectiveRemoteAccessDistributed.
+class Cluster {
+ public:
+  explicit Cluster(int num_tasks)
+      : work_queue_(
+            std::make_shared<UnboundedWorkQueue>(Env::Default(), "test")) {
+    SessionOptions options;
+    std::vector<DeviceAttributes> attributes;
+    for (int t = 0; t < num_tasks; ++t) {
+      auto task = absl::make_unique<Task>();
+      task->name = strings::StrCat("/job:worker/replica:0/task:", t);
+      std::vector<std::unique_ptr<Device>> devices;
+      devices.push_back(absl::make_unique<ThreadPoolDevice>(
+          options, strings::StrCat(task->name, "/device:CPU:0"),
+          Bytes(256 << 20), DeviceLocality(), cpu_allocator()));
+      task->device = devices.back().get();
+      attributes.push_back(task->device->attributes());
+      task->device_mgr = absl::make_unique<StaticDeviceMgr>(std::move(devices));
+      task->device_resolver =
+          absl::make_unique<DeviceResolverDistributed>(task->device_mgr.get());
+      auto* remote_access = new CollectiveRemoteAccessDistributed(
+          task->device_mgr.get(), task->device_resolver.get(), work_queue_,
+          &worker_cache_, kStepId, task->name);
+      task->worker = absl::make_unique<FakeWorker>(remote_access);
+      worker_cache_.AddWorker(task->name, task->worker.get());
+      task->col_exec = new BaseCollectiveExecutor(
+          &col_exec_mgr_, remote_access, kStepId, task->device_mgr.get(),
+          &gpu_ring_order_, work_queue_);
+      tasks_.push_back(std::move(task));
+    }
+    for (const auto& task : tasks_) {
+      TF_CHECK_OK(task->device_resolver->UpdateDeviceAttributes(attributes));
+    }
+  }
+
+  ~Cluster() {
+    for (const auto& task : tasks_) {
+      task->col_exec->Unref();
+    }
+  }
+
+  // Replaces each of `tensors`, one per task, with their mean, computed by
+  // the all-reduce implementation `collective_name`.
+  Status AllReduce(const string& collective_name,
+                   std::vector<Tensor>* tensors) {
+    const int instance_key = ++instance_key_;
+    std::vector<Status> statuses(tasks_.size());
+    BlockingCounter counter(tasks_.size());
+    for (int t = 0; t < tasks_.size(); ++t) {
+      // Collective implementations block the threads that run them.
+      SchedClosure([this, t, &collective_name, instance_key, tensors,
+                    &statuses, &counter]() {
+        statuses[t] = AllReduceInTask(collective_name, instance_key, t,
+                                      &(*tensors)[t]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    Status status;
+    for (const Status& s : statuses) {
+      status.Update(s);
+    }
+    return status;
+  }
+
+ private:
+  struct Task {
+    string name;
+    Device* device;  // Owned by device_mgr
+    std::unique_ptr<DeviceMgr> device_mgr;
+    std::unique_ptr<DeviceResolverDistributed> device_resolver;
+    std::unique_ptr<FakeWorker> worker;
+    CollectiveExecutor* col_exec;
+  };
+
+  Status AllReduceInTask(const string& collective_name, int instance_key,
+                         int rank, Tensor* tensor) {
+    Task* task = tasks_[rank].get();
+    const int group_size = tasks_.size();
+    CollectiveParams cp;
+    cp.name = "all_reduce";
+    cp.group.group_key = 1;
+    cp.group.group_size = group_size;
+    cp.group.device_type = DEVICE_CPU;
+    cp.group.num_tasks = group_size;
+    for (int t = 0; t < group_size; ++t) {
+      cp.group.device_names.push_back(tasks_[t]->device->name());
+      cp.group.task_names.push_back(tasks_[t]->name);
+      cp.group.num_devices_per_task[tasks_[t]->name] = 1;
+      cp.task.is_local.push_back(t == rank);
+    }
+    cp.instance.instance_key = instance_key;
+    cp.instance.type = REDUCTION_COLLECTIVE;
+    cp.instance.data_type = tensor->dtype();
+    cp.instance.shape = tensor->shape();
+    cp.instance.impl_details.collective_name = collective_name;
+    cp.default_rank = rank;
+
+    CollectiveImplementationInterface* col_impl;
+    TF_RETURN_IF_ERROR(CollectiveRegistry::Lookup(collective_name, &col_impl));
+    core::ScopedUnref unref(col_impl);
+    TF_RETURN_IF_ERROR(col_impl->InitializeCollectiveParams(&cp));
+    std::unique_ptr<OpKernel> merge_op =
+        GetBinOp("Add", tensor->dtype(), task->device);
+    std::unique_ptr<OpKernel> final_op =
+        GetBinOp("Div", tensor->dtype(), task->device);
+    cp.merge_op = merge_op.get();
+    cp.final_op = final_op.get();
+
+    NodeDef node_def;
+    TF_CHECK_OK(NodeDefBuilder("collective_reduce", "CollectiveReduce")
+                    .Attr("T", tensor->dtype())
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Div")
+                    .Attr("group_size", group_size)
+                    .Attr("group_key", cp.group.group_key)
+                    .Attr("instance_key", instance_key)
+                    .Attr("subdiv_offsets", std::vector<int>())
+                    .Input(FakeInput(tensor->dtype()))
+                    .Finalize(&node_def));
+    std::unique_ptr<OpKernel> op = GetKernel(node_def, task->device);
+
+    OpKernelContext::Params op_params;
+    op_params.step_id = kStepId;
+    op_params.device = task->device;
+    op_params.op_kernel = op.get();
+    CancellationManager cancellation_manager;
+    op_params.cancellation_manager = &cancellation_manager;
+    gtl::InlinedVector<TensorValue, 4> inputs({TensorValue(tensor)});
+    op_params.inputs = &inputs;
+    gtl::InlinedVector<AllocatorAttributes, 4> input_attrs(
+        {AllocatorAttributes()});
+    op_params.input_alloc_attrs = &input_attrs;
+    DeviceContext* device_context = new DeviceContext;
+    core::ScopedUnref unref_device_context(device_context);
+    op_params.op_device_context = device_context;
+    int forward_from = 0;
+    op_params.forward_from_array = &forward_from;
+    AllocatorAttributes output_attrs;
+    op_params.output_attr_array = &output_attrs;
+    OpKernelContext ctx(&op_params, 1);
+    // The kernel is not run, so the output it would forward is set here.
+    Tensor* output = nullptr;
+    TF_RETURN_IF_ERROR(ctx.forward_input_or_allocate_output(
+        {0}, 0, tensor->shape(), &output));
+
+    auto col_ctx = std::make_shared<CollectiveContext>(
+        task->col_exec, /*nccl_communicator*/ nullptr, task->device_mgr.get(),
+        &ctx, &op_params, cp, strings::StrCat(instance_key, ":0:0"), kStepId,
+        tensor, tensor);
+    TF_RETURN_IF_ERROR(col_impl->InitializeCollectiveContext(col_ctx));
+    Status status;
+    col_impl->Run([&status](const Status& s) { status = s; });
+    return status;
+  }
+
+  std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  TestWorkerCache worker_cache_;
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  const string gpu_ring_order_;
+  std::vector<std::unique_ptr<Task>> tasks_;
+  int instance_key_ = 0;
+};
+
+void TestAllReduce(const string& collective_name, int num_tasks,
+                   int64 num_elements) {
+  Cluster cluster(num_tasks);
+  std::vector<Tensor> tensors;
+  Tensor expected(DT_FLOAT, TensorShape({num_elements}));
+  expected.flat<float>().setZero();
+  for (int t = 0; t < num_tasks; ++t) {
+    Tensor tensor(DT_FLOAT, TensorShape({num_elements}));
+    for (int64 i = 0; i < num_elements; ++i) {
+      tensor.flat<float>()(i) = t * 1000 + i;
+      expected.flat<float>()(i) += (t * 1000 + i) / num_tasks;
+    }
+    tensors.push_back(tensor);
+  }
+  TF_ASSERT_OK(cluster.AllReduce(collective_name, &tensors));
+  for (int t = 0; t < num_tasks; ++t) {
+    ASSERT_EQ(tensors[t].NumElements(), num_elements);
+    for (int64 i = 0; i < num_elements; ++i) {
+      EXPECT_FLOAT_EQ(expected.flat<float>()(i), tensors[t].flat<float>()(i))
+          << "Mismatch at task " << t << " index " << i;
+    }
+  }
+}
+
+TEST(CollectiveReduceDistributedTest, RingReduce) {
+  TestAllReduce("RingReduce", 4, 1001);
+  TestAllReduce("RingReduce", 3, 1 << 16);
+}
+
+TEST(CollectiveReduceDistributedTest, HalvingDoublingReduce) {
+  TestAllReduce("HalvingDoublingReduce", 2, 1);
+  TestAllReduce("HalvingDoublingReduce", 4, 3);
+  TestAllReduce("HalvingDoublingReduce", 8, 1001);
+  TestAllReduce("HalvingDoublingReduce", 4, 1 << 16);
+}
+
+void BM_AllReduce(::testing::benchmark::State& state,
+                  const string& collective_name) {
+  const int num_tasks = state.range(0);
+  const int64 num_elements = state.range(1);
+  Cluster cluster(num_tasks);
+  std::vector<Tensor> tensors;
+  for (int t = 0; t < num_tasks; ++t) {
+    Tensor tensor(DT_FLOAT, TensorShape({num_elements}));
+    tensor.flat<float>().setConstant(1);
+    tensors.push_back(tensor);
+  }
+  for (auto s : state) {
+    TF_CHECK_OK(cluster.AllReduce(collective_name, &tensors));
+  }
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          num_elements * sizeof(float));
+}
+
+void BM_RingReduce(::testing::benchmark::State& state) {
+  BM_AllReduce(state, "RingReduce");
+}
+
+void BM_HalvingDoublingReduce(::testing::benchmark::State& state) {
+  BM_AllReduce(state, "HalvingDoublingReduce");
+}
+
+// Arguments are the number of tasks and of float elements.
+#define ALL_REDUCE_BENCHMARK_ARGS \
+  ArgPair(2, 1 << 8)              \
+      ->ArgPair(4, 1 << 8)        \
+      ->ArgPair(8, 1 << 8)        \
+      ->ArgPair(4, 1 << 14)       \
+      ->ArgPair(8, 1 << 14)       \
+      ->ArgPair(4, 1 << 20)       \
+      ->ArgPair(8, 1 << 20)
+BENCHMARK(BM_RingReduce)->ALL_REDUCE_BENCHMARK_ARGS;
+BENCHMARK(BM_HalvingDoublingReduce)->ALL_REDUCE_BENCHMARK_ARGS;
+
+}  // namespace
+}  // namespace tensorflow
@@ -245,6 +245,7 @@ Status GraphMgr::InitItem(
     // Construct the root executor for the subgraph.
     params.device = unit->device;
     params.function_library = lib;
+    params.batch_inexpensive_nodes = graph_options.batch_inexpensive_nodes();
     params.create_kernel =
         [handle, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
                              OpKernel** kernel) {
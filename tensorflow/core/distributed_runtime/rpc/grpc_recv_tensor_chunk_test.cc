@@ -0,0 +1,236 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kChunkBytes = 64 << 10;  // 64KB
+
+// Starts a cluster of two tasks whose workers receive tensors from each other
+// in chunks of kChunkBytes. The variable is inherited by the servers.
+std::unique_ptr<test::TestCluster> MakeChunkedRecvCluster() {
+  setenv("TF_GRPC_RECV_TENSOR_CHUNK_BYTES",
+         strings::StrCat(kChunkBytes).c_str(), /*overwrite=*/1);
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 1;
+  (*options.config.mutable_device_count())["GPU"] = 0;
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(options, 2, &cluster));
+  return cluster;
+}
+
+std::unique_ptr<Session> NewRemote(const test::TestCluster& cluster) {
+  SessionOptions options;
+  options.target = strings::StrCat("grpc://", cluster.targets()[0]);
+  // Keeps the graphs as built, so that the tensors cross tasks.
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_disable_meta_optimizer(true);
+  return std::unique_ptr<Session>(CHECK_NOTNULL(NewSession(options)));
+}
+
+#if defined(__linux__)
+// Returns the peak resident set size of each process started by this one,
+// which are the servers of the test clusters.
+std::vector<int64> ServerPeakResidentBytes() {
+  std::vector<int64> result;
+  std::vector<string> entries;
+  TF_CHECK_OK(Env::Default()->GetChildren("/proc", &entries));
+  const string parent = strings::StrCat(getpid());
+  for (const string& pid : entries) {
+    string stat;
+    if (!ReadFileToString(Env::Default(), io::JoinPath("/proc", pid, "stat"),
+                          &stat)
+             .ok()) {
+      continue;
+    }
+    // The parent pid follows the parenthesized command and the state.
+    std::vector<string> fields =
+        str_util::Split(stat.substr(stat.rfind(')') + 2), ' ');
+    if (fields.size() < 2 || fields[1] != parent) continue;
+    string status;
+    TF_CHECK_OK(ReadFileToString(
+        Env::Default(), io::JoinPath("/proc", pid, "status"), &status));
+    for (const string& line : str_util::Split(status, '\n')) {
+      long long kb;
+      if (sscanf(line.c_str(), "VmHWM: %lld kB", &kb) == 1) {
+        result.push_back(kb << 10);
+      }
+    }
+  }
+  return result;
+}
+#endif  // defined(__linux__)
+
+TEST(GrpcRecvTensorChunkTest, Contents) {
+  std::unique_ptr<test::TestCluster> cluster = MakeChunkedRecvCluster();
+  const string& dev_a = cluster->devices()[0].name();
+  const string& dev_b = cluster->devices()[1].name();
+
+  // Sent in many chunks, in one chunk, and whole, respectively.
+  Tensor large(DT_INT32, TensorShape({1 << 20}));
+  for (int i = 0; i < large.NumElements(); ++i) {
+    large.flat<int32>()(i) = i;
+  }
+  Tensor small = test::AsTensor<float>({1.0, 2.0, 3.0});
+  Tensor text = test::AsTensor<tstring>({"a", "bc", ""});
+
+  GraphDef gdef;
+  std::vector<string> fetches;
+  {
+    Graph g(OpRegistry::Global());
+    for (const Tensor& t : {large, small, text}) {
+      Node* sent = test::graph::Constant(&g, t);
+      sent->set_assigned_device_name(dev_b);
+      Node* received = test::graph::Identity(&g, sent);
+      received->set_assigned_device_name(dev_a);
+      fetches.push_back(received->name());
+    }
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+  std::unique_ptr<Session> session = NewRemote(*cluster);
+  TF_ASSERT_OK(session->Create(gdef));
+  for (int iters = 0; iters < 3; ++iters) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, fetches, {}, &outputs));
+    ASSERT_EQ(outputs.size(), 3);
+    test::ExpectTensorEqual<int32>(outputs[0], large);
+    test::ExpectTensorEqual<float>(outputs[1], small);
+    test::ExpectTensorEqual<tstring>(outputs[2], text);
+  }
+  TF_ASSERT_OK(session->Close());
+}
+
+TEST(GrpcRecvTensorChunkTest, TransferCodec) {
+  std::unique_ptr<test::TestCluster> cluster = MakeChunkedRecvCluster();
+  const string& dev_a = cluster->devices()[0].name();
+  const string& dev_b = cluster->devices()[1].name();
+
+  // Each encoded tensor is larger than a chunk. The floats are exact in
+  // float16, and a quarter of them is larger than the others, so that
+  // "topk:0.25" keeps exactly those.
+  Tensor ints(DT_INT32, TensorShape({1 << 20}));
+  Tensor floats(DT_FLOAT, TensorShape({1 << 20}));
+  Tensor top_floats(DT_FLOAT, TensorShape({1 << 20}));
+  for (int i = 0; i < ints.NumElements(); ++i) {
+    ints.flat<int32>()(i) = i % 7;
+    const bool top = i % 4 == 1;
+    floats.flat<float>()(i) = top ? i % 1000 + 1 : 0.5;
+    top_floats.flat<float>()(i) = top ? i % 1000 + 1 : 0;
+  }
+
+  GraphDef gdef;
+  std::vector<string> fetches;
+  {
+    Graph g(OpRegistry::Global());
+    for (const auto& sent_with : std::vector<std::pair<Tensor, string>>{
+             {ints, "snappy"}, {floats, "float16"}, {floats, "topk:0.25"}}) {
+      Node* sent = test::graph::Constant(&g, sent_with.first);
+      sent->AddAttr("_transfer_codec", sent_with.second);
+      sent->set_assigned_device_name(dev_b);
+      Node* received = test::graph::Identity(&g, sent);
+      received->set_assigned_device_name(dev_a);
+      fetches.push_back(received->name());
+    }
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+  std::unique_ptr<Session> session = NewRemote(*cluster);
+  TF_ASSERT_OK(session->Create(gdef));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, fetches, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 3);
+  test::ExpectTensorEqual<int32>(outputs[0], ints);
+  test::ExpectTensorEqual<float>(outputs[1], floats);
+  test::ExpectTensorEqual<float>(outputs[2], top_floats);
+  TF_ASSERT_OK(session->Close());
+}
+
+// Reads the peak memory of the servers from /proc, which only Linux has.
+#if defined(__linux__)
+TEST(GrpcRecvTensorChunkTest, PeakMemoryIsBounded) {
+  std::unique_ptr<test::TestCluster> cluster = MakeChunkedRecvCluster();
+  const string& dev_a = cluster->devices()[0].name();
+  const string& dev_b = cluster->devices()[1].name();
+
+  const int64 num_elements = 32 << 20;
+  const int64 tensor_bytes = num_elements * sizeof(int32);
+  GraphDef gdef;
+  string sum_name;
+  {
+    Graph g(OpRegistry::Global());
+    Node* dims =
+        test::graph::Constant(&g, test::AsTensor<int64>({num_elements}));
+    Node* one = test::graph::Constant(&g, test::AsScalar<int32>(1));
+    Node* ones;
+    TF_ASSERT_OK(NodeBuilder(g.NewName("n"), "Fill")
+                     .Input(dims)
+                     .Input(one)
+                     .Finalize(&g, &ones));
+    for (Node* n : {dims, one, ones}) {
+      n->set_assigned_device_name(dev_b);
+    }
+    Node* axes = test::graph::Constant(&g, test::AsTensor<int32>({0}));
+    axes->set_assigned_device_name(dev_a);
+    Node* sum = test::graph::Reduce(&g, "Sum", ones, axes);
+    sum->set_assigned_device_name(dev_a);
+    sum_name = sum->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+  std::unique_ptr<Session> session = NewRemote(*cluster);
+  TF_ASSERT_OK(session->Create(gdef));
+
+  const std::vector<int64> start_bytes = ServerPeakResidentBytes();
+  ASSERT_EQ(start_bytes.size(), 2);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {sum_name}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[0].scalar<int32>()(), num_elements);
+
+  // Each server holds the tensor once. A receiver that buffered the whole
+  // response before decoding it would hold it twice.
+  const std::vector<int64> end_bytes = ServerPeakResidentBytes();
+  ASSERT_EQ(end_bytes.size(), 2);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_LT(end_bytes[i] - start_bytes[i], tensor_bytes * 3 / 2);
+  }
+  TF_ASSERT_OK(session->Close());
+}
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <atomic>
 #include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -66,6 +68,8 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorchunk_(Method(GrpcWorkerMethod::kRecvTensorChunk)),
+        recv_tensor_chunk_bytes_(RecvTensorChunkBytes()),
         logger_(logger),
         target_(target) {}
 
@@ -252,6 +256,12 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
+    if (recv_tensor_chunk_bytes_ > 0 && request->request_id() != 0 &&
+        response->CanReceiveInChunks() &&
+        !recv_tensor_chunk_unimplemented_.load(std::memory_order_relaxed)) {
+      RecvTensorInChunksAsync(call_opts, request, response, callback);
+      return;
+    }
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
@@ -296,6 +306,131 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(&request, response, markrecvfinished_, done);
   }
 
+  // State of a tensor received in RecvTensorChunk calls.
+  struct ChunkedRecvState {
+    // The RecvTensor request the chunks are received for, reissued whole if
+    // the worker does not serve RecvTensorChunk calls.
+    const RecvTensorRequest* recv_request;
+    RecvTensorChunkRequest request;
+    TensorResponse* response;
+    CallOptions* call_opts;
+    StatusCallback done;
+    int64 total_bytes = 0;
+
+    mutex mu;
+    // The number of chunks requested and not yet added to the tensor.
+    int pending TF_GUARDED_BY(mu) = 0;
+    Status status TF_GUARDED_BY(mu);
+  };
+
+  // Receives the tensor of `request` in RecvTensorChunk calls of at most
+  // `recv_tensor_chunk_bytes_` bytes, rather than in one RecvTensor response
+  // that is buffered whole before it is decoded. The call for each chunk is
+  // issued before the previous chunk is copied into the tensor, so that the
+  // transfer of a chunk overlaps the decoding of the previous one.
+  void RecvTensorInChunksAsync(CallOptions* call_opts,
+                               const RecvTensorRequest* request,
+                               TensorResponse* response, StatusCallback done) {
+    ChunkedRecvState* state = new ChunkedRecvState;
+    state->recv_request = request;
+    state->request.set_step_id(request->step_id());
+    state->request.set_rendezvous_key(request->rendezvous_key());
+    state->request.set_request_id(request->request_id());
+    state->request.set_chunk_bytes(recv_tensor_chunk_bytes_);
+    state->request.set_transfer_codec(request->transfer_codec());
+    state->response = response;
+    state->call_opts = call_opts;
+    state->done = std::move(done);
+    IssueRecvTensorChunkRequest(state, /*offset=*/0);
+  }
+
+  void IssueRecvTensorChunkRequest(ChunkedRecvState* state, int64 offset) {
+    {
+      mutex_lock l(state->mu);
+      ++state->pending;
+    }
+    // The request is serialized when it is issued, so the next chunk can
+    // reuse it.
+    state->request.set_offset(offset);
+    RecvTensorChunkResponse* chunk = new RecvTensorChunkResponse;
+    IssueRequest(
+        &state->request, chunk, recvtensorchunk_,
+        [this, state, chunk, offset](const Status& s) {
+          OnRecvTensorChunk(state, chunk, offset, s);
+        },
+        state->call_opts);
+  }
+
+  void OnRecvTensorChunk(ChunkedRecvState* state,
+                         RecvTensorChunkResponse* chunk, int64 offset,
+                         Status s) {
+    if (offset == 0 && errors::IsUnimplemented(s)) {
+      // The worker predates RecvTensorChunk calls. Nothing was received yet,
+      // so the tensor is received in one RecvTensor response instead, as are
+      // all the later tensors from this worker.
+      VLOG(1) << "RecvTensorChunk is not implemented by " << target_
+              << ", receiving tensors in RecvTensor responses: " << s;
+      recv_tensor_chunk_unimplemented_.store(true, std::memory_order_relaxed);
+      delete chunk;
+      IssueRequest(state->recv_request, state->response, recvtensor_,
+                   std::move(state->done), state->call_opts);
+      delete state;
+      return;
+    }
+    if (s.ok() && offset == 0) {
+      state->total_bytes = chunk->total_bytes();
+      s = state->response->InitChunked(chunk->mutable_metadata(),
+                                       chunk->total_bytes());
+    }
+    const int64 next_offset = offset + chunk->content().size();
+    if (s.ok() && next_offset < state->total_bytes) {
+      if (chunk->content().empty()) {
+        s = errors::Internal("Received an empty chunk of ",
+                             state->request.rendezvous_key(), " at ", offset);
+      } else if (!FailedChunkedRecv(state)) {
+        IssueRecvTensorChunkRequest(state, next_offset);
+      }
+    }
+    if (s.ok() && !chunk->content().empty()) {
+      s = state->response->AddChunk(offset, chunk->content());
+    }
+    delete chunk;
+
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->pending > 0) return;
+      status = state->status;
+    }
+    if (status.ok()) {
+      status = state->response->FinishChunked();
+    } else if (state->total_bytes > 0) {
+      // The sender may keep the tensor for the chunks that were not received.
+      ReleaseChunkedTensor(state->request);
+    }
+    StatusCallback done = std::move(state->done);
+    delete state;
+    done(status);
+  }
+
+  bool FailedChunkedRecv(ChunkedRecvState* state) {
+    mutex_lock l(state->mu);
+    return !state->status.ok();
+  }
+
+  // Tells the sender to drop the tensor of a chunked receive that stopped
+  // before its last chunk. Not issued with the call options of the receive,
+  // which may have been cancelled.
+  void ReleaseChunkedTensor(const RecvTensorChunkRequest& chunk_request) {
+    RecvTensorChunkRequest request = chunk_request;
+    request.set_release(true);
+
+    RecvTensorChunkResponse* response = new RecvTensorChunkResponse();
+    auto done = [response](Status status) { delete response; };
+    IssueRequest(&request, response, recvtensorchunk_, done);
+  }
+
   // Helper function for initializing the RpcMethod objects below.
   const char* Method(GrpcWorkerMethod id) { return GrpcWorkerMethodName(id); }
 
@@ -307,6 +442,15 @@ class GrpcRemoteWorker : public WorkerInterface {
     return max_retries;
   }
 
+  // Helper function for configuring the size of the chunks RecvTensor
+  // receives tensors in. Defaults to 0 (tensors are received in one response).
+  static int64 RecvTensorChunkBytes() {
+    int64 chunk_bytes = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_CHUNK_BYTES", 0,
+                                    &chunk_bytes));
+    return chunk_bytes;
+  }
+
   SharedGrpcChannelPtr channel_;
   ::grpc::GenericStub stub_;
   ::grpc::CompletionQueue* cq_;
@@ -328,6 +472,10 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorchunk_;
+  const int64 recv_tensor_chunk_bytes_;
+  // Set once the worker answered a RecvTensorChunk call with UNIMPLEMENTED.
+  std::atomic<bool> recv_tensor_chunk_unimplemented_{false};
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -137,8 +137,10 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
-void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result) {
+static void EncodeTensorToByteBufferImpl(
+    bool is_dead, const Tensor& val, bool require_ack,
+    const TensorTransferEncoding* transfer_encoding,
+    ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
   const int64 kProtoBufLimitBytes = 1LL << 31;
 
@@ -155,6 +157,9 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
+  if (transfer_encoding != nullptr) {
+    *response.mutable_transfer_encoding() = *transfer_encoding;
+  }
   if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
@@ -254,5 +259,18 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              ::grpc::ByteBuffer* result) {
+  EncodeTensorToByteBufferImpl(is_dead, val, require_ack,
+                               /*transfer_encoding=*/nullptr, result);
+}
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              const TensorTransferEncoding& transfer_encoding,
+                              ::grpc::ByteBuffer* result) {
+  EncodeTensorToByteBufferImpl(is_dead, val, require_ack, &transfer_encoding,
+                               result);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
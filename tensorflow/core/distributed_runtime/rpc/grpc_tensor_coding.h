@@ -21,6 +21,7 @@ limitations under the License.
 namespace tensorflow {
 class Tensor;
 class RecvTensorResponse;
+class TensorTransferEncoding;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -49,6 +50,12 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// As above, where "val" is the encoding of a tensor for transfer described
+// by "transfer_encoding".
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              const TensorTransferEncoding& transfer_encoding,
+                              ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
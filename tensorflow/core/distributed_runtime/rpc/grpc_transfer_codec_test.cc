@@ -0,0 +1,134 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+class GrpcTransferCodecTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SessionOptions options;
+    (*options.config.mutable_device_count())["CPU"] = 1;
+    (*options.config.mutable_device_count())["GPU"] = 0;
+    TF_ASSERT_OK(test::TestCluster::MakeTestCluster(options, 2, &cluster_));
+  }
+
+  // Sends `tensor` from the second task to the first one, asking for it to
+  // be encoded with `codec`, and returns it in *received.
+  Status Send(const string& codec, const Tensor& tensor, Tensor* received) {
+    GraphDef gdef;
+    string fetch;
+    {
+      Graph g(OpRegistry::Global());
+      Node* sent = test::graph::Constant(&g, tensor);
+      sent->AddAttr("_transfer_codec", codec);
+      sent->set_assigned_device_name(cluster_->devices()[1].name());
+      Node* identity = test::graph::Identity(&g, sent);
+      identity->set_assigned_device_name(cluster_->devices()[0].name());
+      fetch = identity->name();
+      test::graph::ToGraphDef(&g, &gdef);
+    }
+
+    SessionOptions options;
+    options.target = strings::StrCat("grpc://", cluster_->targets()[0]);
+    // Keeps the graph as built, so that the tensor crosses tasks.
+    options.config.mutable_graph_options()
+        ->mutable_optimizer_options()
+        ->set_opt_level(OptimizerOptions::L0);
+    options.config.mutable_graph_options()
+        ->mutable_rewrite_options()
+        ->set_disable_meta_optimizer(true);
+    std::unique_ptr<Session> session(NewSession(options));
+    TF_RETURN_IF_ERROR(session->Create(gdef));
+    std::vector<Tensor> outputs;
+    Status s = session->Run({}, {fetch}, {}, &outputs);
+    TF_RETURN_IF_ERROR(session->Close());
+    TF_RETURN_IF_ERROR(s);
+    *received = outputs[0];
+    return Status::OK();
+  }
+
+  std::unique_ptr<test::TestCluster> cluster_;
+};
+
+TEST_F(GrpcTransferCodecTest, Snappy) {
+  Tensor tensor(DT_INT64, TensorShape({64, 64}));
+  for (int i = 0; i < tensor.NumElements(); ++i) {
+    tensor.flat<int64>()(i) = i % 7;
+  }
+  Tensor received;
+  TF_ASSERT_OK(Send("snappy", tensor, &received));
+  test::ExpectTensorEqual<int64>(received, tensor);
+}
+
+TEST_F(GrpcTransferCodecTest, Downcast) {
+  Tensor tensor = test::AsTensor<float>({1.001, 3.14159, -2.5, 1024.0});
+  Tensor received;
+  TF_ASSERT_OK(Send("bfloat16", tensor, &received));
+  test::ExpectTensorNear<float>(received, tensor, 1e-2);
+  // Received with the precision of bfloat16.
+  EXPECT_NE(received.flat<float>()(1), tensor.flat<float>()(1));
+}
+
+TEST_F(GrpcTransferCodecTest, TopK) {
+  Tensor tensor(DT_FLOAT, TensorShape({10, 10}));
+  tensor.flat<float>().setConstant(0.5);
+  tensor.flat<float>()(3) = -7;
+  tensor.flat<float>()(42) = 9;
+  tensor.flat<float>()(99) = 8;
+
+  Tensor expected(DT_FLOAT, TensorShape({10, 10}));
+  expected.flat<float>().setZero();
+  expected.flat<float>()(3) = -7;
+  expected.flat<float>()(42) = 9;
+  expected.flat<float>()(99) = 8;
+  Tensor received;
+  TF_ASSERT_OK(Send("topk:0.025", tensor, &received));
+  test::ExpectTensorEqual<float>(received, expected);
+}
+
+TEST_F(GrpcTransferCodecTest, DeclinedCodecsSendTensorsAsTheyAre) {
+  // The sender only applies codecs that fit the tensor.
+  Tensor received;
+  Tensor ints = test::AsTensor<int32>({1, 2, 3});
+  TF_ASSERT_OK(Send("bfloat16", ints, &received));
+  test::ExpectTensorEqual<int32>(received, ints);
+
+  Tensor text = test::AsTensor<tstring>({"a", "bc", ""});
+  TF_ASSERT_OK(Send("snappy", text, &received));
+  test::ExpectTensorEqual<tstring>(received, text);
+
+  Tensor floats = test::AsTensor<float>({1, 2, 3, 4});
+  TF_ASSERT_OK(Send("topk:0.5", floats, &received));
+  test::ExpectTensorEqual<float>(received, floats);
+}
+
+TEST_F(GrpcTransferCodecTest, UnknownCodec) {
+  Tensor received;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      Send("lz4", test::AsTensor<float>({1, 2, 3}), &received)));
+}
+
+}  // namespace
+}  // namespace tensorflow
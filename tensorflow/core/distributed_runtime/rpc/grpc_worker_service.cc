@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_transfer_codec.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -147,6 +148,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorChunk, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -300,6 +302,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorChunkHandler(
+      WorkerCall<RecvTensorChunkRequest, RecvTensorChunkResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorChunkAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorChunk:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorChunk, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -447,11 +468,22 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [response, done, cache_enabled,
+                      transfer_codec = request->transfer_codec()](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      Tensor encoded;
+      TensorTransferEncoding encoding;
+      if (!transfer_codec.empty() && !is_dead &&
+          EncodeTensorForTransfer(transfer_codec, tensor, &encoded,
+                                  &encoding)) {
+        grpc::EncodeTensorToByteBuffer(is_dead, encoded, cache_enabled,
+                                       encoding, response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -487,10 +519,18 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     return;
   }
 
-  const string& key = request->rendezvous_key();
+  RecvHostTensorAsync(opts, step_id, request->rendezvous_key(),
+                      rendezvous_done);
+}
+
+void GrpcWorker::RecvHostTensorAsync(CallOptions* opts, int64 step_id,
+                                     const string& key,
+                                     GrpcResponseCache::FinishResponseCB done) {
+  auto fail = [&done](const Status& status) { done(Tensor(), false, status); };
+
   TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
   Rendezvous::ParsedKey parsed;
-  s = Rendezvous::ParseKey(key, &parsed);
+  Status s = Rendezvous::ParseKey(key, &parsed);
   Device* src_dev = nullptr;
   if (s.ok()) {
     s = PrepareRecvTensor(parsed, &src_dev);
@@ -510,7 +550,7 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
+      [opts, done, src_dev, key](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
@@ -537,21 +577,147 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
               // "val" is on an accelerator device. Uses the device_context to
               // fill the copy on host.
-              StatusCallback copy_ready = [rendezvous_done, copy,
+              StatusCallback copy_ready = [done, copy,
                                            is_dead](const Status& s) {
                 // The value is now ready to be returned on the wire.
-                rendezvous_done(*copy, is_dead, s);
+                done(*copy, is_dead, s);
                 delete copy;
               };
 
-              CopyDeviceToHost(&val, alloc, alloc, request->rendezvous_key(),
-                               src_dev, copy, send_dev_context, copy_ready);
+              CopyDeviceToHost(&val, alloc, alloc, key, src_dev, copy,
+                               send_dev_context, copy_ready);
               return;
             }
           }
         }
 
-        rendezvous_done(val, is_dead, status);
+        done(val, is_dead, status);
+      });
+}
+
+namespace {
+// Sets the `chunk_bytes` bytes of `content` at `offset` as the content of
+// `response`, or all the bytes from `offset` if `chunk_bytes` is not positive.
+// Returns true if they are the last bytes of `content`.
+bool SetContentChunkInResponse(StringPiece content, int64 offset,
+                               int64 chunk_bytes,
+                               RecvTensorChunkResponse* response) {
+  const int64 size = content.size();
+  const int64 end =
+      chunk_bytes > 0 ? std::min(size, offset + chunk_bytes) : size;
+  response->set_content(content.data() + offset, end - offset);
+  return end == size;
+}
+
+// How long the sender keeps a tensor with chunks left to send if the
+// receiver neither requests them nor releases it.
+constexpr uint64 kChunkedTensorIdleMicros = 60 * 1000 * 1000;  // 1 minute
+}  // namespace
+
+void GrpcWorker::DropIdleChunkedTensorsLocked(uint64 now_micros) {
+  for (auto it = chunked_tensors_.begin(); it != chunked_tensors_.end();) {
+    if (now_micros - it->second.last_access_micros >
+        kChunkedTensorIdleMicros) {
+      chunked_tensors_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void GrpcWorker::RecvTensorChunkAsync(CallOptions* opts,
+                                      const RecvTensorChunkRequest* request,
+                                      RecvTensorChunkResponse* response,
+                                      StatusCallback done) {
+  const int64 request_id = request->request_id();
+  const int64 step_id = request->step_id();
+  const int64 offset = request->offset();
+  const int64 chunk_bytes = request->chunk_bytes();
+
+  if (request->release()) {
+    // The receiver stopped before the last chunk.
+    mutex_lock l(chunked_tensors_mu_);
+    chunked_tensors_.erase(request_id);
+    done(Status::OK());
+    return;
+  }
+
+  if (offset > 0) {
+    // The tensor was received by the call for the first chunk.
+    Tensor tensor;
+    Status s;
+    {
+      mutex_lock l(chunked_tensors_mu_);
+      const uint64 now_micros = env_->env->NowMicros();
+      DropIdleChunkedTensorsLocked(now_micros);
+      auto it = chunked_tensors_.find(request_id);
+      if (it == chunked_tensors_.end()) {
+        s = errors::Aborted("No tensor is being sent in chunks for request ",
+                            request_id, " of step ", step_id);
+      } else {
+        tensor = it->second.tensor;
+        it->second.last_access_micros = now_micros;
+      }
+    }
+    StringPiece content = tensor.tensor_data();
+    if (s.ok() && offset >= static_cast<int64>(content.size())) {
+      s = errors::InvalidArgument("Chunk offset ", offset, " is past the ",
+                                  content.size(), " bytes of tensor ",
+                                  request->rendezvous_key());
+    }
+    if (s.ok() &&
+        SetContentChunkInResponse(content, offset, chunk_bytes, response)) {
+      mutex_lock l(chunked_tensors_mu_);
+      chunked_tensors_.erase(request_id);
+    }
+    done(s);
+    return;
+  }
+
+  Status s = recent_request_ids_.TrackUnique(
+      request_id, "RecvTensorChunk (GrpcWorker)", *request);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  RecvHostTensorAsync(
+      opts, step_id, request->rendezvous_key(),
+      [this, request_id, step_id, chunk_bytes, response, done,
+       transfer_codec = request->transfer_codec()](
+          const Tensor& received, bool is_dead, const Status& status) {
+        if (!status.ok()) {
+          done(status);
+          return;
+        }
+        RecvTensorResponse* metadata = response->mutable_metadata();
+        metadata->set_is_dead(is_dead);
+        metadata->set_send_start_micros(env_->env->NowMicros());
+        Tensor tensor = received;
+        TensorTransferEncoding encoding;
+        if (!transfer_codec.empty() && !is_dead &&
+            EncodeTensorForTransfer(transfer_codec, received, &tensor,
+                                    &encoding)) {
+          *metadata->mutable_transfer_encoding() = encoding;
+        }
+        if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+          // The content is not a flat buffer, so the tensor is sent whole.
+          tensor.AsProtoTensorContent(metadata->mutable_tensor());
+          done(Status::OK());
+          return;
+        }
+        metadata->mutable_tensor()->set_dtype(tensor.dtype());
+        tensor.shape().AsProto(
+            metadata->mutable_tensor()->mutable_tensor_shape());
+        StringPiece content = tensor.tensor_data();
+        response->set_total_bytes(content.size());
+        if (!SetContentChunkInResponse(content, 0, chunk_bytes, response)) {
+          mutex_lock l(chunked_tensors_mu_);
+          const uint64 now_micros = env_->env->NowMicros();
+          DropIdleChunkedTensorsLocked(now_micros);
+          chunked_tensors_[request_id] = {step_id, tensor, now_micros};
+        }
+        done(Status::OK());
       });
 }
 
@@ -735,6 +901,18 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  {
+    // Drop the tensors of chunked receives that stopped before their last
+    // chunk, e.g. because the receiver failed.
+    mutex_lock l(chunked_tensors_mu_);
+    for (auto it = chunked_tensors_.begin(); it != chunked_tensors_.end();) {
+      if (it->second.step_id == request->step_id()) {
+        chunked_tensors_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
   Worker::CleanupGraphAsync(request, response, done);
 }
 
@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include "grpcpp/server_builder.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
@@ -46,6 +47,15 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Sends the range of a tensor's content requested by a RecvTensorChunk call.
+  // The first call for a request_id receives the tensor from the rendezvous,
+  // and the tensor is kept until its last chunk is sent or its step is
+  // cleaned up, so that no response is larger than the requested chunk.
+  virtual void RecvTensorChunkAsync(CallOptions* opts,
+                                    const RecvTensorChunkRequest* request,
+                                    RecvTensorChunkResponse* response,
+                                    StatusCallback done);
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -63,8 +73,28 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64 request_id);
 
  private:
+  // Receives the tensor for `key` in `step_id` from the rendezvous, copying it
+  // to host memory if it is on a GPU.
+  void RecvHostTensorAsync(CallOptions* opts, int64 step_id, const string& key,
+                           GrpcResponseCache::FinishResponseCB done);
+
   std::unique_ptr<GrpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+
+  // Drops the entries of `chunked_tensors_` that no chunk was requested for
+  // for a while, e.g. because the receiver crashed.
+  void DropIdleChunkedTensorsLocked(uint64 now_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(chunked_tensors_mu_);
+
+  // Tensors with chunks left to send to RecvTensorChunk calls, by request_id.
+  struct ChunkedTensor {
+    int64 step_id;
+    Tensor tensor;
+    uint64 last_access_micros;
+  };
+  mutex chunked_tensors_mu_;
+  absl::flat_hash_map<int64, ChunkedTensor> chunked_tensors_
+      TF_GUARDED_BY(chunked_tensors_mu_);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
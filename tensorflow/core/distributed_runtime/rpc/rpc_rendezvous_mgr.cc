@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_transfer_codec.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -70,6 +71,13 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // Encoded tensors are decoded in host memory, so codecs are only asked
+    // for when the tensor is received there.
+    if (!recv_args.transfer_codec.empty() &&
+        (alloc_attrs.on_host() || dst_device->device_type() == DEVICE_CPU)) {
+      req_.set_transfer_codec(recv_args.transfer_codec.data(),
+                              recv_args.transfer_codec.size());
+    }
   }
 
   void Reset() {
@@ -125,6 +133,20 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   const Tensor& tensor() const { return resp_.tensor(); }
 
+  // Decodes the received tensor into *tensor if the sender encoded it for
+  // transfer, and otherwise returns it as it is.
+  Status DecodeTensor(Tensor* tensor) const {
+    const RecvTensorResponse& metadata = resp_.metadata();
+    if (!metadata.has_transfer_encoding() || metadata.is_dead()) {
+      *tensor = resp_.tensor();
+      return Status::OK();
+    }
+    return DecodeTransferredTensor(metadata.transfer_encoding(),
+                                   resp_.tensor(),
+                                   dst_device_->GetAllocator(alloc_attrs_),
+                                   tensor);
+  }
+
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
   Device* dst_device() const { return dst_device_; }
@@ -260,6 +282,9 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   if (s.ok()) {
     s = sess->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
   }
+  if (s.ok() && !recv_args.transfer_codec.empty()) {
+    s = ValidateTransferCodec(string(recv_args.transfer_codec));
+  }
   if (!s.ok()) {
     if (rwi != nullptr) {
       sess->worker_cache()->ReleaseWorker(call->src_worker_, rwi);
@@ -295,11 +320,15 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     // If StartAbort was called prior to DeregisterCall, then the
     // current status should be bad.
     Status s = call->status();
+    Tensor tensor;
+    if (s.ok()) {
+      s = call->DecodeTensor(&tensor);
+    }
     // NOTE: `*session()` can potentially be deleted before we return from
     // `call->done()(...)`, so we must release the worker before calling the
     // callback.
     call->ReleaseWorker(session()->worker_cache());
-    call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
+    call->done()(s, Args(), call->recv_args(), tensor, call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
   });
@@ -255,4 +255,48 @@ BENCHMARK(BM_SingleDevice)
     ->ArgPair(4, 10000)
     ->ArgPair(1, 1000000);
 
+// Measures the throughput of RecvTensor for a single large tensor produced on
+// one worker and consumed on another.
+static void BM_RecvTensorThroughput(::testing::benchmark::State& state) {
+  const int64 tensor_bytes = state.range(0);
+  const Cluster* cluster = GetCluster();
+
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+  // The size is fed, so that the tensor cannot be constant-folded away.
+  Scope root = Scope::NewRootScope();
+  Output n = Placeholder(root.WithOpName("n"), DT_INT32);
+  Output x = Fill(root.WithDevice(cluster->devices[1].name()),
+                  Reshape(root, n, {1}), 1.0f);
+  // Only the first element is fetched, so that the client does not receive
+  // the tensor too.
+  /* Output y =*/Slice(
+      root.WithOpName("y").WithDevice(cluster->devices[0].name()), x, {0},
+      {1});
+  GraphDef def;
+  TF_CHECK_OK(root.ToGraphDef(&def));
+
+  std::unique_ptr<Session> session(NewSession(cluster->options));
+  TF_CHECK_OK(session->Create(def));
+  Tensor num_elements(DT_INT32, TensorShape({}));
+  num_elements.scalar<int32>()() = tensor_bytes / sizeof(float);
+  std::vector<Tensor> outputs;
+  // Warm up the connection between the workers.
+  TF_CHECK_OK(session->Run({{"n", num_elements}}, {"y:0"}, {}, &outputs));
+
+  for (auto s : state) {
+    outputs.clear();
+    TF_CHECK_OK(session->Run({{"n", num_elements}}, {"y:0"}, {}, &outputs));
+  }
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          tensor_bytes);
+  testing::SetLabel(strings::StrCat("tensor bytes/send: ", tensor_bytes));
+  TF_CHECK_OK(session->Close());
+}
+BENCHMARK(BM_RecvTensorThroughput)
+    ->Arg(1 << 20)
+    ->Arg(16 << 20)
+    ->Arg(256 << 20)
+    ->Arg(1 << 30);
+
 }  // namespace tensorflow
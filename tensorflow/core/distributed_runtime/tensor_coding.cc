@@ -30,7 +30,9 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  host_allocator_ = nullptr;
   already_used_ = false;
+  copy_chunks_to_device_ = false;
   ClearTensor();
 }
 
@@ -48,6 +50,31 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
     on_host_ = true;
   }
   allocator_ = device_->GetAllocator(alloc_attrs_);
+  if (on_host_) {
+    host_allocator_ = allocator_;
+  } else if (CanCopyFromHost()) {
+    AllocatorAttributes host_attrs;
+    host_attrs.set_on_host(true);
+    host_attrs.set_gpu_compatible(true);
+    host_allocator_ = device_->GetAllocator(host_attrs);
+  }
+}
+
+bool TensorResponse::CanCopyFromHost() const {
+  const DeviceBase::GpuDeviceInfo* gpu_info =
+      device_->tensorflow_gpu_device_info();
+  return gpu_info != nullptr && gpu_info->default_context != nullptr;
+}
+
+Status TensorResponse::CopyToDevice(const Tensor& host_tensor) {
+  Tensor device_tensor(allocator_, host_tensor.dtype(), host_tensor.shape());
+  // Only devices set GPU device info, so `device_` is a Device.
+  TF_RETURN_IF_ERROR(
+      device_->tensorflow_gpu_device_info()
+          ->default_context->CopyCPUTensorToDeviceSync(
+              &host_tensor, static_cast<Device*>(device_), &device_tensor));
+  tensor_ = std::move(device_tensor);
+  return Status::OK();
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
@@ -79,7 +106,73 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
   tensor_ = std::move(t);
 }
 
+Status TensorResponse::InitChunked(RecvTensorResponse* response,
+                                   int64 total_bytes) {
+  if (already_used_) {
+    ClearTensor();
+  }
+  already_used_ = true;
+  copy_chunks_to_device_ = false;
+  if (total_bytes == 0) {
+    return InitFrom(response);
+  }
+  if (!CanReceiveInChunks()) {
+    return errors::Unimplemented("Cannot receive tensors in chunks on ",
+                                 device_->name());
+  }
+  meta_.Swap(response);
+  if (!DataTypeCanUseMemcpy(meta_.tensor().dtype())) {
+    return errors::InvalidArgument("Cannot receive ",
+                                   DataTypeString(meta_.tensor().dtype()),
+                                   " tensor content in chunks");
+  }
+  TF_RETURN_IF_ERROR(TensorShape::IsValidShape(meta_.tensor().tensor_shape()));
+  TensorShape shape(meta_.tensor().tensor_shape());
+  tensor_ = Tensor(host_allocator_, meta_.tensor().dtype(), shape);
+  if (tensor_.tensor_data().size() != total_bytes) {
+    return errors::InvalidArgument("Expected ", tensor_.tensor_data().size(),
+                                   " bytes of tensor content, got ",
+                                   total_bytes);
+  }
+  copy_chunks_to_device_ = !on_host_;
+  return Status::OK();
+}
+
+Status TensorResponse::AddChunk(int64 offset, StringPiece data) {
+  StringPiece buf = tensor_.tensor_data();
+  // Compared in size_t so that a malformed offset cannot overflow the sum.
+  if (offset < 0 || data.size() > buf.size() ||
+      static_cast<size_t>(offset) > buf.size() - data.size()) {
+    return errors::InvalidArgument("Chunk of ", data.size(), " bytes at ",
+                                   offset, " is out of the ", buf.size(),
+                                   " bytes of tensor content");
+  }
+  memcpy(const_cast<char*>(buf.data()) + offset, data.data(), data.size());
+  return Status::OK();
+}
+
+Status TensorResponse::FinishChunked() {
+  if (!copy_chunks_to_device_) return Status::OK();
+  copy_chunks_to_device_ = false;
+  Tensor host_tensor = std::move(tensor_);
+  return CopyToDevice(host_tensor);
+}
+
 Status TensorResponse::ParseFrom(Source* source) {
+  if (!on_host_ && host_allocator_ != nullptr) {
+    // Decode the content from the received bytes straight into pinned host
+    // memory, and copy it to the device from there, rather than staging it in
+    // a TensorProto and then in a host tensor parsed from it.
+    if (already_used_) {
+      ClearTensor();
+    }
+    already_used_ = true;
+    if (ParseFast(source) && meta_.has_tensor()) {
+      Tensor host_tensor = std::move(tensor_);
+      return CopyToDevice(host_tensor);
+    }
+    ClearTensor();
+  }
   if (!on_host_) {
     protobuf::io::CodedInputStream input(source->contents());
     input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
@@ -156,7 +249,7 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(host_allocator_, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -196,12 +289,12 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(host_allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
+        // The underlying ZeroCopyInputStream yields the received slices one
+        // by one, and each is copied straight into the destination buffer.
+        // For host destinations, this is the only copy of the content.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -267,6 +360,12 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kTransferEncodingFieldNumber: {
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_transfer_encoding()))
+          return false;
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -79,6 +79,24 @@ class TensorResponse {
   void InitPartial(const RecvTensorResponse& response,
                    const AllocationAttributes& allocation_attr);
 
+  // Returns true if the content of memcpy-able tensors can be received in
+  // chunks with InitChunked(), AddChunk() and FinishChunked().
+  bool CanReceiveInChunks() const { return host_allocator_ != nullptr; }
+
+  // Initialize tensor from the first response of a chunked receive, which
+  // has `total_bytes` bytes of content to arrive in AddChunk() calls. If
+  // `total_bytes` is 0, *response holds the whole tensor.
+  // Leaves *response with unspecified contents.
+  Status InitChunked(RecvTensorResponse* response, int64 total_bytes);
+
+  // Copy `data` into the tensor content at `offset`. Chunks may be added
+  // concurrently if their ranges do not overlap.
+  Status AddChunk(int64 offset, StringPiece data);
+
+  // Complete a chunked receive once all the chunks have been added, copying
+  // the tensor to the device if it was received on the host for it.
+  Status FinishChunked();
+
   // Return a reference to the parsed tensor.  The tensor will remain
   // live only until *this is destroyed or modified.
   const Tensor& tensor() const { return tensor_; }
@@ -97,11 +115,24 @@ class TensorResponse {
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
+  // Returns true if the device can copy tensors from pinned host memory, so
+  // that ParseFrom() can decode device tensors on the host first.
+  bool CanCopyFromHost() const;
+
+  // Copies `host_tensor` into a new tensor on the device in `tensor_`.
+  Status CopyToDevice(const Tensor& host_tensor);
+
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // Allocates the host tensors ParseFast() decodes into: `allocator_` for host
+  // destinations, pinned host memory for devices that can copy from it, and
+  // null otherwise.
+  Allocator* host_allocator_ = nullptr;
   bool already_used_ = false;
+  // Whether a chunked receive decodes into host memory for the device.
+  bool copy_chunks_to_device_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
 };
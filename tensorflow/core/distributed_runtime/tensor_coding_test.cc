@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <limits>
+
+#include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +51,51 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// Copies host tensors into "device" tensors that also live in host memory, and
+// counts the copies.
+class CountingDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    StringPiece src = cpu_tensor->tensor_data();
+    memcpy(const_cast<char*>(device_tensor->tensor_data().data()), src.data(),
+           src.size());
+    done(Status::OK());
+  }
+
+  int num_copies() const { return num_copies_; }
+
+ private:
+  mutable int num_copies_ = 0;
+};
+
+class DummyGpuDevice : public Device {
+ public:
+  DummyGpuDevice(Env* env, CountingDeviceContext* context)
+      : Device(env, Attributes()) {
+    gpu_device_info_.default_context = context;
+    set_tensorflow_gpu_device_info(&gpu_device_info_);
+  }
+
+  Status Sync() override { return Status::OK(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  static DeviceAttributes Attributes() {
+    DeviceAttributes attr;
+    attr.set_name("/job:localhost/replica:0/task:0/device:GPU:0");
+    attr.set_device_type("GPU");
+    return attr;
+  }
+
+  GpuDeviceInfo gpu_device_info_;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +206,81 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, DeviceTensor) {
+  Tensor src(DT_FLOAT, TensorShape({3, 1000}));
+  src.flat<float>().setRandom();
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  StringSource source(&encoded, 1024);
+
+  auto* context = new CountingDeviceContext;
+  core::ScopedUnref unref(context);
+  DummyGpuDevice gpu_device(Env::Default(), context);
+  TensorResponse response;
+  response.InitAlloc(&gpu_device, AllocatorAttributes());
+  for (int i = 0; i < 2; i++) {  // Twice so we exercise reuse of "response"
+    TF_EXPECT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+    test::ExpectTensorEqual<float>(response.tensor(), src);
+  }
+  // The content is decoded on the host and copied once per tensor, without
+  // going through DeviceBase::MakeTensorFromProto().
+  EXPECT_EQ(context->num_copies(), 2);
+}
+
+TEST_F(TensorResponseTest, TransferEncoding) {
+  Tensor src = test::AsTensor<bfloat16>(
+      {bfloat16(1.0), bfloat16(-2.5), bfloat16(0.0), bfloat16(3.0)});
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  TensorTransferEncoding* encoding = proto.mutable_transfer_encoding();
+  encoding->set_codec("bfloat16");
+  encoding->set_dtype(DT_FLOAT);
+  TensorShape({2, 2}).AsProto(encoding->mutable_shape());
+  string encoded;
+  proto.AppendToString(&encoded);
+  StringSource source(&encoded, 1024);
+
+  // The copy to the device counts the tensors decoded by the fast path, which
+  // has to know the transfer_encoding field not to fall back to the slow one.
+  auto* context = new CountingDeviceContext;
+  core::ScopedUnref unref(context);
+  DummyGpuDevice gpu_device(Env::Default(), context);
+  TensorResponse response;
+  response.InitAlloc(&gpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(context->num_copies(), 1);
+  EXPECT_EQ(response.metadata().transfer_encoding().ShortDebugString(),
+            encoding->ShortDebugString());
+  test::ExpectTensorEqual<bfloat16>(response.tensor(), src);
+}
+
+TEST_F(TensorResponseTest, ChunkOutOfRange) {
+  Tensor src = test::AsTensor<int32>({1, 2, 3, 4});
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  proto.mutable_tensor()->clear_tensor_content();
+
+  DummyDevice cpu_device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.InitChunked(&proto, src.TotalBytes()));
+  StringPiece content = src.tensor_data();
+  EXPECT_TRUE(errors::IsInvalidArgument(response.AddChunk(-1, content)));
+  EXPECT_TRUE(errors::IsInvalidArgument(response.AddChunk(4, content)));
+  // An offset that wraps around when the chunk size is added to it.
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      response.AddChunk(std::numeric_limits<int64>::max(), content)));
+  TF_ASSERT_OK(response.AddChunk(0, content.substr(0, 8)));
+  TF_ASSERT_OK(response.AddChunk(8, content.substr(8)));
+  TF_ASSERT_OK(response.FinishChunked());
+  test::ExpectTensorEqual<int32>(response.tensor(), src);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
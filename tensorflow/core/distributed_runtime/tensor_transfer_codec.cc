@@ -0,0 +1,225 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_transfer_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "absl/strings/strip.h"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kSnappy[] = "snappy";
+constexpr char kBfloat16[] = "bfloat16";
+constexpr char kFloat16[] = "float16";
+constexpr char kTopKPrefix[] = "topk:";
+
+// Parses the fraction of elements kept by a "topk:<fraction>" codec.
+bool ParseTopKFraction(const std::string& codec, float* fraction) {
+  StringPiece value(codec);
+  return absl::ConsumePrefix(&value, kTopKPrefix) &&
+         strings::safe_strtof(value, fraction) && *fraction > 0 &&
+         *fraction <= 1;
+}
+
+bool EncodeSnappy(const Tensor& tensor, Tensor* encoded) {
+  if (!DataTypeCanUseMemcpy(tensor.dtype())) return false;
+  StringPiece data = tensor.tensor_data();
+  std::string compressed;
+  if (!port::Snappy_Compress(data.data(), data.size(), &compressed) ||
+      compressed.size() >= data.size()) {
+    return false;
+  }
+  Tensor t(DT_UINT8, TensorShape({static_cast<int64>(compressed.size())}));
+  memcpy(t.flat<uint8>().data(), compressed.data(), compressed.size());
+  *encoded = std::move(t);
+  return true;
+}
+
+template <typename T>
+bool EncodeDowncast(const Tensor& tensor, Tensor* encoded) {
+  if (tensor.dtype() != DT_FLOAT) return false;
+  Tensor t(DataTypeToEnum<T>::value, tensor.shape());
+  t.flat<T>() = tensor.flat<float>().template cast<T>();
+  *encoded = std::move(t);
+  return true;
+}
+
+// Orders NaNs before all other values, so that they are kept.
+float Magnitude(float value) {
+  return std::isnan(value) ? std::numeric_limits<float>::infinity()
+                           : std::abs(value);
+}
+
+// The encoded tensor holds the int32 indices of the `k` elements kept, in
+// increasing order, followed by their float values.
+bool EncodeTopK(float fraction, const Tensor& tensor, Tensor* encoded) {
+  if (tensor.dtype() != DT_FLOAT ||
+      tensor.NumElements() > std::numeric_limits<int32>::max()) {
+    return false;
+  }
+  const int64 n = tensor.NumElements();
+  const int64 k = std::max<int64>(1, std::ceil(fraction * n));
+  // Each element kept takes the bytes of an index and a value.
+  if (2 * k >= n) return false;
+
+  auto values = tensor.flat<float>();
+  std::vector<int32> indices(n);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::nth_element(indices.begin(), indices.begin() + k, indices.end(),
+                   [&values](int32 a, int32 b) {
+                     return Magnitude(values(a)) > Magnitude(values(b));
+                   });
+  std::sort(indices.begin(), indices.begin() + k);
+
+  Tensor t(DT_UINT8, TensorShape({k * static_cast<int64>(sizeof(int32) +
+                                                         sizeof(float))}));
+  int32* kept_indices = reinterpret_cast<int32*>(t.flat<uint8>().data());
+  float* kept_values = reinterpret_cast<float*>(kept_indices + k);
+  for (int64 i = 0; i < k; ++i) {
+    kept_indices[i] = indices[i];
+    kept_values[i] = values(indices[i]);
+  }
+  *encoded = std::move(t);
+  return true;
+}
+
+Status CorruptEncoding(const TensorTransferEncoding& encoding,
+                       const Tensor& encoded) {
+  return errors::DataLoss("Cannot decode ", encoded.DebugString(),
+                          " with transfer encoding ",
+                          encoding.ShortDebugString());
+}
+
+}  // namespace
+
+Status ValidateTransferCodec(const std::string& codec) {
+  float fraction;
+  if (codec == kSnappy || codec == kBfloat16 || codec == kFloat16 ||
+      ParseTopKFraction(codec, &fraction)) {
+    return Status::OK();
+  }
+  return errors::InvalidArgument(
+      "Unknown transfer codec \"", codec,
+      "\". Expected snappy, bfloat16, float16 or topk:<fraction> with a "
+      "fraction in (0, 1].");
+}
+
+bool EncodeTensorForTransfer(const std::string& codec, const Tensor& tensor,
+                             Tensor* encoded,
+                             TensorTransferEncoding* encoding) {
+  if (tensor.NumElements() == 0) return false;
+  const uint64 start_us = Env::Default()->NowMicros();
+  Tensor t;
+  float fraction;
+  bool applied = false;
+  if (codec == kSnappy) {
+    applied = EncodeSnappy(tensor, &t);
+  } else if (codec == kBfloat16) {
+    applied = EncodeDowncast<bfloat16>(tensor, &t);
+  } else if (codec == kFloat16) {
+    applied = EncodeDowncast<Eigen::half>(tensor, &t);
+  } else if (ParseTopKFraction(codec, &fraction)) {
+    applied = EncodeTopK(fraction, tensor, &t);
+  }
+  if (!applied) return false;
+  metrics::RecordTransferCodecEncode(codec, tensor.TotalBytes(),
+                                     t.TotalBytes(),
+                                     Env::Default()->NowMicros() - start_us);
+  encoding->set_codec(codec);
+  encoding->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(encoding->mutable_shape());
+  *encoded = std::move(t);
+  return true;
+}
+
+Status DecodeTransferredTensor(const TensorTransferEncoding& encoding,
+                               const Tensor& encoded, Allocator* allocator,
+                               Tensor* tensor) {
+  const uint64 start_us = Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(TensorShape::IsValidShape(encoding.shape()));
+  const TensorShape shape(encoding.shape());
+  const std::string& codec = encoding.codec();
+  float fraction;
+  Tensor t;
+  if (codec == kSnappy) {
+    if (!DataTypeCanUseMemcpy(encoding.dtype()) ||
+        encoded.dtype() != DT_UINT8) {
+      return CorruptEncoding(encoding, encoded);
+    }
+    t = Tensor(allocator, encoding.dtype(), shape);
+    StringPiece in = encoded.tensor_data();
+    StringPiece out = t.tensor_data();
+    size_t length;
+    if (!port::Snappy_GetUncompressedLength(in.data(), in.size(), &length) ||
+        length != out.size() ||
+        !port::Snappy_Uncompress(in.data(), in.size(),
+                                 const_cast<char*>(out.data()))) {
+      return CorruptEncoding(encoding, encoded);
+    }
+  } else if (codec == kBfloat16 || codec == kFloat16) {
+    if (encoding.dtype() != DT_FLOAT || encoded.shape() != shape ||
+        encoded.dtype() != (codec == kBfloat16 ? DT_BFLOAT16 : DT_HALF)) {
+      return CorruptEncoding(encoding, encoded);
+    }
+    t = Tensor(allocator, DT_FLOAT, shape);
+    if (codec == kBfloat16) {
+      t.flat<float>() = encoded.flat<bfloat16>().cast<float>();
+    } else {
+      t.flat<float>() = encoded.flat<Eigen::half>().cast<float>();
+    }
+  } else if (ParseTopKFraction(codec, &fraction)) {
+    const int64 element_bytes = sizeof(int32) + sizeof(float);
+    if (encoding.dtype() != DT_FLOAT || encoded.dtype() != DT_UINT8 ||
+        encoded.NumElements() % element_bytes != 0) {
+      return CorruptEncoding(encoding, encoded);
+    }
+    t = Tensor(allocator, DT_FLOAT, shape);
+    auto values = t.flat<float>();
+    values.setZero();
+    const int64 k = encoded.NumElements() / element_bytes;
+    const int32* kept_indices =
+        reinterpret_cast<const int32*>(encoded.flat<uint8>().data());
+    const float* kept_values = reinterpret_cast<const float*>(kept_indices + k);
+    for (int64 i = 0; i < k; ++i) {
+      if (kept_indices[i] < 0 || kept_indices[i] >= values.size()) {
+        return CorruptEncoding(encoding, encoded);
+      }
+      values(kept_indices[i]) = kept_values[i];
+    }
+  } else {
+    return ValidateTransferCodec(codec);
+  }
+  metrics::RecordTransferCodecDecode(codec,
+                                     Env::Default()->NowMicros() - start_us);
+  *tensor = std::move(t);
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSFER_CODEC_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSFER_CODEC_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Transfer codecs trade CPU time on the sender and the receiver of a tensor
+// for fewer bytes on the wire between them. A receiver asks for one with
+// RecvTensorRequest.transfer_codec, taken from the `_transfer_codec`
+// attribute of the node that produces the tensor, and the sender reports the
+// encoding it applied in RecvTensorResponse.transfer_encoding. Tensors are
+// decoded in host memory, so receivers only ask for codecs when they receive
+// the tensor there.
+//
+// The codecs are:
+//
+// * "snappy": lossless compression of the content of memcpy-able tensors.
+// * "bfloat16", "float16": float tensors are sent in half the bytes, with
+//   the precision of the respective type.
+// * "topk:<fraction>": only the given fraction of the elements of float
+//   tensors with the largest magnitudes is sent, and the others are received
+//   as zeros. Meant for gradients that tolerate sparsification.
+//
+// Tensors that a codec does not apply to or does not make smaller are sent
+// as they are. The bytes saved and the time spent encoding and decoding are
+// recorded in the /tensorflow/core/transfer_codec_* metrics.
+
+// Returns an error if `codec` is not one of the codecs above.
+Status ValidateTransferCodec(const std::string& codec);
+
+// Encodes `tensor` with `codec` into *encoded, and describes the encoding in
+// *encoding. Returns false, leaving both unchanged, if the codec does not
+// apply to `tensor` or does not make it smaller.
+bool EncodeTensorForTransfer(const std::string& codec, const Tensor& tensor,
+                             Tensor* encoded,
+                             TensorTransferEncoding* encoding);
+
+// Decodes `encoded`, as described by `encoding`, into *tensor allocated with
+// `allocator`.
+Status DecodeTransferredTensor(const TensorTransferEncoding& encoding,
+                               const Tensor& encoded, Allocator* allocator,
+                               Tensor* tensor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSFER_CODEC_H_
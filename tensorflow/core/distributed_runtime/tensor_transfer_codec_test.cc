@@ -0,0 +1,142 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_transfer_codec.h"
+
+#include <cstdio>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor RoundTrip(const std::string& codec, const Tensor& tensor) {
+  Tensor encoded;
+  TensorTransferEncoding encoding;
+  EXPECT_TRUE(EncodeTensorForTransfer(codec, tensor, &encoded, &encoding));
+  EXPECT_EQ(encoding.codec(), codec);
+  EXPECT_LT(encoded.TotalBytes(), tensor.TotalBytes());
+  Tensor decoded;
+  TF_EXPECT_OK(DecodeTransferredTensor(encoding, encoded, cpu_allocator(),
+                                       &decoded));
+  return decoded;
+}
+
+TEST(TensorTransferCodecTest, Validate) {
+  TF_EXPECT_OK(ValidateTransferCodec("snappy"));
+  TF_EXPECT_OK(ValidateTransferCodec("bfloat16"));
+  TF_EXPECT_OK(ValidateTransferCodec("float16"));
+  TF_EXPECT_OK(ValidateTransferCodec("topk:0.01"));
+  TF_EXPECT_OK(ValidateTransferCodec("topk:1"));
+  EXPECT_TRUE(errors::IsInvalidArgument(ValidateTransferCodec("lz4")));
+  EXPECT_TRUE(errors::IsInvalidArgument(ValidateTransferCodec("topk:0")));
+  EXPECT_TRUE(errors::IsInvalidArgument(ValidateTransferCodec("topk:1.5")));
+  EXPECT_TRUE(errors::IsInvalidArgument(ValidateTransferCodec("topk:")));
+}
+
+bool SnappyCompressionSupported() {
+  string out;
+  StringPiece in = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+  return port::Snappy_Compress(in.data(), in.size(), &out);
+}
+
+TEST(TensorTransferCodecTest, Snappy) {
+  if (!SnappyCompressionSupported()) {
+    fprintf(stderr, "Snappy disabled. Skipping test\n");
+    return;
+  }
+  Tensor tensor(DT_INT64, TensorShape({64, 64}));
+  for (int i = 0; i < tensor.NumElements(); ++i) {
+    tensor.flat<int64>()(i) = i % 7;
+  }
+  test::ExpectTensorEqual<int64>(RoundTrip("snappy", tensor), tensor);
+}
+
+TEST(TensorTransferCodecTest, SnappyDeclinesIncompressible) {
+  Tensor tensor(DT_UINT8, TensorShape({4096}));
+  uint32 state = 1;
+  for (int i = 0; i < tensor.NumElements(); ++i) {
+    state = state * 1664525 + 1013904223;
+    tensor.flat<uint8>()(i) = state >> 24;
+  }
+  Tensor encoded;
+  TensorTransferEncoding encoding;
+  EXPECT_FALSE(EncodeTensorForTransfer("snappy", tensor, &encoded, &encoding));
+  EXPECT_FALSE(encoding.has_shape());
+}
+
+TEST(TensorTransferCodecTest, Downcast) {
+  Tensor tensor = test::AsTensor<float>({1.0, -2.5, 0.0, 1024.0},
+                                        TensorShape({2, 2}));
+  test::ExpectTensorEqual<float>(RoundTrip("bfloat16", tensor), tensor);
+  test::ExpectTensorEqual<float>(RoundTrip("float16", tensor), tensor);
+
+  Tensor precise = test::AsTensor<float>({1.001, 3.14159});
+  test::ExpectTensorNear<float>(RoundTrip("bfloat16", precise), precise, 1e-2);
+  test::ExpectTensorNear<float>(RoundTrip("float16", precise), precise, 2e-3);
+}
+
+TEST(TensorTransferCodecTest, DowncastDeclinesOtherTypes) {
+  Tensor encoded;
+  TensorTransferEncoding encoding;
+  EXPECT_FALSE(EncodeTensorForTransfer(
+      "bfloat16", test::AsTensor<int32>({1, 2, 3}), &encoded, &encoding));
+  EXPECT_FALSE(EncodeTensorForTransfer(
+      "float16", test::AsTensor<double>({1, 2, 3}), &encoded, &encoding));
+}
+
+TEST(TensorTransferCodecTest, TopK) {
+  Tensor tensor(DT_FLOAT, TensorShape({10, 10}));
+  tensor.flat<float>().setConstant(0.5);
+  tensor.flat<float>()(3) = -7;
+  tensor.flat<float>()(42) = 9;
+  tensor.flat<float>()(99) = 8;
+
+  Tensor expected(DT_FLOAT, TensorShape({10, 10}));
+  expected.flat<float>().setZero();
+  expected.flat<float>()(3) = -7;
+  expected.flat<float>()(42) = 9;
+  expected.flat<float>()(99) = 8;
+  test::ExpectTensorEqual<float>(RoundTrip("topk:0.025", tensor), expected);
+}
+
+TEST(TensorTransferCodecTest, TopKDeclinesLargeFractions) {
+  Tensor encoded;
+  TensorTransferEncoding encoding;
+  EXPECT_FALSE(EncodeTensorForTransfer(
+      "topk:0.5", test::AsTensor<float>({1, 2, 3, 4}), &encoded, &encoding));
+}
+
+TEST(TensorTransferCodecTest, CorruptEncoding) {
+  Tensor tensor = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor encoded;
+  TensorTransferEncoding encoding;
+  ASSERT_TRUE(
+      EncodeTensorForTransfer("bfloat16", tensor, &encoded, &encoding));
+  encoding.set_codec("float16");
+  Tensor decoded;
+  EXPECT_TRUE(errors::IsDataLoss(DecodeTransferredTensor(
+      encoding, encoded, cpu_allocator(), &decoded)));
+  encoding.set_codec("lz4");
+  EXPECT_TRUE(errors::IsInvalidArgument(DecodeTransferredTensor(
+      encoding, encoded, cpu_allocator(), &decoded)));
+}
+
+}  // namespace
+}  // namespace tensorflow
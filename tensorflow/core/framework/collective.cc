@@ -57,6 +57,9 @@ string CollGroupParams::ToString() const {
   string v = strings::StrCat(
       "CollGroupParams {group_key=", group_key, " group_size=", group_size,
       " device_type=", device_type.type_string(), " num_tasks=", num_tasks,
+      " halving_doubling_max_bytes=", halving_doubling_max_bytes,
+      " fusion_threshold_bytes=", fusion_threshold_bytes,
+      " fusion_timeout_micros=", fusion_timeout_micros,
       " runtime_details=", runtime_details.ToString(), " devices {");
   for (const auto& d : device_names) {
     strings::StrAppend(&v, d, ",");
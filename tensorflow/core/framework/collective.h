@@ -75,6 +75,15 @@ struct CollGroupParams {
   // GPUs.  Assumes same GPU configuration at each worker.
   string gpu_ring_order = "";
   int32 num_tasks;  // number of distinct tasks in group
+  // All-reduces of up to this many bytes use HalvingDoublingReduce where
+  // possible. Taken from the ConfigProto of the group leader, so that every
+  // member picks the same implementation.
+  int64 halving_doubling_max_bytes = 0;
+  // Reductions of up to this many bytes are fused, waiting at most
+  // fusion_timeout_micros for other reductions to join them. Also taken from
+  // the ConfigProto of the group leader, since every member must fuse alike.
+  int64 fusion_threshold_bytes = 0;
+  int64 fusion_timeout_micros = 0;
   CollGroupRuntimeDetails runtime_details;
   string ToString() const;
   CollGroupParams()
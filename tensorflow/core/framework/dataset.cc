@@ -539,6 +539,9 @@ string DatasetBaseIterator::BuildTraceMeName() {
   if (parent_) {
     strings::StrAppend(&result, ",parent_id=", parent_id_);
   }
+  if (node_ && node_->buffered_bytes() > 0) {
+    strings::StrAppend(&result, ",buffered_bytes=", node_->buffered_bytes());
+  }
 
   TraceMeMetadata metadata = GetTraceMeMetadata();
   for (const auto& pair : metadata) {
@@ -1030,6 +1030,47 @@ class DatasetBaseIterator : public IteratorBase {
     }
   }
 
+  // Like `RecordBufferDequeue()`, for a buffer of elements produced ahead of
+  // their consumer, which `ShouldThrottleBuffer()` can keep small. Only such
+  // buffers are charged to the memory budget of the input pipeline: caches,
+  // shuffle buffers and windows cannot shrink, so they would use up the
+  // budget for good.
+  void RecordProducerBufferDequeue(IteratorContext* ctx,
+                                   const std::vector<Tensor>& element) {
+    RecordProducerBufferEvent(ctx, element, -1);
+  }
+
+  // Like `RecordBufferEnqueue()`, for a buffer of elements produced ahead of
+  // their consumer.
+  void RecordProducerBufferEnqueue(IteratorContext* ctx,
+                                   const std::vector<Tensor>& element) {
+    RecordProducerBufferEvent(ctx, element, 1);
+  }
+
+  // When modeling is enabled, this method returns whether this iterator should
+  // hold off adding to a buffer that holds `buffered_elements` elements,
+  // because the buffers of the input pipeline hold as many bytes as its memory
+  // budget allows.
+  bool ShouldThrottleBuffer(IteratorContext* ctx, int64 buffered_elements) {
+    auto model = ctx->model();
+    return model && node_ &&
+           model->memory_arbiter()->ShouldThrottle(buffered_elements);
+  }
+
+  // Waits on `cond_var` for room in a buffer of this iterator that holds
+  // `buffered_elements` elements. Bytes freed by other iterators do not notify
+  // `cond_var`, so while the memory budget holds this iterator off, the wait
+  // also ends periodically.
+  void WaitForBufferSpace(IteratorContext* ctx, int64 buffered_elements,
+                          condition_variable* cond_var, mutex_lock* l) {
+    if (ShouldThrottleBuffer(ctx, buffered_elements)) {
+      cond_var->wait_for(
+          *l, std::chrono::milliseconds(model::kMemoryBudgetPollIntervalMs));
+    } else {
+      cond_var->wait(*l);
+    }
+  }
+
   // When modeling is enabled, this method records the fact that this iterator
   // has produced an element and its size in bytes.
   void RecordElement(IteratorContext* ctx, std::vector<Tensor>* out_tensors) {
@@ -1067,6 +1108,22 @@ class DatasetBaseIterator : public IteratorBase {
     return model && model->collect_resource_usage() && node_;
   }
 
+  void RecordProducerBufferEvent(IteratorContext* ctx,
+                                 const std::vector<Tensor>& element,
+                                 int64 elements_delta) {
+    auto model = ctx->model();
+    if (!model || !node_) return;
+    model::MemoryArbiter* arbiter = model->memory_arbiter();
+    const bool arbitrated = arbiter->budget_bytes() > 0;
+    if (!arbitrated && !model->collect_resource_usage()) return;
+    const int64 bytes_delta = elements_delta * GetAllocatedBytes(element);
+    node_->record_buffer_event(bytes_delta, elements_delta);
+    if (arbitrated) {
+      node_->record_arbitrated_bytes(bytes_delta);
+      arbiter->record_buffered_bytes(bytes_delta);
+    }
+  }
+
   BaseParams params_;
 };
 
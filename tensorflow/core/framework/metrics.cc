@@ -48,6 +48,13 @@ auto* graph_pending_queue_length_histogram = monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* run_handler_latency_usecs_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler_latency_usecs",
+     "The wall-clock time requests held a RunHandler in microseconds.",
+     "policy"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* graph_run_input_tensor_bytes = monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -64,6 +71,31 @@ auto* graph_unused_outputs = monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* transfer_codec_bytes = monitoring::Counter<2>::New(
+    "/tensorflow/core/transfer_codec_bytes",
+    "The size in bytes of the tensors encoded with a transfer codec, before "
+    "and after encoding.",
+    "codec", "stage");
+
+auto* transfer_codec_usecs = monitoring::Counter<2>::New(
+    "/tensorflow/core/transfer_codec_usecs",
+    "The time in microseconds spent encoding and decoding tensors with a "
+    "transfer codec.",
+    "codec", "operation");
+
+auto* collective_fusion_instances = monitoring::Counter<0>::New(
+    "/tensorflow/core/collective_fusion_instances",
+    "The number of collectives run as part of a fused collective.");
+
+auto* collective_fusion_bytes = monitoring::Counter<0>::New(
+    "/tensorflow/core/collective_fusion_bytes",
+    "The size in bytes of the collectives run as part of a fused collective.");
+
+auto* collective_fusion_triggers = monitoring::Counter<1>::New(
+    "/tensorflow/core/collective_fusion_triggers",
+    "The number of fused collectives, by what triggered their fusion.",
+    "trigger");
+
 auto* tf_data_autotune_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/autotune", "tf.data autotuning", "name");
 
@@ -101,6 +133,12 @@ auto* tf_data_get_next_duration_usecs_histogram = monitoring::Sampler<0>::New(
     {monitoring::Buckets::Explicit(
         {2., 4., 8., 16., 32., 64., 128., 256., 512., 1024., 1e6})});
 
+auto* tf_data_file_open_latency_counter = monitoring::Counter<1>::New(
+    "/tensorflow/data/file_open_latency",
+    "The time (in microseconds) spent opening files read by tf.data, hidden "
+    "behind other work or exposed to the reader.",
+    "exposure");
+
 auto* tf_data_iterator_busy_counter =
     monitoring::Counter<0>::New("/tensorflow/data/iterator_busy",
                                 "The time (in microseconds) during which a "
@@ -202,6 +240,15 @@ void RecordTFDataGetNextDuration(uint64 duration_us) {
   tf_data_get_next_duration_cell->Add(duration_us);
 }
 
+void RecordTFDataFileOpenLatency(uint64 hidden_us, uint64 exposed_us) {
+  static auto* hidden_cell =
+      tf_data_file_open_latency_counter->GetCell("hidden");
+  static auto* exposed_cell =
+      tf_data_file_open_latency_counter->GetCell("exposed");
+  hidden_cell->IncrementBy(hidden_us);
+  exposed_cell->IncrementBy(exposed_us);
+}
+
 void RecordTFDataIteratorBusy(uint64 duration_us) {
   static auto* tf_data_iterator_busy_cell =
       tf_data_iterator_busy_counter->GetCell();
@@ -266,6 +313,10 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+void RecordRunHandlerLatency(const string& policy, uint64 latency_usecs) {
+  run_handler_latency_usecs_histogram->GetCell(policy)->Add(latency_usecs);
+}
+
 void UpdateGraphOptimizationPassTime(const string& pass_name,
                                      const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
@@ -319,5 +370,29 @@ void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordTransferCodecEncode(const string& codec, int64 raw_bytes,
+                               int64 encoded_bytes, uint64 encode_usecs) {
+  transfer_codec_bytes->GetCell(codec, "raw")->IncrementBy(raw_bytes);
+  transfer_codec_bytes->GetCell(codec, "encoded")->IncrementBy(encoded_bytes);
+  transfer_codec_usecs->GetCell(codec, "encode")->IncrementBy(encode_usecs);
+}
+
+void RecordTransferCodecDecode(const string& codec, uint64 decode_usecs) {
+  transfer_codec_usecs->GetCell(codec, "decode")->IncrementBy(decode_usecs);
+}
+
+void RecordCollectiveFusion(int64 num_instances, int64 num_bytes) {
+  static auto* collective_fusion_instances_cell =
+      collective_fusion_instances->GetCell();
+  static auto* collective_fusion_bytes_cell =
+      collective_fusion_bytes->GetCell();
+  collective_fusion_instances_cell->IncrementBy(num_instances);
+  collective_fusion_bytes_cell->IncrementBy(num_bytes);
+}
+
+void RecordCollectiveFusionTrigger(const string& trigger) {
+  collective_fusion_triggers->GetCell(trigger)->IncrementBy(1);
+}
+
 }  // namespace metrics
 }  // namespace tensorflow
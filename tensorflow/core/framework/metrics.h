@@ -70,6 +70,11 @@ void RecordTFDataGetNextDuration(uint64 duration_us);
 // created using GraphHash().
 void RecordTFDataFingerprint(const string& name);
 
+// Records the time (in microseconds) tf.data spent opening a file, split into
+// the part hidden behind other work by opening the file ahead of time and the
+// part a reader had to wait for.
+void RecordTFDataFileOpenLatency(uint64 hidden_us, uint64 exposed_us);
+
 // Records the time (in microseconds) during which `IteratorResource` was busy
 // processing at least one `GetNext()` request.
 void RecordTFDataIteratorBusy(uint64 duration_us);
@@ -100,9 +105,29 @@ void RecordGraphOutputTensors(const size_t size);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the time a request scheduled with `policy` held a RunHandler.
+void RecordRunHandlerLatency(const string& policy, uint64 latency_usecs);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records that a tensor of `raw_bytes` bytes was encoded with the transfer
+// codec `codec` into `encoded_bytes` bytes in `encode_usecs`.
+void RecordTransferCodecEncode(const string& codec, int64 raw_bytes,
+                               int64 encoded_bytes, uint64 encode_usecs);
+
+// Records that a tensor encoded with the transfer codec `codec` was decoded
+// in `decode_usecs`.
+void RecordTransferCodecDecode(const string& codec, uint64 decode_usecs);
+
+// Records that `num_instances` collectives of `num_bytes` in total were run as
+// one fused collective on a device.
+void RecordCollectiveFusion(int64 num_instances, int64 num_bytes);
+
+// Records that rank 0 of a group fused the collectives pending on it, because
+// of `trigger` ("bytes", "count" or "timeout").
+void RecordCollectiveFusionTrigger(const string& trigger);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "absl/time/clock.h"
@@ -119,6 +120,48 @@ inline void UpdateStateValues(
   }
 }
 
+// Inverts the `n` x `n` row-major matrix `a` in place using Gauss-Jordan
+// elimination with partial pivoting. Returns false if `a` is singular.
+bool InvertMatrix(int n, std::vector<double>* a) {
+  std::vector<double>& m = *a;
+  std::vector<double> inverse(n * n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    inverse[i * n + i] = 1.0;
+  }
+  for (int col = 0; col < n; ++col) {
+    int pivot = col;
+    for (int row = col + 1; row < n; ++row) {
+      if (std::abs(m[row * n + col]) > std::abs(m[pivot * n + col])) {
+        pivot = row;
+      }
+    }
+    if (std::abs(m[pivot * n + col]) < 1e-12) {
+      return false;
+    }
+    if (pivot != col) {
+      for (int k = 0; k < n; ++k) {
+        std::swap(m[pivot * n + k], m[col * n + k]);
+        std::swap(inverse[pivot * n + k], inverse[col * n + k]);
+      }
+    }
+    const double scale = 1.0 / m[col * n + col];
+    for (int k = 0; k < n; ++k) {
+      m[col * n + k] *= scale;
+      inverse[col * n + k] *= scale;
+    }
+    for (int row = 0; row < n; ++row) {
+      const double factor = m[row * n + col];
+      if (row == col || factor == 0) continue;
+      for (int k = 0; k < n; ++k) {
+        m[row * n + k] -= factor * m[col * n + k];
+        inverse[row * n + k] -= factor * inverse[col * n + k];
+      }
+    }
+  }
+  m = std::move(inverse);
+  return true;
+}
+
 // The first input of InterleaveMany corresponds to the input dataset whose
 // elements are used to create the (derived) input datasets whose elements are
 // interleaved as output.
@@ -1468,6 +1511,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
     case AutotuneAlgorithm::GRADIENT_DESCENT:
       OptimizeGradientDescent(cpu_budget, ram_budget, model_input_time);
       break;
+    case AutotuneAlgorithm::BAYESIAN:
+      OptimizeBayesian(cpu_budget, ram_budget, model_input_time);
+      break;
   }
 }
 
@@ -1477,6 +1523,8 @@ void Model::RemoveNode(std::shared_ptr<Node> node) {
     if (node->output()) {
       node->output()->remove_input(node);
     }
+    // Releases the bytes still held in the buffer of the node.
+    memory_arbiter_.record_buffered_bytes(-node->arbitrated_bytes());
     VLOG(3) << "Removing " << node->long_name();
   }
 }
@@ -1640,6 +1688,198 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
   UpdateStateValues(&parameters);
 }
 
+void Model::OptimizeBayesian(int64 cpu_budget, int64 ram_budget,
+                             double model_input_time) {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock lock(mu_);
+    snapshot = output_->Snapshot();
+  }
+  VLOG(2) << "Starting optimization of tunable parameters with Bayesian";
+  auto parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    return;
+  }
+  mutex_lock l(observations_mu_);
+  RecordObservation(snapshot);
+
+  // Prior precision of the regression weights and precision of the observed
+  // output times, both relative to the output time of the current values.
+  constexpr double kPriorPrecision = 1.0L;
+  constexpr double kNoisePrecision = 100.0L;
+  // Weight of the standard deviation in the lower confidence bound.
+  constexpr double kExplorationWeight = 0.5L;
+  // Maximum number of parameter steps taken per invocation.
+  constexpr int kMaxSteps = 16;
+
+  std::vector<string> keys;
+  keys.reserve(parameters.size());
+  for (auto& pair : parameters) {
+    keys.push_back(pair.first);
+  }
+  std::sort(keys.begin(), keys.end());
+  auto set_values = [&](const absl::flat_hash_map<string, double>& values) {
+    for (const auto& key : keys) {
+      Parameter* parameter = parameters[key].get();
+      auto* value = gtl::FindOrNull(values, key);
+      parameter->value =
+          value ? std::min(std::max(*value, parameter->min), parameter->max)
+                : parameter->min;
+    }
+  };
+  auto total_parallelism = [&]() {
+    double result = 0;
+    for (const auto& key : keys) {
+      if (parameters[key]->name == kParallelism) {
+        result += parameters[key]->value;
+      }
+    }
+    return result;
+  };
+
+  absl::flat_hash_map<string, double> current;
+  absl::flat_hash_map<string, double> minimum;
+  for (const auto& key : keys) {
+    current[key] = parameters[key]->value;
+    minimum[key] = parameters[key]->min;
+  }
+  // If the current values exceed a budget, the search starts over from the
+  // minimum values, and only needs to stay within the resources they use.
+  set_values(minimum);
+  const double max_parallelism =
+      std::max(static_cast<double>(cpu_budget), total_parallelism());
+  const double max_buffered_bytes = std::max(
+      static_cast<double>(ram_budget), TotalMaximumBufferedBytes(snapshot));
+  auto feasible = [&]() {
+    return total_parallelism() <= max_parallelism &&
+           TotalMaximumBufferedBytes(snapshot) <= max_buffered_bytes;
+  };
+  set_values(current);
+  if (!feasible()) {
+    current = minimum;
+    set_values(current);
+  }
+
+  // Features of the parameter values currently set: a bias, the analytical
+  // output time, and the inverse of each parameter value.
+  double scale = OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  if (scale <= 0) {
+    scale = 1.0;
+  }
+  const int num_features = keys.size() + 2;
+  std::vector<double> features(num_features);
+  auto compute_features = [&]() {
+    features[0] = 1.0;
+    features[1] =
+        OutputTime(snapshot, model_input_time, /*gradients=*/nullptr) / scale;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      features[i + 2] = 1.0 / (1.0 + parameters[keys[i]]->value);
+    }
+  };
+
+  // The posterior of the weights given the observations is normal, with
+  // covariance `(a)^-1` and mean `(a)^-1 * b`. The prior mean predicts the
+  // analytical output time.
+  std::vector<double> a(num_features * num_features, 0.0);
+  std::vector<double> b(num_features, 0.0);
+  for (int i = 0; i < num_features; ++i) {
+    a[i * num_features + i] = kPriorPrecision;
+  }
+  b[1] = kPriorPrecision;
+  for (const auto& observation : observations_) {
+    set_values(observation.parameter_values);
+    compute_features();
+    const double y = observation.output_time / scale;
+    for (int i = 0; i < num_features; ++i) {
+      b[i] += kNoisePrecision * features[i] * y;
+      for (int j = 0; j < num_features; ++j) {
+        a[i * num_features + j] += kNoisePrecision * features[i] * features[j];
+      }
+    }
+  }
+  if (!InvertMatrix(num_features, &a)) {
+    VLOG(2) << "Failed to fit the observed output times. The optimization "
+               "attempt will be aborted.";
+    return;
+  }
+  std::vector<double> weights(num_features, 0.0);
+  for (int i = 0; i < num_features; ++i) {
+    for (int j = 0; j < num_features; ++j) {
+      weights[i] += a[i * num_features + j] * b[j];
+    }
+  }
+  // Lower confidence bound of the output time of the values currently set.
+  auto score = [&]() {
+    compute_features();
+    double mean = 0;
+    double variance = 1.0 / kNoisePrecision;
+    for (int i = 0; i < num_features; ++i) {
+      mean += weights[i] * features[i];
+      for (int j = 0; j < num_features; ++j) {
+        variance += features[i] * a[i * num_features + j] * features[j];
+      }
+    }
+    return mean - kExplorationWeight * std::sqrt(std::max(variance, 0.0));
+  };
+
+  set_values(current);
+  double best_score = score();
+  for (int step = 0; step < kMaxSteps; ++step) {
+    absl::flat_hash_map<string, double> best = current;
+    for (const auto& key : keys) {
+      const Parameter& parameter = *parameters[key];
+      const double value = current[key];
+      for (double new_value : {value + 1, value - 1, value * 2,
+                               std::floor(value / 2)}) {
+        if (new_value < parameter.min || new_value > parameter.max ||
+            new_value == value) {
+          continue;
+        }
+        absl::flat_hash_map<string, double> candidate = current;
+        candidate[key] = new_value;
+        set_values(candidate);
+        if (!feasible()) {
+          continue;
+        }
+        const double candidate_score = score();
+        if (candidate_score < best_score) {
+          best_score = candidate_score;
+          best = std::move(candidate);
+        }
+      }
+    }
+    if (best == current) {
+      break;
+    }
+    current = std::move(best);
+  }
+
+  set_values(current);
+  applied_values_ = current;
+  UpdateStateValues(&parameters);
+}
+
+void Model::RecordObservation(std::shared_ptr<Node> snapshot) {
+  // Maximum number of observations kept for the regression.
+  constexpr size_t kMaxObservations = 64;
+
+  const int64 now_us = env_->NowMicros();
+  const int64 num_elements = snapshot->num_elements();
+  if (!applied_values_.empty() && now_us > last_observation_time_us_ &&
+      num_elements > last_observation_num_elements_) {
+    observations_.push_back(
+        {applied_values_,
+         EnvTime::kMicrosToNanos *
+             static_cast<double>(now_us - last_observation_time_us_) /
+             (num_elements - last_observation_num_elements_)});
+    if (observations_.size() > kMaxObservations) {
+      observations_.pop_front();
+    }
+  }
+  last_observation_time_us_ = now_us;
+  last_observation_num_elements_ = num_elements;
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          absl::flat_hash_map<string, double>* gradients) {
   // To store the input time for each node.
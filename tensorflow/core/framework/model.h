@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
+#include <deque>
 #include <list>
 #include <memory>
 #include <string>
@@ -45,9 +46,14 @@ constexpr char kBufferSize[] = "buffer_size";
 // A key used to identify the input time of the model.
 constexpr char kModelInputTimeKey[] = "model_input_time";
 
+// How often producers held off by a `MemoryArbiter` check whether the budget
+// has been freed up.
+constexpr int64 kMemoryBudgetPollIntervalMs = 10;
+
 enum class AutotuneAlgorithm {
   HILL_CLIMB = 0,
   GRADIENT_DESCENT = 1,
+  BAYESIAN = 2,
 };
 
 enum class TraversalOrder {
@@ -148,6 +154,7 @@ class Node {
         name_(std::move(args.name)),
         autotune_(true),
         buffered_bytes_(0),
+        arbitrated_bytes_(0),
         buffered_elements_(0),
         bytes_consumed_(0),
         bytes_produced_(0),
@@ -204,6 +211,12 @@ class Node {
     return buffered_bytes_;
   }
 
+  // Returns the number of bytes stored in this node's buffer that are charged
+  // to the memory arbiter of the model.
+  int64 arbitrated_bytes() const TF_LOCKS_EXCLUDED(mu_) {
+    return arbitrated_bytes_;
+  }
+
   // Returns the number of elements stored in this node's buffer.
   int64 buffered_elements() const TF_LOCKS_EXCLUDED(mu_) {
     return buffered_elements_;
@@ -274,6 +287,12 @@ class Node {
     buffered_elements_ += elements_delta;
   }
 
+  // Records the change in the bytes of this node's buffer that are charged to
+  // the memory arbiter of the model.
+  void record_arbitrated_bytes(int64 bytes_delta) {
+    arbitrated_bytes_ += bytes_delta;
+  }
+
   // Records that the node produced an element.
   void record_element() TF_LOCKS_EXCLUDED(mu_) {
     num_elements_++;
@@ -549,6 +568,7 @@ class Node {
   // from computation of output time and processing time.
   std::atomic<bool> autotune_;
   std::atomic<int64> buffered_bytes_;
+  std::atomic<int64> arbitrated_bytes_;
   std::atomic<int64> buffered_elements_;
   std::atomic<int64> bytes_consumed_;
   std::atomic<int64> bytes_produced_;
@@ -605,6 +625,48 @@ std::shared_ptr<Node> MakeUnknownRatioNode(Node::Args args);
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// Tracks the bytes held in the buffers of all iterators of an input pipeline
+// against a budget shared by all of them, so that producers can hold off
+// filling their buffers while the budget is exhausted.
+//
+// MemoryArbiter is thread-safe.
+class MemoryArbiter {
+ public:
+  // Sets the budget in bytes. A budget of 0 means no budget.
+  void set_budget_bytes(int64 budget_bytes) { budget_bytes_ = budget_bytes; }
+
+  int64 budget_bytes() const { return budget_bytes_; }
+
+  // Returns the bytes currently held in buffers.
+  int64 buffered_bytes() const { return buffered_bytes_; }
+
+  // Returns the maximum of `buffered_bytes()` so far.
+  int64 peak_buffered_bytes() const { return peak_buffered_bytes_; }
+
+  // Records that the bytes held in buffers changed by `bytes_delta`.
+  void record_buffered_bytes(int64 bytes_delta) {
+    const int64 buffered_bytes = buffered_bytes_ += bytes_delta;
+    int64 peak = peak_buffered_bytes_;
+    while (buffered_bytes > peak &&
+           !peak_buffered_bytes_.compare_exchange_weak(peak, buffered_bytes)) {
+    }
+  }
+
+  // Returns whether a producer should hold off adding to a buffer that holds
+  // `buffered_elements` elements. Empty buffers are never held off, so that
+  // their consumers keep making progress.
+  bool ShouldThrottle(int64 buffered_elements) const {
+    const int64 budget_bytes = budget_bytes_;
+    return buffered_elements > 0 && budget_bytes > 0 &&
+           buffered_bytes_ >= budget_bytes;
+  }
+
+ private:
+  std::atomic<int64> budget_bytes_{0};
+  std::atomic<int64> buffered_bytes_{0};
+  std::atomic<int64> peak_buffered_bytes_{0};
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -618,7 +680,11 @@ std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 class Model {
  public:
   // Creates a new model.
-  Model() : collect_resource_usage_(false) {}
+  Model() : Model(Env::Default()) {}
+
+  // Creates a new model that reads the time from `env`, which is used to
+  // measure the throughput of the input pipeline.
+  explicit Model(Env* env) : env_(env), collect_resource_usage_(false) {}
 
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
@@ -638,6 +704,9 @@ class Model {
   // Removes the given node.
   void RemoveNode(std::shared_ptr<Node> node) TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the arbiter of the memory held in the buffers of the nodes.
+  MemoryArbiter* memory_arbiter() { return &memory_arbiter_; }
+
  private:
   // Collects tunable parameters in the tree rooted in the given node, returning
   // a mapping from a (unique) node name to a tunable parameter.
@@ -675,6 +744,21 @@ class Model {
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
                                double model_input_time);
 
+  // This optimization algorithm fits the output time observed for the
+  // parameter values it chose in previous invocations, using Bayesian linear
+  // regression with the analytical `OutputTime` as a prior. It then moves the
+  // parameters from their current values, one step at a time, to the values
+  // that minimize a lower confidence bound of the predicted output time, while
+  // keeping the total parallelism within the CPU budget and the maximum
+  // buffered bytes within the RAM budget.
+  void OptimizeBayesian(int64 cpu_budget, int64 ram_budget,
+                        double model_input_time);
+
+  // Records the output time observed since the last invocation of
+  // `OptimizeBayesian` for the parameter values it chose then.
+  void RecordObservation(std::shared_ptr<Node> snapshot)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(observations_mu_);
+
   // Collects the output time and if `gradients` is not `nullptr`, the output
   // time gradient w.r.t. tunable parameters of the subtree rooted in the given
   // node.
@@ -694,6 +778,14 @@ class Model {
   // buffers were full.
   double TotalMaximumBufferedBytes(std::shared_ptr<Node> node);
 
+  // The output time observed for a set of parameter values.
+  struct Observation {
+    absl::flat_hash_map<string, double> parameter_values;
+    double output_time;
+  };
+
+  Env* const env_;
+
   // Used for coordination between different input pipeline threads. Exclusive
   // access is required only when adding or removing nodes. Concurrent access to
   // existing nodes is protected by a node mutex.
@@ -708,6 +800,17 @@ class Model {
   // tunable parameter (because the information is used for tuning the value of
   // the parameter) and never stops.
   std::atomic<bool> collect_resource_usage_;
+
+  MemoryArbiter memory_arbiter_;
+
+  // State of `OptimizeBayesian`.
+  mutex observations_mu_;
+  std::deque<Observation> observations_ TF_GUARDED_BY(observations_mu_);
+  // The parameter values chosen by the last invocation.
+  absl::flat_hash_map<string, double> applied_values_
+      TF_GUARDED_BY(observations_mu_);
+  int64 last_observation_time_us_ TF_GUARDED_BY(observations_mu_) = 0;
+  int64 last_observation_num_elements_ TF_GUARDED_BY(observations_mu_) = 0;
 };
 
 }  // namespace model
@@ -947,7 +947,195 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1));
+                         ::testing::Values(0, 1, 2));
+
+TEST(MemoryArbiterTest, Model) {
+  MemoryArbiter arbiter;
+  arbiter.record_buffered_bytes(100);
+  // Without a budget producers are never held off.
+  EXPECT_FALSE(arbiter.ShouldThrottle(1));
+
+  arbiter.set_budget_bytes(150);
+  EXPECT_FALSE(arbiter.ShouldThrottle(1));
+  arbiter.record_buffered_bytes(50);
+  EXPECT_TRUE(arbiter.ShouldThrottle(1));
+  // Empty buffers are always filled.
+  EXPECT_FALSE(arbiter.ShouldThrottle(0));
+
+  arbiter.record_buffered_bytes(-120);
+  EXPECT_FALSE(arbiter.ShouldThrottle(1));
+  EXPECT_EQ(arbiter.buffered_bytes(), 30);
+  EXPECT_EQ(arbiter.peak_buffered_bytes(), 150);
+}
+
+TEST(MemoryArbiterTest, RemoveNodeReleasesBufferedBytes) {
+  Model model;
+  std::shared_ptr<Node> prefetch;
+  std::shared_ptr<Node> map;
+  model.AddNode(
+      [](Node::Args args) { return MakeAsyncKnownRatioNode(args, 1, {}); },
+      "prefetch", nullptr, &prefetch);
+  model.AddNode(
+      [](Node::Args args) { return MakeAsyncKnownRatioNode(args, 1, {}); },
+      "map", prefetch, &map);
+  std::shared_ptr<Node> cache;
+  model.AddNode([](Node::Args args) { return MakeKnownRatioNode(args, 1); },
+                "cache", map, &cache);
+  prefetch->record_buffer_event(100, 1);
+  prefetch->record_arbitrated_bytes(100);
+  map->record_buffer_event(40, 2);
+  map->record_arbitrated_bytes(40);
+  model.memory_arbiter()->record_buffered_bytes(140);
+  // Bytes that are not charged to the arbiter are not released from it.
+  cache->record_buffer_event(1000, 10);
+
+  model.RemoveNode(cache);
+  EXPECT_EQ(model.memory_arbiter()->buffered_bytes(), 140);
+  model.RemoveNode(map);
+  EXPECT_EQ(model.memory_arbiter()->buffered_bytes(), 100);
+  EXPECT_EQ(model.memory_arbiter()->peak_buffered_bytes(), 140);
+}
+
+// Env whose clock only advances when told to.
+class FakeClockEnv : public EnvWrapper {
+ public:
+  FakeClockEnv() : EnvWrapper(Env::Default()) {}
+
+  uint64 NowMicros() const override { return now_us_; }
+
+  void AdvanceByMicros(uint64 delta) { now_us_ += delta; }
+
+ private:
+  uint64 now_us_ = 1;
+};
+
+// A recorded pipeline: a source feeding two parallel maps and a prefetch,
+// with the per element processing time of each stage in nanoseconds.
+struct RecordedPipeline {
+  int64 source_nsec;
+  int64 map1_nsec;
+  int64 map2_nsec;
+  int64 element_bytes;
+  int64 cores;
+  int64 ram_budget;
+};
+
+// Replays a recorded pipeline against `algorithm`: each round the model is
+// optimized, and the pipeline then produces elements at the rate that the
+// chosen parameter values would have delivered on `cores` cores. Returns the
+// throughput of every round in elements per second; the first entry is the
+// throughput of the initial parameter values.
+std::vector<double> ReplayPipeline(AutotuneAlgorithm algorithm,
+                                   const RecordedPipeline& pipeline,
+                                   int rounds) {
+  constexpr int64 kElementsPerRound = 1000;
+  FakeClockEnv env;
+  auto make_state = [](int64 value) {
+    return std::make_shared<SharedState>(
+        value, std::make_shared<mutex>(),
+        std::make_shared<condition_variable>());
+  };
+  std::shared_ptr<Node> prefetch = MakeAsyncKnownRatioNode(
+      {0, "prefetch", nullptr}, 1,
+      {MakeParameter("buffer_size", make_state(1), 1, 16)});
+  std::shared_ptr<Node> map2 = MakeAsyncKnownRatioNode(
+      {1, "map2", prefetch}, 1,
+      {MakeParameter("parallelism", make_state(1), 1, pipeline.cores)});
+  std::shared_ptr<Node> map1 = MakeAsyncKnownRatioNode(
+      {2, "map1", map2}, 1,
+      {MakeParameter("parallelism", make_state(1), 1, pipeline.cores)});
+  std::shared_ptr<Node> source = MakeSourceNode({3, "source", map1});
+
+  Model model(&env);
+  model.AddNode([&prefetch](Node::Args args) { return prefetch; }, "prefetch",
+                nullptr, &prefetch);
+  model.AddNode([&map2](Node::Args args) { return map2; }, "map2", prefetch,
+                &map2);
+  model.AddNode([&map1](Node::Args args) { return map1; }, "map1", map2,
+                &map1);
+  model.AddNode([&source](Node::Args args) { return source; }, "source", map1,
+                &source);
+  const std::vector<std::pair<std::shared_ptr<Node>, int64>> stages = {
+      {prefetch, 0},
+      {map2, pipeline.map2_nsec},
+      {map1, pipeline.map1_nsec},
+      {source, pipeline.source_nsec}};
+  for (const auto& stage : stages) {
+    stage.first->record_buffer_event(pipeline.element_bytes, 1);
+  }
+  auto produce = [&](int64 num_elements) {
+    for (const auto& stage : stages) {
+      stage.first->add_processing_time(num_elements * stage.second);
+      for (int64 i = 0; i < num_elements; ++i) {
+        stage.first->record_element();
+      }
+    }
+  };
+  // The slowest stage bounds the pipeline, oversubscribing the cores slows
+  // every stage down, and a short prefetch buffer exposes consumer jitter.
+  auto element_nsec = [&]() {
+    const double map1_parallelism = map1->parameter_value("parallelism");
+    const double map2_parallelism = map2->parameter_value("parallelism");
+    const double buffer_size = prefetch->parameter_value("buffer_size");
+    const double bottleneck =
+        std::max({static_cast<double>(pipeline.source_nsec),
+                  pipeline.map1_nsec / map1_parallelism,
+                  pipeline.map2_nsec / map2_parallelism});
+    const double oversubscription = std::max(
+        1.0, (map1_parallelism + map2_parallelism) / pipeline.cores);
+    return bottleneck * oversubscription * (1 + 0.2 / (1 + buffer_size));
+  };
+  produce(kElementsPerRound);
+
+  std::vector<double> throughput = {EnvTime::kSecondsToNanos / element_nsec()};
+  for (int round = 0; round < rounds; ++round) {
+    model.Optimize(algorithm, pipeline.cores, pipeline.ram_budget, 0);
+    const double nsec = element_nsec();
+    throughput.push_back(EnvTime::kSecondsToNanos / nsec);
+    if (algorithm == AutotuneAlgorithm::BAYESIAN) {
+      EXPECT_LE(map1->parameter_value("parallelism") +
+                    map2->parameter_value("parallelism"),
+                pipeline.cores);
+      EXPECT_LE(prefetch->TotalMaximumBufferedBytes(), pipeline.ram_budget);
+    }
+    env.AdvanceByMicros(kElementsPerRound * nsec / EnvTime::kMicrosToNanos);
+    produce(kElementsPerRound);
+  }
+  return throughput;
+}
+
+TEST(ReplayTest, Model) {
+  constexpr int kRounds = 20;
+  const std::vector<RecordedPipeline> pipelines = {
+      // CPU bound first map.
+      {10000, 200000, 50000, 1 << 20, 8, 64 << 20},
+      // Balanced maps with a tight memory budget.
+      {5000, 100000, 100000, 4 << 20, 16, 48 << 20},
+      // Input bound.
+      {80000, 40000, 20000, 1 << 10, 4, 1 << 20},
+  };
+  for (int i = 0; i < pipelines.size(); ++i) {
+    for (auto algorithm :
+         {AutotuneAlgorithm::HILL_CLIMB, AutotuneAlgorithm::GRADIENT_DESCENT,
+          AutotuneAlgorithm::BAYESIAN}) {
+      const std::vector<double> throughput =
+          ReplayPipeline(algorithm, pipelines[i], kRounds);
+      // The first round whose throughput is within 5% of the final one.
+      int converged = 0;
+      while (std::abs(throughput[converged] - throughput.back()) >
+             0.05 * throughput.back()) {
+        ++converged;
+      }
+      LOG(INFO) << "Pipeline " << i << ", algorithm "
+                << static_cast<int>(algorithm) << ": converged in "
+                << converged << " rounds to " << throughput.back()
+                << " elements/s";
+      if (algorithm == AutotuneAlgorithm::BAYESIAN) {
+        EXPECT_GE(throughput.back(), throughput.front());
+      }
+    }
+  }
+}
 
 }  // namespace
 }  // namespace model
@@ -52,6 +52,9 @@ class RendezvousInterface {
     DeviceContext* device_context = nullptr;
     AllocatorAttributes alloc_attrs;
     CancellationManager* cancellation_manager = nullptr;  // not owned.
+    // The codec a remote sender is asked to encode the tensor with, or empty
+    // for none. Only set on receives. Not owned.
+    StringPiece transfer_codec;
   };
 
   // Parses the key constructed by CreateKey and parse src/dst device
@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -741,6 +742,10 @@ class RunHandler::Impl {
 
   int64 priority() { return options_.priority(); }
 
+  // Estimated cost of the current request in microseconds.
+  double estimated_cost_us() const { return estimated_cost_us_; }
+  void set_estimated_cost_us(double cost) { estimated_cost_us_ = cost; }
+
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
    public:
@@ -761,6 +766,7 @@ class RunHandler::Impl {
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
   RunOptions::Experimental::RunHandlerPoolOptions options_;
+  double estimated_cost_us_ = 0;
 };
 
 // Contains shared state across all run handlers present in the pool. Also
@@ -781,6 +787,8 @@ class RunHandlerPool::Impl {
             &queue_waiters_)),
         iterations_(0),
         version_(0),
+        use_cost_model_(ParamFromEnvBoolWithDefault(
+            "TF_RUN_HANDLER_USE_COST_MODEL", false)),
         sub_thread_pool_end_request_percentage_(ParamFromEnvWithDefault(
             "TF_RUN_HANDLER_SUB_THREAD_POOL_END_REQUEST_PERCENTAGE",
             std::vector<double>({1}))) {
@@ -837,6 +845,9 @@ class RunHandlerPool::Impl {
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    // Estimated costs of the active requests, in the order of
+    // `thread_work_sources`. Only used with the cost model.
+    std::vector<double> request_costs;
     {
       mutex_lock l(mu_);
       if (!has_free_handler()) {
@@ -859,26 +870,49 @@ class RunHandlerPool::Impl {
       handler_impl = free_handlers_.back();
       handler_impl->Reset(step_id, options);
       free_handlers_.pop_back();
+      if (use_cost_model_) {
+        // Requests without an estimate are assumed to be typical.
+        handler_impl->set_estimated_cost_us(
+            options.estimated_cost_us() > 0 ? options.estimated_cost_us()
+                                            : time_hist_.Median() * 1000.0);
+      }
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
+      if (use_cost_model_) {
+        request_costs.reserve(num_active_requests);
+      }
       int priority = options.priority();
+      // With the cost model, requests of the same priority are sorted by
+      // their estimated cost, so that cheap requests are not stuck behind
+      // expensive ones.
+      auto goes_before = [&](RunHandler::Impl* other) {
+        if (priority != other->priority()) {
+          return priority > other->priority();
+        }
+        return use_cost_model_ &&
+               handler_impl->estimated_cost_us() < other->estimated_cost_us();
+      };
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+        if (!new_handler_inserted &&
+            (it == sorted_active_handlers_.cend() || goes_before(*it))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
           --it;
         }
         (*thread_work_sources)[i] = (*it)->tws();
+        if (use_cost_model_) {
+          request_costs.push_back((*it)->estimated_cost_us());
+        }
         ++it;
       }
       version = ++version_;
     }
-    RecomputePoolStats(num_active_requests, version, *thread_work_sources);
+    RecomputePoolStats(num_active_requests, version, *thread_work_sources,
+                       request_costs);
     return WrapUnique<RunHandler>(new RunHandler(handler_impl));
   }
 
@@ -892,6 +926,9 @@ class RunHandlerPool::Impl {
     uint64 now = tensorflow::EnvTime::NowMicros();
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
+    metrics::RecordRunHandlerLatency(
+        use_cost_model_ ? "cost_model" : "priority",
+        now - handler->start_time_us());
 
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
@@ -923,11 +960,26 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<double> GetActiveHandlerCostsForTesting() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<double> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->estimated_cost_us());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
       const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
-          thread_work_sources);
+          thread_work_sources,
+      const std::vector<double>& request_costs);
+
+  // Returns for each of `num_threads` the index of the request it should
+  // attempt first.
+  std::vector<int> ChooseRequests(int num_active_requests, int num_threads,
+                                  const std::vector<double>& request_costs);
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -957,13 +1009,17 @@ class RunHandlerPool::Impl {
   int64 iterations_ TF_GUARDED_BY(mu_);
   mutex mu_;
   int64 version_ TF_GUARDED_BY(mu_);
+  // If true, requests are ordered and given threads by their estimated cost
+  // rather than only by priority and arrival time.
+  const bool use_cost_model_;
   const std::vector<double> sub_thread_pool_end_request_percentage_;
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
     int num_active_requests, uint64 version,
     const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
-        thread_work_sources) {
+        thread_work_sources,
+    const std::vector<double>& request_costs) {
   if (num_active_requests == 0) return;
 
   int sub_thread_pool_id = 0;
@@ -984,8 +1040,8 @@ void RunHandlerPool::Impl::RecomputePoolStats(
   int num_blocking_threads = run_handler_thread_pool()->NumBlockingThreads();
   int num_non_blocking_threads = num_threads - num_blocking_threads;
 
-  std::vector<int> request_idx_list = ChooseRequestsWithExponentialDistribution(
-      num_active_requests, num_blocking_threads);
+  std::vector<int> request_idx_list =
+      ChooseRequests(num_active_requests, num_blocking_threads, request_costs);
   for (int i = 0; i < num_blocking_threads; ++i) {
     VLOG(2) << "Set work for tid=" << i
             << " with start_request_idx=" << request_idx_list[i];
@@ -993,8 +1049,8 @@ void RunHandlerPool::Impl::RecomputePoolStats(
         i, request_idx_list[i], version, thread_work_sources);
   }
 
-  request_idx_list = ChooseRequestsWithExponentialDistribution(
-      num_active_requests, num_non_blocking_threads);
+  request_idx_list = ChooseRequests(num_active_requests,
+                                    num_non_blocking_threads, request_costs);
   for (int i = 0; i < num_non_blocking_threads; ++i) {
     VLOG(2) << "Set work for tid=" << (i + num_blocking_threads)
             << " with start_request_idx=" << request_idx_list[i];
@@ -1004,10 +1060,23 @@ void RunHandlerPool::Impl::RecomputePoolStats(
   }
 }
 
+std::vector<int> RunHandlerPool::Impl::ChooseRequests(
+    int num_active_requests, int num_threads,
+    const std::vector<double>& request_costs) {
+  if (use_cost_model_) {
+    return ChooseRequestsWithCostDistribution(request_costs, num_threads);
+  }
+  return ChooseRequestsWithExponentialDistribution(num_active_requests,
+                                                   num_threads);
+}
+
 void RunHandlerPool::Impl::LogInfo() {
   if (iterations_++ % 50000 == 10 && VLOG_IS_ON(1)) {
     int num_active_requests = sorted_active_handlers_.size();
     VLOG(1) << "Printing time histogram: " << time_hist_.ToString();
+    VLOG(1) << "Latency percentiles: p50 " << time_hist_.Median()
+            << " ms, p99 " << time_hist_.Percentile(99) << " ms, p99.9 "
+            << time_hist_.Percentile(99.9) << " ms.";
     VLOG(1) << "Active session runs: " << num_active_requests;
     uint64 now = tensorflow::Env::Default()->NowMicros();
     string times_str = "";
@@ -1092,6 +1161,10 @@ std::vector<int64> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<double> RunHandlerPool::GetActiveHandlerCostsForTesting() const {
+  return impl_->GetActiveHandlerCostsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -72,6 +72,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the estimated costs for active handlers, in the same order as
+  // GetActiveHandlerPrioritiesForTesting().
+  std::vector<double> GetActiveHandlerCostsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -29,10 +29,12 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -113,6 +115,38 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, CostSchedulingTest) {
+  ASSERT_EQ(setenv("TF_RUN_HANDLER_USE_COST_MODEL", "true", true), 0);
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_estimated_cost_us(500);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.set_estimated_cost_us(100);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.set_estimated_cost_us(300);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  // Priority still takes precedence over cost.
+  options.set_priority(1);
+  options.set_estimated_cost_us(1000);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+
+  // Requests of the same priority are ordered by their cost.
+  std::vector<double> expected_costs = {1000, 100, 300, 500};
+  EXPECT_EQ(pool->GetActiveHandlerCostsForTesting(), expected_costs);
+
+  // All requests make progress.
+  BlockingCounter counter(4);
+  for (auto* handler :
+       {handler1.get(), handler2.get(), handler3.get(), handler4.get()}) {
+    handler->ScheduleInterOpClosure([&counter]() { counter.DecrementCount(); });
+  }
+  counter.Wait();
+  ASSERT_EQ(unsetenv("TF_RUN_HANDLER_USE_COST_MODEL"), 0);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -811,5 +845,73 @@ TEST_F(RunHandlerTest, TestWaitTimeout) {
   EXPECT_NE(next_handle.get(), nullptr);
 }
 
+// Replays a mix of cheap and expensive requests from concurrent clients, and
+// reports the latency percentiles of both kinds of requests. Runs with the
+// default policy (0) and with the cost model (1).
+void BM_MixedRequests(::testing::benchmark::State& state) {
+  const bool use_cost_model = state.range(0);
+  CHECK_EQ(setenv("TF_RUN_HANDLER_USE_COST_MODEL",
+                  use_cost_model ? "true" : "false", true),
+           0);
+  static constexpr int kNumThreads = 4;
+  static constexpr int kNumClients = 8;
+  static constexpr int kRequestsPerClient = 50;
+  // Every kExpensiveRequestPeriod-th request is expensive.
+  static constexpr int kExpensiveRequestPeriod = 10;
+  static constexpr int kCheapRequestClosures = 4;
+  static constexpr int kExpensiveRequestClosures = 200;
+  static constexpr int kClosureMicros = 50;
+
+  RunHandlerPool pool(kNumThreads, kNumThreads);
+  mutex mu;
+  histogram::Histogram cheap_latency_us;
+  histogram::Histogram expensive_latency_us;
+  std::atomic<int64> step_id(0);
+  for (auto s : state) {
+    thread::ThreadPool clients(Env::Default(), "clients", kNumClients);
+    for (int client = 0; client < kNumClients; ++client) {
+      clients.Schedule([&, client]() {
+        for (int i = 0; i < kRequestsPerClient; ++i) {
+          const bool expensive =
+              (client * kRequestsPerClient + i) % kExpensiveRequestPeriod == 0;
+          const int num_closures =
+              expensive ? kExpensiveRequestClosures : kCheapRequestClosures;
+          RunOptions::Experimental::RunHandlerPoolOptions options;
+          options.set_estimated_cost_us(num_closures * kClosureMicros);
+          const uint64 start_us = Env::Default()->NowMicros();
+          {
+            auto handler = pool.Get(step_id++, /*timeout_in_ms=*/0, options);
+            BlockingCounter counter(num_closures);
+            for (int j = 0; j < num_closures; ++j) {
+              handler->ScheduleInterOpClosure([&counter]() {
+                // Busy-waits to simulate a kernel.
+                const uint64 end_us =
+                    Env::Default()->NowMicros() + kClosureMicros;
+                while (Env::Default()->NowMicros() < end_us) {
+                }
+                counter.DecrementCount();
+              });
+            }
+            counter.Wait();
+          }
+          const double latency_us = Env::Default()->NowMicros() - start_us;
+          mutex_lock l(mu);
+          (expensive ? expensive_latency_us : cheap_latency_us)
+              .Add(latency_us);
+        }
+      });
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64>(state.iterations()) *
+                          kNumClients * kRequestsPerClient);
+  state.SetLabel(strings::StrCat(
+      "cheap p50=", cheap_latency_us.Median(),
+      "us p99=", cheap_latency_us.Percentile(99),
+      "us expensive p50=", expensive_latency_us.Median(),
+      "us p99=", expensive_latency_us.Percentile(99), "us"));
+  CHECK_EQ(unsetenv("TF_RUN_HANDLER_USE_COST_MODEL"), 0);
+}
+BENCHMARK(BM_MixedRequests)->Arg(0)->Arg(1)->UseRealTime();
+
 }  // namespace
 }  // namespace tensorflow
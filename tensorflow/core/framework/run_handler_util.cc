@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/run_handler_util.h"
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/logging.h"
@@ -181,4 +183,58 @@ std::vector<int> ChooseRequestsWithExponentialDistribution(
   return request_idx_list;
 }
 
+std::vector<int> ChooseRequestsWithCostDistribution(
+    const std::vector<double>& request_costs, int num_threads) {
+  const int num_active_requests = request_costs.size();
+  std::vector<int> request_idx_list(num_threads, 0);
+  if (num_active_requests == 0) {
+    return request_idx_list;
+  }
+  if (num_active_requests >= num_threads) {
+    std::iota(request_idx_list.begin(), request_idx_list.end(), 0);
+    return request_idx_list;
+  }
+
+  std::vector<int> num_threads_per_request(num_active_requests, 1);
+  const int num_remaining_threads = num_threads - num_active_requests;
+  double total_cost = 0;
+  for (double cost : request_costs) {
+    total_cost += std::max(cost, 0.0);
+  }
+  int num_assigned_threads = 0;
+  std::vector<double> remainders(num_active_requests);
+  for (int i = 0; i < num_active_requests; ++i) {
+    const double share =
+        total_cost > 0
+            ? num_remaining_threads * std::max(request_costs[i], 0.0) /
+                  total_cost
+            : static_cast<double>(num_remaining_threads) / num_active_requests;
+    const int num_whole_threads =
+        std::min(static_cast<int>(share),
+                 num_remaining_threads - num_assigned_threads);
+    num_threads_per_request[i] += num_whole_threads;
+    num_assigned_threads += num_whole_threads;
+    remainders[i] = share - num_whole_threads;
+  }
+  // The threads lost to rounding go to the requests with the largest
+  // remainders, earlier requests first on ties.
+  std::vector<int> order(num_active_requests);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&remainders](int a, int b) {
+    return remainders[a] > remainders[b];
+  });
+  for (int i = 0; num_assigned_threads < num_remaining_threads; ++i) {
+    ++num_threads_per_request[order[i]];
+    ++num_assigned_threads;
+  }
+
+  int tid = 0;
+  for (int i = 0; i < num_active_requests; ++i) {
+    for (int j = 0; j < num_threads_per_request[i]; ++j) {
+      request_idx_list[tid++] = i;
+    }
+  }
+  return request_idx_list;
+}
+
 }  // namespace tensorflow
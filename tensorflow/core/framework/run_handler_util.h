@@ -54,6 +54,14 @@ void ComputeInterOpStealingRanges(int num_threads, int min_threads_per_domain,
 std::vector<int> ChooseRequestsWithExponentialDistribution(
     int num_active_requests, int num_threads);
 
+// Like ChooseRequestsWithExponentialDistribution, but sizes the share of each
+// request by its estimated cost. Every request gets at least one thread, and
+// the remaining threads are distributed in proportion to 'request_costs'. If
+// there are more requests than threads, the first num_threads requests get one
+// thread each, so callers should order the requests by urgency.
+std::vector<int> ChooseRequestsWithCostDistribution(
+    const std::vector<double>& request_costs, int num_threads);
+
 // Look up environment variable named 'var_name' and return the value if it
 // exist and can be parsed. Return 'default_value' otherwise.
 double ParamFromEnvWithDefault(const char* var_name, double default_value);
@@ -126,6 +126,23 @@ TEST(RunHandlerUtilTest, TestExponentialRequestDistribution) {
   ASSERT_EQ(actual_distribution, expected_distribution);
 }
 
+TEST(RunHandlerUtilTest, TestCostRequestDistribution) {
+  // Every request gets a thread, the rest are shared in proportion to cost.
+  std::vector<int> expected_distribution{0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2};
+  ASSERT_EQ(ChooseRequestsWithCostDistribution({10, 30, 60}, 13),
+            expected_distribution);
+
+  // Threads are shared evenly if no request has a cost.
+  expected_distribution = {0, 0, 1, 1};
+  ASSERT_EQ(ChooseRequestsWithCostDistribution({0, 0}, 4),
+            expected_distribution);
+
+  // With more requests than threads, the first requests get a thread each.
+  expected_distribution = {0, 1};
+  ASSERT_EQ(ChooseRequestsWithCostDistribution({1, 2, 3}, 2),
+            expected_distribution);
+}
+
 TEST(RunHandlerUtilTest, TestParamFromEnvWithDefault) {
   std::vector<double> result = ParamFromEnvWithDefault(
       "RUN_HANDLER_TEST_ENV", std::vector<double>{0, 0, 0});
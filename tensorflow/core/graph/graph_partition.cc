@@ -303,6 +303,12 @@ NodeDef* AddRecv(const PartitionOptions& opts, const GraphInfo& g_info,
   SetSendRecvAttrs(opts, edge, &recv_builder);
   recv_builder.Device(dst->assigned_device_name())
       .Attr("tensor_type", cast_dtype);
+  // Asks the sender to encode the tensor with the codec that its producer
+  // requests, if any.
+  const AttrValue* transfer_codec = src->attrs().Find("_transfer_codec");
+  if (transfer_codec != nullptr && !edge->IsControlEdge()) {
+    recv_builder.Attr("_transfer_codec", *transfer_codec);
+  }
   NodeDef* recv = gdef->add_node();
   *status = recv_builder.Finalize(recv, /*consume=*/true);
   if (!status->ok()) return nullptr;
@@ -541,6 +541,32 @@ TEST_F(GraphPartitionTest, SetIncarnation) {
   }
 }
 
+TEST_F(GraphPartitionTest, TransferCodec) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  a1.node()->AddAttr("_transfer_codec", "snappy");
+  auto a2 = FloatInput(in_.WithOpName("A2"));
+  Combine(in_.WithOpName("B1"), a1, a2);
+
+  Partition(ToGraphDef(), &partitions_);
+  EXPECT_EQ(2, partitions_.size());
+
+  // Only the _Recv of the output of A1 asks for the codec.
+  int num_recvs = 0;
+  for (const NodeDef& ndef :
+       partitions_["/job:a/replica:0/task:0/cpu:1"].node()) {
+    if (ndef.op() != "_Recv") continue;
+    ++num_recvs;
+    string codec;
+    if (str_util::StartsWith(ndef.name(), "A1/")) {
+      TF_EXPECT_OK(GetNodeAttr(ndef, "_transfer_codec", &codec));
+      EXPECT_EQ(codec, "snappy");
+    } else {
+      EXPECT_FALSE(TryGetNodeAttr(ndef, "_transfer_codec", &codec));
+    }
+  }
+  EXPECT_EQ(num_recvs, 2);
+}
+
 TEST(TopologicalSortNodesWithTimePriorityTest, NoDependencies) {
   // Create placeholders, shuffle them so the order in the graph is not strictly
   // increasing.
@@ -42,6 +42,18 @@ constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 constexpr char kOutputShapes[] = "output_shapes";
 constexpr char kOutputTypes[] = "output_types";
 constexpr char kReshuffleEachIteration[] = "reshuffle_each_iteration";
+constexpr char kSpillDir[] = "spill_dir";
+constexpr char kSpillMemoryLimitBytes[] = "spill_memory_limit_bytes";
+
+// Copies the spill configuration of the shuffle, if it has one, so that the
+// fused node buffers its elements the same way.
+void CopySpillAttributes(const NodeDef& shuffle_node, NodeDef* fused_node) {
+  for (auto key : {kSpillDir, kSpillMemoryLimitBytes}) {
+    if (shuffle_node.attr().count(key)) {
+      graph_utils::CopyAttribute(key, shuffle_node, fused_node);
+    }
+  }
+}
 
 Status FuseShuffleV1AndRepeat(const NodeDef& shuffle_node,
                               const NodeDef& repeat_node,
@@ -71,6 +83,7 @@ Status FuseShuffleV1AndRepeat(const NodeDef& shuffle_node,
   for (auto key : {kOutputShapes, kOutputTypes, kReshuffleEachIteration}) {
     graph_utils::CopyAttribute(key, shuffle_node, fused_node);
   }
+  CopySpillAttributes(shuffle_node, fused_node);
 
   return Status::OK();
 }
@@ -110,6 +123,7 @@ Status FuseShuffleV2AndRepeat(const NodeDef& shuffle_node,
 
   // Default the `reshuffle_each_iteration` attribute to true.
   (*fused_node->mutable_attr())[kReshuffleEachIteration].set_b(true);
+  CopySpillAttributes(shuffle_node, fused_node);
 
   return Status::OK();
 }
@@ -145,6 +159,7 @@ Status FuseShuffleV3AndRepeat(const NodeDef& shuffle_node,
   for (auto key : {kOutputShapes, kOutputTypes, kReshuffleEachIteration}) {
     graph_utils::CopyAttribute(key, shuffle_node, fused_node);
   }
+  CopySpillAttributes(shuffle_node, fused_node);
 
   return Status::OK();
 }
@@ -28,6 +28,8 @@ namespace {
 constexpr char kOutputShapes[] = "output_shapes";
 constexpr char kOutputTypes[] = "output_types";
 constexpr char kReshuffleEachIteration[] = "reshuffle_each_iteration";
+constexpr char kSpillDir[] = "spill_dir";
+constexpr char kSpillMemoryLimitBytes[] = "spill_memory_limit_bytes";
 
 TEST(ShuffleAndRepeatFusionTest, FuseShuffleV1AndRepeat) {
   GrapplerItem item;
@@ -200,6 +202,8 @@ TEST(ShuffleAndRepeatFusionTest, FuseShuffleV3AndRepeat) {
   NodeDef *shuffle_node = graph_utils::AddNode(
       "", "ShuffleDatasetV3", shuffle_inputs, common_attrs, &graph);
   (*shuffle_node->mutable_attr())[kReshuffleEachIteration].set_b(true);
+  (*shuffle_node->mutable_attr())[kSpillDir].set_s("/tmp/spill");
+  (*shuffle_node->mutable_attr())[kSpillMemoryLimitBytes].set_i(1024);
 
   NodeDef *count_node = graph_utils::AddScalarConstNode<int64>(-1, &graph);
   std::vector<string> repeat_inputs(2);
@@ -227,8 +231,8 @@ TEST(ShuffleAndRepeatFusionTest, FuseShuffleV3AndRepeat) {
   EXPECT_EQ(shuffle_and_repeat_node.input(3), shuffle_node->input(3));
   EXPECT_EQ(shuffle_and_repeat_node.input(4), repeat_node->input(1));
   EXPECT_EQ(shuffle_and_repeat_node.input(5), shuffle_node->input(4));
-  for (const auto &attr :
-       {kOutputShapes, kOutputTypes, kReshuffleEachIteration}) {
+  for (const auto &attr : {kOutputShapes, kOutputTypes, kReshuffleEachIteration,
+                           kSpillDir, kSpillMemoryLimitBytes}) {
     EXPECT_TRUE(AreAttrValuesEqual(shuffle_and_repeat_node.attr().at(attr),
                                    shuffle_node->attr().at(attr)));
   }
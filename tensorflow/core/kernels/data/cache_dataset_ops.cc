@@ -16,10 +16,13 @@ limitations under the License.
 
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/stats_utils.h"
+#include "tensorflow/core/kernels/data/tiered_cache.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
@@ -37,6 +40,8 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudgetBytes;
+/* static */ constexpr const char* const CacheDatasetOp::kSpillDir;
 
 namespace {
 
@@ -661,10 +666,14 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                             std::shared_ptr<MemoryCache> cache)
+                             std::shared_ptr<MemoryCache> cache,
+                             int64 memory_budget_bytes,
+                             const std::string& spill_dir)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        memory_budget_bytes_(memory_budget_bytes),
+        spill_dir_(spill_dir) {
     input_->Ref();
   }
 
@@ -706,6 +715,26 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
   }
 
  protected:
+  // Returns a new, empty cache for the writer to fill when the memory budget
+  // is limited.
+  std::unique_ptr<TieredCache> NewTieredCache() const {
+    return absl::make_unique<TieredCache>(Env::Default(), memory_budget_bytes_,
+                                          spill_dir_);
+  }
+
+  // Appends the memory budget and spill directory to the attrs of the
+  // serialized dataset.
+  void AddTieringAttrs(
+      DatasetGraphDefBuilder* b,
+      std::vector<std::pair<StringPiece, AttrValue>>* attrs) const {
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
+    attrs->emplace_back(kMemoryBudgetBytes, memory_budget_bytes);
+    AttrValue spill_dir;
+    b->BuildAttrValue(spill_dir_, &spill_dir);
+    attrs->emplace_back(kSpillDir, spill_dir);
+  }
+
   class MemoryIterator : public DatasetIterator<MemoryDatasetBase> {
    public:
     explicit MemoryIterator(const Params& params, MemoryCache* cache)
@@ -735,8 +764,16 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCacheCompleted), ""));
-        TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        if (TieredCache* tiered_cache = cache_->tiered()) {
+          TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+              writer, prefix(), tiered_cache->size(),
+              [tiered_cache](int64 i, std::vector<Tensor>* element) {
+                return tiered_cache->Peek(i, element);
+              }));
+        } else {
+          TF_RETURN_IF_ERROR(
+              WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        }
       }
       return SaveInput(ctx, writer, iterator_);
     }
@@ -747,10 +784,20 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       iterator_.reset();
       cache_->Reset();
       if (reader->Contains(full_name(kCacheCompleted))) {
-        std::vector<std::vector<Tensor>> temp_cache;
-        TF_RETURN_IF_ERROR(
-            ReadElementsFromCheckpoint(reader, prefix(), &temp_cache));
-        cache_->Complete(std::move(temp_cache));
+        if (dataset()->memory_budget_bytes_ > 0) {
+          std::unique_ptr<TieredCache> tiered_cache =
+              dataset()->NewTieredCache();
+          TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+              reader, prefix(), [&](std::vector<Tensor> element) {
+                return tiered_cache->Append(std::move(element));
+              }));
+          cache_->Complete(std::move(tiered_cache));
+        } else {
+          std::vector<std::vector<Tensor>> temp_cache;
+          TF_RETURN_IF_ERROR(
+              ReadElementsFromCheckpoint(reader, prefix(), &temp_cache));
+          cache_->Complete(std::move(temp_cache));
+        }
       }
       TF_RETURN_IF_ERROR(InitializeIterator(ctx));
       return RestoreInput(ctx, reader, iterator_);
@@ -760,11 +807,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
     class MemoryWriterIterator : public DatasetIterator<MemoryDatasetBase> {
      public:
       explicit MemoryWriterIterator(const Params& params, MemoryCache* cache)
-          : DatasetIterator<MemoryDatasetBase>(params), cache_(cache) {}
+          : DatasetIterator<MemoryDatasetBase>(params), cache_(cache) {
+        if (dataset()->memory_budget_bytes_ > 0) {
+          tiered_temp_cache_ = dataset()->NewTieredCache();
+        }
+      }
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
-        if (!temp_cache_.empty() && !cache_->IsCompleted()) {
+        if (TempCacheSize() > 0 && !cache_->IsCompleted()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
@@ -784,16 +835,22 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            CompleteCache();
           }
           return Status::OK();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        if (tiered_temp_cache_) {
+          // The memory used by a tiered cache is bounded by its budget, so
+          // it is not recorded per element.
+          TF_RETURN_IF_ERROR(tiered_temp_cache_->Append(*out_tensors));
+        } else {
+          RecordBufferEnqueue(ctx, *out_tensors);
+          temp_cache_.emplace_back(*out_tensors);
+        }
+        if (TempCacheSize() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          CompleteCache();
         }
         return Status::OK();
       }
@@ -809,8 +866,17 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
-          TF_RETURN_IF_ERROR(
-              WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          if (tiered_temp_cache_) {
+            TieredCache* tiered_cache = tiered_temp_cache_.get();
+            TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+                writer, prefix(), tiered_cache->size(),
+                [tiered_cache](int64 i, std::vector<Tensor>* element) {
+                  return tiered_cache->Peek(i, element);
+                }));
+          } else {
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          }
         }
         return SaveInput(ctx, writer, input_impl_);
       }
@@ -819,17 +885,42 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              IteratorStateReader* reader) override {
         mutex_lock l(mu_);
         if (!reader->Contains(full_name(kCacheCompleted))) {
-          TF_RETURN_IF_ERROR(
-              ReadElementsFromCheckpoint(reader, prefix(), &temp_cache_));
+          if (tiered_temp_cache_) {
+            tiered_temp_cache_ = dataset()->NewTieredCache();
+            TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+                reader, prefix(), [this](std::vector<Tensor> element) {
+                  return tiered_temp_cache_->Append(std::move(element));
+                }));
+          } else {
+            TF_RETURN_IF_ERROR(
+                ReadElementsFromCheckpoint(reader, prefix(), &temp_cache_));
+          }
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
 
      private:
+      int64 TempCacheSize() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (tiered_temp_cache_) {
+          return tiered_temp_cache_->size();
+        }
+        return temp_cache_.size();
+      }
+
+      void CompleteCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (tiered_temp_cache_) {
+          cache_->Complete(std::move(tiered_temp_cache_));
+        } else {
+          cache_->Complete(std::move(temp_cache_));
+        }
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      // Used instead of `temp_cache_` when the cache has a memory budget.
+      std::unique_ptr<TieredCache> tiered_temp_cache_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -844,8 +935,12 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // dataset but performance modeling uses the iterator abstraction and
         // thus we record the memory allocated for the cache here. The caveat
         // is that this is incorrect if there are concurrent instances of this
-        // iterator.
+        // iterator. A tiered cache is not recorded, since its memory is
+        // bounded by its budget.
         tf_shared_lock l(mu_);
+        if (cache_->tiered() != nullptr) {
+          return Status::OK();
+        }
         for (size_t i = 0; i < cache_->size(); ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
@@ -857,9 +952,18 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
-          out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
-                              cache_tensors.end());
+          if (TieredCache* tiered_cache = cache_->tiered()) {
+            std::vector<Tensor> cache_tensors;
+            TF_RETURN_IF_ERROR(tiered_cache->Get(index_, &cache_tensors));
+            out_tensors->insert(out_tensors->begin(),
+                                std::make_move_iterator(cache_tensors.begin()),
+                                std::make_move_iterator(cache_tensors.end()));
+            RecordTieredCacheStats(ctx, tiered_cache->stats());
+          } else {
+            const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+            out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
+                                cache_tensors.end());
+          }
           index_++;
           *end_of_sequence = false;
           return Status::OK();
@@ -895,6 +999,27 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       }
 
      private:
+      void RecordTieredCacheStats(IteratorContext* ctx,
+                                  const TieredCache::Stats& stats) {
+        auto stats_aggregator = ctx->stats_aggregator();
+        if (!stats_aggregator) {
+          return;
+        }
+        const string& node_name = dataset()->node_name();
+        stats_aggregator->AddScalar(stats_utils::CacheHitsScalarName(node_name),
+                                    static_cast<float>(stats.hits),
+                                    num_elements());
+        stats_aggregator->AddScalar(
+            stats_utils::CacheMissesScalarName(node_name),
+            static_cast<float>(stats.misses), num_elements());
+        stats_aggregator->AddScalar(
+            stats_utils::CacheMemoryBytesScalarName(node_name),
+            static_cast<float>(stats.memory_bytes), num_elements());
+        stats_aggregator->AddScalar(
+            stats_utils::CacheSpilledBytesScalarName(node_name),
+            static_cast<float>(stats.spilled_bytes), num_elements());
+      }
+
       mutex mu_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
@@ -924,6 +1049,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  // If positive, the bytes of elements the cache keeps in memory. The rest are
+  // spilled to a file in `spill_dir_`.
+  const int64 memory_budget_bytes_;
+  const std::string spill_dir_;
 };  // MemoryDatasetBase
 
 // This version of memory dataset has an exclusive ownership of the memory cache
@@ -932,8 +1061,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
  public:
   MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
-                MemoryCacheManager* manager, ResourceHandle&& resource_handle)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                MemoryCacheManager* manager, ResourceHandle&& resource_handle,
+                int64 memory_budget_bytes, const std::string& spill_dir)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget_bytes,
+                          spill_dir),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()) {}
@@ -955,8 +1086,10 @@ class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
     Node* filename_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(tstring(""), &filename_node));
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    AddTieringAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_node, filename_node}, output));
+        b->AddDataset(this, {input_node, filename_node}, attrs, output));
     return Status::OK();
   }
 
@@ -974,8 +1107,10 @@ class CacheDatasetOp::MemoryDatasetV2
  public:
   MemoryDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
                   MemoryCacheManager* manager, ResourceHandle&& resource_handle,
-                  bool owns_resource)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                  bool owns_resource, int64 memory_budget_bytes,
+                  const std::string& spill_dir)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget_bytes,
+                          spill_dir),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1004,8 +1139,11 @@ class CacheDatasetOp::MemoryDatasetV2
     Tensor handle(DT_RESOURCE, TensorShape({}));
     handle.scalar<ResourceHandle>()() = resource_handle_;
     TF_RETURN_IF_ERROR(b->AddTensor(handle, &resource_handle_node));
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    AddTieringAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+        this, {input_node, filename_node, resource_handle_node}, attrs,
+        output));
     return Status::OK();
   }
 
@@ -1018,7 +1156,13 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryBudgetBytes, &memory_budget_bytes_));
+  OP_REQUIRES(ctx, memory_budget_bytes_ >= 0,
+              errors::InvalidArgument(
+                  "`memory_budget_bytes` must be greater than or equal to 0."));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDir, &spill_dir_));
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1051,7 +1195,8 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       }
       // Ownership of manager is transferred onto `MemoryDatasetV2`.
       *output = new MemoryDatasetV2(ctx, input, manager, std::move(handle),
-                                    owns_resource);
+                                    owns_resource, memory_budget_bytes_,
+                                    spill_dir_);
     } else {
       MemoryCacheManager* manager;
       OP_REQUIRES_OK(
@@ -1063,7 +1208,8 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       auto handle =
           MakeResourceHandle<MemoryCacheManager>(ctx, container, name);
       // Ownership of manager is transferred onto `MemoryDataset`.
-      *output = new MemoryDataset(ctx, input, manager, std::move(handle));
+      *output = new MemoryDataset(ctx, input, manager, std::move(handle),
+                                  memory_budget_bytes_, spill_dir_);
     }
   } else {
     if (op_version_ == 2) {
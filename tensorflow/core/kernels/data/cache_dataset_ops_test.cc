@@ -29,10 +29,13 @@ class CacheDatasetParams : public DatasetParams {
   CacheDatasetParams(T input_dataset_params, string filename,
                      DataTypeVector output_dtypes,
                      std::vector<PartialTensorShape> output_shapes,
-                     string node_name)
+                     string node_name, int64 memory_budget_bytes = 0,
+                     string spill_dir = "")
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
-        filename_(filename) {
+        filename_(filename),
+        memory_budget_bytes_(memory_budget_bytes),
+        spill_dir_(std::move(spill_dir)) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -52,7 +55,9 @@ class CacheDatasetParams : public DatasetParams {
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
     *attr_vector = {{CacheDatasetOp::kOutputTypes, output_dtypes_},
-                    {CacheDatasetOp::kOutputShapes, output_shapes_}};
+                    {CacheDatasetOp::kOutputShapes, output_shapes_},
+                    {CacheDatasetOp::kMemoryBudgetBytes, memory_budget_bytes_},
+                    {CacheDatasetOp::kSpillDir, spill_dir_}};
     return Status::OK();
   }
 
@@ -62,6 +67,8 @@ class CacheDatasetParams : public DatasetParams {
 
  private:
   string filename_;
+  int64 memory_budget_bytes_;
+  string spill_dir_;
 };
 
 class CacheDatasetOpTest : public DatasetOpsTestBase {
@@ -199,6 +206,47 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_SUITE_P(CacheDatasetOpTest, ParameterizedGetNextTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(CacheDatasetOpTest, MemoryBudget) {
+  const string spill_dir =
+      io::JoinPath(testing::TmpDir(), "cache_dataset_op_test_spill");
+  auto dataset_params = CacheDatasetParams(
+      TensorSliceDatasetParams(
+          /*components=*/{CreateTensor<int64>(TensorShape{3, 3, 1},
+                                              {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+          /*node_name=*/"tensor_slice"),
+      /*filename=*/"",
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({3, 1})}, kNodeName,
+      // Only one of the three 24-byte elements fits in memory.
+      /*memory_budget_bytes=*/24, /*spill_dir=*/spill_dir);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  const std::vector<Tensor> expected_outputs = CreateTensors<int64>(
+      TensorShape({3, 1}), {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}});
+  // Writes the cache, then reads it twice.
+  for (int i = 0; i < 3; ++i) {
+    if (i > 0) {
+      TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(),
+                                          /*parent=*/nullptr,
+                                          dataset_params.iterator_prefix(),
+                                          &iterator_));
+    }
+    bool end_of_sequence = false;
+    std::vector<Tensor> out_tensors;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                             /*compare_order=*/true));
+  }
+  std::vector<string> spill_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(spill_dir, &spill_files));
+  EXPECT_EQ(spill_files.size(), 1);
+}
+
 TEST_F(CacheDatasetOpTest, DatasetNodeName) {
   auto dataset_params = CacheDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
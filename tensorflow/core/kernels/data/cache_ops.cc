@@ -41,6 +41,14 @@ void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
   }
 }
 
+void MemoryCache::Complete(std::unique_ptr<TieredCache> cache) {
+  mutex_lock l(mu_);
+  if (!completed_) {
+    tiered_cache_ = std::move(cache);
+    completed_ = true;
+  }
+}
+
 bool MemoryCache::IsCompleted() {
   tf_shared_lock l(mu_);
   return completed_;
@@ -50,6 +58,7 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  tiered_cache_.reset();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64 index) {
@@ -58,8 +67,16 @@ const std::vector<Tensor>& MemoryCache::at(int64 index) {
   return cache_[index];
 }
 
+TieredCache* MemoryCache::tiered() {
+  tf_shared_lock l(mu_);
+  return tiered_cache_.get();
+}
+
 size_t MemoryCache::size() {
   tf_shared_lock l(mu_);
+  if (tiered_cache_) {
+    return tiered_cache_->size();
+  }
   return cache_.size();
 }
 
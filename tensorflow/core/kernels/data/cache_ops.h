@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/tiered_cache.h"
 
 namespace tensorflow {
 namespace data {
@@ -27,12 +28,15 @@ namespace data {
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// By default all elements are held in memory. A writer with a memory budget
+// fills a `TieredCache` instead, which keeps at most that many bytes in memory
+// and the rest in a spill file.
 class MemoryCache {
  public:
-  MemoryCache() = default;
-
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
+  void Complete(std::unique_ptr<TieredCache> cache);
 
   // Returns whether the cache is completed.
   bool IsCompleted();
@@ -40,14 +44,20 @@ class MemoryCache {
   // Resets the cache.
   void Reset();
 
-  // Returns the element at the given index.
+  // Returns the element at the given index. Must not be called when the cache
+  // is tiered.
   const std::vector<Tensor>& at(int64 index);
 
+  // Returns the tiered cache of a completed cache, or nullptr if its elements
+  // are all in memory. The returned pointer will be invalidated by any call
+  // to Reset().
+  TieredCache* tiered();
+
   // Returns the size of the cache.
   size_t size();
 
   // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
+  // invalidated by any call to Reset(). Empty when the cache is tiered.
   const std::vector<std::vector<Tensor>>& data();
 
  private:
@@ -55,6 +65,7 @@ class MemoryCache {
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<TieredCache> tiered_cache_ TF_GUARDED_BY(mu_);
 };
 
 // A resource wrapping a shared instance of a memory cache.
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/util/work_sharder.h"
 
@@ -88,6 +89,86 @@ Status ReadElementsFromCheckpoint(IteratorStateReader* reader,
   return Status::OK();
 }
 
+Status WriteElementsToCheckpoint(
+    IteratorStateWriter* writer, StringPiece key_prefix, int64 num_elements,
+    const std::function<Status(int64, std::vector<Tensor>*)>& get_element) {
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key_prefix, kNumElements, num_elements));
+  std::vector<Tensor> element;
+  for (int64 i = 0; i < num_elements; ++i) {
+    element.clear();
+    TF_RETURN_IF_ERROR(get_element(i, &element));
+    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
+    TF_RETURN_IF_ERROR(
+        writer->WriteScalar(element_prefix, kNumComponents, element.size()));
+    for (int j = 0; j < element.size(); ++j) {
+      TF_RETURN_IF_ERROR(writer->WriteTensor(
+          element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
+    }
+  }
+  return Status::OK();
+}
+
+Status ReadElementsFromCheckpoint(
+    IteratorStateReader* reader, StringPiece key_prefix,
+    const std::function<Status(std::vector<Tensor>)>& add_element) {
+  int64 num_elements;
+  TF_RETURN_IF_ERROR(
+      reader->ReadScalar(key_prefix, kNumElements, &num_elements));
+  for (int64 i = 0; i < num_elements; ++i) {
+    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
+    int64 num_components;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(element_prefix, kNumComponents, &num_components));
+    std::vector<Tensor> element(num_components);
+    for (int j = 0; j < num_components; ++j) {
+      TF_RETURN_IF_ERROR(reader->ReadTensor(
+          element_prefix, absl::StrCat(kComponent, "[", j, "]"), &element[j]));
+    }
+    TF_RETURN_IF_ERROR(add_element(std::move(element)));
+  }
+  return Status::OK();
+}
+
+// Each tensor is stored as a serialized TensorProto preceded by its varint32
+// length.
+Status SerializeElement(const std::vector<Tensor>& element, tstring* out) {
+  out->clear();
+  for (const Tensor& tensor : element) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    std::string serialized;
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::Internal("Failed to serialize tensor of shape ",
+                              tensor.shape().DebugString());
+    }
+    core::PutVarint32(out, serialized.size());
+    out->append(serialized);
+  }
+  return Status::OK();
+}
+
+Status DeserializeElement(StringPiece serialized,
+                          std::vector<Tensor>* element) {
+  element->clear();
+  while (!serialized.empty()) {
+    uint32 length;
+    if (!core::GetVarint32(&serialized, &length) ||
+        length > serialized.size()) {
+      return errors::DataLoss("Corrupted serialized element");
+    }
+    TensorProto proto;
+    Tensor tensor;
+    if (!proto.ParseFromArray(serialized.data(), length) ||
+        !tensor.FromProto(proto)) {
+      return errors::DataLoss("Unable to parse serialized tensor");
+    }
+    element->push_back(std::move(tensor));
+    serialized.remove_prefix(length);
+  }
+  return Status::OK();
+}
+
 std::pair<int64, int64> MaybeOverrideSeeds(std::pair<int64, int64> seeds) {
   if (seeds.first == 0 && seeds.second == 0) {
     return {random::New64(), random::New64()};
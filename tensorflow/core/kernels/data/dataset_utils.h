@@ -118,6 +118,24 @@ Status ReadElementsFromCheckpoint(IteratorStateReader* reader,
                                   StringPiece key_prefix,
                                   std::vector<std::vector<Tensor>>* elements);
 
+// Like WriteElementsToCheckpoint, for elements that are not all held in
+// memory: element `i` is obtained by calling `get_element(i, &element)`.
+Status WriteElementsToCheckpoint(
+    IteratorStateWriter* writer, StringPiece key_prefix, int64 num_elements,
+    const std::function<Status(int64, std::vector<Tensor>*)>& get_element);
+
+// Like ReadElementsFromCheckpoint, but passes each element to `add_element` as
+// soon as it is read.
+Status ReadElementsFromCheckpoint(
+    IteratorStateReader* reader, StringPiece key_prefix,
+    const std::function<Status(std::vector<Tensor>)>& add_element);
+
+// Serializes the tensors of `element` into a single string, which
+// DeserializeElement turns back into the element.
+Status SerializeElement(const std::vector<Tensor>& element, tstring* out);
+
+Status DeserializeElement(StringPiece serialized, std::vector<Tensor>* element);
+
 // Dataset op level determinism policy.
 class DeterminismPolicy {
  public:
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/in_flight_limit.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
@@ -55,6 +56,9 @@ namespace data {
     DataServiceDatasetOp::kMaxOutstandingRequests;
 /* static */ constexpr const char* const
     DataServiceDatasetOp::kTaskRefreshIntervalHintMs;
+/* static */ constexpr const char* const
+    DataServiceDatasetOp::kElementsPerRequest;
+/* static */ constexpr const char* const DataServiceDatasetOp::kLocalReads;
 /* static */ constexpr const char* const
     DataServiceDatasetOp::kIterationCounter;
 /* static */ constexpr const char* const DataServiceDatasetOp::kOutputTypes;
@@ -63,6 +67,10 @@ namespace data {
 namespace {
 // Default interval between task list refreshes.
 const int64 kDefaultTaskRefreshIntervalMs = 1000;  // 1 second.
+// Workers stop adding elements to a response once it holds this many bytes.
+const int64 kMaxBytesPerRequest = 1 << 20;  // 1MB.
+// The most requests to keep in flight to a single task.
+const int64 kMaxInFlightPerTask = 8;
 }  // namespace
 
 // Dataset for reading data from the tf.data service non-deterministically.
@@ -76,6 +84,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           ProcessingMode processing_mode, const std::string& address,
           const std::string& protocol, const std::string& job_name,
           int64 max_outstanding_requests, int64 task_refresh_interval_ms,
+          int64 elements_per_request, bool local_reads,
           IterationCounter* iteration_counter, bool owns_resource,
           ResourceHandle iteration_counter_handle,
           const DataTypeVector& output_types,
@@ -88,6 +97,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         job_name_(job_name),
         max_outstanding_requests_(max_outstanding_requests),
         task_refresh_interval_ms_(task_refresh_interval_ms),
+        elements_per_request_(elements_per_request),
+        local_reads_(local_reads),
         iteration_counter_(iteration_counter),
         owns_resource_(owns_resource),
         iteration_counter_handle_(iteration_counter_handle),
@@ -164,12 +175,21 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(task_refresh_interval_ms_,
                       &task_refresh_interval_hint_ms);
 
+    AttrValue elements_per_request;
+    b->BuildAttrValue(elements_per_request_, &elements_per_request);
+
+    AttrValue local_reads;
+    b->BuildAttrValue(local_reads_, &local_reads);
+
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {dataset_id, processing_mode, address, protocol, job_name,
                        max_outstanding_requests, iteration_counter_handle},
                       {std::make_pair(kTaskRefreshIntervalHintMs,
-                                      task_refresh_interval_hint_ms)},
+                                      task_refresh_interval_hint_ms),
+                       std::make_pair(kElementsPerRequest,
+                                      elements_per_request),
+                       std::make_pair(kLocalReads, local_reads)},
                       output));
     return Status::OK();
   }
@@ -180,6 +200,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params, int64 iterator_index)
         : DatasetIterator<Dataset>(params),
           iterator_index_(iterator_index),
+          elements_per_request_(params.dataset->elements_per_request_),
           max_outstanding_requests_(params.dataset->max_outstanding_requests_) {
     }
 
@@ -254,6 +275,10 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
             });
       }
 
+      if (results_.empty()) {
+        // Tells the requests in flight that the consumer is waiting on them.
+        num_consumer_waits_++;
+      }
       while (results_.empty() &&
              !(job_finished_ && num_running_worker_threads_ == 0) &&
              !cancelled_ && status_.ok()) {
@@ -298,8 +323,10 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     data::TraceMeMetadata GetTraceMeMetadata() const override {
       data::TraceMeMetadata result;
       int64 num_tasks = -1;
+      int64 max_requests_in_flight = -1;
       if (mu_.try_lock()) {
         num_tasks = tasks_.size() - finished_tasks_;
+        max_requests_in_flight = MaxRequestsInFlight();
         mu_.unlock();
       }
       std::string num_tasks_string =
@@ -312,6 +339,16 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           "max_outstanding_requests",
           strings::Printf("%lld", static_cast<long long>(
                                       dataset()->max_outstanding_requests_))));
+      result.push_back(std::make_pair(
+          "elements_per_request",
+          strings::Printf("%lld",
+                          static_cast<long long>(elements_per_request_))));
+      result.push_back(std::make_pair(
+          "max_requests_in_flight",
+          (max_requests_in_flight == -1)
+              ? "unavailable"
+              : strings::Printf("%lld", static_cast<long long>(
+                                            max_requests_in_flight))));
       return result;
     }
 
@@ -326,8 +363,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       const std::string address;
       // Client for fetching task elements from the tf.data service worker.
       const std::unique_ptr<DataServiceWorkerClient> worker;
-      // Indicates whether a worker thread is currently processing the task.
-      bool in_use TF_GUARDED_BY(&Iterator::mu_) = false;
+      // The number of worker threads with a request in flight for the task.
+      int64 num_in_flight TF_GUARDED_BY(&Iterator::mu_) = 0;
+      // Bounds `num_in_flight`, adapting to the latency of the requests.
+      InFlightLimit in_flight_limit TF_GUARDED_BY(&Iterator::mu_){
+          kMaxInFlightPerTask};
       // Indicates whether the worker has returned end_of_sequence for the task.
       bool end_of_sequence TF_GUARDED_BY(&Iterator::mu_) = false;
     };
@@ -344,8 +384,10 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       while (true) {
         {
           mutex_lock l(mu_);
-          // All units are microseconds.
-          while (!cancelled_ && Env::Default()->NowMicros() < next_check) {
+          // All units are microseconds. Worker threads wake the manager early
+          // when the in-flight limits call for more threads.
+          while (!cancelled_ && Env::Default()->NowMicros() < next_check &&
+                 !NeedsWorkerThreads()) {
             int64 remaining_time = next_check - Env::Default()->NowMicros();
             VLOG(3) << "Task thread manager waiting for " << remaining_time
                     << "us";
@@ -357,10 +399,12 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
             return;
           }
         }
-        UpdateTasks();
+        if (Env::Default()->NowMicros() >= next_check) {
+          UpdateTasks();
+          next_check = Env::Default()->NowMicros() +
+                       dataset()->task_refresh_interval_ms_ * 1000;
+        }
         UpdateWorkerThreads(ctx.get());
-        next_check = Env::Default()->NowMicros() +
-                     dataset()->task_refresh_interval_ms_ * 1000;
       }
     }
 
@@ -403,8 +447,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       for (auto& new_task_entry : task_id_to_task) {
         TaskInfo& task_info = new_task_entry.second;
         std::unique_ptr<DataServiceWorkerClient> worker;
-        Status s = CreateDataServiceWorkerClient(task_info.worker_address(),
-                                                 dataset()->protocol_, worker);
+        Status s = CreateDataServiceWorkerClient(
+            task_info.worker_address(), dataset()->protocol_,
+            dataset()->local_reads_, worker);
         if (!s.ok()) {
           status_ = s;
           get_next_cv_.notify_all();
@@ -414,21 +459,71 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                                                 task_info.worker_address(),
                                                 std::move(worker)));
       }
+      UpdateMaxOutstandingRequests();
+    }
+
+    // With autotuning, buffers room for a full request for every request the
+    // tasks may have in flight.
+    void UpdateMaxOutstandingRequests() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (dataset()->max_outstanding_requests_ == model::kAutotune) {
-        // Adjust max_outstanding_requests to account for newly added tasks.
-        max_outstanding_requests_ = tasks_.size();
+        max_outstanding_requests_ =
+            MaxRequestsInFlight() * ElementsPerRequest();
       }
     }
 
+    // Returns the most elements to reserve buffer space for in one request.
+    // With autotuning, that is as many of the elements received so far as fit
+    // in `kMaxBytesPerRequest` on average, so that batching requests does not
+    // multiply the memory held for large elements. Until an element has been
+    // received, it is one.
+    int64 ElementsPerRequest() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (dataset()->max_outstanding_requests_ != model::kAutotune) {
+        return elements_per_request_;
+      }
+      if (num_received_elements_ == 0) {
+        return 1;
+      }
+      const int64 average_element_bytes =
+          std::max<int64>(1, received_bytes_ / num_received_elements_);
+      return std::max<int64>(
+          1, std::min(elements_per_request_,
+                      kMaxBytesPerRequest / average_element_bytes));
+    }
+
+    // Returns the number of requests the unfinished tasks may have in flight.
+    int64 MaxRequestsInFlight() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64 result = 0;
+      for (const auto& task : tasks_) {
+        if (!task->end_of_sequence) {
+          result += task->in_flight_limit.limit();
+        }
+      }
+      return result;
+    }
+
+    // Returns the number of worker threads to run: one per request the tasks
+    // may have in flight, but no more than the requests the buffer can hold
+    // when `max_outstanding_requests` is set.
+    int64 TargetWorkerThreads() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64 result = MaxRequestsInFlight();
+      if (dataset()->max_outstanding_requests_ != model::kAutotune) {
+        result = std::min(result, max_outstanding_requests_);
+      }
+      return result;
+    }
+
+    bool NeedsWorkerThreads() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return !job_finished_ &&
+             num_running_worker_threads_ < TargetWorkerThreads();
+    }
+
     void UpdateWorkerThreads(IteratorContext* ctx) TF_LOCKS_EXCLUDED(mu_) {
       mutex_lock l(mu_);
-      while (num_running_worker_threads_ < max_outstanding_requests_) {
+      while (num_running_worker_threads_ < TargetWorkerThreads()) {
         num_running_worker_threads_++;
-        outstanding_requests_++;
         auto done = [this]() {
           mutex_lock l(mu_);
           num_running_worker_threads_--;
-          outstanding_requests_--;
           get_next_cv_.notify_all();
         };
         worker_threads_.push_back(ctx->StartThread(
@@ -444,21 +539,17 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         VLOG(1) << "Worker thread exiting";
       });
       VLOG(1) << "Starting worker thread";
-      std::shared_ptr<Task> task_to_process;
       while (true) {
+        std::shared_ptr<Task> task_to_process;
+        int64 num_elements;
+        int64 consumer_waits;
         {
           mutex_lock l(mu_);
-          if (task_to_process) {
-            task_to_process->in_use = false;
-            task_to_process = nullptr;
-            worker_thread_cv_.notify_one();
-          }
-          outstanding_requests_--;
           while (!cancelled_ && !(SpaceInBuffer() && TaskAvailable()) &&
                  !job_finished_) {
             if (VLOG_IS_ON(3)) {
               VLOG(3) << "Sleeping with results_.size=" << results_.size()
-                      << ", outstanding_requests_=" << outstanding_requests_
+                      << ", outstanding_elements_=" << outstanding_elements_
                       << ", max_oustanding_requests="
                       << max_outstanding_requests_
                       << " finished_tasks=" << finished_tasks_
@@ -466,7 +557,6 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
             }
             worker_thread_cv_.wait(l);
           }
-          outstanding_requests_++;
           if (cancelled_ || job_finished_) {
             return;
           }
@@ -475,23 +565,35 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           for (int i = 0; i < num_tasks; ++i) {
             int index = (next_task_index_ + i) % num_tasks;
             std::shared_ptr<Task>& task = tasks_[index];
-            if (!task->in_use && !task->end_of_sequence) {
-              task->in_use = true;
+            if (CanRequest(*task)) {
+              task->num_in_flight++;
               task_to_process = task;
               next_task_index_ = (index + 1) % num_tasks;
               break;
             }
           }
           DCHECK(task_to_process != nullptr);
+          // Reserves buffer space for the elements requested.
+          num_elements = std::min<int64>(
+              ElementsPerRequest(),
+              max_outstanding_requests_ - results_.size() -
+                  outstanding_elements_);
+          outstanding_elements_ += num_elements;
+          consumer_waits = num_consumer_waits_;
           VLOG(3) << "Processing task " << task_to_process->task_id;
         }
+        const int64 start_micros = EnvTime::NowMicros();
         int64 deadline_micros = kint64max;
-        Status s = GetElement(task_to_process.get(), deadline_micros);
+        Status s =
+            GetElements(task_to_process.get(), num_elements, deadline_micros);
+        const int64 latency_micros = EnvTime::NowMicros() - start_micros;
+        mutex_lock l(mu_);
+        outstanding_elements_ -= num_elements;
+        task_to_process->num_in_flight--;
+        worker_thread_cv_.notify_one();
         if (!s.ok()) {
-          mutex_lock l(mu_);
           VLOG(1) << "Failed to get element from worker "
                   << task_to_process->address << ": " << s;
-          task_to_process->in_use = false;
           status_ = Status(
               s.code(),
               absl::StrCat("Failed to get element from worker ",
@@ -499,24 +601,42 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           get_next_cv_.notify_all();
           return;
         }
+        const int64 limit = task_to_process->in_flight_limit.limit();
+        task_to_process->in_flight_limit.RecordLatency(
+            latency_micros, /*consumer_waited=*/num_consumer_waits_ >
+                                consumer_waits);
+        if (task_to_process->in_flight_limit.limit() != limit) {
+          VLOG(2) << "Keeping " << task_to_process->in_flight_limit.limit()
+                  << " requests in flight for task "
+                  << task_to_process->task_id;
+          UpdateMaxOutstandingRequests();
+          worker_thread_cv_.notify_all();
+          if (NeedsWorkerThreads()) {
+            manager_thread_cv_.notify_one();
+          }
+        }
       }
     }
 
-    // Gets an element from a task and adds the element to `results_`.
+    // Gets up to `max_elements` elements from a task in one request and adds
+    // them to `results_`.
     //
     // If the task reaches end_of_sequence or is cancelled (e.g. due to a
-    // worker dying), GetElement returns Status::OK() without adding to
-    // `results_`.
-    Status GetElement(Task* task, int64 deadline_micros)
+    // worker dying), GetElements marks it finished after adding the elements
+    // returned with end_of_sequence, if any.
+    Status GetElements(Task* task, int64 max_elements, int64 deadline_micros)
         TF_LOCKS_EXCLUDED(mu_) {
-      VLOG(3) << "Getting an element for task id " << task->task_id;
+      VLOG(3) << "Getting " << max_elements << " elements for task id "
+              << task->task_id;
       tensorflow::profiler::TraceMe activity(
           "GetDataServiceElement", tensorflow::profiler::TraceMeLevel::kInfo);
-      CompressedElement compressed;
+      std::vector<std::vector<Tensor>> elements;
       bool end_of_sequence;
       for (int num_retries = 0;; ++num_retries) {
-        Status s = task->worker->GetElement(task->task_id, compressed,
-                                            end_of_sequence);
+        elements.clear();
+        Status s = task->worker->GetElements(task->task_id, max_elements,
+                                             kMaxBytesPerRequest, elements,
+                                             end_of_sequence);
         if (s.ok()) {
           break;
         }
@@ -552,34 +672,59 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         Env::Default()->SleepForMicroseconds(backoff_until - now_micros);
       }
 
-      std::vector<Tensor> element;
-      if (!end_of_sequence) {
-        Tensor tensor(DT_VARIANT, TensorShape{});
-        tensor.scalar<Variant>()() = std::move(compressed);
-        element.push_back(tensor);
+      for (const auto& element : elements) {
+        if (element.size() != dataset()->output_dtypes().size()) {
+          return errors::FailedPrecondition(
+              "Expected an element with ", dataset()->output_dtypes().size(),
+              " components from worker ", task->address, ", but got ",
+              element.size());
+        }
       }
       mutex_lock l(mu_);
-      if (end_of_sequence) {
+      for (auto& element : elements) {
+        for (const Tensor& tensor : element) {
+          received_bytes_ += tensor.TotalBytes();
+        }
+        num_received_elements_++;
+        results_.push(std::move(element));
+      }
+      if (!elements.empty()) {
+        UpdateMaxOutstandingRequests();
+        get_next_cv_.notify_all();
+      }
+      // Other requests for the task may have seen end_of_sequence first.
+      if (end_of_sequence && !task->end_of_sequence) {
         task->end_of_sequence = true;
         finished_tasks_++;
-        return Status::OK();
+        UpdateMaxOutstandingRequests();
       }
-      results_.push(std::move(element));
-      get_next_cv_.notify_all();
-      VLOG(3) << "Got an element for task id " << task->task_id;
+      VLOG(3) << "Got " << elements.size() << " elements for task id "
+              << task->task_id;
       return Status::OK();
     }
 
     bool SpaceInBuffer() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-      return results_.size() + outstanding_requests_ <
+      return results_.size() + outstanding_elements_ <
              max_outstanding_requests_;
     }
 
+    bool CanRequest(const Task& task) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return !task.end_of_sequence &&
+             task.num_in_flight < task.in_flight_limit.limit();
+    }
+
     bool TaskAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-      return finished_tasks_ + outstanding_requests_ < tasks_.size();
+      for (const auto& task : tasks_) {
+        if (CanRequest(*task)) {
+          return true;
+        }
+      }
+      return false;
     }
 
     const int64 iterator_index_;
+    // The most elements to fetch from a worker in one request.
+    const int64 elements_per_request_;
 
     mutable mutex mu_;
     condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
@@ -589,11 +734,19 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     // Method for deregistering the cancellation callback.
     std::function<void()> deregister_fn_;
 
-    int64 outstanding_requests_ TF_GUARDED_BY(mu_) = 0;
+    // The number of elements requested by the requests in flight.
+    int64 outstanding_elements_ TF_GUARDED_BY(mu_) = 0;
     // max_outstanding_requests controls how many elements may be held in memory
-    // at the same time. This count includes both in-progress requests for
-    // elements as well as completed requests which haven't yet been produced.
+    // at the same time. This count includes both elements requested by
+    // in-progress requests as well as received elements which haven't yet
+    // been produced.
     int64 max_outstanding_requests_ TF_GUARDED_BY(mu_);
+    // The bytes and number of the elements received so far.
+    int64 received_bytes_ TF_GUARDED_BY(mu_) = 0;
+    int64 num_received_elements_ TF_GUARDED_BY(mu_) = 0;
+
+    // The number of GetNext calls which found no elements to produce.
+    int64 num_consumer_waits_ TF_GUARDED_BY(mu_) = 0;
 
     // The number of threads in `worker_threads_` which are still running.
     int64 num_running_worker_threads_ TF_GUARDED_BY(mu_) = 0;
@@ -629,6 +782,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
   const tstring job_name_;
   const int64 max_outstanding_requests_;
   const int64 task_refresh_interval_ms_;
+  const int64 elements_per_request_;
+  const bool local_reads_;
   IterationCounter* const iteration_counter_;  // Owned
   const bool owns_resource_;
   const ResourceHandle iteration_counter_handle_;
@@ -644,6 +799,13 @@ DataServiceDatasetOp::DataServiceDatasetOp(OpKernelConstruction* ctx)
   if (task_refresh_interval_hint_ms_ == model::kAutotune) {
     task_refresh_interval_hint_ms_ = kDefaultTaskRefreshIntervalMs;
   }
+  OP_REQUIRES_OK(
+      ctx, ctx->GetAttribute(kElementsPerRequest, &elements_per_request_));
+  OP_REQUIRES(ctx, elements_per_request_ > 0,
+              errors::InvalidArgument(kElementsPerRequest,
+                                      " must be positive, but was ",
+                                      elements_per_request_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttribute(kLocalReads, &local_reads_));
   OP_REQUIRES_OK(ctx, ctx->GetAttribute(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttribute(kOutputShapes, &output_shapes_));
 }
@@ -715,8 +877,9 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
   *output =
       new Dataset(ctx, dataset_id, processing_mode, address, protocol, job_name,
                   max_outstanding_requests, task_refresh_interval_hint_ms_,
-                  iteration_counter, owns_resource, iteration_counter_handle,
-                  output_types_, output_shapes_);
+                  elements_per_request_, local_reads_, iteration_counter,
+                  owns_resource, iteration_counter_handle, output_types_,
+                  output_shapes_);
 }
 
 REGISTER_KERNEL_BUILDER(Name("DataServiceDataset").Device(DEVICE_CPU),
@@ -56,6 +56,9 @@ class DataServiceDatasetOp : public DatasetOpKernel {
       "max_outstanding_requests";
   static constexpr const char* const kTaskRefreshIntervalHintMs =
       "task_refresh_interval_hint_ms";
+  static constexpr const char* const kElementsPerRequest =
+      "elements_per_request";
+  static constexpr const char* const kLocalReads = "local_reads";
   static constexpr const char* const kIterationCounter = "iteration_counter";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
@@ -71,6 +74,8 @@ class DataServiceDatasetOp : public DatasetOpKernel {
   class Dataset;
 
   int64 task_refresh_interval_hint_ms_;
+  int64 elements_per_request_;
+  bool local_reads_;
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
 };
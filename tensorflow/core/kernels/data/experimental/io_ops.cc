@@ -119,7 +119,8 @@ Status SaveDatasetOp::WriteData(OpKernelContext* ctx, DatasetBase* dataset,
       auto writer_thread = std::make_unique<snapshot_util::AsyncWriter>(
           ctx->env(), shard_index, snapshot_shard_directory,
           /*checkpoint_id=*/0, compression_, kFileFormatVersion,
-          dataset->output_dtypes(), [&mu, &status](Status s) {
+          dataset->output_dtypes(), /*num_threads=*/0,
+          [&mu, &status](Status s) {
             mutex_lock l(mu);
             status.Update(s);
           });
@@ -305,7 +306,7 @@ class LoadDatasetOp::Dataset : public DatasetBase {
           ctx->env(), snapshot_shard_dirs, dataset()->compression_,
           dataset()->metadata_.version(), dataset()->output_dtypes(),
           dataset()->output_shapes(), /*start_index=*/0,
-          &dataset_of_snapshot_files));
+          /*num_threads=*/0, &dataset_of_snapshot_files));
 
       Tensor input_dataset_tensor(DT_VARIANT, TensorShape({}));
       TF_RETURN_IF_ERROR(StoreDatasetInVariantTensor(dataset_of_snapshot_files,
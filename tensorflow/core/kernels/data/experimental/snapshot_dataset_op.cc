@@ -83,6 +83,10 @@ namespace experimental {
     SnapshotDatasetV2Op::kReaderFuncTarguments;
 /* static */ constexpr const char* const
     SnapshotDatasetV2Op::kShardFuncTarguments;
+/* static */ constexpr const char* const
+    SnapshotDatasetV2Op::kCompressionThreads;
+/* static */ constexpr const char* const
+    SnapshotDatasetV2Op::kDecompressionThreads;
 /* static */ constexpr const int SnapshotDatasetV2Op::kFileFormatVersion;
 
 // ==== Snapshot Implementation ====
@@ -121,7 +125,8 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           const std::string& path, const std::string& compression,
           const std::string& reader_prefix, const std::string& writer_prefix,
           std::unique_ptr<CapturedFunction> reader_func,
-          std::unique_ptr<CapturedFunction> shard_func);
+          std::unique_ptr<CapturedFunction> shard_func,
+          int64 compression_threads, int64 decompression_threads);
 
   ~Dataset() override;
 
@@ -156,6 +161,11 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
   std::unique_ptr<CapturedFunction> reader_func_;
   std::unique_ptr<CapturedFunction> shard_func_;
 
+  // Number of threads used to encode (resp. decode) elements of the snapshot
+  // files. These only affect performance, so they are not part of the hash.
+  const int64 compression_threads_;
+  const int64 decompression_threads_;
+
   class Iterator;
 };
 
@@ -310,7 +320,8 @@ SnapshotDatasetV2Op::Dataset::Dataset(
     const std::string& path, const std::string& compression,
     const std::string& reader_prefix, const std::string& writer_prefix,
     std::unique_ptr<CapturedFunction> reader_func,
-    std::unique_ptr<CapturedFunction> shard_func)
+    std::unique_ptr<CapturedFunction> shard_func, int64 compression_threads,
+    int64 decompression_threads)
     : DatasetBase(DatasetContext(ctx)),
       input_(input),
       hash_(hash),
@@ -319,7 +330,9 @@ SnapshotDatasetV2Op::Dataset::Dataset(
       reader_prefix_(reader_prefix),
       writer_prefix_(writer_prefix),
       reader_func_(std::move(reader_func)),
-      shard_func_(std::move(shard_func)) {
+      shard_func_(std::move(shard_func)),
+      compression_threads_(compression_threads),
+      decompression_threads_(decompression_threads) {
   input_->Ref();
 }
 
@@ -405,6 +418,12 @@ Status SnapshotDatasetV2Op::Dataset::AsGraphDefInternal(
   b->BuildAttrValue(shard_func_other_args_types,
                     &shard_func_arguments_types_attr);
 
+  AttrValue compression_threads_attr;
+  b->BuildAttrValue(compression_threads_, &compression_threads_attr);
+
+  AttrValue decompression_threads_attr;
+  b->BuildAttrValue(decompression_threads_, &decompression_threads_attr);
+
   return b->AddDataset(
       this,
       /*inputs=*/
@@ -421,7 +440,9 @@ Status SnapshotDatasetV2Op::Dataset::AsGraphDefInternal(
        {kReaderFunc, reader_func_attr},
        {kShardFunc, shard_func_attr},
        {kReaderFuncTarguments, reader_func_arguments_types_attr},
-       {kShardFuncTarguments, shard_func_arguments_types_attr}},
+       {kShardFuncTarguments, shard_func_arguments_types_attr},
+       {kCompressionThreads, compression_threads_attr},
+       {kDecompressionThreads, decompression_threads_attr}},
       output);
 }
 
@@ -579,7 +600,8 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Reader::Initialize(
   TF_RETURN_IF_ERROR(snapshot_util::Reader::MakeNestedDataset(
       ctx->env(), snapshot_shard_dirs, dataset()->compression_,
       metadata.version(), dataset()->output_dtypes(),
-      dataset()->output_shapes(), start_index_, &dataset_of_snapshot_files));
+      dataset()->output_shapes(), start_index_,
+      dataset()->decompression_threads_, &dataset_of_snapshot_files));
 
   Tensor input_dataset_tensor(DT_VARIANT, TensorShape({}));
   TF_RETURN_IF_ERROR(StoreDatasetInVariantTensor(dataset_of_snapshot_files,
@@ -755,7 +777,8 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Writer::GetNextInternal(
       auto writer = std::make_unique<snapshot_util::AsyncWriter>(
           ctx->env(), shard_index, snapshot_shard_directory,
           current_checkpoint_id_, dataset()->compression_, kFileFormatVersion,
-          dataset()->output_dtypes(), [this](Status s) {
+          dataset()->output_dtypes(), dataset()->compression_threads_,
+          [this](Status s) {
             if (!s.ok()) {
               LOG(ERROR) << "AsyncWriter in snapshot writer failed: " << s;
               mutex_lock l(writer_status_mu_);
@@ -852,6 +875,25 @@ SnapshotDatasetV2Op::SnapshotDatasetV2Op(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttribute(kHash, &hash));
   hash_ = static_cast<uint64>(hash);
 
+  compression_threads_ = 0;
+  if (ctx->HasAttr(kCompressionThreads)) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttribute(kCompressionThreads, &compression_threads_));
+  }
+  OP_REQUIRES(ctx, compression_threads_ >= 0,
+              errors::InvalidArgument("`", kCompressionThreads,
+                                      "` must be non-negative, but got ",
+                                      compression_threads_, "."));
+  decompression_threads_ = 0;
+  if (ctx->HasAttr(kDecompressionThreads)) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttribute(kDecompressionThreads, &decompression_threads_));
+  }
+  OP_REQUIRES(ctx, decompression_threads_ >= 0,
+              errors::InvalidArgument("`", kDecompressionThreads,
+                                      "` must be non-negative, but got ",
+                                      decompression_threads_, "."));
+
   OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kReaderFunc, reader_params,
                                                &reader_func_metadata_));
   OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kShardFunc, shard_params,
@@ -895,7 +937,8 @@ void SnapshotDatasetV2Op::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
 
   *output = new SnapshotDatasetV2Op::Dataset(
       ctx, input, hash, path, compression, reader_prefix_, writer_prefix_,
-      std::move(reader_func), std::move(shard_func));
+      std::move(reader_func), std::move(shard_func), compression_threads_,
+      decompression_threads_);
 }
 
 namespace {
@@ -982,6 +1025,18 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
       OP_REQUIRES_OK(ctx, ctx->GetAttribute("snapshot_name", &snapshot_name_));
     }
 
+    compression_threads_ = 0;
+    if (ctx->HasAttr("compression_threads")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttribute("compression_threads",
+                                            &compression_threads_));
+    }
+
+    decompression_threads_ = 0;
+    if (ctx->HasAttr("decompression_threads")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttribute("decompression_threads",
+                                            &decompression_threads_));
+    }
+
     if (shard_size_bytes_ == -1) shard_size_bytes_ = kDefaultShardSizeBytes;
 
     // Default to 1 day expiry for snapshots.
@@ -1007,6 +1062,14 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         errors::InvalidArgument(
             "pending_snapshot_expiry_seconds must be at least 1 second."));
 
+    OP_REQUIRES(ctx, compression_threads_ >= 0,
+                errors::InvalidArgument(
+                    "compression_threads must be non-negative."));
+
+    OP_REQUIRES(ctx, decompression_threads_ >= 0,
+                errors::InvalidArgument(
+                    "decompression_threads must be non-negative."));
+
     OP_REQUIRES(ctx,
                 mode_ == snapshot_util::kModeAuto ||
                     mode_ == snapshot_util::kModeRead ||
@@ -1054,7 +1117,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
                           pending_snapshot_expiry_seconds_, num_reader_threads_,
                           reader_buffer_size_, num_writer_threads_,
                           writer_buffer_size_, shuffle_on_read_, seed_, seed2_,
-                          mode_, snapshot_name_);
+                          mode_, snapshot_name_, compression_threads_,
+                          decompression_threads_);
   }
 
  private:
@@ -1068,7 +1132,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
             const uint64 num_reader_threads, const uint64 reader_buffer_size,
             const uint64 num_writer_threads, const uint64 writer_buffer_size,
             const bool shuffle_on_read, const uint64 seed, const uint64 seed2,
-            const std::string& mode, const std::string& snapshot_name)
+            const std::string& mode, const std::string& snapshot_name,
+            const int64 compression_threads,
+            const int64 decompression_threads)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           dir_(path),
@@ -1086,7 +1152,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           seed_(seed),
           seed2_(seed2),
           mode_(mode),
-          snapshot_name_(snapshot_name) {
+          snapshot_name_(snapshot_name),
+          compression_threads_(compression_threads),
+          decompression_threads_(decompression_threads) {
       input_->Ref();
     }
 
@@ -1173,6 +1241,13 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
       AttrValue snapshot_name_attr;
       b->BuildAttrValue(snapshot_name_, &snapshot_name_attr);
 
+      AttrValue compression_threads_attr;
+      b->BuildAttrValue<int64>(compression_threads_, &compression_threads_attr);
+
+      AttrValue decompression_threads_attr;
+      b->BuildAttrValue<int64>(decompression_threads_,
+                               &decompression_threads_attr);
+
       TF_RETURN_IF_ERROR(b->AddDataset(
           this,
           /*inputs=*/
@@ -1194,7 +1269,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
            {"seed", seed_attr},
            {"seed2", seed2_attr},
            {"mode", mode_attr},
-           {"snapshot_name", snapshot_name_attr}},
+           {"snapshot_name", snapshot_name_attr},
+           {"compression_threads", compression_threads_attr},
+           {"decompression_threads", decompression_threads_attr}},
           output));
       return Status::OK();
     }
@@ -1588,7 +1665,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           std::unique_ptr<snapshot_util::Reader> reader;
           TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
               env, filename, dataset()->compression_, version_,
-              dataset()->output_dtypes(), &reader));
+              dataset()->output_dtypes(), dataset()->decompression_threads_,
+              &reader));
           while (true) {
             // Wait for a slot in the buffer.
             {
@@ -2165,7 +2243,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
               TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
                   env, *snapshot_data_filename, dataset()->compression_,
-                  kCurrentVersion, dataset()->output_dtypes(), writer));
+                  kCurrentVersion, dataset()->output_dtypes(),
+                  dataset()->compression_threads_, writer));
               *bytes_written = 0;
             }
             TF_RETURN_IF_ERROR((*writer)->WriteTensors(elem.value));
@@ -2208,7 +2287,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           std::unique_ptr<snapshot_util::Writer> writer;
           Status s = snapshot_util::Writer::Create(
               env, snapshot_data_filename, dataset()->compression_,
-              kCurrentVersion, dataset()->output_dtypes(), &writer);
+              kCurrentVersion, dataset()->output_dtypes(),
+              dataset()->compression_threads_, &writer);
           if (!s.ok()) {
             LOG(ERROR) << "Creating " << snapshot_data_filename
                        << " failed: " << s.ToString();
@@ -2366,6 +2446,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
     const std::string mode_;
     const std::string snapshot_name_;
+
+    const int64 compression_threads_;
+    const int64 decompression_threads_;
   };
 
   Status ComputeDatasetHash(const GraphDef& graph_def, const std::string& path,
@@ -2402,6 +2485,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
   std::string mode_;
   std::string snapshot_name_;
+
+  int64 compression_threads_;
+  int64 decompression_threads_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("SnapshotDataset").Device(DEVICE_CPU),
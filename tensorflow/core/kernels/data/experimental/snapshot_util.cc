@@ -79,18 +79,129 @@ std::string GetCheckpointFileName(const std::string& shard_directory,
                       static_cast<unsigned long long>(checkpoint_id)));
 }
 
+ParallelEncoder::ParallelEncoder(Env* env, const std::string& name,
+                                 int64 num_threads, EncodeFn encode_fn,
+                                 WriteFn write_fn)
+    : num_threads_(num_threads),
+      encode_fn_(std::move(encode_fn)),
+      write_fn_(std::move(write_fn)),
+      thread_pool_(absl::make_unique<thread::ThreadPool>(
+          env, ThreadOptions(), name, num_threads,
+          /*low_latency_hint=*/false)) {}
+
+Status ParallelEncoder::Add(const std::vector<Tensor>& tensors) {
+  auto element = std::make_shared<EncodedElement>();
+  {
+    mutex_lock l(mu_);
+    encoded_elements_.push_back(element);
+  }
+  thread_pool_->Schedule([this, tensors, element]() {
+    std::vector<std::string> records;
+    Status s = encode_fn_(tensors, &records);
+    mutex_lock l(mu_);
+    element->records = std::move(records);
+    element->status = s;
+    element->done = true;
+    encoded_cv_.notify_all();
+  });
+  // Keeps the pool busy while bounding the elements held in memory.
+  return WriteEncodedElements(/*max_pending=*/2 * num_threads_);
+}
+
+Status ParallelEncoder::Flush() {
+  return WriteEncodedElements(/*max_pending=*/0);
+}
+
+Status ParallelEncoder::WriteEncodedElements(size_t max_pending) {
+  while (true) {
+    std::shared_ptr<EncodedElement> element;
+    {
+      mutex_lock l(mu_);
+      if (encoded_elements_.empty() ||
+          (!encoded_elements_.front()->done &&
+           encoded_elements_.size() <= max_pending)) {
+        return Status::OK();
+      }
+      element = encoded_elements_.front();
+      while (!element->done) {
+        encoded_cv_.wait(l);
+      }
+      encoded_elements_.pop_front();
+    }
+    TF_RETURN_IF_ERROR(element->status);
+    for (const auto& record : element->records) {
+      TF_RETURN_IF_ERROR(write_fn_(record));
+    }
+  }
+}
+
+ParallelDecoder::ParallelDecoder(Env* env, const std::string& name,
+                                 int64 num_threads, ReadFn read_fn,
+                                 DecodeFn decode_fn)
+    : num_threads_(num_threads),
+      read_fn_(std::move(read_fn)),
+      decode_fn_(std::move(decode_fn)),
+      thread_pool_(absl::make_unique<thread::ThreadPool>(
+          env, ThreadOptions(), name, num_threads,
+          /*low_latency_hint=*/false)) {}
+
+Status ParallelDecoder::Next(std::vector<Tensor>* read_tensors) {
+  const size_t read_ahead = 2 * num_threads_;
+  while (read_ahead_status_.ok() && decoded_elements_.size() < read_ahead) {
+    std::vector<tstring> records;
+    read_ahead_status_ = read_fn_(&records);
+    if (!read_ahead_status_.ok()) {
+      break;
+    }
+    auto element = std::make_shared<DecodedElement>();
+    decoded_elements_.push_back(element);
+    thread_pool_->Schedule([this, element, records = std::move(records)]() {
+      std::vector<Tensor> tensors;
+      Status s = decode_fn_(records, &tensors);
+      mutex_lock l(mu_);
+      element->tensors = std::move(tensors);
+      element->status = s;
+      element->done = true;
+      decoded_cv_.notify_all();
+    });
+  }
+  if (decoded_elements_.empty()) {
+    return read_ahead_status_;
+  }
+  std::shared_ptr<DecodedElement> element = decoded_elements_.front();
+  decoded_elements_.pop_front();
+  mutex_lock l(mu_);
+  while (!element->done) {
+    decoded_cv_.wait(l);
+  }
+  TF_RETURN_IF_ERROR(element->status);
+  read_tensors->reserve(read_tensors->size() + element->tensors.size());
+  for (auto& tensor : element->tensors) {
+    read_tensors->push_back(std::move(tensor));
+  }
+  return Status::OK();
+}
+
 Status Writer::Create(Env* env, const std::string& filename,
                       const std::string& compression_type, int version,
                       const DataTypeVector& dtypes,
                       std::unique_ptr<Writer>* out_writer) {
+  return Create(env, filename, compression_type, version, dtypes,
+                /*num_threads=*/0, out_writer);
+}
+
+Status Writer::Create(Env* env, const std::string& filename,
+                      const std::string& compression_type, int version,
+                      const DataTypeVector& dtypes, int64 num_threads,
+                      std::unique_ptr<Writer>* out_writer) {
   switch (version) {
     case 1:
-      *out_writer =
-          absl::make_unique<CustomWriter>(filename, compression_type, dtypes);
+      *out_writer = absl::make_unique<CustomWriter>(filename, compression_type,
+                                                    dtypes, num_threads);
       break;
     case 2:
-      *out_writer =
-          absl::make_unique<TFRecordWriter>(filename, compression_type);
+      *out_writer = absl::make_unique<TFRecordWriter>(
+          filename, compression_type, num_threads);
       break;
     default:
       return errors::InvalidArgument("Snapshot writer version: ", version,
@@ -101,8 +212,11 @@ Status Writer::Create(Env* env, const std::string& filename,
 }
 
 TFRecordWriter::TFRecordWriter(const std::string& filename,
-                               const std::string& compression_type)
-    : filename_(filename), compression_type_(compression_type) {}
+                               const std::string& compression_type,
+                               int64 num_threads)
+    : filename_(filename),
+      compression_type_(compression_type),
+      num_threads_(num_threads) {}
 
 Status TFRecordWriter::Initialize(tensorflow::Env* env) {
   TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
@@ -110,10 +224,30 @@ Status TFRecordWriter::Initialize(tensorflow::Env* env) {
   record_writer_ = absl::make_unique<io::RecordWriter>(
       dest_.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
                        /*compression_type=*/compression_type_));
+  if (num_threads_ > 0) {
+    encoder_ = absl::make_unique<ParallelEncoder>(
+        env, "snapshot_compression", num_threads_,
+        [](const std::vector<Tensor>& tensors,
+           std::vector<std::string>* records) {
+          records->reserve(tensors.size());
+          for (const auto& tensor : tensors) {
+            TensorProto proto;
+            tensor.AsProtoTensorContent(&proto);
+            records->push_back(proto.SerializeAsString());
+          }
+          return Status::OK();
+        },
+        [this](const std::string& record) {
+          return record_writer_->WriteRecord(record);
+        });
+  }
   return Status::OK();
 }
 
 Status TFRecordWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+  if (encoder_) {
+    return encoder_->Add(tensors);
+  }
   for (const auto& tensor : tensors) {
     TensorProto proto;
     tensor.AsProtoTensorContent(&proto);
@@ -135,6 +269,9 @@ Status TFRecordWriter::WriteTensors(const std::vector<Tensor>& tensors) {
 }
 
 Status TFRecordWriter::Sync() {
+  if (encoder_) {
+    TF_RETURN_IF_ERROR(encoder_->Flush());
+  }
   TF_RETURN_IF_ERROR(record_writer_->Flush());
   return dest_->Flush();
 }
@@ -159,10 +296,11 @@ TFRecordWriter::~TFRecordWriter() {
 
 CustomWriter::CustomWriter(const std::string& filename,
                            const std::string& compression_type,
-                           const DataTypeVector& dtypes)
+                           const DataTypeVector& dtypes, int64 num_threads)
     : filename_(filename),
       compression_type_(compression_type),
-      dtypes_(dtypes) {}
+      dtypes_(dtypes),
+      num_threads_(num_threads) {}
 
 Status CustomWriter::Initialize(tensorflow::Env* env) {
   TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
@@ -194,11 +332,23 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
       num_complex_++;
     }
   }
+  if (num_threads_ > 0) {
+    encoder_ = absl::make_unique<ParallelEncoder>(
+        env, "snapshot_compression", num_threads_,
+        [this](const std::vector<Tensor>& tensors,
+               std::vector<std::string>* records) {
+          return EncodeTensors(tensors, records);
+        },
+        [this](const std::string& record) { return WriteRecord(record); });
+  }
 
   return Status::OK();
 }
 
 Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+  if (encoder_) {
+    return encoder_->Add(tensors);
+  }
   if (compression_type_ != io::compression::kSnappy) {
     experimental::SnapshotRecord record;
     for (const auto& tensor : tensors) {
@@ -217,16 +367,37 @@ Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
 #endif  // TF_CORD_SUPPORT
   }
 
+  experimental::SnapshotTensorMetadata metadata;
+  string output;
+  TF_RETURN_IF_ERROR(SnappyCompress(tensors, &metadata, &output));
+
+#if defined(TF_CORD_SUPPORT)
+  auto metadata_buffer = new std::string();
+  metadata.SerializeToString(metadata_buffer);
+  absl::Cord metadata_serialized = absl::MakeCordFromExternal(
+      *metadata_buffer,
+      [metadata_buffer](absl::string_view) { delete metadata_buffer; });
+#else
+  std::string metadata_serialized = metadata.SerializeAsString();
+#endif  // TF_CORD_SUPPORT
+  TF_RETURN_IF_ERROR(WriteRecord(metadata_serialized));
+  TF_RETURN_IF_ERROR(WriteRecord(output));
+  return Status::OK();
+}
+
+Status CustomWriter::SnappyCompress(
+    const std::vector<Tensor>& tensors,
+    experimental::SnapshotTensorMetadata* metadata,
+    std::string* compressed) const {
   std::vector<const TensorBuffer*> tensor_buffers;
   tensor_buffers.reserve(num_simple_);
   std::vector<TensorProto> tensor_protos;
   tensor_protos.reserve(num_complex_);
-  experimental::SnapshotTensorMetadata metadata;
   int64 total_size = 0;
   for (int i = 0, end = tensors.size(); i < end; ++i) {
     const Tensor& tensor = tensors[i];
     experimental::TensorMetadata* tensor_metadata =
-        metadata.add_tensor_metadata();
+        metadata->add_tensor_metadata();
     tensor.shape().AsProto(tensor_metadata->mutable_tensor_shape());
     int64 size = 0;
     if (simple_tensor_mask_[i]) {
@@ -248,7 +419,7 @@ Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
   int buffer_index = 0;
   int proto_index = 0;
   for (int i = 0, end = tensors.size(); i < end; ++i) {
-    const auto& tensor_metadata = metadata.tensor_metadata(i);
+    const auto& tensor_metadata = metadata->tensor_metadata(i);
     if (simple_tensor_mask_[i]) {
       memcpy(position, tensor_buffers[buffer_index]->data(),
              tensor_metadata.tensor_size_bytes());
@@ -262,29 +433,42 @@ Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
   }
   DCHECK_EQ(position, uncompressed.data() + total_size);
 
-  string output;
-  if (!port::Snappy_Compress(uncompressed.data(), total_size, &output)) {
+  if (!port::Snappy_Compress(uncompressed.data(), total_size, compressed)) {
     return errors::Internal("Failed to compress using snappy.");
   }
+  return Status::OK();
+}
 
-#if defined(TF_CORD_SUPPORT)
-  auto metadata_buffer = new std::string();
-  metadata.SerializeToString(metadata_buffer);
-  absl::Cord metadata_serialized = absl::MakeCordFromExternal(
-      *metadata_buffer,
-      [metadata_buffer](absl::string_view) { delete metadata_buffer; });
-#else
-  std::string metadata_serialized = metadata.SerializeAsString();
-#endif  // TF_CORD_SUPPORT
-  TF_RETURN_IF_ERROR(WriteRecord(metadata_serialized));
-  TF_RETURN_IF_ERROR(WriteRecord(output));
+Status CustomWriter::EncodeTensors(const std::vector<Tensor>& tensors,
+                                   std::vector<std::string>* records) const {
+  if (compression_type_ != io::compression::kSnappy) {
+    experimental::SnapshotRecord record;
+    for (const auto& tensor : tensors) {
+      tensor.AsProtoTensorContent(record.add_tensor());
+    }
+    records->push_back(record.SerializeAsString());
+    return Status::OK();
+  }
+  experimental::SnapshotTensorMetadata metadata;
+  std::string compressed;
+  TF_RETURN_IF_ERROR(SnappyCompress(tensors, &metadata, &compressed));
+  records->push_back(metadata.SerializeAsString());
+  records->push_back(std::move(compressed));
   return Status::OK();
 }
 
-Status CustomWriter::Sync() { return dest_->Sync(); }
+Status CustomWriter::Sync() {
+  if (encoder_) {
+    TF_RETURN_IF_ERROR(encoder_->Flush());
+  }
+  return dest_->Sync();
+}
 
 Status CustomWriter::Close() {
   if (dest_ != nullptr) {
+    if (encoder_) {
+      TF_RETURN_IF_ERROR(encoder_->Flush());
+    }
     TF_RETURN_IF_ERROR(dest_->Close());
     dest_ = nullptr;
   }
@@ -322,18 +506,26 @@ Status Reader::Create(Env* env, const std::string& filename,
                       const string& compression_type, int version,
                       const DataTypeVector& dtypes,
                       std::unique_ptr<Reader>* out_reader) {
+  return Create(env, filename, compression_type, version, dtypes,
+                /*num_threads=*/0, out_reader);
+}
+
+Status Reader::Create(Env* env, const std::string& filename,
+                      const string& compression_type, int version,
+                      const DataTypeVector& dtypes, int64 num_threads,
+                      std::unique_ptr<Reader>* out_reader) {
   switch (version) {
     // CustomReader is able to read a legacy snapshot file format (v0) though
     // custom writer doesn't have the ability to write it any more since it is
     // strictly worse than V1.
     case 0:
     case 1:
-      *out_reader = absl::make_unique<CustomReader>(filename, compression_type,
-                                                    version, dtypes);
+      *out_reader = absl::make_unique<CustomReader>(
+          filename, compression_type, version, dtypes, num_threads);
       break;
     case 2:
-      *out_reader =
-          absl::make_unique<TFRecordReader>(filename, compression_type, dtypes);
+      *out_reader = absl::make_unique<TFRecordReader>(
+          filename, compression_type, dtypes, num_threads);
       break;
     default:
       return errors::InvalidArgument("Snapshot reader version: ", version,
@@ -357,14 +549,16 @@ class Reader::Dataset : public DatasetBase {
   explicit Dataset(const std::string& shard_dir, const std::string& compression,
                    const int64 version, const DataTypeVector& dtypes,
                    const std::vector<PartialTensorShape>& shapes,
-                   const int64 start_index, DatasetContext::Params params)
+                   const int64 start_index, const int64 num_threads,
+                   DatasetContext::Params params)
       : DatasetBase(DatasetContext(std::move(params))),
         shard_dir_(shard_dir),
         compression_(compression),
         version_(version),
         dtypes_(dtypes),
         shapes_(shapes),
-        start_index_(start_index) {}
+        start_index_(start_index),
+        num_threads_(num_threads) {}
 
   const DataTypeVector& output_dtypes() const override { return dtypes_; }
 
@@ -406,7 +600,8 @@ class Reader::Dataset : public DatasetBase {
     Status Initialize(IteratorContext* ctx) override {
       TF_RETURN_IF_ERROR(Reader::Create(
           ctx->env(), GetCurrentFilename(), dataset()->compression_,
-          dataset()->version_, dataset()->dtypes_, &reader_));
+          dataset()->version_, dataset()->dtypes_, dataset()->num_threads_,
+          &reader_));
       bool end_of_sequence;
       for (int64 i = 0; i < dataset()->start_index_; ++i) {
         // TODO(frankchn): Optimize this to not parse every single element.
@@ -460,7 +655,8 @@ class Reader::Dataset : public DatasetBase {
       current_checkpoint_id_++;
       TF_RETURN_IF_ERROR(env->FileExists(GetCurrentFilename()));
       return Reader::Create(env, GetCurrentFilename(), dataset()->compression_,
-                            dataset()->version_, dataset()->dtypes_, &reader_);
+                            dataset()->version_, dataset()->dtypes_,
+                            dataset()->num_threads_, &reader_);
     }
 
     std::unique_ptr<Reader> reader_;
@@ -477,6 +673,7 @@ class Reader::Dataset : public DatasetBase {
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
   const int64 start_index_;
+  const int64 num_threads_;
 };
 
 class Reader::NestedDataset : public DatasetBase {
@@ -578,6 +775,7 @@ Status Reader::MakeNestedDataset(Env* env,
                                  const DataTypeVector& dtypes,
                                  const std::vector<PartialTensorShape>& shapes,
                                  const int64 start_index,
+                                 const int64 num_threads,
                                  DatasetBase** output) {
   std::vector<DatasetBase*> datasets;
 
@@ -592,7 +790,7 @@ Status Reader::MakeNestedDataset(Env* env,
 
     datasets.push_back(
         new Dataset(shard_dir, compression_type, version, dtypes, shapes,
-                    dataset_start_index,
+                    dataset_start_index, num_threads,
                     DatasetContext::Params({"snapshot_util::Reader::Dataset",
                                             "snapshot_util_reader_Dataset"})));
   }
@@ -611,11 +809,12 @@ Status Reader::MakeNestedDataset(Env* env,
 
 TFRecordReader::TFRecordReader(const std::string& filename,
                                const string& compression_type,
-                               const DataTypeVector& dtypes)
+                               const DataTypeVector& dtypes, int64 num_threads)
     : filename_(filename),
       offset_(0),
       compression_type_(compression_type),
-      dtypes_(dtypes) {}
+      dtypes_(dtypes),
+      num_threads_(num_threads) {}
 
 Status TFRecordReader::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
@@ -623,10 +822,44 @@ Status TFRecordReader::Initialize(Env* env) {
   record_reader_ = absl::make_unique<io::RecordReader>(
       file_.get(), io::RecordReaderOptions::CreateRecordReaderOptions(
                        /*compression_type=*/compression_type_));
+  if (num_threads_ > 0) {
+    decoder_ = absl::make_unique<ParallelDecoder>(
+        env, "snapshot_decompression", num_threads_,
+        [this](std::vector<tstring>* records) {
+          return ReadElementRecords(records);
+        },
+        &TFRecordReader::DecodeElementRecords);
+  }
+  return Status::OK();
+}
+
+Status TFRecordReader::ReadElementRecords(std::vector<tstring>* records) {
+  records->reserve(dtypes_.size());
+  for (int i = 0, end = dtypes_.size(); i < end; ++i) {
+    records->emplace_back();
+    TF_RETURN_IF_ERROR(record_reader_->ReadRecord(&offset_, &records->back()));
+  }
+  return Status::OK();
+}
+
+Status TFRecordReader::DecodeElementRecords(
+    const std::vector<tstring>& records, std::vector<Tensor>* read_tensors) {
+  read_tensors->reserve(records.size());
+  for (const tstring& record : records) {
+    TensorProto proto;
+    proto.ParseFromArray(record.data(), record.size());
+    read_tensors->emplace_back();
+    if (!read_tensors->back().FromProto(proto)) {
+      return errors::DataLoss("Unable to parse tensor from stored proto.");
+    }
+  }
   return Status::OK();
 }
 
 Status TFRecordReader::ReadTensors(std::vector<Tensor>* read_tensors) {
+  if (decoder_) {
+    return decoder_->Next(read_tensors);
+  }
   read_tensors->reserve(dtypes_.size());
   for (int i = 0; i < dtypes_.size(); ++i) {
     tstring record;
@@ -647,11 +880,12 @@ Status TFRecordReader::ReadTensors(std::vector<Tensor>* read_tensors) {
 
 CustomReader::CustomReader(const std::string& filename,
                            const string& compression_type, const int version,
-                           const DataTypeVector& dtypes)
+                           const DataTypeVector& dtypes, int64 num_threads)
     : filename_(filename),
       compression_type_(compression_type),
       version_(version),
-      dtypes_(dtypes) {}
+      dtypes_(dtypes),
+      num_threads_(num_threads) {}
 
 Status CustomReader::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
@@ -691,6 +925,17 @@ Status CustomReader::Initialize(Env* env) {
       num_complex_++;
     }
   }
+  if (num_threads_ > 0) {
+    decoder_ = absl::make_unique<ParallelDecoder>(
+        env, "snapshot_decompression", num_threads_,
+        [this](std::vector<tstring>* records) {
+          return ReadElementRecords(records);
+        },
+        [this](const std::vector<tstring>& records,
+               std::vector<Tensor>* tensors) {
+          return DecodeElementRecords(records, tensors);
+        });
+  }
 
   return Status::OK();
 }
@@ -699,6 +944,9 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
   profiler::TraceMe activity(
       [&]() { return absl::StrCat(kClassName, kSeparator, "ReadTensors"); },
       profiler::TraceMeLevel::kInfo);
+  if (decoder_) {
+    return decoder_->Next(read_tensors);
+  }
   if (version_ == 0 || compression_type_ != io::compression::kSnappy) {
     return ReadTensorsV0(read_tensors);
   }
@@ -716,14 +964,22 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
   if (!metadata.ParseFromArray(metadata_str.data(), metadata_str.size())) {
     return errors::DataLoss("Could not parse SnapshotTensorMetadata");
   }
+  tstring compressed;
+  TF_RETURN_IF_ERROR(ReadRecord(&compressed));
+  return DecodeSnappyElement(metadata, compressed, read_tensors);
+}
+
+Status CustomReader::DecodeSnappyElement(
+    const experimental::SnapshotTensorMetadata& metadata,
+    const tstring& compressed, std::vector<Tensor>* read_tensors) const {
   read_tensors->reserve(metadata.tensor_metadata_size());
 
   std::vector<Tensor> simple_tensors;
   simple_tensors.reserve(num_simple_);
   std::vector<std::pair<std::unique_ptr<char[]>, size_t>> tensor_proto_strs;
   tensor_proto_strs.reserve(num_complex_);
-  TF_RETURN_IF_ERROR(
-      SnappyUncompress(&metadata, &simple_tensors, &tensor_proto_strs));
+  TF_RETURN_IF_ERROR(SnappyUncompress(&metadata, compressed, &simple_tensors,
+                                      &tensor_proto_strs));
 
   int simple_index = 0;
   int complex_index = 0;
@@ -750,16 +1006,30 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
 }
 
 Status CustomReader::ReadTensorsV0(std::vector<Tensor>* read_tensors) {
-  experimental::SnapshotRecord record;
 #if defined(PLATFORM_GOOGLE)
+  experimental::SnapshotRecord record;
   absl::Cord c;
   TF_RETURN_IF_ERROR(ReadRecord(&c));
   record.ParseFromCord(c);
+  read_tensors->reserve(record.tensor_size());
+  for (int i = 0; i < record.tensor_size(); ++i) {
+    read_tensors->emplace_back();
+    if (!read_tensors->back().FromProto(record.tensor(i))) {
+      return errors::DataLoss("Unable to parse tensor from proto.");
+    }
+  }
+  return Status::OK();
 #else   // PLATFORM_GOOGLE
   tstring record_bytes;
   TF_RETURN_IF_ERROR(ReadRecord(&record_bytes));
-  record.ParseFromArray(record_bytes.data(), record_bytes.size());
+  return DecodeRecordV0(record_bytes, read_tensors);
 #endif  // PLATFORM_GOOGLE
+}
+
+Status CustomReader::DecodeRecordV0(const tstring& record_bytes,
+                                    std::vector<Tensor>* read_tensors) const {
+  experimental::SnapshotRecord record;
+  record.ParseFromArray(record_bytes.data(), record_bytes.size());
   read_tensors->reserve(record.tensor_size());
   for (int i = 0; i < record.tensor_size(); ++i) {
     read_tensors->emplace_back();
@@ -770,13 +1040,37 @@ Status CustomReader::ReadTensorsV0(std::vector<Tensor>* read_tensors) {
   return Status::OK();
 }
 
+Status CustomReader::ReadElementRecords(std::vector<tstring>* records) {
+  const int num_records =
+      (version_ == 0 || compression_type_ != io::compression::kSnappy) ? 1 : 2;
+  for (int i = 0; i < num_records; ++i) {
+    records->emplace_back();
+    TF_RETURN_IF_ERROR(ReadRecord(&records->back()));
+  }
+  return Status::OK();
+}
+
+Status CustomReader::DecodeElementRecords(
+    const std::vector<tstring>& records,
+    std::vector<Tensor>* read_tensors) const {
+  if (records.size() == 1) {
+    return DecodeRecordV0(records[0], read_tensors);
+  }
+  if (version_ != 1) {
+    return errors::InvalidArgument("Version: ", version_, " is not supported.");
+  }
+  experimental::SnapshotTensorMetadata metadata;
+  if (!metadata.ParseFromArray(records[0].data(), records[0].size())) {
+    return errors::DataLoss("Could not parse SnapshotTensorMetadata");
+  }
+  return DecodeSnappyElement(metadata, records[1], read_tensors);
+}
+
 Status CustomReader::SnappyUncompress(
     const experimental::SnapshotTensorMetadata* metadata,
-    std::vector<Tensor>* simple_tensors,
+    const tstring& compressed, std::vector<Tensor>* simple_tensors,
     std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
-        tensor_proto_strs) {
-  tstring compressed;
-  TF_RETURN_IF_ERROR(ReadRecord(&compressed));
+        tensor_proto_strs) const {
   size_t size;
   if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
                                           &size)) {
@@ -936,13 +1230,13 @@ AsyncWriter::AsyncWriter(Env* env, int64 file_index,
                          const std::string& shard_directory,
                          uint64 checkpoint_id, const std::string& compression,
                          int64 version, const DataTypeVector& output_types,
-                         std::function<void(Status)> done) {
+                         int64 num_threads, std::function<void(Status)> done) {
   thread_ = absl::WrapUnique(env->StartThread(
       ThreadOptions(), absl::StrCat("writer_thread_", file_index),
       [this, env, shard_directory, checkpoint_id, compression, version,
-       &output_types, done = std::move(done)] {
+       &output_types, num_threads, done = std::move(done)] {
         done(WriterThread(env, shard_directory, checkpoint_id, compression,
-                          version, output_types));
+                          version, output_types, num_threads));
       }));
 }
 
@@ -972,13 +1266,14 @@ bool AsyncWriter::ElementAvailable() { return !deque_.empty(); }
 Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
                                  uint64 checkpoint_id,
                                  const std::string& compression, int64 version,
-                                 DataTypeVector output_types) {
+                                 DataTypeVector output_types,
+                                 int64 num_threads) {
   std::unique_ptr<snapshot_util::Writer> writer;
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(shard_directory));
 
   TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
       env, GetCheckpointFileName(shard_directory, checkpoint_id), compression,
-      version, std::move(output_types), &writer));
+      version, std::move(output_types), num_threads, &writer));
 
   while (true) {
     ElementOrEOF be;
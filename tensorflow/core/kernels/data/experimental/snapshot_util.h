@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SNAPSHOT_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SNAPSHOT_UTIL_H_
 
+#include <deque>
+#include <functional>
+#include <memory>
+
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
@@ -25,8 +29,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -69,6 +75,90 @@ std::string ShardDirectory(const std::string& run_directory, int64 shard_id);
 std::string GetCheckpointFileName(const std::string& shard_directory,
                                   const uint64 checkpoint_id);
 
+// Encodes dataset elements into records on a pool of `num_threads` threads.
+// The records are written with `write_fn` by the thread calling Add or Flush,
+// in the order the elements were added.
+class ParallelEncoder {
+ public:
+  using EncodeFn = std::function<Status(const std::vector<Tensor>& tensors,
+                                        std::vector<std::string>* records)>;
+  using WriteFn = std::function<Status(const std::string& record)>;
+
+  ParallelEncoder(Env* env, const std::string& name, int64 num_threads,
+                  EncodeFn encode_fn, WriteFn write_fn);
+
+  // Starts encoding `tensors`, and writes the records of the elements encoded
+  // so far. Blocks while more than 2 * `num_threads` elements are pending, to
+  // bound the elements held in memory.
+  Status Add(const std::vector<Tensor>& tensors) TF_LOCKS_EXCLUDED(mu_);
+
+  // Waits for all added elements to be encoded and writes their records.
+  Status Flush() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct EncodedElement {
+    std::vector<std::string> records;
+    Status status;
+    bool done = false;
+  };
+
+  // Writes the encoded elements at the front of `encoded_elements_`, waiting
+  // for them to be encoded until at most `max_pending` elements are left.
+  Status WriteEncodedElements(size_t max_pending) TF_LOCKS_EXCLUDED(mu_);
+
+  const int64 num_threads_;
+  const EncodeFn encode_fn_;
+  const WriteFn write_fn_;
+  mutex mu_;
+  condition_variable encoded_cv_;
+  // Elements being encoded, in the order of the Add calls.
+  std::deque<std::shared_ptr<EncodedElement>> encoded_elements_
+      TF_GUARDED_BY(mu_);
+  // Destroyed first, so that encoding threads finish before the members they
+  // use are destroyed.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
+// Decodes dataset elements on a pool of `num_threads` threads. The records of
+// up to 2 * `num_threads` elements are read ahead with `read_fn`, and the
+// elements are returned in the order they were read.
+class ParallelDecoder {
+ public:
+  using ReadFn = std::function<Status(std::vector<tstring>* records)>;
+  using DecodeFn = std::function<Status(const std::vector<tstring>& records,
+                                        std::vector<Tensor>* tensors)>;
+
+  ParallelDecoder(Env* env, const std::string& name, int64 num_threads,
+                  ReadFn read_fn, DecodeFn decode_fn);
+
+  // Appends the tensors of the next element to `read_tensors`. Returns the
+  // error of `read_fn`, e.g. OutOfRange at the end of the file, once all
+  // elements read before it are returned.
+  Status Next(std::vector<Tensor>* read_tensors) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct DecodedElement {
+    std::vector<Tensor> tensors;
+    Status status;
+    bool done = false;
+  };
+
+  const int64 num_threads_;
+  const ReadFn read_fn_;
+  const DecodeFn decode_fn_;
+  mutex mu_;
+  condition_variable decoded_cv_;
+  // Elements being decoded, in file order. Only used by the thread calling
+  // Next; the elements' fields are guarded by `mu_`.
+  std::deque<std::shared_ptr<DecodedElement>> decoded_elements_;
+  // The status of reading the records after the last element in
+  // `decoded_elements_`.
+  Status read_ahead_status_;
+  // Destroyed first, so that decoding threads finish before the members they
+  // use are destroyed.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
 // This is a interface class that exposes snapshot writing functionality.
 class Writer {
  public:
@@ -78,6 +168,13 @@ class Writer {
                        const DataTypeVector& dtypes,
                        std::unique_ptr<Writer>* out_writer);
 
+  // Like Create above, but encodes up to `num_threads` elements in parallel
+  // if `num_threads` is positive.
+  static Status Create(Env* env, const std::string& filename,
+                       const std::string& compression_type, int version,
+                       const DataTypeVector& dtypes, int64 num_threads,
+                       std::unique_ptr<Writer>* out_writer);
+
   // Writes a vector of tensors to the snapshot writer file.
   virtual Status WriteTensors(const std::vector<Tensor>& tensors) = 0;
 
@@ -95,10 +192,15 @@ class Writer {
 };
 
 // Writes snapshots with the standard TFRecord file format.
+//
+// If `num_threads` is positive, tensors are serialized on a pool of
+// `num_threads` threads, and written to the file in order by the thread
+// calling WriteTensors. Compression runs on the writing thread, as the record
+// writer compresses the file as one stream.
 class TFRecordWriter : public Writer {
  public:
   TFRecordWriter(const std::string& filename,
-                 const std::string& compression_type);
+                 const std::string& compression_type, int64 num_threads = 0);
 
   Status WriteTensors(const std::vector<Tensor>& tensors) override;
 
@@ -117,9 +219,18 @@ class TFRecordWriter : public Writer {
 
   std::unique_ptr<WritableFile> dest_;
   std::unique_ptr<io::RecordWriter> record_writer_;
+  const int64 num_threads_;
+  // Null unless `num_threads_` is positive.
+  std::unique_ptr<ParallelEncoder> encoder_;
 };
 
 // Writes snapshot with a custom (legacy) file format.
+//
+// If `num_threads` is positive, elements are serialized and compressed on a
+// pool of `num_threads` threads, and written to the file in order by the
+// thread calling WriteTensors. Compression with snappy is done per element
+// and thus runs in parallel; gzip compresses the file as a stream, so only the
+// serialization runs in parallel.
 class CustomWriter : public Writer {
  public:
   static constexpr const size_t kHeaderSize = sizeof(uint64);
@@ -130,7 +241,7 @@ class CustomWriter : public Writer {
   static constexpr const char* const kSeparator = "::";
 
   CustomWriter(const std::string& filename, const std::string& compression_type,
-               const DataTypeVector& dtypes);
+               const DataTypeVector& dtypes, int64 num_threads = 0);
 
   Status WriteTensors(const std::vector<Tensor>& tensors) override;
 
@@ -150,6 +261,16 @@ class CustomWriter : public Writer {
   Status WriteRecord(const absl::Cord& data);
 #endif  // TF_CORD_SUPPORT
 
+  // Serializes `tensors` into one buffer, compresses it with snappy into
+  // `*compressed`, and describes the tensors in `*metadata`.
+  Status SnappyCompress(const std::vector<Tensor>& tensors,
+                        experimental::SnapshotTensorMetadata* metadata,
+                        std::string* compressed) const;
+
+  // Encodes `tensors` into the records to write for them.
+  Status EncodeTensors(const std::vector<Tensor>& tensors,
+                       std::vector<std::string>* records) const;
+
   std::unique_ptr<WritableFile> dest_;
   const std::string filename_;
   const std::string compression_type_;
@@ -161,6 +282,11 @@ class CustomWriter : public Writer {
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
   int num_simple_ = 0;
   int num_complex_ = 0;
+
+  const int64 num_threads_;
+  // Null unless `num_threads_` is positive. Destroyed first, so that encoding
+  // threads finish before the members they use are destroyed.
+  std::unique_ptr<ParallelEncoder> encoder_;
 };
 
 // Interface class for reading snapshot files previous written with Writer.
@@ -174,6 +300,13 @@ class Reader {
                        const DataTypeVector& dtypes,
                        std::unique_ptr<Reader>* out_reader);
 
+  // Like Create above, but decodes up to `num_threads` elements in parallel if
+  // `num_threads` is positive.
+  static Status Create(Env* env, const std::string& filename,
+                       const string& compression_type, int version,
+                       const DataTypeVector& dtypes, int64 num_threads,
+                       std::unique_ptr<Reader>* out_reader);
+
   // Returns a nested dataset for a set of given snapshot file names.
   //
   // This function takes a vector of snapshot files, and returns a nested
@@ -185,6 +318,7 @@ class Reader {
                                   const DataTypeVector& dtypes,
                                   const std::vector<PartialTensorShape>& shapes,
                                   const int64 start_index,
+                                  const int64 num_threads,
                                   DatasetBase** output);
 
   // Reads a vector of Tensors from the snapshot file.
@@ -204,10 +338,14 @@ class Reader {
 };
 
 // Reads snapshots previously written with `TFRecordWriter`.
+//
+// If `num_threads` is positive, the reader reads the records of up to
+// 2 * `num_threads` elements ahead, and parses them on a pool of `num_threads`
+// threads.
 class TFRecordReader : public Reader {
  public:
   TFRecordReader(const std::string& filename, const string& compression_type,
-                 const DataTypeVector& dtypes);
+                 const DataTypeVector& dtypes, int64 num_threads = 0);
 
   Status ReadTensors(std::vector<Tensor>* read_tensors) override;
 
@@ -217,6 +355,13 @@ class TFRecordReader : public Reader {
   Status Initialize(Env* env) override;
 
  private:
+  // Reads the records of the next element without parsing them.
+  Status ReadElementRecords(std::vector<tstring>* records);
+
+  // Parses the tensors of an element from its records.
+  static Status DecodeElementRecords(const std::vector<tstring>& records,
+                                     std::vector<Tensor>* read_tensors);
+
   std::string filename_;
   std::unique_ptr<RandomAccessFile> file_;
   std::unique_ptr<io::RecordReader> record_reader_;
@@ -224,9 +369,18 @@ class TFRecordReader : public Reader {
 
   const string compression_type_;
   const DataTypeVector dtypes_;
+
+  const int64 num_threads_;
+  // Null unless `num_threads_` is positive. Destroyed first, so that decoding
+  // threads finish before the members they use are destroyed.
+  std::unique_ptr<ParallelDecoder> decoder_;
 };
 
 // Reads snapshots previously written with `CustomWriter`.
+//
+// If `num_threads` is positive, the reader reads the records of up to
+// 2 * `num_threads` elements ahead, and decompresses and parses them on a pool
+// of `num_threads` threads.
 class CustomReader : public Reader {
  public:
   // The reader input buffer size is deliberately large because the input reader
@@ -245,7 +399,8 @@ class CustomReader : public Reader {
   static constexpr const char* const kSeparator = "::";
 
   CustomReader(const std::string& filename, const string& compression_type,
-               const int version, const DataTypeVector& dtypes);
+               const int version, const DataTypeVector& dtypes,
+               int64 num_threads = 0);
 
   Status ReadTensors(std::vector<Tensor>* read_tensors) override;
 
@@ -257,11 +412,28 @@ class CustomReader : public Reader {
  private:
   Status ReadTensorsV0(std::vector<Tensor>* read_tensors);
 
+  // Parses the tensors of a version 0 record, or of a record written without
+  // snappy compression.
+  Status DecodeRecordV0(const tstring& record,
+                        std::vector<Tensor>* read_tensors) const;
+
+  // Decompresses the tensors described by `metadata` from `compressed`.
+  Status DecodeSnappyElement(
+      const experimental::SnapshotTensorMetadata& metadata,
+      const tstring& compressed, std::vector<Tensor>* read_tensors) const;
+
   Status SnappyUncompress(
       const experimental::SnapshotTensorMetadata* metadata,
-      std::vector<Tensor>* simple_tensors,
+      const tstring& compressed, std::vector<Tensor>* simple_tensors,
       std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
-          tensor_proto_strs);
+          tensor_proto_strs) const;
+
+  // Reads the records of the next element without decoding them.
+  Status ReadElementRecords(std::vector<tstring>* records);
+
+  // Decodes an element from the records read by ReadElementRecords.
+  Status DecodeElementRecords(const std::vector<tstring>& records,
+                              std::vector<Tensor>* read_tensors) const;
 
   Status ReadRecord(tstring* record);
 
@@ -278,6 +450,11 @@ class CustomReader : public Reader {
   int num_simple_ = 0;
   int num_complex_ = 0;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
+
+  const int64 num_threads_;
+  // Null unless `num_threads_` is positive. Destroyed first, so that decoding
+  // threads finish before the members they use are destroyed.
+  std::unique_ptr<ParallelDecoder> decoder_;
 };
 
 // Writes snapshot metadata to the given directory.
@@ -319,10 +496,12 @@ struct ElementOrEOF {
 // writer = nullptr;  // This will block until writes are flushed.
 class AsyncWriter {
  public:
+  // The elements are encoded on `num_threads` threads if it is positive, see
+  // Writer::Create.
   explicit AsyncWriter(Env* env, int64 file_index,
                        const std::string& shard_directory, uint64 checkpoint_id,
                        const std::string& compression, int64 version,
-                       const DataTypeVector& output_types,
+                       const DataTypeVector& output_types, int64 num_threads,
                        std::function<void(Status)> done);
 
   // Writes the given tensors. The method is non-blocking and returns without
@@ -338,7 +517,8 @@ class AsyncWriter {
   bool ElementAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status WriterThread(Env* env, const std::string& shard_directory,
                       uint64 checkpoint_id, const std::string& compression,
-                      int64 version, DataTypeVector output_types);
+                      int64 version, DataTypeVector output_types,
+                      int64 num_threads);
 
   mutex mu_;
   std::deque<ElementOrEOF> deque_ TF_GUARDED_BY(mu_);
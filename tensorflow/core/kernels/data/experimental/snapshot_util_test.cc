@@ -38,7 +38,16 @@ void GenerateTensorVector(tensorflow::DataTypeVector& dtypes,
   }
 }
 
-void SnapshotRoundTrip(std::string compression_type, int version) {
+int64 ElementBytes(const std::vector<Tensor>& tensors) {
+  int64 bytes = 0;
+  for (const auto& tensor : tensors) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+void SnapshotRoundTrip(std::string compression_type, int version,
+                       int64 write_threads = 0, int64 read_threads = 0) {
   // Generate ground-truth tensors for writing and reading.
   std::vector<Tensor> tensors;
   tensorflow::DataTypeVector dtypes;
@@ -49,7 +58,8 @@ void SnapshotRoundTrip(std::string compression_type, int version) {
 
   std::unique_ptr<Writer> writer;
   TF_ASSERT_OK(Writer::Create(tensorflow::Env::Default(), filename,
-                              compression_type, version, dtypes, &writer));
+                              compression_type, version, dtypes, write_threads,
+                              &writer));
 
   for (int i = 0; i < 100; ++i) {
     TF_ASSERT_OK(writer->WriteTensors(tensors));
@@ -58,7 +68,7 @@ void SnapshotRoundTrip(std::string compression_type, int version) {
 
   std::unique_ptr<Reader> reader;
   TF_ASSERT_OK(Reader::Create(Env::Default(), filename, compression_type,
-                              version, dtypes, &reader));
+                              version, dtypes, read_threads, &reader));
 
   for (int i = 0; i < 100; ++i) {
     std::vector<Tensor> read_tensors;
@@ -78,6 +88,9 @@ void SnapshotRoundTrip(std::string compression_type, int version) {
     }
   }
 
+  std::vector<Tensor> read_tensors;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadTensors(&read_tensors)));
+
   TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
 
@@ -91,8 +104,24 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+TEST(SnapshotUtilTest, ParallelRoundTripTest) {
+  for (const auto& compression_type :
+       {io::compression::kNone, io::compression::kGzip,
+        io::compression::kSnappy}) {
+    for (int version : {1, 2}) {
+      SnapshotRoundTrip(compression_type, version, /*write_threads=*/4,
+                        /*read_threads=*/4);
+      // Files written in parallel are readable serially and vice versa.
+      SnapshotRoundTrip(compression_type, version, /*write_threads=*/4,
+                        /*read_threads=*/0);
+      SnapshotRoundTrip(compression_type, version, /*write_threads=*/0,
+                        /*read_threads=*/4);
+    }
+  }
+}
+
 void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
-                                 int version) {
+                                 int version, int64 num_threads = 0) {
   tensorflow::testing::StopTiming();
 
   tensorflow::DataTypeVector dtypes;
@@ -113,7 +142,7 @@ void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
 
   std::unique_ptr<Reader> reader;
   TF_ASSERT_OK(Reader::Create(Env::Default(), filename, compression_type,
-                              version, dtypes, &reader));
+                              version, dtypes, num_threads, &reader));
 
   tensorflow::testing::StartTiming();
   for (int i = 0; i < iters; ++i) {
@@ -121,6 +150,8 @@ void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
     reader->ReadTensors(&read_tensors).IgnoreError();
   }
   tensorflow::testing::StopTiming();
+  tensorflow::testing::BytesProcessed(static_cast<int64>(iters) *
+                                      ElementBytes(tensors));
 
   TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
@@ -151,8 +182,20 @@ BENCHMARK(SnapshotCustomReaderSnappyBenchmark);
 BENCHMARK(SnapshotTFRecordReaderNoneBenchmark);
 BENCHMARK(SnapshotTFRecordReaderGzipBenchmark);
 
+void SnapshotParallelReaderGzipBenchmark(int iters, int num_threads) {
+  SnapshotReaderBenchmarkLoop(iters, io::compression::kGzip, 1, num_threads);
+}
+
+void SnapshotParallelReaderSnappyBenchmark(int iters, int num_threads) {
+  SnapshotReaderBenchmarkLoop(iters, io::compression::kSnappy, 1,
+                              num_threads);
+}
+
+BENCHMARK(SnapshotParallelReaderGzipBenchmark)->Arg(0)->Arg(2)->Arg(8);
+BENCHMARK(SnapshotParallelReaderSnappyBenchmark)->Arg(0)->Arg(2)->Arg(8);
+
 void SnapshotWriterBenchmarkLoop(int iters, std::string compression_type,
-                                 int version) {
+                                 int version, int64 num_threads = 0) {
   tensorflow::testing::StopTiming();
 
   tensorflow::DataTypeVector dtypes;
@@ -164,7 +207,8 @@ void SnapshotWriterBenchmarkLoop(int iters, std::string compression_type,
 
   std::unique_ptr<Writer> writer;
   TF_ASSERT_OK(Writer::Create(tensorflow::Env::Default(), filename,
-                              compression_type, version, dtypes, &writer));
+                              compression_type, version, dtypes, num_threads,
+                              &writer));
 
   tensorflow::testing::StartTiming();
   for (int i = 0; i < iters; ++i) {
@@ -172,6 +216,8 @@ void SnapshotWriterBenchmarkLoop(int iters, std::string compression_type,
   }
   writer->Close().IgnoreError();
   tensorflow::testing::StopTiming();
+  tensorflow::testing::BytesProcessed(static_cast<int64>(iters) *
+                                      ElementBytes(tensors));
 
   TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
@@ -207,6 +253,18 @@ BENCHMARK(SnapshotTFRecordWriterNoneBenchmark);
 BENCHMARK(SnapshotTFRecordWriterGzipBenchmark);
 BENCHMARK(SnapshotTFRecordWriterSnappyBenchmark);
 
+void SnapshotParallelWriterGzipBenchmark(int iters, int num_threads) {
+  SnapshotWriterBenchmarkLoop(iters, io::compression::kGzip, 1, num_threads);
+}
+
+void SnapshotParallelWriterSnappyBenchmark(int iters, int num_threads) {
+  SnapshotWriterBenchmarkLoop(iters, io::compression::kSnappy, 1,
+                              num_threads);
+}
+
+BENCHMARK(SnapshotParallelWriterGzipBenchmark)->Arg(0)->Arg(2)->Arg(8);
+BENCHMARK(SnapshotParallelWriterSnappyBenchmark)->Arg(0)->Arg(2)->Arg(8);
+
 }  // namespace
 }  // namespace snapshot_util
 }  // namespace data
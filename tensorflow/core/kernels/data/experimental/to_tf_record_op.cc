@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/io/zlib_segment_index.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/resource.h"
 
@@ -32,7 +33,13 @@ class ToTFRecordOp : public AsyncOpKernel {
  public:
   explicit ToTFRecordOp(OpKernelConstruction* ctx)
       : AsyncOpKernel(ctx),
-        background_worker_(ctx->env(), "tf_data_to_tf_record") {}
+        background_worker_(ctx->env(), "tf_data_to_tf_record") {
+    // ExperimentalDatasetToTFRecord does not have the attr.
+    if (ctx->HasAttr("zlib_segment_bytes")) {
+      OP_REQUIRES_OK(ctx,
+                     ctx->GetAttr("zlib_segment_bytes", &zlib_segment_bytes_));
+    }
+  }
 
   template <typename T>
   Status ParseScalarArgument(OpKernelContext* ctx,
@@ -65,11 +72,18 @@ class ToTFRecordOp : public AsyncOpKernel {
     tstring compression_type;
     TF_RETURN_IF_ERROR(ParseScalarArgument<tstring>(ctx, "compression_type",
                                                     &compression_type));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type);
+    // Segmented ZLIB/GZIP files get an index next to them, with which
+    // TFRecordDataset inflates them on several threads.
+    options.zlib_segment_bytes = zlib_segment_bytes_;
+    const bool write_zlib_index =
+        options.compression_type ==
+            io::RecordWriterOptions::ZLIB_COMPRESSION &&
+        options.zlib_segment_bytes > 0;
     std::unique_ptr<WritableFile> file;
     TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(filename, &file));
-    auto writer = absl::make_unique<io::RecordWriter>(
-        file.get(),
-        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+    auto writer = absl::make_unique<io::RecordWriter>(file.get(), options);
 
     DatasetBase* dataset;
     TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
@@ -100,10 +114,18 @@ class ToTFRecordOp : public AsyncOpKernel {
       }
       components.clear();
     } while (!end_of_sequence);
+    if (write_zlib_index) {
+      TF_RETURN_IF_ERROR(writer->Close());
+      TF_RETURN_IF_ERROR(file->Close());
+      TF_RETURN_IF_ERROR(io::WriteZlibSegmentIndex(
+          ctx->env(), io::ZlibSegmentIndexFilename(filename),
+          writer->zlib_segment_index()));
+    }
     return Status::OK();
   }
 
   BackgroundWorker background_worker_;
+  int64 zlib_segment_bytes_ = 0;
 };
 
 REGISTER_KERNEL_BUILDER(Name("DatasetToTFRecord").Device(DEVICE_CPU),
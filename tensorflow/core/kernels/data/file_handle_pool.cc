@@ -0,0 +1,230 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/file_handle_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// A file whose first bytes have already been read. Reads that fall within
+// them are served from memory, and the underlying file is only kept if the
+// head is not the whole file. The head and the file are shared by all the
+// owners that prefetched the file.
+class PrefetchedFile : public RandomAccessFile {
+ public:
+  PrefetchedFile(std::string filename, std::shared_ptr<RandomAccessFile> file,
+                 std::shared_ptr<const std::string> head, bool head_is_file)
+      : filename_(std::move(filename)),
+        file_(std::move(file)),
+        head_(std::move(head)),
+        head_is_file_(head_is_file) {}
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return Status::OK();
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    const std::string& head = *head_;
+    if (offset + n <= head.size()) {
+      *result = StringPiece(head.data() + offset, n);
+      return Status::OK();
+    }
+    if (head_is_file_) {
+      const size_t start = std::min<uint64>(offset, head.size());
+      *result = StringPiece(head.data() + start, head.size() - start);
+      return errors::OutOfRange("Read less bytes than requested");
+    }
+    return file_->Read(offset, n, result, scratch);
+  }
+
+ private:
+  const std::string filename_;
+  const std::shared_ptr<RandomAccessFile> file_;
+  const std::shared_ptr<const std::string> head_;
+  const bool head_is_file_;
+};
+
+}  // namespace
+
+/* static */ FileHandlePool* FileHandlePool::Shared(int64 num_threads,
+                                                    int64 capacity,
+                                                    int64 head_bytes) {
+  if (num_threads <= 0) return nullptr;
+  static mutex* mu = new mutex;
+  static auto* pools =
+      new absl::flat_hash_map<std::tuple<int64, int64, int64>,
+                              FileHandlePool*>;
+  mutex_lock l(*mu);
+  FileHandlePool*& pool = (*pools)[std::make_tuple(num_threads, capacity,
+                                                   head_bytes)];
+  if (pool == nullptr) {
+    pool = new FileHandlePool(Env::Default(), num_threads, capacity,
+                              head_bytes);
+  }
+  return pool;
+}
+
+FileHandlePool::FileHandlePool(Env* env, int num_threads, int64 capacity,
+                               int64 head_bytes)
+    : env_(env),
+      capacity_(capacity),
+      head_bytes_(head_bytes),
+      thread_pool_(absl::make_unique<thread::ThreadPool>(
+          env, "tf_data_file_handle_pool", num_threads)) {}
+
+FileHandlePool::~FileHandlePool() { thread_pool_.reset(); }
+
+void FileHandlePool::Prefetch(const void* owner, const std::string& filename) {
+  std::shared_ptr<Entry> entry;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(filename);
+    if (it != entries_.end()) {
+      it->second->owners.insert(owner);
+      return;
+    }
+    if (static_cast<int64>(entries_.size()) >= capacity_ &&
+        !DropOldestDoneEntry()) {
+      return;
+    }
+    entry = std::make_shared<Entry>();
+    entry->start_micros = env_->NowMicros();
+    entry->owners.insert(owner);
+    entries_[filename] = entry;
+    order_.push_back(filename);
+  }
+  thread_pool_->Schedule(
+      [this, filename, entry]() { OpenEntry(filename, entry.get()); });
+}
+
+void FileHandlePool::Cancel(const void* owner, const std::string& filename) {
+  mutex_lock l(mu_);
+  ReleaseLocked(owner, filename);
+}
+
+Status FileHandlePool::Open(const void* owner, Env* env,
+                            const std::string& filename,
+                            std::unique_ptr<RandomAccessFile>* file) {
+  const uint64 start_micros = env->NowMicros();
+  std::shared_ptr<Entry> entry;
+  if (env == env_) {
+    mutex_lock l(mu_);
+    entry = ReleaseLocked(owner, filename);
+    if (entry) {
+      while (!entry->done) {
+        cond_var_.wait(l);
+      }
+    }
+  }
+  if (!entry) {
+    Status s = env->NewRandomAccessFile(filename, file);
+    metrics::RecordTFDataFileOpenLatency(
+        /*hidden_us=*/0, /*exposed_us=*/env->NowMicros() - start_micros);
+    return s;
+  }
+  // The open overlapped with other work until this reader asked for the file,
+  // and the reader waited for the rest of it.
+  const uint64 hidden_end_micros = std::min(entry->end_micros, start_micros);
+  metrics::RecordTFDataFileOpenLatency(
+      /*hidden_us=*/hidden_end_micros > entry->start_micros
+          ? hidden_end_micros - entry->start_micros
+          : 0,
+      /*exposed_us=*/env->NowMicros() - start_micros);
+  TF_RETURN_IF_ERROR(entry->status);
+  // The entry no longer changes once it is done, and outlives the file through
+  // the shared pointers.
+  *file = absl::make_unique<PrefetchedFile>(
+      filename, std::shared_ptr<RandomAccessFile>(entry, entry->file.get()),
+      std::shared_ptr<const std::string>(entry, &entry->head),
+      entry->head_is_file);
+  return Status::OK();
+}
+
+int64 FileHandlePool::size() {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+void FileHandlePool::OpenEntry(const std::string& filename, Entry* entry) {
+  std::unique_ptr<RandomAccessFile> file;
+  Status status = env_->NewRandomAccessFile(filename, &file);
+  std::string head;
+  bool head_is_file = false;
+  if (status.ok() && head_bytes_ > 0) {
+    head.resize(head_bytes_);
+    StringPiece data;
+    Status s = file->Read(/*offset=*/0, head_bytes_, &data, &head[0]);
+    if (s.ok() || errors::IsOutOfRange(s)) {
+      head_is_file = !s.ok();
+      if (data.data() != head.data()) {
+        memmove(&head[0], data.data(), data.size());
+      }
+      head.resize(data.size());
+    } else {
+      // Leaves the error to the reader, which reads the file itself.
+      head.clear();
+    }
+  }
+  if (head_is_file) {
+    // The reader never needs the file again.
+    file.reset();
+  }
+  mutex_lock l(mu_);
+  entry->status = status;
+  entry->file = std::move(file);
+  entry->head = std::move(head);
+  entry->head_is_file = head_is_file;
+  entry->end_micros = env_->NowMicros();
+  entry->done = true;
+  cond_var_.notify_all();
+}
+
+std::shared_ptr<FileHandlePool::Entry> FileHandlePool::ReleaseLocked(
+    const void* owner, const std::string& filename) {
+  auto it = entries_.find(filename);
+  if (it == entries_.end()) return nullptr;
+  std::shared_ptr<Entry> entry = it->second;
+  entry->owners.erase(owner);
+  if (entry->owners.empty()) {
+    entries_.erase(it);
+    order_.erase(std::find(order_.begin(), order_.end(), filename));
+  }
+  return entry;
+}
+
+bool FileHandlePool::DropOldestDoneEntry() {
+  for (auto it = order_.begin(); it != order_.end(); ++it) {
+    auto entry = entries_.find(*it);
+    if (entry->second->done) {
+      entries_.erase(entry);
+      order_.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace data
+}  // namespace tensorflow
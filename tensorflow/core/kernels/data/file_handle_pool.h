@@ -0,0 +1,129 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_FILE_HANDLE_POOL_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_FILE_HANDLE_POOL_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// Opens files ahead of their readers on a set of I/O threads shared by the
+// datasets that use the pool, so that readers of many small files do not pay
+// the open and first read latency of each file in turn.
+//
+// Prefetch() opens a file in the background and reads its first `head_bytes`
+// bytes in a single request. Open() claims that handle, waiting for the open
+// to finish if needed. Reads within the head are served from memory, and files
+// no longer than the head are closed as soon as they are read, so a pipeline
+// over millions of small files issues one read per file and keeps at most
+// `capacity` files open ahead of its readers.
+//
+// Prefetches are made on behalf of an owner, typically a dataset iterator.
+// Several owners may prefetch the same file, and a prefetched file is only
+// dropped once every owner has opened or cancelled it.
+//
+// The time spent opening each claimed file is recorded with
+// metrics::RecordTFDataFileOpenLatency(), split into the part that overlapped
+// with other work and the part Open() waited for.
+//
+// FileHandlePool is thread-safe.
+class FileHandlePool {
+ public:
+  // Returns the pool shared by all datasets that open files on `num_threads`
+  // threads, keep up to `capacity` files open ahead of their readers and read
+  // the first `head_bytes` bytes of each. Returns null if `num_threads` is not
+  // positive.
+  static FileHandlePool* Shared(int64 num_threads, int64 capacity,
+                                int64 head_bytes);
+
+  FileHandlePool(Env* env, int num_threads, int64 capacity, int64 head_bytes);
+
+  // Waits for the opens in progress to finish.
+  ~FileHandlePool();
+
+  // Starts opening `filename` in the background for `owner`, unless it is
+  // already being opened, in which case `owner` shares that open. If
+  // `capacity` files are already open ahead of their readers, the least
+  // recently prefetched one that is done opening is dropped to make room; if
+  // all of them are still opening, `filename` is not prefetched.
+  void Prefetch(const void* owner, const std::string& filename);
+
+  // Releases the prefetch of `filename` made for `owner`, for readers that
+  // will no longer read it. The file is dropped if no other owner holds it.
+  void Cancel(const void* owner, const std::string& filename);
+
+  // Opens `filename` with `env` for `owner`, sharing the handle opened by
+  // Prefetch() if there is one and `env` is the environment of the pool. This
+  // releases the prefetch made for `owner` as Cancel() does.
+  Status Open(const void* owner, Env* env, const std::string& filename,
+              std::unique_ptr<RandomAccessFile>* file);
+
+  // Returns the number of files opened or being opened ahead of their readers.
+  int64 size();
+
+ private:
+  struct Entry {
+    uint64 start_micros = 0;
+    uint64 end_micros = 0;
+    bool done = false;
+    Status status;
+    std::unique_ptr<RandomAccessFile> file;
+    // The first bytes of the file, and whether they are the whole file.
+    std::string head;
+    bool head_is_file = false;
+    // The owners that prefetched the file and have not opened or cancelled it.
+    absl::flat_hash_set<const void*> owners;
+  };
+
+  // Opens the file of `entry` and reads its head.
+  void OpenEntry(const std::string& filename, Entry* entry);
+
+  // Removes `owner` from the owners of the entry of `filename`, and drops the
+  // entry if that was its last owner. Returns the entry, or null if there is
+  // no entry for `filename`.
+  std::shared_ptr<Entry> ReleaseLocked(const void* owner,
+                                       const std::string& filename)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Drops the oldest entry that is done. Returns false if there is none.
+  bool DropOldestDoneEntry() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const int64 capacity_;
+  const int64 head_bytes_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  // Entries by file name, and the file names in the order of Prefetch().
+  absl::flat_hash_map<std::string, std::shared_ptr<Entry>> entries_
+      TF_GUARDED_BY(mu_);
+  std::deque<std::string> order_ TF_GUARDED_BY(mu_);
+  // Destroyed first, so that no open outlives the pool.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_FILE_HANDLE_POOL_H_
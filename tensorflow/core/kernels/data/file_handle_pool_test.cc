@@ -0,0 +1,185 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/file_handle_pool.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64 kHeadBytes = 64;
+
+// Owners on whose behalf files are prefetched.
+const int kOwner = 1;
+const int kOtherOwner = 2;
+
+std::string WriteFile(const std::string& name, int64 size) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "file_handle_pool_test_" + name);
+  std::string contents(size, '\0');
+  for (int64 i = 0; i < size; ++i) {
+    contents[i] = 'a' + i % 26;
+  }
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, contents));
+  return filename;
+}
+
+// Reads `file` in reads of `read_size` bytes, the way a buffered reader would.
+std::string ReadAll(const RandomAccessFile& file, size_t read_size) {
+  std::string contents;
+  std::vector<char> scratch(read_size);
+  while (true) {
+    StringPiece data;
+    Status s = file.Read(contents.size(), read_size, &data, scratch.data());
+    contents.append(data.data(), data.size());
+    if (errors::IsOutOfRange(s)) return contents;
+    TF_CHECK_OK(s);
+  }
+}
+
+std::string ReadFile(const std::string& filename) {
+  std::string contents;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), filename, &contents));
+  return contents;
+}
+
+TEST(FileHandlePoolTest, Prefetch) {
+  FileHandlePool pool(Env::Default(), /*num_threads=*/2, /*capacity=*/8,
+                      kHeadBytes);
+  // Shorter than, as long as, and longer than the head.
+  const std::vector<std::string> filenames = {
+      WriteFile("small", kHeadBytes / 2), WriteFile("head", kHeadBytes),
+      WriteFile("large", 10 * kHeadBytes + 3), WriteFile("empty", 0)};
+  for (const std::string& filename : filenames) {
+    pool.Prefetch(&kOwner, filename);
+  }
+  EXPECT_EQ(pool.size(), filenames.size());
+  for (const std::string& filename : filenames) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_ASSERT_OK(pool.Open(&kOwner, Env::Default(), filename, &file));
+    for (size_t read_size : {1, 7, 64, 1000}) {
+      EXPECT_EQ(ReadAll(*file, read_size), ReadFile(filename));
+    }
+    StringPiece name;
+    TF_ASSERT_OK(file->Name(&name));
+    EXPECT_EQ(name, filename);
+  }
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(FileHandlePoolTest, OpenWithoutPrefetch) {
+  FileHandlePool pool(Env::Default(), /*num_threads=*/1, /*capacity=*/8,
+                      kHeadBytes);
+  const std::string filename = WriteFile("not_prefetched", 3 * kHeadBytes);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(pool.Open(&kOwner, Env::Default(), filename, &file));
+  EXPECT_EQ(ReadAll(*file, 10), ReadFile(filename));
+}
+
+TEST(FileHandlePoolTest, MissingFile) {
+  FileHandlePool pool(Env::Default(), /*num_threads=*/1, /*capacity=*/8,
+                      kHeadBytes);
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "file_handle_pool_test_missing");
+  pool.Prefetch(&kOwner, filename);
+  std::unique_ptr<RandomAccessFile> file;
+  Status s = pool.Open(&kOwner, Env::Default(), filename, &file);
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+}
+
+TEST(FileHandlePoolTest, Capacity) {
+  FileHandlePool pool(Env::Default(), /*num_threads=*/1, /*capacity=*/2,
+                      kHeadBytes);
+  std::vector<std::string> filenames;
+  for (int i = 0; i < 10; ++i) {
+    filenames.push_back(WriteFile(strings::StrCat("capacity_", i), 100));
+    pool.Prefetch(&kOwner, filenames.back());
+    EXPECT_LE(pool.size(), 2);
+  }
+  // Files that were dropped or never prefetched are opened directly.
+  for (const std::string& filename : filenames) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_ASSERT_OK(pool.Open(&kOwner, Env::Default(), filename, &file));
+    EXPECT_EQ(ReadAll(*file, 10), ReadFile(filename));
+  }
+}
+
+TEST(FileHandlePoolTest, Cancel) {
+  FileHandlePool pool(Env::Default(), /*num_threads=*/1, /*capacity=*/8,
+                      kHeadBytes);
+  const std::string filename = WriteFile("cancel", 100);
+  pool.Prefetch(&kOwner, filename);
+  pool.Prefetch(&kOwner, filename);
+  EXPECT_EQ(pool.size(), 1);
+  pool.Cancel(&kOwner, filename);
+  EXPECT_EQ(pool.size(), 0);
+  pool.Cancel(&kOwner, filename);
+}
+
+TEST(FileHandlePoolTest, CancelKeepsPrefetchOfOtherOwners) {
+  FileHandlePool pool(Env::Default(), /*num_threads=*/1, /*capacity=*/8,
+                      kHeadBytes);
+  const std::string filename = WriteFile("cancel_other", 100);
+  pool.Prefetch(&kOwner, filename);
+  pool.Prefetch(&kOtherOwner, filename);
+  EXPECT_EQ(pool.size(), 1);
+  pool.Cancel(&kOwner, filename);
+  EXPECT_EQ(pool.size(), 1);
+  // Cancelling again does not release the prefetch of the other owner.
+  pool.Cancel(&kOwner, filename);
+  EXPECT_EQ(pool.size(), 1);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(pool.Open(&kOtherOwner, Env::Default(), filename, &file));
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_EQ(ReadAll(*file, 10), ReadFile(filename));
+}
+
+TEST(FileHandlePoolTest, OwnersShareOpenFile) {
+  FileHandlePool pool(Env::Default(), /*num_threads=*/1, /*capacity=*/8,
+                      kHeadBytes);
+  const std::string filename = WriteFile("shared", 10 * kHeadBytes);
+  pool.Prefetch(&kOwner, filename);
+  pool.Prefetch(&kOtherOwner, filename);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(pool.Open(&kOwner, Env::Default(), filename, &file));
+  EXPECT_EQ(pool.size(), 1);
+  std::unique_ptr<RandomAccessFile> other_file;
+  TF_ASSERT_OK(pool.Open(&kOtherOwner, Env::Default(), filename, &other_file));
+  EXPECT_EQ(pool.size(), 0);
+  file.reset();
+  EXPECT_EQ(ReadAll(*other_file, 7), ReadFile(filename));
+}
+
+TEST(FileHandlePoolTest, Shared) {
+  EXPECT_EQ(FileHandlePool::Shared(/*num_threads=*/0, /*capacity=*/8,
+                                   kHeadBytes),
+            nullptr);
+  FileHandlePool* pool =
+      FileHandlePool::Shared(/*num_threads=*/2, /*capacity=*/8, kHeadBytes);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(FileHandlePool::Shared(/*num_threads=*/2, /*capacity=*/8,
+                                   kHeadBytes),
+            pool);
+  EXPECT_NE(FileHandlePool::Shared(/*num_threads=*/2, /*capacity=*/16,
+                                   kHeadBytes),
+            pool);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -37,26 +37,38 @@ constexpr int64 kOptimizationPeriodThresholdMs = 60 * EnvTime::kSecondsToMillis;
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+const char* AlgorithmName(model::AutotuneAlgorithm algorithm) {
+  switch (algorithm) {
+    case model::AutotuneAlgorithm::HILL_CLIMB:
+      return "hill climb";
+    case model::AutotuneAlgorithm::GRADIENT_DESCENT:
+      return "gradient descent";
+    case model::AutotuneAlgorithm::BAYESIAN:
+      return "bayesian";
+  }
+  return "unknown";
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const ModelDatasetOp::kAlgorithm;
 /* static */ constexpr const char* const ModelDatasetOp::kCpuBudget;
 /* static */ constexpr const char* const ModelDatasetOp::kRamBudget;
+/* static */ constexpr const char* const ModelDatasetOp::kBufferRamBudget;
 
 class ModelDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           model::AutotuneAlgorithm algorithm, int64 cpu_budget,
-          int64 ram_budget)
+          int64 ram_budget, int64 buffer_ram_budget)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         algorithm_(algorithm),
         cpu_budget_(cpu_budget),
         ram_budget_(ram_budget),
+        buffer_ram_budget_(buffer_ram_budget),
         traceme_metadata_(
-            {{"algorithm", algorithm == model::AutotuneAlgorithm::HILL_CLIMB
-                               ? "hill climb"
-                               : "gradient descent"},
+            {{"algorithm", AlgorithmName(algorithm)},
              {"cpu_budget",
               strings::Printf("%lld", static_cast<long long>(cpu_budget))},
              {"ram_budget",
@@ -105,13 +117,16 @@ class ModelDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(cpu_budget_, &cpu_budget_attr);
     AttrValue ram_budget_attr;
     b->BuildAttrValue(ram_budget_, &ram_budget_attr);
-
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_graph_node},
-                      {std::make_pair(kAlgorithm, algorithm_attr),
-                       std::make_pair(kCpuBudget, cpu_budget_attr),
-                       std::make_pair(kRamBudget, ram_budget_attr)},
-                      output));
+    AttrValue buffer_ram_budget_attr;
+    b->BuildAttrValue(buffer_ram_budget_, &buffer_ram_budget_attr);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node},
+        {std::make_pair(kAlgorithm, algorithm_attr),
+         std::make_pair(kCpuBudget, cpu_budget_attr),
+         std::make_pair(kRamBudget, ram_budget_attr),
+         std::make_pair(kBufferRamBudget, buffer_ram_budget_attr)},
+        output));
     return Status::OK();
   }
 
@@ -126,6 +141,9 @@ class ModelDatasetOp::Dataset : public DatasetBase {
                           ? kRamBudgetShare * port::AvailableRam()
                           : dataset()->ram_budget_) {
       model_ = std::make_shared<model::Model>();
+      // Producers hold off filling their buffers once these hold the whole
+      // buffer budget, if the user set one.
+      model_->memory_arbiter()->set_budget_bytes(dataset()->buffer_ram_budget_);
     }
 
     ~Iterator() override {
@@ -275,6 +293,7 @@ class ModelDatasetOp::Dataset : public DatasetBase {
   const model::AutotuneAlgorithm algorithm_;
   const int64 cpu_budget_;
   const int64 ram_budget_;
+  const int64 buffer_ram_budget_;
   const TraceMeMetadata traceme_metadata_;
 };
 
@@ -299,12 +318,22 @@ ModelDatasetOp::ModelDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES(ctx, ram_budget_ >= 0,
               errors::InvalidArgument("RAM budget must be positive but is ",
                                       ram_budget_, "."));
+  if (ctx->HasAttr(kBufferRamBudget)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttribute(kBufferRamBudget, &buffer_ram_budget_));
+  } else {
+    buffer_ram_budget_ = 0;
+  }
+  OP_REQUIRES(ctx, buffer_ram_budget_ >= 0,
+              errors::InvalidArgument(
+                  "Buffer RAM budget must be positive but is ",
+                  buffer_ram_budget_, "."));
 }
 
 void ModelDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
   *output = new ModelDatasetOp::Dataset(ctx, input, algorithm_, cpu_budget_,
-                                        ram_budget_);
+                                        ram_budget_, buffer_ram_budget_);
 }
 
 namespace {
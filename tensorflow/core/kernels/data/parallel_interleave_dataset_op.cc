@@ -386,7 +386,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       });
       if (result->status.ok()) {
         *out_tensors = std::move(result->return_values);
-        RecordBufferDequeue(ctx, *out_tensors);
+        RecordProducerBufferDequeue(ctx, *out_tensors);
       }
       *end_of_sequence = false;
       return result->status;
@@ -958,11 +958,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           NotifyElementUpdate(element);
           break;
         }
-        RecordBufferEnqueue(ctx_.get(), result->return_values);
+        RecordProducerBufferEnqueue(ctx_.get(), result->return_values);
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (!NeedsProcessing(element)) {
           break;
         }
       }
@@ -1060,8 +1060,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       if (!element->initialized) {
         return true;
       }
+      // While the memory budget of the input pipeline is exhausted, elements
+      // that have buffered results are not processed further. Consuming their
+      // results schedules them again.
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < dataset()->buffer_output_elements_ &&
+             !ShouldThrottleBuffer(ctx_.get(), element->results.size());
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
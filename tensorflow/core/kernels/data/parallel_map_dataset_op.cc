@@ -427,7 +427,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
 
       auto done = [this, ctx, result](Status status) {
         result->status.Update(status);
-        RecordBufferEnqueue(ctx.get(), result->return_values);
+        RecordProducerBufferEnqueue(ctx.get(), result->return_values);
         CallCompleted(ctx, result);
       };
 
@@ -469,7 +469,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
                          bool* end_of_sequence) TF_LOCKS_EXCLUDED(*mu_) {
       if (!result->end_of_input && result->status.ok()) {
         *out_tensors = std::move(result->return_values);
-        RecordBufferDequeue(ctx, *out_tensors);
+        RecordProducerBufferDequeue(ctx, *out_tensors);
         *end_of_sequence = false;
         return Status::OK();
       }
@@ -501,10 +501,13 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         tf_shared_lock l(*mu_);  // mu_ == num_parallel_calls_->mu
         new_calls.reserve(num_parallel_calls_->value);
       }
-      auto busy = [this]() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
+      // While the memory budget of the input pipeline is exhausted, no calls
+      // are added to the results already buffered.
+      auto busy = [this, &ctx]() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
         int64 num_parallel_calls = num_parallel_calls_->value;
         return num_calls_ >= num_parallel_calls ||
-               invocation_results_.size() >= num_parallel_calls;
+               invocation_results_.size() >= num_parallel_calls ||
+               ShouldThrottleBuffer(ctx.get(), invocation_results_.size());
       };
       // Counts the total number of calls to use as an id of InvocationResult.
       int64 num_total_calls = 0;
@@ -513,7 +516,8 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
           mutex_lock l(*mu_);
           while (!cancelled_ && busy()) {
             RecordStop(ctx.get());
-            cond_var_->wait(l);
+            WaitForBufferSpace(ctx.get(), invocation_results_.size(),
+                               cond_var_.get(), &l);
             RecordStart(ctx.get());
           }
           if (cancelled_) {
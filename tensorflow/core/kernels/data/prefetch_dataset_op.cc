@@ -393,12 +393,12 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           VLOG(2) << "Setting slack_us_: " << slack_us_;
         }
         *out_tensors = std::move(buffer_.front().value);
-        RecordBufferDequeue(ctx, *out_tensors);
+        RecordProducerBufferDequeue(ctx, *out_tensors);
       } else {
         // If status not ok, we still record the dequeue event to make sure each
         // enqueue event is paired with a dequeue event even in the presence of
         // errors.
-        RecordBufferDequeue(ctx, buffer_.front().value);
+        RecordProducerBufferDequeue(ctx, buffer_.front().value);
       }
       if (legacy_autotune_) {
         auto_tuner_.RecordConsumption(buffer_.size());
@@ -439,9 +439,13 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         // 1. Wait for a slot in the buffer.
         {
           mutex_lock l(*mu_);
-          while (!cancelled_ && buffer_.size() >= buffer_limit()) {
+          // While the memory budget of the input pipeline is exhausted, the
+          // buffer shrinks to the elements it already holds.
+          while (!cancelled_ &&
+                 (buffer_.size() >= buffer_limit() ||
+                  ShouldThrottleBuffer(ctx.get(), buffer_.size()))) {
             RecordStop(ctx.get());
-            cond_var_->wait(l);
+            WaitForBufferSpace(ctx.get(), buffer_.size(), cond_var_.get(), &l);
             RecordStart(ctx.get());
           }
 
@@ -488,7 +492,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         // 3. Signal that the element has been produced.
         {
           mutex_lock l(*mu_);
-          RecordBufferEnqueue(ctx.get(), buffer_element.value);
+          RecordProducerBufferEnqueue(ctx.get(), buffer_element.value);
           buffer_element.created_us = EnvTime::NowMicros();
           buffer_element.id = num_produced;
           buffer_.push_back(std::move(buffer_element));
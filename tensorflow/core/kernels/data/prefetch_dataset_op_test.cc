@@ -12,6 +12,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
+#include <numeric>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 
 namespace tensorflow {
@@ -76,6 +80,41 @@ class PrefetchDatasetParams : public DatasetParams {
   int64 buffer_size_min_;
 };
 
+// Caches its input in memory.
+class MemoryCacheDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  MemoryCacheDatasetParams(T input_dataset_params, DataTypeVector output_dtypes,
+                           std::vector<PartialTensorShape> output_shapes,
+                           string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<tstring>(TensorShape({}), {""})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {CacheDatasetOp::kInputDataset, CacheDatasetOp::kFileName};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{CacheDatasetOp::kOutputTypes, output_dtypes_},
+                    {CacheDatasetOp::kOutputShapes, output_shapes_},
+                    {CacheDatasetOp::kMemoryBudgetBytes, int64{0}},
+                    {CacheDatasetOp::kSpillDir, ""}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override { return CacheDatasetOp::kDatasetType; }
+};
+
 // Test case 1: positive buffer size.
 PrefetchDatasetParams PrefetchDatasetParams1() {
   auto tensor_slice_dataset_params = TensorSliceDatasetParams(
@@ -327,6 +366,55 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(PrefetchDatasetOpTest, PrefetchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+TEST_F(PrefetchDatasetOpTest, CacheDoesNotUseBufferBudget) {
+  constexpr int64 kNumElements = 1000;
+  constexpr int64 kBufferSize = 5;
+  constexpr int64 kBufferRamBudget = 1024;
+  std::vector<int64> values(kNumElements);
+  std::iota(values.begin(), values.end(), 0);
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{kNumElements, 1},
+                                          values)},
+      /*node_name=*/"tensor_slice");
+  auto cache_dataset_params = MemoryCacheDatasetParams(
+      tensor_slice_dataset_params, /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})}, /*node_name=*/"cache");
+  auto dataset_params = PrefetchDatasetParams(
+      /*input_dataset_params=*/cache_dataset_params,
+      /*buffer_size=*/kBufferSize,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*slack_period=*/0,
+      /*legacy_autotune=*/false,
+      /*buffer_size_min=*/0,
+      /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  auto model = std::make_shared<model::Model>();
+  model->memory_arbiter()->set_budget_bytes(kBufferRamBudget);
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.model = model;
+  IteratorContext ctx(std::move(params));
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(&ctx, /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator));
+  // The cache ends up holding several times the budget, but only the
+  // prefetch buffer is charged to it.
+  int64 cached_bytes = 0;
+  for (int64 i = 0; i < kNumElements; ++i) {
+    std::vector<Tensor> out_tensors;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(iterator->GetNext(&ctx, &out_tensors, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    cached_bytes += out_tensors[0].TotalBytes();
+    EXPECT_FALSE(model->memory_arbiter()->ShouldThrottle(kBufferSize));
+  }
+  EXPECT_GT(cached_bytes, kBufferRamBudget);
+  EXPECT_GT(model->memory_arbiter()->peak_buffered_bytes(), 0);
+  EXPECT_LT(model->memory_arbiter()->peak_buffered_bytes(), kBufferRamBudget);
+}
+
 TEST_F(PrefetchDatasetOpTest, InvalidBufferSize) {
   auto dataset_params = InvalidBufferSizePrefetchDatasetParams();
   EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
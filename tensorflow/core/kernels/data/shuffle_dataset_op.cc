@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/data/shuffle_spill_buffer.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -46,6 +47,9 @@ namespace data {
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputShapes;
 /* static */ constexpr const char* const
     ShuffleDatasetOpBase::kReshuffleEachIteration;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kSpillDir;
+/* static */ constexpr const char* const
+    ShuffleDatasetOpBase::kSpillMemoryLimitBytes;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
 
@@ -65,6 +69,8 @@ constexpr char kSlicesSize[] = "slices_size";
 constexpr char kSlicesStart[] = "slices_start";
 constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kBuffer[] = "buffer";
+constexpr char kSpilled[] = "spilled";
+constexpr char kSpillBuffer[] = "spill_buffer";
 constexpr char kSize[] = "size";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kTFData[] = "tf_data";
@@ -76,19 +82,35 @@ constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
-    : UnaryDatasetOpKernel(ctx) {}
+    : UnaryDatasetOpKernel(ctx) {
+  // Setting `spill_dir` to a local directory lets the shuffle buffer grow
+  // beyond memory: once the buffered elements take more than
+  // `spill_memory_limit_bytes`, they are spilled to files in the directory.
+  if (ctx->HasAttr(kSpillDir)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDir, &spill_dir_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillMemoryLimitBytes,
+                                     &spill_memory_limit_bytes_));
+    OP_REQUIRES(ctx, spill_memory_limit_bytes_ > 0,
+                errors::InvalidArgument(
+                    "`spill_memory_limit_bytes` must be greater than zero."));
+  }
+}
 
 // Abstract base dataset that implements a shuffling iterator.
 class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
  public:
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64 buffer_size,
-                     std::shared_ptr<SeedGenerator> seed_generator, int64 count)
+                     std::shared_ptr<SeedGenerator> seed_generator, int64 count,
+                     const std::string& spill_dir,
+                     int64 spill_memory_limit_bytes)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        spill_dir_(spill_dir),
+        spill_memory_limit_bytes_(spill_memory_limit_bytes),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
@@ -141,15 +163,32 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   }
 
  protected:
+  // Appends the spill configuration to the attrs of the serialized dataset.
+  void AddSpillAttrs(
+      DatasetGraphDefBuilder* b,
+      std::vector<std::pair<StringPiece, AttrValue>>* attrs) const {
+    AttrValue spill_dir;
+    b->BuildAttrValue(spill_dir_, &spill_dir);
+    attrs->emplace_back(kSpillDir, spill_dir);
+    AttrValue spill_memory_limit_bytes;
+    b->BuildAttrValue(spill_memory_limit_bytes_, &spill_memory_limit_bytes);
+    attrs->emplace_back(kSpillMemoryLimitBytes, spill_memory_limit_bytes);
+  }
+
   class Iterator : public DatasetIterator<ShuffleDatasetBase> {
    public:
     explicit Iterator(const Params& params, SeedGenerator* seed_generator)
         : DatasetIterator<ShuffleDatasetBase>(params),
           seed_generator_(seed_generator),
           parent_generator_(seed_generator->seed(), seed_generator->seed2()),
-          generator_(&parent_generator_) {
-      buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
-          params.dataset->buffer_size_);
+          generator_(&parent_generator_),
+          spill_(!params.dataset->spill_dir_.empty()) {
+      if (spill_) {
+        spill_buffers_.push_back(NewSpillBuffer());
+      } else {
+        buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
+            params.dataset->buffer_size_);
+      }
       slices_.push_back(absl::make_unique<Slice>(0, 0));
     }
 
@@ -198,6 +237,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           epoch_++;
           int64 n = slices_.back()->end;
           slices_.push_back(absl::make_unique<Slice>(n, n));
+          if (spill_) {
+            spill_buffers_.push_back(NewSpillBuffer());
+          }
           if (ctx->split_provider()) {
             TF_RETURN_IF_ERROR(ctx->split_provider()->Reset());
           }
@@ -210,8 +252,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
                     << this->dataset()->buffer_size_;
           }
           this->RecordBufferEnqueue(ctx, input_element);
-          buffer_->at(slices_.back()->end % this->dataset()->buffer_size_) =
-              std::move(input_element);
+          if (spill_) {
+            spill_buffers_.back()->Add(std::move(input_element));
+            TF_RETURN_IF_ERROR(MaybeSpill());
+          } else {
+            buffer_->at(slices_.back()->end % this->dataset()->buffer_size_) =
+                std::move(input_element);
+          }
           num_elements_++;
           slices_.back()->end++;
         } else {
@@ -236,6 +283,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         while (!slices_.empty() &&
                slices_.front()->start == slices_.front()->end) {
           slices_.pop_front();
+          if (spill_) {
+            spill_buffers_.pop_front();
+          }
           // Reinitialize the RNG state for the next epoch.
           num_random_samples_ = 0;
           seed_generator_->GenerateSeeds(&seed_, &seed2_);
@@ -246,13 +296,19 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         // slice, and then remove the element from the slice.
         int64 offset =
             Random() % (slices_.front()->end - slices_.front()->start);
-        int64 index =
-            (slices_.front()->start + offset) % this->dataset()->buffer_size_;
-        *out_tensors = std::move(buffer_->at(index));
-        this->RecordBufferDequeue(ctx, *out_tensors);
-        std::swap(buffer_->at(index),
-                  buffer_->at(slices_.front()->start %
-                              this->dataset()->buffer_size_));
+        if (spill_) {
+          TF_RETURN_IF_ERROR(
+              spill_buffers_.front()->Remove(offset, out_tensors));
+          this->RecordBufferDequeue(ctx, *out_tensors);
+        } else {
+          int64 index = (slices_.front()->start + offset) %
+                        this->dataset()->buffer_size_;
+          *out_tensors = std::move(buffer_->at(index));
+          this->RecordBufferDequeue(ctx, *out_tensors);
+          std::swap(buffer_->at(index),
+                    buffer_->at(slices_.front()->start %
+                                this->dataset()->buffer_size_));
+        }
         slices_.front()->start++;
         num_elements_--;
       } else {
@@ -302,7 +358,18 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kEpoch), epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kNumElements), num_elements_));
-      TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      if (spill_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kSpilled), ""));
+        // One spill buffer per slice.
+        for (size_t i = 0; i < spill_buffers_.size(); ++i) {
+          TF_RETURN_IF_ERROR(spill_buffers_[i]->Save(
+              writer, this->full_name(absl::StrJoin(
+                          std::make_tuple(kSpillBuffer, i), "_"))));
+        }
+      } else {
+        TF_RETURN_IF_ERROR(
+            WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      }
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kSlicesSize), slices_.size()));
       for (size_t i = 0; i < slices_.size(); ++i) {
@@ -357,10 +424,28 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             reader->ReadScalar(this->full_name(kSlicesSize), &temp));
         slices_size = static_cast<size_t>(temp);
       }
-      buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
-          this->dataset()->buffer_size_);
-      TF_RETURN_IF_ERROR(
-          ReadElementsFromCheckpoint(reader, prefix(), buffer_.get()));
+      // The buffer is restored in the mode it was saved in.
+      spill_ = reader->Contains(this->full_name(kSpilled));
+      spill_buffers_.clear();
+      buffer_.reset();
+      if (spill_) {
+        if (this->dataset()->spill_dir_.empty()) {
+          return errors::FailedPrecondition(
+              "The checkpoint holds a shuffle buffer spilled to disk; set `",
+              kSpillDir, "` to restore it.");
+        }
+        for (size_t i = 0; i < slices_size; ++i) {
+          spill_buffers_.push_back(NewSpillBuffer());
+          TF_RETURN_IF_ERROR(spill_buffers_.back()->Restore(
+              reader, this->full_name(absl::StrJoin(
+                          std::make_tuple(kSpillBuffer, i), "_"))));
+        }
+      } else {
+        buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
+            this->dataset()->buffer_size_);
+        TF_RETURN_IF_ERROR(
+            ReadElementsFromCheckpoint(reader, prefix(), buffer_.get()));
+      }
       slices_.clear();
       for (size_t i = 0; i < slices_size; ++i) {
         int64 start;
@@ -403,6 +488,33 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return out;
     }
 
+    std::unique_ptr<ShuffleSpillBuffer> NewSpillBuffer() const {
+      return absl::make_unique<ShuffleSpillBuffer>(Env::Default(),
+                                                   this->dataset()->spill_dir_);
+    }
+
+    // Spills the in-memory elements of the latest epochs until the buffered
+    // elements fit in the memory limit. The epoch being filled is spilled
+    // first, as its elements are produced last.
+    Status MaybeSpill() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64 memory_bytes = 0;
+      for (const auto& spill_buffer : spill_buffers_) {
+        memory_bytes += spill_buffer->memory_bytes();
+      }
+      for (auto it = spill_buffers_.rbegin();
+           it != spill_buffers_.rend() &&
+           memory_bytes > this->dataset()->spill_memory_limit_bytes_;
+           ++it) {
+        if ((*it)->memory_bytes() == 0) continue;
+        VLOG(2) << "Spilling " << (*it)->memory_bytes()
+                << " bytes of the shuffle buffer to "
+                << this->dataset()->spill_dir_;
+        memory_bytes -= (*it)->memory_bytes();
+        TF_RETURN_IF_ERROR((*it)->Spill(Random()));
+      }
+      return Status::OK();
+    }
+
     mutex mu_;
     SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
     std::unique_ptr<std::vector<std::vector<Tensor>>> buffer_
@@ -422,6 +534,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     int64 num_random_samples_ TF_GUARDED_BY(mu_) = 0;
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // Whether the elements are held in `spill_buffers_` rather than `buffer_`.
+    bool spill_ TF_GUARDED_BY(mu_);
+    // When spilling, the elements of each slice in `slices_`, which only
+    // count the elements.
+    std::deque<std::unique_ptr<ShuffleSpillBuffer>> spill_buffers_
+        TF_GUARDED_BY(mu_);
   };
 
   const DatasetBase* const input_;
@@ -431,6 +549,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64 count_;
+  // Scratch directory to spill the buffer to, or empty to keep it in memory.
+  const std::string spill_dir_;
+  const int64 spill_memory_limit_bytes_;
   const TraceMeMetadata traceme_metadata_;
 };  // ShuffleDatasetBase
 
@@ -442,8 +563,10 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
           int64 count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, const std::string& spill_dir,
+          int64 spill_memory_limit_bytes)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_dir, spill_memory_limit_bytes),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -476,12 +599,13 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2_node));
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
         {input_graph_node, buffer_size_node, seed_node, seed2_node},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
-        output));
+        attrs, output));
     return Status::OK();
   }
 
@@ -500,8 +624,10 @@ class ShuffleDatasetOp::DatasetV2 : public ShuffleDatasetBase {
  public:
   DatasetV2(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
             int64 count, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            const std::string& spill_dir, int64 spill_memory_limit_bytes)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_dir, spill_memory_limit_bytes),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -532,11 +658,12 @@ class ShuffleDatasetOp::DatasetV2 : public ShuffleDatasetBase {
     Tensor handle(DT_RESOURCE, TensorShape({}));
     handle.scalar<ResourceHandle>()() = resource_handle_;
     TF_RETURN_IF_ERROR(b->AddTensor(handle, &resource_handle_node));
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
         {input_graph_node, buffer_size_node, resource_handle_node},  // Inputs
-        {},                                                          // Attrs
-        output));
+        attrs, output));
     return Status::OK();
   }
 
@@ -554,8 +681,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
             int64 count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            const std::string& spill_dir, int64 spill_memory_limit_bytes)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_dir, spill_memory_limit_bytes),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -594,13 +723,14 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
-                      {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
-                      output));
+                      attrs, output));
     return Status::OK();
   }
 
@@ -676,9 +806,10 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, spill_dir_,
+        spill_memory_limit_bytes_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
@@ -705,9 +836,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV2`.
-    *output =
-        new ShuffleDatasetOp::DatasetV2(ctx, input, buffer_size, count, manager,
-                                        std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV2(
+        ctx, input, buffer_size, count, manager, std::move(handle),
+        owns_resource, spill_dir_, spill_memory_limit_bytes_);
   } else {
     if (op_version_ != 1) {
       LOG(WARNING) << "Unsupported version of shuffle dataset op: "
@@ -738,9 +869,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
         MakeResourceHandle<SeedGeneratorManager>(ctx, container, name);
 
     // Ownership of manager is transferred onto `Dataset`.
-    *output = new ShuffleDatasetOp::Dataset(ctx, input, buffer_size, count,
-                                            std::move(seeds), manager,
-                                            std::move(handle));
+    *output = new ShuffleDatasetOp::Dataset(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), spill_dir_, spill_memory_limit_bytes_);
   }
 }
 
@@ -748,8 +879,10 @@ class ShuffleAndRepeatDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
           RandomSeeds&& seeds, SeedGeneratorManager* manager, int64 count,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, const std::string& spill_dir,
+          int64 spill_memory_limit_bytes)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_dir, spill_memory_limit_bytes),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -784,11 +917,12 @@ class ShuffleAndRepeatDatasetOp::Dataset : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this, {input_graph_node, buffer_size, seed, seed2, count},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
-        output));
+        attrs, output));
     return Status::OK();
   }
 
@@ -803,8 +937,10 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
  public:
   DatasetV2(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
             int64 count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            const std::string& spill_dir, int64 spill_memory_limit_bytes)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_dir, spill_memory_limit_bytes),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -845,13 +981,14 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddSpillAttrs(b, &attrs);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, count_node, resource_handle_node},  // Inputs
-                      {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
-                      output));
+                      attrs, output));
     return Status::OK();
   }
 
@@ -937,7 +1074,8 @@ void ShuffleAndRepeatDatasetOp::MakeDataset(OpKernelContext* ctx,
     // Ownership of manager is transferred onto `DatasetV2`.
     *output = new ShuffleAndRepeatDatasetOp::DatasetV2(
         ctx, input, buffer_size, count, std::move(seeds), manager,
-        std::move(handle), owns_resource);
+        std::move(handle), owns_resource, spill_dir_,
+        spill_memory_limit_bytes_);
   } else {
     if (op_version_ != 1) {
       LOG(WARNING) << "Unsupported version of shuffle dataset op: "
@@ -964,7 +1102,8 @@ void ShuffleAndRepeatDatasetOp::MakeDataset(OpKernelContext* ctx,
 
     // Ownership of manager is transferred onto `Dataset`.
     *output = new Dataset(ctx, input, buffer_size, std::move(seeds), manager,
-                          count, std::move(handle));
+                          count, std::move(handle), spill_dir_,
+                          spill_memory_limit_bytes_);
   }
 }
 
@@ -30,11 +30,18 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kReshuffleEachIteration =
       "reshuffle_each_iteration";
+  static constexpr const char* const kSpillDir = "spill_dir";
+  static constexpr const char* const kSpillMemoryLimitBytes =
+      "spill_memory_limit_bytes";
 
   explicit ShuffleDatasetOpBase(OpKernelConstruction* ctx);
 
  protected:
   class ShuffleDatasetBase;
+
+  // Scratch directory to spill the buffer to, or empty to keep it in memory.
+  std::string spill_dir_;
+  int64 spill_memory_limit_bytes_ = 0;
 };
 
 class ShuffleDatasetOp : public ShuffleDatasetOpBase {
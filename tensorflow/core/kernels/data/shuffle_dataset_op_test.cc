@@ -13,6 +13,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
 namespace data {
@@ -28,14 +29,17 @@ class ShuffleDatasetParams : public DatasetParams {
                        int64 seed2, int64 count, bool reshuffle_each_iteration,
                        DataTypeVector output_dtypes,
                        std::vector<PartialTensorShape> output_shapes,
-                       string node_name)
+                       string node_name, string spill_dir = "",
+                       int64 spill_memory_limit_bytes = 1LL << 30)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         seed_(seed),
         seed2_(seed2),
         count_(count),
-        reshuffle_each_iteration_(reshuffle_each_iteration) {
+        reshuffle_each_iteration_(reshuffle_each_iteration),
+        spill_dir_(std::move(spill_dir)),
+        spill_memory_limit_bytes_(spill_memory_limit_bytes) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -74,6 +78,9 @@ class ShuffleDatasetParams : public DatasetParams {
                               output_shapes_);
     attr_vector->emplace_back(ShuffleDatasetOp::kReshuffleEachIteration,
                               reshuffle_each_iteration_);
+    attr_vector->emplace_back(ShuffleDatasetOpBase::kSpillDir, spill_dir_);
+    attr_vector->emplace_back(ShuffleDatasetOpBase::kSpillMemoryLimitBytes,
+                              spill_memory_limit_bytes_);
     return Status::OK();
   }
 
@@ -92,6 +99,8 @@ class ShuffleDatasetParams : public DatasetParams {
   int64 seed2_;
   int64 count_;
   bool reshuffle_each_iteration_;
+  string spill_dir_;
+  int64 spill_memory_limit_bytes_;
 };
 
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
@@ -549,6 +558,71 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Spills every element to disk, by setting a memory limit of one byte, and
+// checks that the iterator still produces each element once and can be
+// restored in the middle of an epoch.
+TEST_F(ShuffleDatasetOpTest, SpillToDisk) {
+  const string spill_dir =
+      io::JoinPath(testing::TmpDir(), "shuffle_dataset_op_test_spill");
+  // Shuffles and repeats twice, to spill elements of two epochs.
+  auto dataset_params = ShuffleDatasetParams(
+      RangeDatasetParams(0, 10, 1),
+      /*buffer_size=*/10,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*count=*/2,
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleAndRepeatNodeName,
+      /*spill_dir=*/spill_dir,
+      /*spill_memory_limit_bytes=*/1);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  for (int i = 0; i < 7; ++i) {
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+  }
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+
+  std::vector<int64> expected;
+  while (true) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    if (end_of_sequence) break;
+    expected.push_back(next[0].scalar<int64>()());
+  }
+
+  VariantTensorDataReader reader(data);
+  TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                               dataset_params.iterator_prefix(), *dataset_,
+                               &iterator_));
+  std::vector<int64> restored;
+  while (true) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    if (end_of_sequence) break;
+    restored.push_back(next[0].scalar<int64>()());
+  }
+  EXPECT_EQ(restored, expected);
+  // 20 elements in total, over two epochs of 10.
+  EXPECT_EQ(expected.size(), 13);
+  iterator_.reset();
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(spill_dir, &children));
+  EXPECT_TRUE(children.empty());
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
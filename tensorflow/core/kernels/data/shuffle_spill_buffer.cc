@@ -0,0 +1,230 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/shuffle_spill_buffer.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Runs are only read sequentially, so a modest buffer per run suffices.
+constexpr int64 kRunReadBufferBytes = 256 << 10;
+
+constexpr char kReservoir[] = "reservoir";
+constexpr char kNumRuns[] = "num_runs";
+constexpr char kRun[] = "run";
+
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& tensor : element) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace
+
+ShuffleSpillBuffer::ShuffleSpillBuffer(Env* env, std::string scratch_dir)
+    : env_(env), scratch_dir_(std::move(scratch_dir)) {}
+
+ShuffleSpillBuffer::~ShuffleSpillBuffer() { Clear(); }
+
+void ShuffleSpillBuffer::Add(std::vector<Tensor> element) {
+  memory_bytes_ += ElementBytes(element);
+  reservoir_.push_back(std::move(element));
+}
+
+Status ShuffleSpillBuffer::NewRunFile(std::string* filename,
+                                      std::unique_ptr<WritableFile>* file) {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(scratch_dir_));
+  *filename = io::JoinPath(
+      scratch_dir_, absl::StrCat("shuffle_spill_", random::New64(), ".run"));
+  return env_->NewWritableFile(*filename, file);
+}
+
+Status ShuffleSpillBuffer::OpenRun(Run* run) {
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(run->filename, &run->file));
+  io::RecordReaderOptions options;
+  options.buffer_size = kRunReadBufferBytes;
+  run->reader = absl::make_unique<io::RecordReader>(run->file.get(), options);
+  run->offset = 0;
+  return Status::OK();
+}
+
+Status ShuffleSpillBuffer::Spill(uint64 seed) {
+  if (reservoir_.empty()) {
+    return Status::OK();
+  }
+  random::PhiloxRandom parent_generator(seed);
+  random::SingleSampleAdapter<random::PhiloxRandom> generator(
+      &parent_generator);
+  for (size_t i = reservoir_.size() - 1; i > 0; --i) {
+    std::swap(reservoir_[i], reservoir_[generator() % (i + 1)]);
+  }
+
+  auto run = absl::make_unique<Run>();
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(NewRunFile(&run->filename, &file));
+  // Registered before writing, so that the file is deleted on failure.
+  runs_.push_back(std::move(run));
+  Run* new_run = runs_.back().get();
+  {
+    io::RecordWriter writer(file.get());
+    tstring record;
+    for (const auto& element : reservoir_) {
+      TF_RETURN_IF_ERROR(SerializeElement(element, &record));
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+  }
+  TF_RETURN_IF_ERROR(file->Close());
+  TF_RETURN_IF_ERROR(OpenRun(new_run));
+  new_run->num_elements = reservoir_.size();
+  num_spilled_ += reservoir_.size();
+  reservoir_.clear();
+  memory_bytes_ = 0;
+  return Status::OK();
+}
+
+Status ShuffleSpillBuffer::ReadFromRun(size_t i, std::vector<Tensor>* element) {
+  Run* run = runs_[i].get();
+  tstring record;
+  TF_RETURN_IF_ERROR(run->reader->ReadRecord(&run->offset, &record));
+  TF_RETURN_IF_ERROR(DeserializeElement(record, element));
+  --run->num_elements;
+  --num_spilled_;
+  if (run->num_elements == 0) {
+    DeleteRun(run);
+    runs_.erase(runs_.begin() + i);
+  }
+  return Status::OK();
+}
+
+Status ShuffleSpillBuffer::Remove(int64 index, std::vector<Tensor>* element) {
+  if (index < 0 || index >= size()) {
+    return errors::OutOfRange("Index ", index,
+                              " is out of range for a buffer of size ",
+                              size());
+  }
+  const int64 num_in_memory = reservoir_.size();
+  if (index < num_in_memory) {
+    *element = std::move(reservoir_[index]);
+    if (index != num_in_memory - 1) {
+      reservoir_[index] = std::move(reservoir_.back());
+    }
+    reservoir_.pop_back();
+    memory_bytes_ -= ElementBytes(*element);
+    return Status::OK();
+  }
+  index -= num_in_memory;
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    if (index < runs_[i]->num_elements) {
+      return ReadFromRun(i, element);
+    }
+    index -= runs_[i]->num_elements;
+  }
+  return errors::Internal("Shuffle spill buffer is inconsistent");
+}
+
+void ShuffleSpillBuffer::DeleteRun(Run* run) {
+  run->reader.reset();
+  run->file.reset();
+  Status s = env_->DeleteFile(run->filename);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete shuffle spill file " << run->filename
+                 << ": " << s;
+  }
+}
+
+void ShuffleSpillBuffer::Clear() {
+  for (auto& run : runs_) {
+    DeleteRun(run.get());
+  }
+  runs_.clear();
+  num_spilled_ = 0;
+  reservoir_.clear();
+  memory_bytes_ = 0;
+}
+
+Status ShuffleSpillBuffer::Save(IteratorStateWriter* writer,
+                                const std::string& key_prefix) {
+  TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+      writer, absl::StrCat(key_prefix, "::", kReservoir), reservoir_));
+  TF_RETURN_IF_ERROR(writer->WriteScalar(key_prefix, kNumRuns, runs_.size()));
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    const Run& run = *runs_[i];
+    // Reads the rest of the run without disturbing the buffered reader.
+    io::RecordReader reader(run.file.get());
+    uint64 offset = run.offset;
+    tstring record;
+    TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+        writer, absl::StrCat(key_prefix, "::", kRun, i), run.num_elements,
+        [&](int64 j, std::vector<Tensor>* element) {
+          TF_RETURN_IF_ERROR(reader.ReadRecord(&offset, &record));
+          return DeserializeElement(record, element);
+        }));
+  }
+  return Status::OK();
+}
+
+Status ShuffleSpillBuffer::Restore(IteratorStateReader* reader,
+                                   const std::string& key_prefix) {
+  Clear();
+  TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+      reader, absl::StrCat(key_prefix, "::", kReservoir), &reservoir_));
+  for (const auto& element : reservoir_) {
+    memory_bytes_ += ElementBytes(element);
+  }
+  int64 num_runs;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(key_prefix, kNumRuns, &num_runs));
+  for (int64 i = 0; i < num_runs; ++i) {
+    auto run = absl::make_unique<Run>();
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(NewRunFile(&run->filename, &file));
+    runs_.push_back(std::move(run));
+    Run* new_run = runs_.back().get();
+    // The elements are written back one at a time, so restoring a run does
+    // not need to hold it in memory.
+    {
+      io::RecordWriter writer(file.get());
+      tstring record;
+      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+          reader, absl::StrCat(key_prefix, "::", kRun, i),
+          [&](std::vector<Tensor> element) {
+            TF_RETURN_IF_ERROR(SerializeElement(element, &record));
+            ++new_run->num_elements;
+            return writer.WriteRecord(record);
+          }));
+      TF_RETURN_IF_ERROR(writer.Close());
+    }
+    TF_RETURN_IF_ERROR(file->Close());
+    TF_RETURN_IF_ERROR(OpenRun(new_run));
+    num_spilled_ += new_run->num_elements;
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
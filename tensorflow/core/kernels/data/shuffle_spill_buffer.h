@@ -0,0 +1,121 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_SPILL_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_SPILL_BUFFER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+
+// A shuffle buffer that keeps some of its elements in an in-memory reservoir
+// and the rest in "runs": files in a local scratch directory that each hold
+// a batch of serialized elements in random order.
+//
+// Since the elements of a run are shuffled when it is written, reading the
+// next element of a run is equivalent to drawing one of its remaining
+// elements at random. Removing element `index` of the buffer therefore draws
+// uniformly from all of its elements while only reading the runs
+// sequentially.
+//
+// The buffer never spills by itself; the owner calls `Spill()` to bound its
+// memory usage. Run files are deleted once they are exhausted, and when the
+// buffer is destroyed.
+//
+// A ShuffleSpillBuffer is NOT safe for concurrent use by multiple threads.
+class ShuffleSpillBuffer {
+ public:
+  ShuffleSpillBuffer(Env* env, std::string scratch_dir);
+  ~ShuffleSpillBuffer();
+
+  // Returns the number of elements in the buffer.
+  int64 size() const { return reservoir_.size() + num_spilled_; }
+
+  // Returns the number of elements in run files.
+  int64 num_spilled() const { return num_spilled_; }
+
+  // Returns the number of tensor bytes held in memory.
+  int64 memory_bytes() const { return memory_bytes_; }
+
+  // Adds `element` to the in-memory reservoir.
+  void Add(std::vector<Tensor> element);
+
+  // Writes the in-memory reservoir to a new run file, in a random order
+  // derived from `seed`.
+  Status Spill(uint64 seed);
+
+  // Removes the element at `index`, which must be less than `size()`.
+  // Elements in memory come first, followed by the runs in the order they
+  // were spilled; only the next element of a run can be removed, which
+  // stands for any element of the run.
+  Status Remove(int64 index, std::vector<Tensor>* element);
+
+  // Saves the contents of the buffer to `writer` under `key_prefix`. The
+  // remaining elements of each run are written to the checkpoint, so it can
+  // be restored after the scratch files are gone.
+  Status Save(IteratorStateWriter* writer, const std::string& key_prefix);
+
+  // Replaces the contents of the buffer with those saved under `key_prefix`,
+  // writing the saved runs to new scratch files.
+  Status Restore(IteratorStateReader* reader, const std::string& key_prefix);
+
+ private:
+  struct Run {
+    std::string filename;
+    // The number of elements left to read.
+    int64 num_elements = 0;
+    std::unique_ptr<RandomAccessFile> file;
+    std::unique_ptr<io::RecordReader> reader;
+    uint64 offset = 0;
+  };
+
+  // Creates an empty run file and returns a writer for it.
+  Status NewRunFile(std::string* filename,
+                    std::unique_ptr<WritableFile>* file);
+
+  // Opens `run` for reading its elements from the start.
+  Status OpenRun(Run* run);
+
+  // Reads the next element of `runs_[i]`, deleting the run if it is
+  // exhausted.
+  Status ReadFromRun(size_t i, std::vector<Tensor>* element);
+
+  // Deletes the file of `run`, logging failures.
+  void DeleteRun(Run* run);
+
+  // Deletes all runs and elements.
+  void Clear();
+
+  Env* const env_;
+  const std::string scratch_dir_;
+  std::vector<std::vector<Tensor>> reservoir_;
+  int64 memory_bytes_ = 0;
+  std::vector<std::unique_ptr<Run>> runs_;
+  int64 num_spilled_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShuffleSpillBuffer);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_SPILL_BUFFER_H_
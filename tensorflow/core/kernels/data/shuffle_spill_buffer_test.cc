@@ -0,0 +1,182 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/shuffle_spill_buffer.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string ScratchDir(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), "shuffle_spill_buffer_test", name);
+}
+
+int NumFiles(const std::string& dir) {
+  std::vector<string> children;
+  if (!Env::Default()->GetChildren(dir, &children).ok()) return 0;
+  return children.size();
+}
+
+// Elements have an int64 and a string component.
+std::vector<Tensor> MakeElement(int64 i) {
+  return {CreateTensor<int64>(TensorShape({}), {i}),
+          CreateTensor<tstring>(TensorShape({2}),
+                                {strings::StrCat("a", i), "b"})};
+}
+
+int64 ElementId(const std::vector<Tensor>& element) {
+  EXPECT_EQ(element.size(), 2);
+  EXPECT_EQ(element[1].flat<tstring>()(0),
+            strings::StrCat("a", element[0].scalar<int64>()()));
+  return element[0].scalar<int64>()();
+}
+
+TEST(ShuffleSpillBufferTest, InMemory) {
+  const std::string dir = ScratchDir("in_memory");
+  ShuffleSpillBuffer buffer(Env::Default(), dir);
+  for (int64 i = 0; i < 10; ++i) {
+    buffer.Add(MakeElement(i));
+  }
+  EXPECT_EQ(buffer.size(), 10);
+  EXPECT_EQ(buffer.num_spilled(), 0);
+  EXPECT_GT(buffer.memory_bytes(), 0);
+
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(buffer.Remove(3, &element));
+  EXPECT_EQ(ElementId(element), 3);
+  // The last element takes the place of the removed one.
+  TF_ASSERT_OK(buffer.Remove(3, &element));
+  EXPECT_EQ(ElementId(element), 9);
+  EXPECT_EQ(buffer.size(), 8);
+  EXPECT_TRUE(errors::IsOutOfRange(buffer.Remove(8, &element)));
+  EXPECT_EQ(NumFiles(dir), 0);
+}
+
+TEST(ShuffleSpillBufferTest, SpillAndRemove) {
+  const std::string dir = ScratchDir("spill_and_remove");
+  ShuffleSpillBuffer buffer(Env::Default(), dir);
+  for (int64 i = 0; i < 100; ++i) {
+    buffer.Add(MakeElement(i));
+    if (i % 30 == 29) {
+      TF_ASSERT_OK(buffer.Spill(/*seed=*/i));
+      EXPECT_EQ(buffer.memory_bytes(), 0);
+    }
+  }
+  EXPECT_EQ(buffer.size(), 100);
+  EXPECT_EQ(buffer.num_spilled(), 90);
+  EXPECT_EQ(NumFiles(dir), 3);
+
+  // Draws from the runs as well as from memory.
+  std::vector<int64> ids;
+  std::vector<Tensor> element;
+  while (buffer.size() > 0) {
+    TF_ASSERT_OK(buffer.Remove(buffer.size() - 1, &element));
+    ids.push_back(ElementId(element));
+  }
+  // The last run is drained first, and its elements were shuffled.
+  std::vector<int64> last_run(ids.begin(), ids.begin() + 30);
+  EXPECT_FALSE(std::is_sorted(last_run.begin(), last_run.end()));
+  std::sort(last_run.begin(), last_run.end());
+  EXPECT_EQ(last_run.front(), 60);
+  EXPECT_EQ(last_run.back(), 89);
+
+  std::sort(ids.begin(), ids.end());
+  for (int64 i = 0; i < 100; ++i) {
+    EXPECT_EQ(ids[i], i);
+  }
+  // Exhausted runs are deleted.
+  EXPECT_EQ(NumFiles(dir), 0);
+}
+
+TEST(ShuffleSpillBufferTest, SpillIsDeterministic) {
+  std::vector<std::vector<int64>> orders;
+  for (int i = 0; i < 2; ++i) {
+    ShuffleSpillBuffer buffer(Env::Default(), ScratchDir("deterministic"));
+    for (int64 j = 0; j < 50; ++j) {
+      buffer.Add(MakeElement(j));
+    }
+    TF_ASSERT_OK(buffer.Spill(/*seed=*/42));
+    orders.emplace_back();
+    std::vector<Tensor> element;
+    while (buffer.size() > 0) {
+      TF_ASSERT_OK(buffer.Remove(0, &element));
+      orders.back().push_back(ElementId(element));
+    }
+  }
+  EXPECT_EQ(orders[0], orders[1]);
+}
+
+TEST(ShuffleSpillBufferTest, SaveAndRestore) {
+  const std::string dir = ScratchDir("save_and_restore");
+  ShuffleSpillBuffer buffer(Env::Default(), dir);
+  for (int64 i = 0; i < 40; ++i) {
+    buffer.Add(MakeElement(i));
+    if (i % 16 == 15) {
+      TF_ASSERT_OK(buffer.Spill(/*seed=*/i));
+    }
+  }
+  std::vector<Tensor> element;
+  for (int64 index : {35, 20, 3}) {
+    TF_ASSERT_OK(buffer.Remove(index, &element));
+  }
+
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(buffer.Save(&writer, FullName("test", "buffer")));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  ShuffleSpillBuffer restored(Env::Default(), dir);
+  TF_ASSERT_OK(restored.Restore(&reader, FullName("test", "buffer")));
+  EXPECT_EQ(restored.size(), buffer.size());
+  EXPECT_EQ(restored.num_spilled(), buffer.num_spilled());
+  EXPECT_EQ(restored.memory_bytes(), buffer.memory_bytes());
+
+  // The restored buffer produces the same elements for the same indices.
+  std::vector<Tensor> restored_element;
+  int64 index = 7;
+  while (buffer.size() > 0) {
+    index = (index * 31 + 11) % buffer.size();
+    TF_ASSERT_OK(buffer.Remove(index, &element));
+    TF_ASSERT_OK(restored.Remove(index, &restored_element));
+    EXPECT_EQ(ElementId(element), ElementId(restored_element));
+  }
+  EXPECT_EQ(restored.size(), 0);
+  EXPECT_EQ(NumFiles(dir), 0);
+}
+
+TEST(ShuffleSpillBufferTest, DeletesRunsOnDestruction) {
+  const std::string dir = ScratchDir("destruction");
+  {
+    ShuffleSpillBuffer buffer(Env::Default(), dir);
+    for (int64 i = 0; i < 10; ++i) {
+      buffer.Add(MakeElement(i));
+      TF_ASSERT_OK(buffer.Spill(/*seed=*/i));
+    }
+    EXPECT_EQ(NumFiles(dir), 10);
+  }
+  EXPECT_EQ(NumFiles(dir), 0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
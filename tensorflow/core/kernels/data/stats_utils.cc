@@ -32,6 +32,10 @@ ABSL_CONST_INIT const char kDroppedElements[] = "dropped_elements";
 ABSL_CONST_INIT const char kFeaturesCount[] = "features_count";
 ABSL_CONST_INIT const char kFeatureValuesCount[] = "feature_values_count";
 ABSL_CONST_INIT const char kExamplesCount[] = "examples_count";
+ABSL_CONST_INIT const char kCacheHits[] = "cache_hits";
+ABSL_CONST_INIT const char kCacheMisses[] = "cache_misses";
+ABSL_CONST_INIT const char kCacheMemoryBytes[] = "cache_memory_bytes";
+ABSL_CONST_INIT const char kCacheSpilledBytes[] = "cache_spilled_bytes";
 
 string ExecutionTimeHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kExecutionTime);
@@ -69,6 +73,22 @@ string FeatureValueHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kFeatureValuesCount);
 }
 
+string CacheHitsScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kCacheHits);
+}
+
+string CacheMissesScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kCacheMisses);
+}
+
+string CacheMemoryBytesScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kCacheMemoryBytes);
+}
+
+string CacheSpilledBytesScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kCacheSpilledBytes);
+}
+
 }  // namespace stats_utils
 }  // namespace data
 }  // namespace tensorflow
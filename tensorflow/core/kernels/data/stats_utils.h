@@ -31,6 +31,10 @@ extern const char kDroppedElements[];
 extern const char kFeaturesCount[];
 extern const char kFeatureValuesCount[];
 extern const char kExamplesCount[];
+extern const char kCacheHits[];
+extern const char kCacheMisses[];
+extern const char kCacheMemoryBytes[];
+extern const char kCacheSpilledBytes[];
 
 // Name for tf.data function execution time (in ns) histogram metrics.
 string ExecutionTimeHistogramName(const string& prefix);
@@ -61,6 +65,16 @@ string FeatureHistogramName(const string& prefix);
 // Name for feature-values count histogram metrics.
 string FeatureValueHistogramName(const string& prefix);
 
+// Name for the scalar metrics of cached elements read from memory and from
+// the spill file.
+string CacheHitsScalarName(const string& prefix);
+string CacheMissesScalarName(const string& prefix);
+
+// Name for the scalar metrics of cached bytes held in memory and written to
+// the spill file.
+string CacheMemoryBytesScalarName(const string& prefix);
+string CacheSpilledBytesScalarName(const string& prefix);
+
 }  // namespace stats_utils
 }  // namespace data
 }  // namespace tensorflow
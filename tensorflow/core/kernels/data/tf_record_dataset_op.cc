@@ -14,9 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/file_handle_pool.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
@@ -24,6 +26,9 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zlib_segment_index.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -35,6 +40,15 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kNumReadAheadBuffers;
+/* static */ constexpr const char* const TFRecordDatasetOp::kNumInflateThreads;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kFileHandlePoolThreads;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kFileHandlePoolCapacity;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kFileHandlePoolHeadBytes;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
@@ -42,6 +56,9 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64 kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64 kS3BlockSize = kCloudTpuBlockSize;
+// The number of files after the current one that are opened ahead of time when
+// the `file_handle_pool_threads` attr enables the shared file handle pool.
+constexpr size_t kFilesOpenedAhead = 4;
 
 bool is_cloud_tpu_gcs_fs() {
 #if defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)
@@ -50,17 +67,84 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+// Returns a thread pool of `num_threads` threads, or of one thread per
+// schedulable CPU if `num_threads` is `model::kAutotune`, to inflate ZLIB/GZIP
+// files that have a segment index. Datasets that ask for the same number of
+// threads share a pool, as interleaves create one dataset per file. Returns
+// null if `num_threads` is 0, which disables parallel inflation.
+thread::ThreadPool* InflateThreadPool(int64 num_threads) {
+  if (num_threads == model::kAutotune) {
+    num_threads = port::MaxParallelism();
+  }
+  if (num_threads <= 0) return nullptr;
+  static mutex* mu = new mutex;
+  static auto* pools = new absl::flat_hash_map<int64, thread::ThreadPool*>;
+  mutex_lock l(*mu);
+  thread::ThreadPool*& pool = (*pools)[num_threads];
+  if (pool == nullptr) {
+    pool = new thread::ThreadPool(Env::Default(), "tf_record_inflate",
+                                  num_threads);
+  }
+  return pool;
+}
+
+// Makes `options` inflate `filename` in parallel if the file has an up to date
+// segment index. Looking for the index costs a metadata request per file on
+// remote filesystems, so only datasets that ask for inflate threads do it.
+void MaybeUseZlibSegmentIndex(Env* env, const string& filename,
+                              thread::ThreadPool* pool,
+                              io::RecordReaderOptions* options) {
+  const string index_filename = io::ZlibSegmentIndexFilename(filename);
+  if (!env->FileExists(index_filename).ok()) return;
+  auto index = std::make_shared<io::ZlibSegmentIndex>();
+  Status s = io::ReadZlibSegmentIndex(env, index_filename, index.get());
+  uint64 file_size = 0;
+  if (s.ok()) {
+    s = env->GetFileSize(filename, &file_size);
+  }
+  if (s.ok() && static_cast<int64>(file_size) != index->compressed_size) {
+    s = errors::DataLoss(index_filename, " describes ", index->compressed_size,
+                         " bytes instead of ", file_size);
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Reading " << filename
+                 << " without its segment index: " << s;
+    return;
+  }
+  options->zlib_segment_index = std::move(index);
+  options->zlib_thread_pool = pool;
+}
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   int64 num_read_ahead_buffers, int64 num_inflate_threads,
+                   int64 file_handle_pool_threads,
+                   int64 file_handle_pool_capacity,
+                   int64 file_handle_pool_head_bytes)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
+        num_read_ahead_buffers_(num_read_ahead_buffers),
+        num_inflate_threads_(num_inflate_threads),
+        file_handle_pool_threads_(file_handle_pool_threads),
+        file_handle_pool_capacity_(file_handle_pool_capacity),
+        file_handle_pool_head_bytes_(file_handle_pool_head_bytes),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        file_handle_pool_(FileHandlePool::Shared(file_handle_pool_threads,
+                                                 file_handle_pool_capacity,
+                                                 file_handle_pool_head_bytes)) {
+    if (options_.compression_type ==
+        io::RecordReaderOptions::ZLIB_COMPRESSION) {
+      inflate_thread_pool_ = InflateThreadPool(num_inflate_threads);
+    }
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      // Keeping several buffers in flight lets a single file saturate fast
+      // local storage, at the cost of that many more buffers per open file.
+      options_.num_read_ahead_buffers = num_read_ahead_buffers;
     }
   }
 
@@ -101,8 +185,26 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    AttrValue num_read_ahead_buffers;
+    b->BuildAttrValue(num_read_ahead_buffers_, &num_read_ahead_buffers);
+    AttrValue num_inflate_threads;
+    b->BuildAttrValue(num_inflate_threads_, &num_inflate_threads);
+    AttrValue file_handle_pool_threads;
+    b->BuildAttrValue(file_handle_pool_threads_, &file_handle_pool_threads);
+    AttrValue file_handle_pool_capacity;
+    b->BuildAttrValue(file_handle_pool_capacity_, &file_handle_pool_capacity);
+    AttrValue file_handle_pool_head_bytes;
+    b->BuildAttrValue(file_handle_pool_head_bytes_,
+                      &file_handle_pool_head_bytes);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {std::make_pair(kNumReadAheadBuffers, num_read_ahead_buffers),
+         std::make_pair(kNumInflateThreads, num_inflate_threads),
+         std::make_pair(kFileHandlePoolThreads, file_handle_pool_threads),
+         std::make_pair(kFileHandlePoolCapacity, file_handle_pool_capacity),
+         std::make_pair(kFileHandlePoolHeadBytes,
+                        file_handle_pool_head_bytes)},
+        output));
     return Status::OK();
   }
 
@@ -112,6 +214,19 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
+    ~Iterator() override {
+      mutex_lock l(mu_);
+      CancelPrefetchesLocked();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      // Interleaves create the iterators of their upcoming input elements ahead
+      // of reading from them, so the first files start opening here.
+      mutex_lock l(mu_);
+      PrefetchFilesLocked();
+      return Status::OK();
+    }
+
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
@@ -181,6 +296,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
                            IteratorStateReader* reader) override {
       mutex_lock l(mu_);
       ResetStreamsLocked();
+      CancelPrefetchesLocked();
       int64 current_file_index;
       TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
                                             &current_file_index));
@@ -205,9 +321,20 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
-      reader_ = absl::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      FileHandlePool* pool = dataset()->file_handle_pool_;
+      if (pool != nullptr) {
+        PrefetchFilesLocked();
+        TF_RETURN_IF_ERROR(pool->Open(this, env, next_filename, &file_));
+      } else {
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
+      }
+      io::RecordReaderOptions options = dataset()->options_;
+      if (dataset()->inflate_thread_pool_ != nullptr) {
+        MaybeUseZlibSegmentIndex(env, next_filename,
+                                 dataset()->inflate_thread_pool_, &options);
+      }
+      reader_ =
+          absl::make_unique<io::SequentialRecordReader>(file_.get(), options);
       return Status::OK();
     }
 
@@ -217,8 +344,35 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       file_.reset();
     }
 
+    // Starts opening the current file and the `kFilesOpenedAhead` files after
+    // it in the shared file handle pool, if enabled.
+    void PrefetchFilesLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      FileHandlePool* pool = dataset()->file_handle_pool_;
+      if (pool == nullptr) return;
+      const std::vector<string>& filenames = dataset()->filenames_;
+      next_file_to_prefetch_ =
+          std::max(next_file_to_prefetch_, current_file_index_);
+      const size_t limit = std::min(
+          filenames.size(), current_file_index_ + kFilesOpenedAhead + 1);
+      for (; next_file_to_prefetch_ < limit; ++next_file_to_prefetch_) {
+        pool->Prefetch(this, filenames[next_file_to_prefetch_]);
+      }
+    }
+
+    // Drops the files prefetched for this iterator that it has not opened.
+    void CancelPrefetchesLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      FileHandlePool* pool = dataset()->file_handle_pool_;
+      if (pool == nullptr) return;
+      for (size_t i = current_file_index_; i < next_file_to_prefetch_; ++i) {
+        pool->Cancel(this, dataset()->filenames_[i]);
+      }
+      next_file_to_prefetch_ = 0;
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    // The index of the first file not yet prefetched in the file handle pool.
+    size_t next_file_to_prefetch_ TF_GUARDED_BY(mu_) = 0;
 
     // `reader_` will borrow the object that `file_` points to, so
     // we must destroy `reader_` before `file_`.
@@ -228,11 +382,48 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
+  const int64 num_read_ahead_buffers_;
+  const int64 num_inflate_threads_;
+  const int64 file_handle_pool_threads_;
+  const int64 file_handle_pool_capacity_;
+  const int64 file_handle_pool_head_bytes_;
   io::RecordReaderOptions options_;
+  // Not owned. Null unless segmented ZLIB/GZIP files are inflated in parallel.
+  thread::ThreadPool* inflate_thread_pool_ = nullptr;
+  // Not owned. Null unless files are opened ahead of their readers.
+  FileHandlePool* const file_handle_pool_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kNumReadAheadBuffers, &num_read_ahead_buffers_));
+  OP_REQUIRES(ctx, num_read_ahead_buffers_ >= 0,
+              errors::InvalidArgument("`num_read_ahead_buffers` must be >= 0 "
+                                      "(0 == no read-ahead)"));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kNumInflateThreads, &num_inflate_threads_));
+  OP_REQUIRES(ctx,
+              num_inflate_threads_ >= 0 ||
+                  num_inflate_threads_ == model::kAutotune,
+              errors::InvalidArgument("`num_inflate_threads` must be >= 0 or ",
+                                      model::kAutotune,
+                                      " (0 == serial inflation)"));
+  OP_REQUIRES_OK(
+      ctx, ctx->GetAttr(kFileHandlePoolThreads, &file_handle_pool_threads_));
+  OP_REQUIRES(ctx, file_handle_pool_threads_ >= 0,
+              errors::InvalidArgument("`file_handle_pool_threads` must be >= 0 "
+                                      "(0 == no file handle pool)"));
+  OP_REQUIRES_OK(
+      ctx, ctx->GetAttr(kFileHandlePoolCapacity, &file_handle_pool_capacity_));
+  OP_REQUIRES(
+      ctx, file_handle_pool_capacity_ > 0,
+      errors::InvalidArgument("`file_handle_pool_capacity` must be > 0"));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kFileHandlePoolHeadBytes,
+                                   &file_handle_pool_head_bytes_));
+  OP_REQUIRES(
+      ctx, file_handle_pool_head_bytes_ >= 0,
+      errors::InvalidArgument("`file_handle_pool_head_bytes` must be >= 0"));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -279,8 +470,11 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, num_read_ahead_buffers_,
+                        num_inflate_threads_, file_handle_pool_threads_,
+                        file_handle_pool_capacity_,
+                        file_handle_pool_head_bytes_);
 }
 
 namespace {
@@ -26,6 +26,16 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kFileNames = "filenames";
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kNumReadAheadBuffers =
+      "num_read_ahead_buffers";
+  static constexpr const char* const kNumInflateThreads =
+      "num_inflate_threads";
+  static constexpr const char* const kFileHandlePoolThreads =
+      "file_handle_pool_threads";
+  static constexpr const char* const kFileHandlePoolCapacity =
+      "file_handle_pool_capacity";
+  static constexpr const char* const kFileHandlePoolHeadBytes =
+      "file_handle_pool_head_bytes";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -34,6 +44,12 @@ class TFRecordDatasetOp : public DatasetOpKernel {
 
  private:
   class Dataset;
+
+  int64 num_read_ahead_buffers_;
+  int64 num_inflate_threads_;
+  int64 file_handle_pool_threads_;
+  int64 file_handle_pool_capacity_;
+  int64 file_handle_pool_head_bytes_;
 };
 
 }  // namespace data
@@ -0,0 +1,185 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/tiered_cache.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& tensor : element) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace
+
+TieredCache::TieredCache(Env* env, int64 memory_budget_bytes,
+                         std::string spill_dir)
+    : env_(env),
+      memory_budget_bytes_(memory_budget_bytes),
+      spill_dir_(std::move(spill_dir)) {}
+
+TieredCache::~TieredCache() {
+  if (filename_.empty()) return;
+  read_file_.reset();
+  write_file_.reset();
+  Status s = env_->DeleteFile(filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete cache file " << filename_ << ": " << s;
+  }
+}
+
+Status TieredCache::Append(std::vector<Tensor> element) {
+  mutex_lock l(mu_);
+  Entry entry;
+  entry.bytes = ElementBytes(element);
+  if (stats_.memory_bytes + entry.bytes <= memory_budget_bytes_) {
+    entry.element = std::move(element);
+    entry.in_memory = true;
+    lru_.push_front(entries_.size());
+    entry.lru_position = lru_.begin();
+    stats_.memory_bytes += entry.bytes;
+  } else {
+    TF_RETURN_IF_ERROR(WriteToFile(element, &entry));
+  }
+  entries_.push_back(std::move(entry));
+  return Status::OK();
+}
+
+Status TieredCache::Get(int64 index, std::vector<Tensor>* element) {
+  mutex_lock l(mu_);
+  if (index < 0 || index >= static_cast<int64>(entries_.size())) {
+    return errors::OutOfRange("Index ", index, " is out of range for ",
+                              entries_.size(), " cached elements");
+  }
+  Entry* entry = &entries_[index];
+  if (entry->in_memory) {
+    ++stats_.hits;
+    lru_.splice(lru_.begin(), lru_, entry->lru_position);
+    *element = entry->element;
+    return Status::OK();
+  }
+  ++stats_.misses;
+  TF_RETURN_IF_ERROR(ReadFromFile(*entry, element));
+  if (entry->bytes <= memory_budget_bytes_) {
+    TF_RETURN_IF_ERROR(EvictUntil(memory_budget_bytes_ - entry->bytes));
+    entry->element = *element;
+    entry->in_memory = true;
+    entry->lru_position = lru_.insert(lru_.end(), index);
+    stats_.memory_bytes += entry->bytes;
+  }
+  return Status::OK();
+}
+
+Status TieredCache::Peek(int64 index, std::vector<Tensor>* element) {
+  mutex_lock l(mu_);
+  if (index < 0 || index >= static_cast<int64>(entries_.size())) {
+    return errors::OutOfRange("Index ", index, " is out of range for ",
+                              entries_.size(), " cached elements");
+  }
+  const Entry& entry = entries_[index];
+  if (entry.in_memory) {
+    *element = entry.element;
+    return Status::OK();
+  }
+  return ReadFromFile(entry, element);
+}
+
+int64 TieredCache::size() {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+TieredCache::Stats TieredCache::stats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+Status TieredCache::WriteToFile(const std::vector<Tensor>& element,
+                                Entry* entry) {
+  if (write_file_ == nullptr) {
+    if (spill_dir_.empty()) {
+      if (!env_->LocalTempFilename(&filename_)) {
+        return errors::Unavailable("No local temporary directory for the ",
+                                   "cache file");
+      }
+    } else {
+      TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(spill_dir_));
+      filename_ = io::JoinPath(
+          spill_dir_, absl::StrCat("cache_", random::New64(), ".spill"));
+    }
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(filename_, &write_file_));
+  }
+  tstring serialized;
+  TF_RETURN_IF_ERROR(SerializeElement(element, &serialized));
+  TF_RETURN_IF_ERROR(write_file_->Append(serialized));
+  entry->file_offset = file_size_;
+  entry->file_length = serialized.size();
+  file_size_ += serialized.size();
+  stats_.spilled_bytes += serialized.size();
+  needs_flush_ = true;
+  return Status::OK();
+}
+
+Status TieredCache::ReadFromFile(const Entry& entry,
+                                 std::vector<Tensor>* element) {
+  if (needs_flush_) {
+    TF_RETURN_IF_ERROR(write_file_->Flush());
+    needs_flush_ = false;
+  }
+  if (read_file_ == nullptr) {
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &read_file_));
+  }
+  std::unique_ptr<char[]> scratch(new char[entry.file_length]);
+  StringPiece serialized;
+  Status s = read_file_->Read(entry.file_offset, entry.file_length,
+                              &serialized, scratch.get());
+  if (errors::IsOutOfRange(s) && serialized.size() == entry.file_length) {
+    s = Status::OK();
+  }
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Cache file ", filename_, " is truncated");
+  }
+  TF_RETURN_IF_ERROR(s);
+  return DeserializeElement(serialized, element);
+}
+
+Status TieredCache::EvictUntil(int64 memory_bytes) {
+  while (stats_.memory_bytes > memory_bytes && !lru_.empty()) {
+    Entry* victim = &entries_[lru_.back()];
+    if (victim->file_offset < 0) {
+      TF_RETURN_IF_ERROR(WriteToFile(victim->element, victim));
+    }
+    victim->element.clear();
+    victim->in_memory = false;
+    stats_.memory_bytes -= victim->bytes;
+    lru_.pop_back();
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
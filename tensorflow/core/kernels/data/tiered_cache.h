@@ -0,0 +1,126 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_TIERED_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_TIERED_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+
+// Holds the elements of a cached dataset, keeping at most
+// `memory_budget_bytes` of tensor data in memory and the rest in a local file.
+//
+// Elements are appended in order. Those that do not fit in memory are written
+// to the file. Reading an element that is not in memory loads it from the
+// file and admits it into memory, evicting the least recently used elements.
+// Evicted elements that are not in the file yet are written to it first.
+//
+// Admitted elements are inserted at the least recently used end, and only move
+// up when they are read again before being evicted. A dataset that is read
+// sequentially over and over, as cached datasets are, thus keeps hitting on
+// the elements already in memory, where plain LRU would evict every element
+// before it is read again.
+//
+// TieredCache is thread-safe. File reads are done under the lock.
+class TieredCache {
+ public:
+  struct Stats {
+    // The number of Get() calls served from memory and from the file.
+    int64 hits = 0;
+    int64 misses = 0;
+    // The bytes of tensor data held in memory.
+    int64 memory_bytes = 0;
+    // The bytes of serialized elements written to the file.
+    int64 spilled_bytes = 0;
+  };
+
+  // The file is created in `spill_dir`, or in a local temporary directory if
+  // it is empty.
+  TieredCache(Env* env, int64 memory_budget_bytes, std::string spill_dir);
+
+  // Deletes the file.
+  ~TieredCache();
+
+  // Appends `element` to the cache.
+  Status Append(std::vector<Tensor> element);
+
+  // Copies the element at `index` into `*element`, loading it into memory if
+  // needed.
+  Status Get(int64 index, std::vector<Tensor>* element);
+
+  // Like Get(), but leaves the memory tier and the statistics unchanged.
+  Status Peek(int64 index, std::vector<Tensor>* element);
+
+  // Returns the number of elements in the cache.
+  int64 size();
+
+  Stats stats();
+
+ private:
+  struct Entry {
+    // Only set while the element is in memory.
+    std::vector<Tensor> element;
+    int64 bytes = 0;
+    // The location of the serialized element in the file, or -1 if it was
+    // not written.
+    int64 file_offset = -1;
+    size_t file_length = 0;
+    bool in_memory = false;
+    // Position in `lru_` while in memory.
+    std::list<int64>::iterator lru_position;
+  };
+
+  // Writes `element` at the end of the file, recording its location in
+  // `*entry`.
+  Status WriteToFile(const std::vector<Tensor>& element, Entry* entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Status ReadFromFile(const Entry& entry, std::vector<Tensor>* element)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Evicts elements until at most `memory_bytes` are in memory.
+  Status EvictUntil(int64 memory_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const int64 memory_budget_bytes_;
+  const std::string spill_dir_;
+
+  mutex mu_;
+  std::vector<Entry> entries_ TF_GUARDED_BY(mu_);
+  // Indices of the elements in memory, most recently used first.
+  std::list<int64> lru_ TF_GUARDED_BY(mu_);
+  std::string filename_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<WritableFile> write_file_ TF_GUARDED_BY(mu_);
+  // Whether `write_file_` may buffer data that `read_file_` cannot see yet.
+  bool needs_flush_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<RandomAccessFile> read_file_ TF_GUARDED_BY(mu_);
+  int64 file_size_ TF_GUARDED_BY(mu_) = 0;
+  Stats stats_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TieredCache);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_TIERED_CACHE_H_
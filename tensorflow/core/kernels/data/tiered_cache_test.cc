@@ -0,0 +1,156 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/tiered_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Each element holds 16 int64 values, i.e. 128 bytes.
+constexpr int64 kElementBytes = 128;
+
+std::string SpillDir(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), "tiered_cache_test", name);
+}
+
+int NumFiles(const std::string& dir) {
+  std::vector<string> children;
+  if (!Env::Default()->GetChildren(dir, &children).ok()) return 0;
+  return children.size();
+}
+
+std::vector<Tensor> MakeElement(int64 i) {
+  std::vector<int64> values(16, i);
+  return {CreateTensor<int64>(TensorShape({16}), values)};
+}
+
+int64 ElementId(const std::vector<Tensor>& element) {
+  EXPECT_EQ(element.size(), 1);
+  return element[0].flat<int64>()(15);
+}
+
+TEST(TieredCacheTest, InMemory) {
+  const std::string dir = SpillDir("in_memory");
+  TieredCache cache(Env::Default(), 10 * kElementBytes, dir);
+  for (int64 i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(cache.Append(MakeElement(i)));
+  }
+  EXPECT_EQ(cache.size(), 10);
+  std::vector<Tensor> element;
+  for (int64 i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(cache.Get(i, &element));
+    EXPECT_EQ(ElementId(element), i);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(cache.Get(10, &element)));
+  TieredCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 10);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.memory_bytes, 10 * kElementBytes);
+  EXPECT_EQ(stats.spilled_bytes, 0);
+  EXPECT_EQ(NumFiles(dir), 0);
+}
+
+TEST(TieredCacheTest, SpillsWhatDoesNotFit) {
+  const std::string dir = SpillDir("spill");
+  TieredCache cache(Env::Default(), 4 * kElementBytes, dir);
+  for (int64 i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(cache.Append(MakeElement(i)));
+  }
+  TieredCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.memory_bytes, 4 * kElementBytes);
+  EXPECT_GT(stats.spilled_bytes, 0);
+  EXPECT_EQ(NumFiles(dir), 1);
+
+  std::vector<Tensor> element;
+  for (int64 i = 9; i >= 0; --i) {
+    TF_ASSERT_OK(cache.Get(i, &element));
+    EXPECT_EQ(ElementId(element), i);
+  }
+  // Loading the spilled elements never exceeds the budget.
+  EXPECT_LE(cache.stats().memory_bytes, 4 * kElementBytes);
+}
+
+TEST(TieredCacheTest, RepeatedScansKeepHitting) {
+  TieredCache cache(Env::Default(), 50 * kElementBytes, SpillDir("scans"));
+  for (int64 i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(cache.Append(MakeElement(i)));
+  }
+  std::vector<Tensor> element;
+  for (int epoch = 0; epoch < 5; ++epoch) {
+    for (int64 i = 0; i < 100; ++i) {
+      TF_ASSERT_OK(cache.Get(i, &element));
+      EXPECT_EQ(ElementId(element), i);
+    }
+  }
+  // With least recently used insertion every scan would miss on all elements;
+  // inserting loaded elements at the cold end keeps most of the hot ones.
+  TieredCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.hits + stats.misses, 500);
+  EXPECT_GE(stats.hits, 5 * 49);
+}
+
+TEST(TieredCacheTest, EvictedElementsAreWrittenBack) {
+  TieredCache cache(Env::Default(), 2 * kElementBytes, SpillDir("evict"));
+  for (int64 i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(cache.Append(MakeElement(i)));
+  }
+  const int64 spilled_bytes = cache.stats().spilled_bytes;
+  std::vector<Tensor> element;
+  // Loading element 2 evicts element 0 or 1, which were never written.
+  TF_ASSERT_OK(cache.Get(2, &element));
+  EXPECT_GT(cache.stats().spilled_bytes, spilled_bytes);
+  for (int64 i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(cache.Get(i, &element));
+    EXPECT_EQ(ElementId(element), i);
+  }
+}
+
+TEST(TieredCacheTest, PeekHasNoSideEffects) {
+  TieredCache cache(Env::Default(), kElementBytes, SpillDir("peek"));
+  for (int64 i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(cache.Append(MakeElement(i)));
+  }
+  const TieredCache::Stats before = cache.stats();
+  std::vector<Tensor> element;
+  for (int64 i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(cache.Peek(i, &element));
+    EXPECT_EQ(ElementId(element), i);
+  }
+  const TieredCache::Stats after = cache.stats();
+  EXPECT_EQ(after.hits, before.hits);
+  EXPECT_EQ(after.misses, before.misses);
+  EXPECT_EQ(after.memory_bytes, before.memory_bytes);
+  EXPECT_EQ(after.spilled_bytes, before.spilled_bytes);
+}
+
+TEST(TieredCacheTest, DeletesFileOnDestruction) {
+  const std::string dir = SpillDir("destruction");
+  {
+    TieredCache cache(Env::Default(), 0, dir);
+    TF_ASSERT_OK(cache.Append(MakeElement(0)));
+    EXPECT_EQ(NumFiles(dir), 1);
+  }
+  EXPECT_EQ(NumFiles(dir), 0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -66,6 +66,21 @@ class Int64Filler {
   DataType dtype = DT_INT64;
 };
 
+// Fills small ids, which are encoded as single-byte varints.
+class SmallInt64Filler {
+ public:
+  SmallInt64Filler() {}
+  void operator()(Feature* f, int feature_size) const {
+    for (int i = 0; i < feature_size; ++i) {
+      f->mutable_int64_list()->add_value(i % 100);
+    }
+  }
+  Tensor make_dense_default(int feature_size) {
+    return Tensor(dtype, TensorShape({feature_size}));
+  }
+  DataType dtype = DT_INT64;
+};
+
 class FloatFiller {
  public:
   FloatFiller() {}
@@ -139,6 +154,7 @@ absl::once_flag ExampleStore<T>::flags_init;
 
 template struct ExampleStore<BytesFiller>;
 template struct ExampleStore<Int64Filler>;
+template struct ExampleStore<SmallInt64Filler>;
 template struct ExampleStore<FloatFiller>;
 
 enum BenchmarkType { kDense, kSparse, kVarLenDense, kRagged };
@@ -340,6 +356,8 @@ typedef BenchmarkOptions<ExampleStore<Int64Filler>, kDense> DenseInt64;
 typedef BenchmarkOptions<ExampleStore<Int64Filler>, kVarLenDense>
     VarLenDenseInt64;
 typedef BenchmarkOptions<ExampleStore<Int64Filler>, kRagged> RaggedInt64;
+typedef BenchmarkOptions<ExampleStore<SmallInt64Filler>, kDense>
+    DenseSmallInt64;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kSparse> SparseFloat;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kDense> DenseFloat;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kVarLenDense>
@@ -378,6 +396,7 @@ BM_AllParseExample(VarLenDenseString);
 BM_AllParseExample(SparseInt64);
 BM_AllParseExample(DenseInt64);
 BM_AllParseExample(VarLenDenseInt64);
+BM_AllParseExample(DenseSmallInt64);
 BM_AllParseExample(SparseFloat);
 BM_AllParseExample(DenseFloat);
 BM_AllParseExample(VarLenDenseFloat);
@@ -432,6 +451,7 @@ BM_AllParseExampleV2(SparseInt64);
 BM_AllParseExampleV2(DenseInt64);
 BM_AllParseExampleV2(VarLenDenseInt64);
 BM_AllParseExampleV2(RaggedInt64);
+BM_AllParseExampleV2(DenseSmallInt64);
 BM_AllParseExampleV2(SparseFloat);
 BM_AllParseExampleV2(DenseFloat);
 BM_AllParseExampleV2(VarLenDenseFloat);
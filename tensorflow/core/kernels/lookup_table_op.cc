@@ -30,7 +30,7 @@ limitations under the License.
 namespace tensorflow {
 namespace lookup {
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Lookup table that wraps an flat_hash_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
@@ -145,25 +145,16 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
     tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.bucket_count();
   }
 
  private:
   mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<K, V> table_ TF_GUARDED_BY(mu_);
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps an flat_hash_map. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -294,24 +285,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
     tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.bucket_count();
   }
 
  private:
   TensorShape value_shape_;
   mutable mutex mu_;
   typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
 };
 
 namespace {
@@ -334,6 +316,11 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
 }  // namespace
 
 // Modeled after densehashtable in https://github.com/sparsehash/sparsehash
+//
+// Large tables are split into independently locked shards, selected by the top
+// bits of the key hash, so that an insert, remove or rehash in one shard never
+// blocks lookups in the others. Exported keys and values always use the bucket
+// layout of a single unsharded table, which keeps checkpoints compatible.
 template <class K, class V>
 class MutableDenseHashTable final : public LookupInterface {
  public:
@@ -394,16 +381,43 @@ class MutableDenseHashTable final : public LookupInterface {
     int64 initial_num_buckets;
     OP_REQUIRES_OK(ctx, GetNodeAttribute(kernel->def(), "initial_num_buckets",
                                          &initial_num_buckets));
-    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
+    OP_REQUIRES(ctx,
+                initial_num_buckets >= 4 &&
+                    (initial_num_buckets & (initial_num_buckets - 1)) == 0,
+                errors::InvalidArgument(
+                    "Number of buckets must be at least 4 and a power of 2, "
+                    "got: ",
+                    initial_num_buckets));
+
+    // Small tables are not worth sharding, and keep exactly the behavior (and
+    // zero-copy export/import) of a single table.
+    int64 num_shards = 1;
+    shard_bits_ = 0;
+    while (num_shards < kMaxShards &&
+           initial_num_buckets / (2 * num_shards) >= kMinShardBuckets) {
+      num_shards <<= 1;
+      ++shard_bits_;
+    }
+    for (int64 i = 0; i < num_shards; ++i) {
+      shards_.emplace_back(new Shard);
+      Shard* shard = shards_.back().get();
+      mutex_lock l(shard->mu);
+      OP_REQUIRES_OK(
+          ctx, AllocateBuckets(ctx, shard, initial_num_buckets / num_shards));
+    }
   }
 
-  size_t size() const override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
-    return num_entries_;
+  size_t size() const override {
+    size_t num_entries = 0;
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      num_entries += shard->num_entries;
+    }
+    return num_entries;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
-              const Tensor& default_value) override TF_LOCKS_EXCLUDED(mu_) {
+              const Tensor& default_value) override {
     const int64 num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
     const int64 key_size = key_shape_.num_elements();
     const int64 value_size = value_shape_.num_elements();
@@ -418,53 +432,50 @@ class MutableDenseHashTable final : public LookupInterface {
     auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
     const auto default_flat = default_value.flat<V>();
 
-    tf_shared_lock l(mu_);
-    const auto key_buckets_matrix =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
-    const auto value_buckets_matrix =
-        value_buckets_.AccessTensor(ctx)->template matrix<V>();
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> shard_rows;
+    TF_RETURN_IF_ERROR(GroupKeysByShard(ctx, key_matrix, false, &key_hashes,
+                                        &shard_rows));
+
     const auto empty_key_matrix =
         empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const auto deleted_key_matrix =
-        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const int64 bit_mask = num_buckets_ - 1;
     // TODO(andreasst): parallelize using work_sharder
-    for (int64 i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
-      }
-      int64 bucket_index = key_hash & bit_mask;
-      int64 num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      if (shard_rows[s].empty()) continue;
+      Shard* shard = shards_[s].get();
+      tf_shared_lock l(shard->mu);
+      const auto key_buckets_matrix =
+          shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
+      const auto value_buckets_matrix =
+          shard->value_buckets.AccessTensor(ctx)->template matrix<V>();
+      const int64 bit_mask = shard->num_buckets - 1;
+      for (const int64 i : shard_rows[s]) {
+        int64 bucket_index = key_hashes[i] & bit_mask;
+        int64 num_probes = 0;
+        while (true) {
+          if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(
+                  value_buckets_matrix(bucket_index, j));
+            }
+            break;
           }
-          break;
-        }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+          if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix,
+                         0)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= shard->num_buckets) {
+            return errors::Internal(
+                "Internal error in MutableDenseHashTable lookup");
           }
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
         }
       }
     }
@@ -472,7 +483,7 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& key,
-                const Tensor& value) override TF_LOCKS_EXCLUDED(mu_) {
+                const Tensor& value) override {
     const int64 batch_size = (key.dims() == 0) ? 1 : key.dim_size(0);
     if (key.NumElements() != batch_size * key_shape_.num_elements()) {
       TensorShape expected_shape({batch_size});
@@ -481,24 +492,40 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
-    // For simplicity we assume that all keys in the input result in inserts
-    // rather than updates. That means we may grow the table even though we
-    // don't need to. As long as the number of keys inserted in one call is
-    // small compared to the size of the map, the impact of this is minimal.
-    const int64 pending_num_entries = num_entries_ + batch_size;
-    if (pending_num_entries > num_buckets_ * max_load_factor_) {
-      int64 new_num_buckets = num_buckets_;
-      do {
-        new_num_buckets <<= 1;
-      } while (pending_num_entries > new_num_buckets * max_load_factor_);
-      TF_RETURN_IF_ERROR(Rebucket(ctx, new_num_buckets));
+    const auto key_matrix =
+        key.shaped<K, 2>({batch_size, key_shape_.num_elements()});
+    const auto value_matrix =
+        value.shaped<V, 2>({batch_size, value_shape_.num_elements()});
+
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> shard_rows;
+    TF_RETURN_IF_ERROR(GroupKeysByShard(ctx, key_matrix, false, &key_hashes,
+                                        &shard_rows));
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      if (shard_rows[s].empty()) continue;
+      Shard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      // For simplicity we assume that all keys in the input result in inserts
+      // rather than updates. That means we may grow the shard even though we
+      // don't need to. As long as the number of keys inserted in one call is
+      // small compared to the size of the map, the impact of this is minimal.
+      const int64 pending_num_entries =
+          shard->num_entries + shard_rows[s].size();
+      if (pending_num_entries > shard->num_buckets * max_load_factor_) {
+        int64 new_num_buckets = shard->num_buckets;
+        do {
+          new_num_buckets <<= 1;
+        } while (pending_num_entries > new_num_buckets * max_load_factor_);
+        TF_RETURN_IF_ERROR(Rebucket(ctx, shard, new_num_buckets));
+      }
+      TF_RETURN_IF_ERROR(DoInsert(ctx, shard, key_matrix, value_matrix,
+                                  key_hashes, shard_rows[s]));
     }
-    return DoInsert(ctx, key, value, false);
+    return Status::OK();
   }
 
-  Status Remove(OpKernelContext* ctx, const Tensor& key) override
-      TF_LOCKS_EXCLUDED(mu_) {
+  Status Remove(OpKernelContext* ctx, const Tensor& key) override {
     if (key.NumElements() != key.dim_size(0) * key_shape_.num_elements()) {
       TensorShape expected_shape({key.dim_size(0)});
       expected_shape.AppendShape(key_shape_);
@@ -506,43 +533,164 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
-    return DoRemove(ctx, key);
+    const auto key_matrix =
+        key.shaped<K, 2>({key.dim_size(0), key_shape_.num_elements()});
+
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> shard_rows;
+    TF_RETURN_IF_ERROR(GroupKeysByShard(ctx, key_matrix, false, &key_hashes,
+                                        &shard_rows));
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      if (shard_rows[s].empty()) continue;
+      Shard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      TF_RETURN_IF_ERROR(
+          DoRemove(ctx, shard, key_matrix, key_hashes, shard_rows[s]));
+    }
+    return Status::OK();
   }
 
+  // Shards are restored one at a time, so that only a single shard's worth of
+  // old buckets is alive at once. A lookup that runs concurrently with an
+  // import may therefore see a mix of old and restored shards.
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
-                      const Tensor& values) override TF_LOCKS_EXCLUDED(mu_) {
-    mutex_lock l(mu_);
-    num_buckets_ = keys.dim_size(0);
-    key_buckets_ = PersistentTensor(keys);
-    value_buckets_ = PersistentTensor(values);
-    // Count the number of keys that are not the empty_key or deleted_key.
-    // This requires iterating through the whole table but that is OK as we
-    // only execute it during checkpoint restore.
-    num_entries_ = 0;
-    const auto empty_key_tensor =
-        empty_key_.AccessTensor(ctx)->template shaped<K, 2>(
-            {1, key_shape_.num_elements()});
-    const auto deleted_key_tensor =
-        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>(
-            {1, key_shape_.num_elements()});
-    const auto key_buckets_tensor =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
-    for (int64 i = 0; i < num_buckets_; ++i) {
-      if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
-          !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
-        ++num_entries_;
+                      const Tensor& values) override {
+    const int64 key_size = key_shape_.num_elements();
+    const int64 num_buckets = keys.dim_size(0);
+    if (shards_.size() == 1) {
+      // The imported buckets already have the layout of a single shard, so
+      // adopt them as is.
+      Shard* shard = shards_[0].get();
+      mutex_lock l(shard->mu);
+      shard->num_buckets = num_buckets;
+      shard->key_buckets = PersistentTensor(keys);
+      shard->value_buckets = PersistentTensor(values);
+      // Count the number of keys that are not the empty_key or deleted_key.
+      // This requires iterating through the whole table but that is OK as we
+      // only execute it during checkpoint restore.
+      shard->num_entries = 0;
+      const auto empty_key_tensor =
+          empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+      const auto deleted_key_tensor =
+          deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+      const auto key_buckets_tensor =
+          shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
+      for (int64 i = 0; i < num_buckets; ++i) {
+        if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
+            !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
+          ++shard->num_entries;
+        }
       }
+      return Status::OK();
+    }
+
+    const auto key_matrix = keys.shaped<K, 2>({num_buckets, key_size});
+    const auto value_matrix =
+        values.shaped<V, 2>({num_buckets, value_shape_.num_elements()});
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> shard_rows;
+    TF_RETURN_IF_ERROR(GroupKeysByShard(ctx, key_matrix, true, &key_hashes,
+                                        &shard_rows));
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      // Probing masks with num_buckets - 1, so the shard size must stay a
+      // power of 2. The imported tensors may come from a table with any
+      // number of buckets, so start from the shard minimum and double.
+      const int64 num_entries = shard_rows[s].size();
+      const int64 shard_share = num_buckets / shards_.size();
+      int64 new_num_buckets = kMinShardBuckets;
+      while (new_num_buckets < shard_share ||
+             num_entries > new_num_buckets * max_load_factor_) {
+        new_num_buckets <<= 1;
+      }
+      Shard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      TF_RETURN_IF_ERROR(AllocateBuckets(ctx, shard, new_num_buckets));
+      TF_RETURN_IF_ERROR(DoInsert(ctx, shard, key_matrix, value_matrix,
+                                  key_hashes, shard_rows[s]));
     }
     return Status::OK();
   }
 
-  Status ExportValues(OpKernelContext* ctx) override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
-    Tensor key_buckets_tensor = *key_buckets_.AccessTensor(ctx);
-    Tensor value_buckets_tensor = *value_buckets_.AccessTensor(ctx);
-    TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_tensor));
-    TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets_tensor));
+  Status ExportValues(OpKernelContext* ctx) override {
+    if (shards_.size() == 1) {
+      Shard* shard = shards_[0].get();
+      tf_shared_lock l(shard->mu);
+      Tensor key_buckets_tensor = *shard->key_buckets.AccessTensor(ctx);
+      Tensor value_buckets_tensor = *shard->value_buckets.AccessTensor(ctx);
+      TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_tensor));
+      TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets_tensor));
+      return Status::OK();
+    }
+
+    // Hold all shards for a consistent snapshot; lookups can still proceed.
+    std::vector<std::unique_ptr<tf_shared_lock>> locks;
+    int64 total_num_buckets = 0;
+    for (const auto& shard : shards_) {
+      locks.emplace_back(new tf_shared_lock{shard->mu});
+      total_num_buckets += shard->num_buckets;
+    }
+    int64 num_buckets = 4;
+    while (num_buckets < total_num_buckets) {
+      num_buckets <<= 1;
+    }
+
+    const int64 key_size = key_shape_.num_elements();
+    const int64 value_size = value_shape_.num_elements();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "keys", TensorShape({num_buckets, key_size}), &keys));
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "values", TensorShape({num_buckets, value_size}), &values));
+    auto keys_matrix = keys->matrix<K>();
+    auto values_matrix = values->matrix<V>();
+    const auto empty_key_flat =
+        empty_key_.AccessTensor(ctx)->template flat<K>();
+    for (int64 i = 0; i < num_buckets; ++i) {
+      for (int64 j = 0; j < key_size; ++j) {
+        keys_matrix(i, j) = empty_key_flat(j);
+      }
+      for (int64 j = 0; j < value_size; ++j) {
+        values_matrix(i, j) = V();
+      }
+    }
+
+    // Re-insert every entry as a single table of num_buckets would have.
+    const auto empty_key_tensor =
+        empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    const auto deleted_key_tensor =
+        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    const int64 bit_mask = num_buckets - 1;
+    for (const auto& shard : shards_) {
+      const Tensor& shard_keys = *shard->key_buckets.AccessTensor(ctx);
+      const Tensor& shard_values = *shard->value_buckets.AccessTensor(ctx);
+      const auto shard_keys_matrix = shard_keys.matrix<K>();
+      const auto shard_values_matrix = shard_values.matrix<V>();
+      for (int64 r = 0; r < shard->num_buckets; ++r) {
+        if (IsEqualKey(empty_key_tensor, 0, shard_keys_matrix, r) ||
+            IsEqualKey(deleted_key_tensor, 0, shard_keys_matrix, r)) {
+          continue;
+        }
+        int64 bucket_index = HashKey(shard_keys_matrix, r) & bit_mask;
+        int64 num_probes = 0;
+        while (!IsEqualKey(keys_matrix, bucket_index, empty_key_tensor, 0)) {
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= num_buckets) {
+            return errors::Internal(
+                "Internal error in MutableDenseHashTable export");
+          }
+        }
+        for (int64 j = 0; j < key_size; ++j) {
+          keys_matrix(bucket_index, j) = shard_keys_matrix(r, j);
+        }
+        for (int64 j = 0; j < value_size; ++j) {
+          values_matrix(bucket_index, j) = shard_values_matrix(r, j);
+        }
+      }
+    }
     return Status::OK();
   }
 
@@ -551,7 +699,7 @@ class MutableDenseHashTable final : public LookupInterface {
     TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(keys, values));
     TF_RETURN_IF_ERROR(CheckKeyShape(keys.shape()));
 
-    // The storage format in key_buckets_ and value_buckets_ is always vectors,
+    // The storage format in key_buckets and value_buckets is always vectors,
     // even if the inputs are scalars. This is what eventually gets exported
     // and is expected by the import method as well.
     TensorShape key_shape = MaybeVectorizeShape(key_shape_);
@@ -579,31 +727,59 @@ class MutableDenseHashTable final : public LookupInterface {
 
   TensorShape value_shape() const override { return value_shape_; }
 
-  int64 MemoryUsed() const override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
-    return sizeof(MutableDenseHashTable) + key_buckets_.AllocatedBytes() +
-           value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes();
+  int64 MemoryUsed() const override {
+    int64 ret = sizeof(MutableDenseHashTable) + empty_key_.AllocatedBytes();
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      ret += sizeof(Shard) + shard->key_buckets.AllocatedBytes() +
+             shard->value_buckets.AllocatedBytes();
+    }
+    return ret;
   }
 
  private:
-  Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
-                  bool ignore_empty_and_deleted_key)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
-    const int64 value_size = value_shape_.num_elements();
-    const int64 key_size = key_shape_.num_elements();
-    const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
-    auto value_matrix = value.shaped<V, 2>({num_elements, value_size});
+  // Tables are split into at most kMaxShards shards, each of which starts
+  // with at least kMinShardBuckets buckets.
+  static constexpr int64 kMaxShards = 16;
+  static constexpr int64 kMinShardBuckets = 4096;
+
+  struct Shard {
+    mutable mutex mu;
+    int64 num_entries TF_GUARDED_BY(mu) = 0;
+    int64 num_buckets TF_GUARDED_BY(mu) = 0;
+    PersistentTensor key_buckets TF_GUARDED_BY(mu);
+    PersistentTensor value_buckets TF_GUARDED_BY(mu);
+  };
+
+  int64 ShardIndex(uint64 key_hash) const {
+    if (shard_bits_ == 0) {
+      return 0;
+    }
+    // HashScalar() is the identity for integer keys, so mix the hash before
+    // taking its top bits.
+    return (key_hash * 0x9E3779B97F4A7C15ULL) >> (64 - shard_bits_);
+  }
 
-    auto key_buckets_matrix =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
-    auto value_buckets_matrix =
-        value_buckets_.AccessTensor(ctx)->template matrix<V>();
+  // Hashes each row of `key_matrix` into `key_hashes` and groups the row
+  // indices by shard. Rows holding the empty or deleted key are an error,
+  // unless `ignore_empty_and_deleted_key` is set, in which case they are
+  // skipped.
+  Status GroupKeysByShard(OpKernelContext* ctx,
+                          typename TTypes<K>::ConstMatrix key_matrix,
+                          bool ignore_empty_and_deleted_key,
+                          std::vector<uint64>* key_hashes,
+                          std::vector<std::vector<int64>>* shard_rows) {
+    const int64 num_elements = key_matrix.dimension(0);
+    const int64 key_size = key_shape_.num_elements();
     const auto empty_key_tensor =
         empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const auto deleted_key_tensor =
         deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const int64 bit_mask = num_buckets_ - 1;
+    key_hashes->resize(num_elements);
+    shard_rows->assign(shards_.size(), {});
+    if (shards_.size() == 1) {
+      (*shard_rows)[0].reserve(num_elements);
+    }
     for (int64 i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
@@ -622,7 +798,35 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
-      int64 bucket_index = key_hash & bit_mask;
+      (*key_hashes)[i] = key_hash;
+      (*shard_rows)[ShardIndex(key_hash)].push_back(i);
+    }
+    return Status::OK();
+  }
+
+  // Inserts the given rows of `key_matrix` and `value_matrix`, whose hashes
+  // are in `key_hashes`, into `shard`. The rows must not hold the empty or
+  // deleted key.
+  Status DoInsert(OpKernelContext* ctx, Shard* shard,
+                  typename TTypes<K>::ConstMatrix key_matrix,
+                  typename TTypes<V>::ConstMatrix value_matrix,
+                  const std::vector<uint64>& key_hashes,
+                  const std::vector<int64>& rows)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    const int64 value_size = value_shape_.num_elements();
+    const int64 key_size = key_shape_.num_elements();
+
+    auto key_buckets_matrix =
+        shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
+    auto value_buckets_matrix =
+        shard->value_buckets.AccessTensor(ctx)->template matrix<V>();
+    const auto empty_key_tensor =
+        empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    const auto deleted_key_tensor =
+        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    const int64 bit_mask = shard->num_buckets - 1;
+    for (const int64 i : rows) {
+      int64 bucket_index = key_hashes[i] & bit_mask;
       int64 num_probes = 0;
       while (true) {
         if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
@@ -635,7 +839,7 @@ class MutableDenseHashTable final : public LookupInterface {
         if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0) ||
             IsEqualKey(key_buckets_matrix, bucket_index, deleted_key_tensor,
                        0)) {
-          ++num_entries_;
+          ++shard->num_entries;
           for (int64 j = 0; j < key_size; ++j) {
             key_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(key_matrix(i, j));
@@ -649,7 +853,7 @@ class MutableDenseHashTable final : public LookupInterface {
         ++num_probes;
         bucket_index =
             (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
+        if (num_probes >= shard->num_buckets) {
           return errors::Internal(
               "Internal error in MutableDenseHashTable insert");
         }
@@ -658,38 +862,26 @@ class MutableDenseHashTable final : public LookupInterface {
     return Status::OK();
   }
 
-  Status DoRemove(OpKernelContext* ctx, const Tensor& key)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 num_elements = key.dim_size(0);
+  Status DoRemove(OpKernelContext* ctx, Shard* shard,
+                  typename TTypes<K>::ConstMatrix key_matrix,
+                  const std::vector<uint64>& key_hashes,
+                  const std::vector<int64>& rows)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
     const int64 key_size = key_shape_.num_elements();
-    const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
 
     auto key_buckets_matrix =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
+        shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
     const auto empty_key_tensor =
         empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const auto deleted_key_tensor =
-        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const auto deleted_key_flat =
         deleted_key_.AccessTensor(ctx)->template flat<K>();
-    const int64 bit_mask = num_buckets_ - 1;
-    for (int64 i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_tensor, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_tensor, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
-      }
-      int64 bucket_index = key_hash & bit_mask;
+    const int64 bit_mask = shard->num_buckets - 1;
+    for (const int64 i : rows) {
+      int64 bucket_index = key_hashes[i] & bit_mask;
       int64 num_probes = 0;
       while (true) {
         if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          --num_entries_;
+          --shard->num_entries;
           for (int64 j = 0; j < key_size; ++j) {
             key_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(deleted_key_flat(j));
@@ -702,7 +894,7 @@ class MutableDenseHashTable final : public LookupInterface {
         ++num_probes;
         bucket_index =
             (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
+        if (num_probes >= shard->num_buckets) {
           return errors::Internal(
               "Internal error in MutableDenseHashTable remove");
         }
@@ -711,26 +903,22 @@ class MutableDenseHashTable final : public LookupInterface {
     return Status::OK();
   }
 
-  Status AllocateBuckets(OpKernelContext* ctx, int64 new_num_buckets)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    if (new_num_buckets < 4 ||
-        ((new_num_buckets & (new_num_buckets - 1)) != 0)) {
-      return errors::InvalidArgument(
-          "Number of buckets must be at least 4 and a power of 2, got: ",
-          new_num_buckets);
-    }
-    num_buckets_ = new_num_buckets;
-    num_entries_ = 0;
+  // `new_num_buckets` must be a power of 2.
+  Status AllocateBuckets(OpKernelContext* ctx, Shard* shard,
+                         int64 new_num_buckets)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    shard->num_buckets = new_num_buckets;
+    shard->num_entries = 0;
 
     const int64 key_size = key_shape_.num_elements();
     Tensor* key_buckets_tensor;
     TF_RETURN_IF_ERROR(ctx->allocate_persistent(
-        key_dtype(), TensorShape({num_buckets_, key_size}), &key_buckets_,
-        &key_buckets_tensor));
+        key_dtype(), TensorShape({new_num_buckets, key_size}),
+        &shard->key_buckets, &key_buckets_tensor));
     auto key_buckets_matrix = key_buckets_tensor->matrix<K>();
     const auto empty_key_flat =
         empty_key_.AccessTensor(ctx)->template flat<K>();
-    for (int64 i = 0; i < num_buckets_; ++i) {
+    for (int64 i = 0; i < new_num_buckets; ++i) {
       for (int64 j = 0; j < key_size; ++j) {
         key_buckets_matrix(i, j) = empty_key_flat(j);
       }
@@ -739,10 +927,10 @@ class MutableDenseHashTable final : public LookupInterface {
     const int64 value_size = value_shape_.num_elements();
     Tensor* value_buckets_tensor;
     TF_RETURN_IF_ERROR(ctx->allocate_persistent(
-        value_dtype(), TensorShape({num_buckets_, value_size}), &value_buckets_,
-        &value_buckets_tensor));
+        value_dtype(), TensorShape({new_num_buckets, value_size}),
+        &shard->value_buckets, &value_buckets_tensor));
     auto value_buckets_matrix = value_buckets_tensor->matrix<V>();
-    for (int64 i = 0; i < num_buckets_; ++i) {
+    for (int64 i = 0; i < new_num_buckets; ++i) {
       for (int64 j = 0; j < value_size; ++j) {
         // Initialize values to the default value for the type to avoid
         // exposing uninitialized memory in ExportValues().
@@ -752,12 +940,32 @@ class MutableDenseHashTable final : public LookupInterface {
     return Status::OK();
   }
 
-  Status Rebucket(OpKernelContext* ctx, int64 num_new_buckets)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    Tensor old_key_buckets = *key_buckets_.AccessTensor(ctx);
-    Tensor old_value_buckets = *value_buckets_.AccessTensor(ctx);
-    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets));
-    return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
+  // Only blocks the lookups that go to `shard` while it is rebuilt.
+  Status Rebucket(OpKernelContext* ctx, Shard* shard, int64 num_new_buckets)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    const Tensor old_key_buckets = *shard->key_buckets.AccessTensor(ctx);
+    const Tensor old_value_buckets = *shard->value_buckets.AccessTensor(ctx);
+    const auto old_key_matrix = old_key_buckets.matrix<K>();
+    const int64 old_num_buckets = old_key_buckets.dim_size(0);
+    const int64 key_size = key_shape_.num_elements();
+    const auto empty_key_tensor =
+        empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    const auto deleted_key_tensor =
+        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    std::vector<uint64> key_hashes(old_num_buckets);
+    std::vector<int64> rows;
+    rows.reserve(shard->num_entries);
+    for (int64 i = 0; i < old_num_buckets; ++i) {
+      if (IsEqualKey(empty_key_tensor, 0, old_key_matrix, i) ||
+          IsEqualKey(deleted_key_tensor, 0, old_key_matrix, i)) {
+        continue;
+      }
+      key_hashes[i] = HashKey(old_key_matrix, i);
+      rows.push_back(i);
+    }
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, shard, num_new_buckets));
+    return DoInsert(ctx, shard, old_key_matrix, old_value_buckets.matrix<V>(),
+                    key_hashes, rows);
   }
 
   uint64 HashKey(typename TTypes<K>::ConstMatrix key, int64 index) const {
@@ -773,9 +981,8 @@ class MutableDenseHashTable final : public LookupInterface {
 
   // Use a template to allow this function to be used both with Matrix and
   // ConstMatrix types.
-  template <typename MT2>
-  bool IsEqualKey(typename TTypes<K>::Matrix tensor1, int64 index1, MT2 tensor2,
-                  int64 index2) const {
+  template <typename MT1, typename MT2>
+  bool IsEqualKey(MT1 tensor1, int64 index1, MT2 tensor2, int64 index2) const {
     for (int64 i = 0; i < key_shape_.num_elements(); ++i) {
       if (tensor1(index1, i) != tensor2(index2, i)) {
         return false;
@@ -787,11 +994,9 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape key_shape_;
   TensorShape value_shape_;
   float max_load_factor_;
-  mutable mutex mu_;
-  int64 num_entries_ TF_GUARDED_BY(mu_);
-  int64 num_buckets_ TF_GUARDED_BY(mu_);
-  PersistentTensor key_buckets_ TF_GUARDED_BY(mu_);
-  PersistentTensor value_buckets_ TF_GUARDED_BY(mu_);
+  // Immutable after construction; each shard is guarded by its own mutex.
+  std::vector<std::unique_ptr<Shard>> shards_;
+  int shard_bits_;
   PersistentTensor empty_key_;
   uint64 empty_key_hash_;
   PersistentTensor deleted_key_;
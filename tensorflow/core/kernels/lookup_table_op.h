@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <atomic>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
@@ -57,42 +59,27 @@ class LookupTableOp : public OpKernel {
 
   // ctx is not owned by this function.
   void Compute(OpKernelContext* ctx) override {
+    // Once the handle has been published, resource outputs only need the
+    // immutable handle and a (shared) ResourceMgr lookup, so concurrent steps
+    // that reference the same table do not serialize on mu_.
+    if (table_handle_set_.load(std::memory_order_acquire) &&
+        ctx->expected_output_dtype(0) == DT_RESOURCE) {
+      OP_REQUIRES_OK(ctx, LookupOrCreateTable(ctx));
+      ctx->set_output(0, *table_handle_.AccessTensor(ctx));
+      return;
+    }
+
     mutex_lock l(mu_);
 
-    if (!table_handle_set_) {
+    if (!table_handle_set_.load(std::memory_order_relaxed)) {
       OP_REQUIRES_OK(ctx, cinfo_.Init(ctx->resource_manager(), def(),
                                       use_node_name_sharing_));
     }
 
-    auto creator =
-        [ctx, this](lookup::LookupInterface** ret)
-            TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-              lookup::LookupInterface* container = new Container(ctx, this);
-              if (!ctx->status().ok()) {
-                container->Unref();
-                return ctx->status();
-              }
-              if (ctx->track_allocations()) {
-                ctx->record_persistent_memory_allocation(
-                    container->MemoryUsed() + table_handle_.AllocatedBytes());
-              }
-              *ret = container;
-              return Status::OK();
-            };
-
-    lookup::LookupInterface* table = nullptr;
-    OP_REQUIRES_OK(ctx,
-                   cinfo_.resource_manager()
-                       ->template LookupOrCreate<lookup::LookupInterface>(
-                           cinfo_.container(), cinfo_.name(), &table, creator));
-    core::ScopedUnref unref_me(table);
-
-    OP_REQUIRES_OK(ctx, lookup::CheckTableDataTypes(
-                            *table, DataTypeToEnum<key_dtype>::v(),
-                            DataTypeToEnum<value_dtype>::v(), cinfo_.name()));
+    OP_REQUIRES_OK(ctx, LookupOrCreateTable(ctx));
 
     if (ctx->expected_output_dtype(0) == DT_RESOURCE) {
-      if (!table_handle_set_) {
+      if (!table_handle_set_.load(std::memory_order_relaxed)) {
         auto h =
             table_handle_.AccessTensor(ctx)->template scalar<ResourceHandle>();
         h() = MakeResourceHandle<lookup::LookupInterface>(
@@ -100,19 +87,20 @@ class LookupTableOp : public OpKernel {
       }
       ctx->set_output(0, *table_handle_.AccessTensor(ctx));
     } else {
-      if (!table_handle_set_) {
+      if (!table_handle_set_.load(std::memory_order_relaxed)) {
         auto h = table_handle_.AccessTensor(ctx)->template flat<tstring>();
         h(0) = cinfo_.container();
         h(1) = cinfo_.name();
       }
       ctx->set_output_ref(0, &mu_, table_handle_.AccessTensor(ctx));
     }
-    table_handle_set_ = true;
+    table_handle_set_.store(true, std::memory_order_release);
   }
 
   ~LookupTableOp() override {
     // If the table object was not shared, delete it.
-    if (table_handle_set_ && cinfo_.resource_is_private_to_kernel()) {
+    if (table_handle_set_.load(std::memory_order_acquire) &&
+        cinfo_.resource_is_private_to_kernel()) {
       if (!cinfo_.resource_manager()
                ->template Delete<lookup::LookupInterface>(cinfo_.container(),
                                                           cinfo_.name())
@@ -123,9 +111,40 @@ class LookupTableOp : public OpKernel {
   }
 
  private:
+  // Looks up the table in the resource manager, creating it if it does not
+  // exist yet (or was deleted, e.g. by a session reset), and checks its types.
+  // cinfo_ must have been initialized.
+  Status LookupOrCreateTable(OpKernelContext* ctx) {
+    auto creator = [ctx, this](lookup::LookupInterface** ret) {
+      lookup::LookupInterface* container = new Container(ctx, this);
+      if (!ctx->status().ok()) {
+        container->Unref();
+        return ctx->status();
+      }
+      if (ctx->track_allocations()) {
+        ctx->record_persistent_memory_allocation(
+            container->MemoryUsed() + table_handle_.AllocatedBytes());
+      }
+      *ret = container;
+      return Status::OK();
+    };
+
+    lookup::LookupInterface* table = nullptr;
+    TF_RETURN_IF_ERROR(
+        cinfo_.resource_manager()
+            ->template LookupOrCreate<lookup::LookupInterface>(
+                cinfo_.container(), cinfo_.name(), &table, creator));
+    core::ScopedUnref unref_me(table);
+
+    return lookup::CheckTableDataTypes(*table, DataTypeToEnum<key_dtype>::v(),
+                                       DataTypeToEnum<value_dtype>::v(),
+                                       cinfo_.name());
+  }
+
   mutex mu_;
-  PersistentTensor table_handle_ TF_GUARDED_BY(mu_);
-  bool table_handle_set_ TF_GUARDED_BY(mu_);
+  // Written under mu_ before table_handle_set_ is published, read-only after.
+  PersistentTensor table_handle_;
+  std::atomic<bool> table_handle_set_;
   ContainerInfo cinfo_;
   bool use_node_name_sharing_;
 
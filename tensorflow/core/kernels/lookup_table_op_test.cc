@@ -0,0 +1,368 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kTableSize = 1 << 16;
+
+// Builds a graph with an int64 -> int64 table of type `table_op` that maps
+// every key k in [0, kTableSize) to 2 * k. Returns the names of the node that
+// fills the table and of a node that looks up `num_keys` keys in it.
+GraphDef MakeLookupGraph(const string& table_op, int64 num_keys,
+                         string* import_name, string* find_name) {
+  Graph g(OpRegistry::Global());
+  Node* table;
+  TF_CHECK_OK(NodeBuilder(g.NewName("table"), table_op)
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_INT64)
+                  .Finalize(&g, &table));
+
+  Tensor keys(DT_INT64, TensorShape({kTableSize}));
+  Tensor values(DT_INT64, TensorShape({kTableSize}));
+  for (int64 i = 0; i < kTableSize; ++i) {
+    keys.flat<int64>()(i) = i;
+    values.flat<int64>()(i) = 2 * i;
+  }
+  Node* import;
+  TF_CHECK_OK(NodeBuilder(g.NewName("import"), "LookupTableImportV2")
+                  .Input(table)
+                  .Input(test::graph::Constant(&g, keys))
+                  .Input(test::graph::Constant(&g, values))
+                  .Finalize(&g, &import));
+
+  // Half of the queried keys are absent from the table.
+  Tensor query(DT_INT64, TensorShape({num_keys}));
+  for (int64 i = 0; i < num_keys; ++i) {
+    query.flat<int64>()(i) = (i * 7919) % (2 * kTableSize);
+  }
+  Node* find;
+  TF_CHECK_OK(NodeBuilder(g.NewName("find"), "LookupTableFindV2")
+                  .Input(table)
+                  .Input(test::graph::Constant(&g, query))
+                  .Input(test::graph::Constant(&g, test::AsScalar<int64>(-1)))
+                  .Finalize(&g, &find));
+
+  *import_name = import->name();
+  *find_name = find->name();
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  return gd;
+}
+
+void CheckConcurrentFind(const string& table_op) {
+  constexpr int kNumThreads = 16;
+  constexpr int kNumSteps = 50;
+  constexpr int64 kNumKeys = 128;
+  string import_name, find_name;
+  GraphDef gd = MakeLookupGraph(table_op, kNumKeys, &import_name, &find_name);
+  std::unique_ptr<Session> sess(NewSession(SessionOptions()));
+  TF_ASSERT_OK(sess->Create(gd));
+  TF_ASSERT_OK(sess->Run({}, {}, {import_name}, nullptr));
+
+  thread::ThreadPool pool(Env::Default(), "lookup_test", kNumThreads);
+  BlockingCounter counter(kNumThreads);
+  for (int t = 0; t < kNumThreads; ++t) {
+    pool.Schedule([&]() {
+      for (int step = 0; step < kNumSteps; ++step) {
+        std::vector<Tensor> outputs;
+        TF_CHECK_OK(sess->Run({}, {find_name}, {}, &outputs));
+        const auto found = outputs[0].flat<int64>();
+        for (int64 i = 0; i < kNumKeys; ++i) {
+          const int64 key = (i * 7919) % (2 * kTableSize);
+          CHECK_EQ(found(i), key < kTableSize ? 2 * key : -1);
+        }
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+}
+
+TEST(LookupTableOpTest, ConcurrentFindHashTable) {
+  CheckConcurrentFind("HashTableV2");
+}
+
+TEST(LookupTableOpTest, ConcurrentFindMutableHashTable) {
+  CheckConcurrentFind("MutableHashTableV2");
+}
+
+// Exercises a MutableDenseHashTable large enough to be sharded with
+// concurrent inserts and lookups, then checks that its export can be imported
+// into a small (unsharded) table that adopts the buckets as they are.
+TEST(LookupTableOpTest, ShardedDenseHashTable) {
+  constexpr int kNumThreads = 8;
+  constexpr int64 kKeysPerThread = 4096;
+  Graph g(OpRegistry::Global());
+  auto dense_table = [&g](int64 initial_num_buckets) {
+    Node* table;
+    TF_CHECK_OK(
+        NodeBuilder(g.NewName("table"), "MutableDenseHashTableV2")
+            .Input(test::graph::Constant(&g, test::AsScalar<int64>(-1)))
+            .Input(test::graph::Constant(&g, test::AsScalar<int64>(-2)))
+            .Attr("key_dtype", DT_INT64)
+            .Attr("value_dtype", DT_INT64)
+            .Attr("initial_num_buckets", initial_num_buckets)
+            .Finalize(&g, &table));
+    return table;
+  };
+  Node* sharded = dense_table(131072);
+  Node* unsharded = dense_table(4);
+
+  auto placeholder = [&g](const string& name) {
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(g.NewName(name), "Placeholder")
+                    .Attr("dtype", DT_INT64)
+                    .Finalize(&g, &node));
+    return node;
+  };
+  Node* keys = placeholder("keys");
+  Node* values = placeholder("values");
+  Node* default_value = test::graph::Constant(&g, test::AsScalar<int64>(-1));
+  Node *insert, *remove, *find, *size, *export_values, *import, *import_find;
+  TF_CHECK_OK(NodeBuilder(g.NewName("insert"), "LookupTableInsertV2")
+                  .Input(sharded)
+                  .Input(keys)
+                  .Input(values)
+                  .Finalize(&g, &insert));
+  TF_CHECK_OK(NodeBuilder(g.NewName("remove"), "LookupTableRemoveV2")
+                  .Input(sharded)
+                  .Input(keys)
+                  .Finalize(&g, &remove));
+  TF_CHECK_OK(NodeBuilder(g.NewName("find"), "LookupTableFindV2")
+                  .Input(sharded)
+                  .Input(keys)
+                  .Input(default_value)
+                  .Finalize(&g, &find));
+  TF_CHECK_OK(NodeBuilder(g.NewName("size"), "LookupTableSizeV2")
+                  .Input(sharded)
+                  .Finalize(&g, &size));
+  TF_CHECK_OK(NodeBuilder(g.NewName("export"), "LookupTableExportV2")
+                  .Input(sharded)
+                  .Attr("Tkeys", DT_INT64)
+                  .Attr("Tvalues", DT_INT64)
+                  .Finalize(&g, &export_values));
+  TF_CHECK_OK(NodeBuilder(g.NewName("import"), "LookupTableImportV2")
+                  .Input(unsharded)
+                  .Input(export_values, 0)
+                  .Input(export_values, 1)
+                  .Finalize(&g, &import));
+  TF_CHECK_OK(NodeBuilder(g.NewName("find"), "LookupTableFindV2")
+                  .Input(unsharded)
+                  .Input(keys)
+                  .Input(default_value)
+                  .Finalize(&g, &import_find));
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  std::unique_ptr<Session> sess(NewSession(SessionOptions()));
+  TF_ASSERT_OK(sess->Create(gd));
+
+  auto range = [](int64 begin, int64 end, int64 scale) {
+    Tensor t(DT_INT64, TensorShape({end - begin}));
+    for (int64 i = begin; i < end; ++i) {
+      t.flat<int64>()(i - begin) = i * scale;
+    }
+    return t;
+  };
+  {
+    thread::ThreadPool pool(Env::Default(), "dense_test", 2 * kNumThreads);
+    BlockingCounter counter(2 * kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      const int64 begin = t * kKeysPerThread;
+      const int64 end = begin + kKeysPerThread;
+      pool.Schedule([&, begin, end]() {
+        for (int64 i = begin; i < end; i += 256) {
+          TF_CHECK_OK(sess->Run({{keys->name(), range(i, i + 256, 1)},
+                                 {values->name(), range(i, i + 256, 3)}},
+                                {}, {insert->name()}, nullptr));
+        }
+        counter.DecrementCount();
+      });
+      pool.Schedule([&, begin, end]() {
+        for (int step = 0; step < 16; ++step) {
+          std::vector<Tensor> outputs;
+          TF_CHECK_OK(sess->Run({{keys->name(), range(begin, end, 1)}},
+                                {find->name()}, {}, &outputs));
+          // Every key is either absent or already has its final value.
+          const auto found = outputs[0].flat<int64>();
+          for (int64 i = 0; i < kKeysPerThread; ++i) {
+            CHECK(found(i) == -1 || found(i) == 3 * (begin + i));
+          }
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+
+  const int64 num_keys = kNumThreads * kKeysPerThread;
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(sess->Run({}, {size->name()}, {}, &outputs));
+  EXPECT_EQ(num_keys, outputs[0].scalar<int64>()());
+
+  TF_ASSERT_OK(
+      sess->Run({{keys->name(), range(0, num_keys / 2, 1)}}, {},
+                {remove->name()}, nullptr));
+  TF_ASSERT_OK(sess->Run({}, {size->name()}, {}, &outputs));
+  EXPECT_EQ(num_keys / 2, outputs[0].scalar<int64>()());
+
+  TF_ASSERT_OK(sess->Run({}, {}, {import->name()}, nullptr));
+  Tensor expected(DT_INT64, TensorShape({num_keys}));
+  for (int64 i = 0; i < num_keys; ++i) {
+    expected.flat<int64>()(i) = i < num_keys / 2 ? -1 : 3 * i;
+  }
+  for (const string& find_name : {find->name(), import_find->name()}) {
+    TF_ASSERT_OK(sess->Run({{keys->name(), range(0, num_keys, 1)}},
+                           {find_name}, {}, &outputs));
+    test::ExpectTensorEqual<int64>(expected, outputs[0]);
+  }
+}
+
+// Imports buckets whose count is not a multiple of the number of shards, as
+// produced by the export of a differently sized table, into a sharded
+// MutableDenseHashTable and reads every key back.
+TEST(LookupTableOpTest, ImportIntoShardedDenseHashTable) {
+  constexpr int64 kNumRows = 3000;
+  Graph g(OpRegistry::Global());
+  Node* table;
+  TF_CHECK_OK(NodeBuilder(g.NewName("table"), "MutableDenseHashTableV2")
+                  .Input(test::graph::Constant(&g, test::AsScalar<int64>(-1)))
+                  .Input(test::graph::Constant(&g, test::AsScalar<int64>(-2)))
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_INT64)
+                  .Attr("initial_num_buckets", int64{131072})
+                  .Finalize(&g, &table));
+
+  // Every third row is an empty bucket, as in an exported table.
+  Tensor buckets(DT_INT64, TensorShape({kNumRows, 1}));
+  Tensor bucket_values(DT_INT64, TensorShape({kNumRows, 1}));
+  std::vector<int64> expected_keys;
+  for (int64 i = 0; i < kNumRows; ++i) {
+    const bool empty = i % 3 == 0;
+    buckets.matrix<int64>()(i, 0) = empty ? -1 : 7 * i;
+    bucket_values.matrix<int64>()(i, 0) = empty ? 0 : 5 * i;
+    if (!empty) expected_keys.push_back(7 * i);
+  }
+  Node* import;
+  TF_CHECK_OK(NodeBuilder(g.NewName("import"), "LookupTableImportV2")
+                  .Input(table)
+                  .Input(test::graph::Constant(&g, buckets))
+                  .Input(test::graph::Constant(&g, bucket_values))
+                  .Finalize(&g, &import));
+  const int64 num_keys = expected_keys.size();
+  Tensor query(DT_INT64, TensorShape({num_keys}));
+  for (int64 i = 0; i < num_keys; ++i) {
+    query.flat<int64>()(i) = expected_keys[i];
+  }
+  Node *find, *size;
+  TF_CHECK_OK(NodeBuilder(g.NewName("find"), "LookupTableFindV2")
+                  .Input(table)
+                  .Input(test::graph::Constant(&g, query))
+                  .Input(test::graph::Constant(&g, test::AsScalar<int64>(-1)))
+                  .Finalize(&g, &find));
+  TF_CHECK_OK(NodeBuilder(g.NewName("size"), "LookupTableSizeV2")
+                  .Input(table)
+                  .Finalize(&g, &size));
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  std::unique_ptr<Session> sess(NewSession(SessionOptions()));
+  TF_ASSERT_OK(sess->Create(gd));
+  TF_ASSERT_OK(sess->Run({}, {}, {import->name()}, nullptr));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(sess->Run({}, {find->name(), size->name()}, {}, &outputs));
+  EXPECT_EQ(num_keys, outputs[1].scalar<int64>()());
+  const auto found = outputs[0].flat<int64>();
+  for (int64 i = 0; i < num_keys; ++i) {
+    EXPECT_EQ(expected_keys[i] / 7 * 5, found(i)) << expected_keys[i];
+  }
+}
+
+// Measures how lookups scale when many concurrent steps reference the same
+// table, which is the typical serving setup for vocabulary lookups.
+void BM_ConcurrentFind(const string& table_op,
+                       ::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const int64 num_keys = state.range(1);
+  string import_name, find_name;
+  GraphDef gd = MakeLookupGraph(table_op, num_keys, &import_name, &find_name);
+  SessionOptions opts;
+  opts.config.set_inter_op_parallelism_threads(num_threads);
+  std::unique_ptr<Session> sess(NewSession(opts));
+  TF_CHECK_OK(sess->Create(gd));
+  TF_CHECK_OK(sess->Run({}, {}, {import_name}, nullptr));
+
+  thread::ThreadPool pool(Env::Default(), "lookup_bench", num_threads);
+  for (auto s : state) {
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&]() {
+        std::vector<Tensor> outputs;
+        TF_CHECK_OK(sess->Run({}, {find_name}, {}, &outputs));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(static_cast<int64>(state.iterations()) *
+                          num_threads * num_keys);
+}
+
+void BM_ConcurrentFindHashTable(::testing::benchmark::State& state) {
+  BM_ConcurrentFind("HashTableV2", state);
+}
+
+void BM_ConcurrentFindMutableHashTable(::testing::benchmark::State& state) {
+  BM_ConcurrentFind("MutableHashTableV2", state);
+}
+
+BENCHMARK(BM_ConcurrentFindHashTable)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(64, 1)
+    ->ArgPair(1, 1024)
+    ->ArgPair(4, 1024)
+    ->ArgPair(16, 1024)
+    ->ArgPair(64, 1024);
+
+BENCHMARK(BM_ConcurrentFindMutableHashTable)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(64, 1)
+    ->ArgPair(1, 1024)
+    ->ArgPair(4, 1024)
+    ->ArgPair(16, 1024)
+    ->ArgPair(64, 1024);
+
+}  // namespace
+}  // namespace tensorflow
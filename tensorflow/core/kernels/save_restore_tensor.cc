@@ -28,8 +28,10 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -237,6 +239,12 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64 kLargeShapeThreshold = 16 << 20;  // 16M
 
+// Number of threads used to restore tensors in parallel.
+const int kNumRestoreThreads = 8;
+
+// Tensors smaller than this are read and written on a single thread.
+const int64 kParallelIOMinTensorBytes = 16 << 20;  // 16MB
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -257,7 +265,7 @@ struct RestoreOp {
 
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
+    BundleReader reader(Env::Default(), reader_prefix, reader_options);
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -274,7 +282,13 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && use_mmap) {
+      // Lookup the full tensor, aliasing the data file where possible.
+      Tensor mapped;
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped));
+      context->set_output(idx, mapped);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -327,12 +341,40 @@ struct RestoreOp {
   string tensor_name;
   string shape_and_slice;
   string reader_prefix;
+  bool use_mmap;
+  BundleReader::Options reader_options;
 
   ::tensorflow::Status status;
 };
 
+// Runs "ops" in order, sharing a new BundleReader.
+void RunRestoreOpsWithNewReader(
+    const string& prefix, const BundleReader::Options& options,
+    gtl::ArraySlice<std::unique_ptr<RestoreOp>> ops) {
+  BundleReader reader(Env::Default(), prefix, options);
+  for (const auto& op : ops) {
+    op->status = reader.status().ok() ? op->run(&reader) : reader.status();
+  }
+}
+
 }  // namespace
 
+std::unique_ptr<thread::ThreadPool> NewCheckpointIOThreadPool(
+    int64 largest_tensor_bytes) {
+  if (largest_tensor_bytes < kParallelIOMinTensorBytes) return nullptr;
+  int64 num_threads = 0;
+  Status status =
+      ReadInt64FromEnvVar("TF_CHECKPOINT_IO_THREADS",
+                          std::min(port::MaxParallelism(), 16), &num_threads);
+  if (!status.ok()) {
+    LOG(WARNING) << "NewCheckpointIOThreadPool: " << status;
+    return nullptr;
+  }
+  if (num_threads <= 1) return nullptr;
+  return std::unique_ptr<thread::ThreadPool>(
+      new thread::ThreadPool(Env::Default(), "checkpoint_io", num_threads));
+}
+
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
@@ -356,13 +398,23 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   BundleReader default_reader(Env::Default(), prefix_string);
   TF_RETURN_IF_ERROR(default_reader.status());
 
+  // In mmap mode, full tensors alias the memory-mapped data files, so a
+  // restore costs a checksum instead of a read and a copy.
+  bool use_mmap = false;
+  TF_RETURN_IF_ERROR(
+      ReadBoolFromEnvVar("TF_CHECKPOINT_RESTORE_USE_MMAP", false, &use_mmap));
+
   std::vector<string> mismatched_errors;
+  int64 largest_tensor_bytes = 0;
   for (const size_t i : sorted_name_idx) {
     TensorShape restored_full_shape;
     DataType original_dtype;
     const string& tensor_name = tensor_names_flat(i);
     TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
         tensor_name, &original_dtype, &restored_full_shape));
+    largest_tensor_bytes =
+        std::max(largest_tensor_bytes, restored_full_shape.num_elements() *
+                                           DataTypeSize(original_dtype));
     if (dtypes[i] != original_dtype) {
       string error_msg = strings::StrCat(
           "tensor_name = ", tensor_name, "; expected dtype ",
@@ -376,12 +428,25 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // Large tensors are read in parallel chunks on "io_pool", by readers that
+  // are opened with it.
+  std::unique_ptr<thread::ThreadPool> io_pool =
+      NewCheckpointIOThreadPool(largest_tensor_bytes);
+  BundleReader::Options reader_options;
+  reader_options.thread_pool = io_pool.get();
+  std::unique_ptr<BundleReader> direct_reader;
+  if (io_pool != nullptr) {
+    direct_reader.reset(
+        new BundleReader(Env::Default(), prefix_string, reader_options));
+    TF_RETURN_IF_ERROR(direct_reader->status());
+  }
+
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
-    auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
-    if (op->should_run_in_pool(&default_reader)) {
+    auto op = new RestoreOp{context, i, tensor_name, shape_and_slice,
+                            prefix_string, use_mmap, reader_options};
+    if (use_mmap || op->should_run_in_pool(&default_reader)) {
       pool_restore_ops.emplace_back(op);
     } else {
       direct_restore_ops.emplace_back(op);
@@ -393,16 +458,31 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
     if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
-      for (auto& op : pool_restore_ops) {
-        reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors", kNumRestoreThreads));
+      if (use_mmap) {
+        // Every op runs in the pool, in one batch of neighboring keys per
+        // thread so that readers are not reopened for each small tensor.
+        gtl::ArraySlice<std::unique_ptr<RestoreOp>> ops(pool_restore_ops);
+        const size_t batch_size =
+            (ops.size() + kNumRestoreThreads - 1) / kNumRestoreThreads;
+        for (size_t start = 0; start < ops.size(); start += batch_size) {
+          auto batch = ops.subspan(start, batch_size);
+          reader_pool->Schedule([&prefix_string, &reader_options, batch]() {
+            RunRestoreOpsWithNewReader(prefix_string, reader_options, batch);
+          });
+        }
+      } else {
+        for (auto& op : pool_restore_ops) {
+          reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
+        }
       }
     }
 
     // Read small tensors from the op thread
     for (auto& op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+      TF_RETURN_IF_ERROR(op->run(direct_reader != nullptr ? direct_reader.get()
+                                                          : &default_reader));
     }
   }
 
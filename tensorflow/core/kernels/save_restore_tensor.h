@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 #define TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 
+#include <memory>
+
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_writer.h"
 
@@ -68,6 +71,13 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& shape_and_slices,
                         gtl::ArraySlice<DataType> dtypes);
 
+// Returns a thread pool on which a V2 checkpoint's BundleWriter or
+// BundleReader can copy, read and checksum large tensors in parallel chunks,
+// or nullptr if "largest_tensor_bytes" is too small to benefit.  The number of
+// threads is read from TF_CHECKPOINT_IO_THREADS; a value <= 1 disables this.
+std::unique_ptr<thread::ThreadPool> NewCheckpointIOThreadPool(
+    int64 largest_tensor_bytes);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
@@ -0,0 +1,179 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks SaveV2 and RestoreV2 throughput over several mixes of tensor
+// sizes, with and without parallel checkpoint I/O.
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+// "count" float tensors of "bytes" bytes each.
+struct TensorSizes {
+  int count;
+  int64 bytes;
+};
+
+// The mixes of tensor sizes that are benchmarked, indexed by the first
+// benchmark argument.
+const std::vector<std::vector<TensorSizes>>& Mixes() {
+  static const auto* mixes = new std::vector<std::vector<TensorSizes>>{
+      {{4096, 4 << 10}},                   // Many small tensors.
+      {{8, 64 << 20}},                     // A few large tensors.
+      {{1024, 64 << 10}, {4, 128 << 20}},  // Small and large tensors.
+  };
+  return *mixes;
+}
+
+std::vector<Tensor> MakeTensors(int mix, int64* total_bytes) {
+  std::vector<Tensor> tensors;
+  *total_bytes = 0;
+  for (const TensorSizes& sizes : Mixes()[mix]) {
+    for (int i = 0; i < sizes.count; ++i) {
+      Tensor t(DT_FLOAT, TensorShape({sizes.bytes / 4}));
+      t.flat<float>().setConstant(i);
+      tensors.push_back(t);
+      *total_bytes += sizes.bytes;
+    }
+  }
+  return tensors;
+}
+
+// Sets the number of threads used for parallel checkpoint I/O.
+void SetCheckpointIOThreads(int num_threads) {
+  setenv("TF_CHECKPOINT_IO_THREADS", strings::StrCat(num_threads).c_str(), 1);
+}
+
+// Adds the prefix, tensor_names and shape_and_slices inputs of SaveV2 and
+// RestoreV2 to "g".
+void AddSaveRestoreInputs(Graph* g, const string& prefix, int num_tensors,
+                          std::vector<Node*>* inputs) {
+  std::vector<tstring> names;
+  for (int i = 0; i < num_tensors; ++i) {
+    names.push_back(strings::StrCat("tensor_", i));
+  }
+  inputs->push_back(test::graph::Constant(g, test::AsScalar<tstring>(prefix)));
+  inputs->push_back(test::graph::Constant(
+      g, test::AsTensor<tstring>(names, {num_tensors})));
+  inputs->push_back(test::graph::Constant(
+      g, test::AsTensor<tstring>(std::vector<tstring>(num_tensors, ""),
+                                 {num_tensors})));
+}
+
+SessionOptions NoOptimizations() {
+  SessionOptions session_options;
+  session_options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  return session_options;
+}
+
+static void BM_SaveV2(::testing::benchmark::State& state) {
+  const int mix = state.range(0);
+  SetCheckpointIOThreads(state.range(1));
+  int64 total_bytes;
+  const std::vector<Tensor> tensors = MakeTensors(mix, &total_bytes);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> inputs;
+  AddSaveRestoreInputs(g, io::JoinPath(testing::TmpDir(), "bm_save_v2"),
+                       tensors.size(), &inputs);
+  std::vector<NodeBuilder::NodeOut> data;
+  for (const Tensor& t : tensors) {
+    data.emplace_back(test::graph::Constant(g, t));
+  }
+  Node* save;
+  TF_CHECK_OK(NodeBuilder("save", "SaveV2")
+                  .Input(inputs[0])
+                  .Input(inputs[1])
+                  .Input(inputs[2])
+                  .Input(data)
+                  .Finalize(g, &save));
+
+  SessionOptions session_options = NoOptimizations();
+  test::Benchmark("cpu", g, &session_options, nullptr, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          total_bytes);
+}
+BENCHMARK(BM_SaveV2)
+    ->ArgPair(0, 1)
+    ->ArgPair(0, 16)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 16)
+    ->ArgPair(2, 1)
+    ->ArgPair(2, 16);
+
+static void BM_RestoreV2(::testing::benchmark::State& state) {
+  const int mix = state.range(0);
+  SetCheckpointIOThreads(state.range(1));
+  int64 total_bytes;
+  const string prefix = io::JoinPath(testing::TmpDir(), "bm_restore_v2");
+  int num_tensors;
+  {
+    const std::vector<Tensor> tensors = MakeTensors(mix, &total_bytes);
+    num_tensors = tensors.size();
+    BundleWriter writer(Env::Default(), prefix);
+    for (int i = 0; i < num_tensors; ++i) {
+      TF_CHECK_OK(writer.Add(strings::StrCat("tensor_", i), tensors[i]));
+    }
+    TF_CHECK_OK(writer.Finish());
+  }
+
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> inputs;
+  AddSaveRestoreInputs(g, prefix, num_tensors, &inputs);
+  Node* restore;
+  TF_CHECK_OK(NodeBuilder("restore", "RestoreV2")
+                  .Input(inputs[0])
+                  .Input(inputs[1])
+                  .Input(inputs[2])
+                  .Attr("dtypes", std::vector<DataType>(num_tensors, DT_FLOAT))
+                  .Finalize(g, &restore));
+
+  SessionOptions session_options = NoOptimizations();
+  test::Benchmark("cpu", g, &session_options, nullptr, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          total_bytes);
+}
+BENCHMARK(BM_RestoreV2)
+    ->ArgPair(0, 1)
+    ->ArgPair(0, 16)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 16)
+    ->ArgPair(2, 1)
+    ->ArgPair(2, 16);
+
+}  // namespace
+}  // namespace tensorflow
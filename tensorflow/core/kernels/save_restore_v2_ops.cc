@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
@@ -105,7 +106,28 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    // Aligning tensor data lets restores memory-map it; see
+    // BundleReader::LookupMapped().
+    int64 data_alignment = 1;
+    OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_CHECKPOINT_DATA_ALIGNMENT",
+                                                1, &data_alignment));
+    OP_REQUIRES(context, data_alignment >= 1,
+                errors::InvalidArgument(
+                    "TF_CHECKPOINT_DATA_ALIGNMENT must be >= 1, got ",
+                    data_alignment));
+    int64 largest_tensor_bytes = 0;
+    for (int i = 0; i < num_tensors; ++i) {
+      largest_tensor_bytes = std::max(
+          largest_tensor_bytes,
+          static_cast<int64>(context->input(i + kFixedInputs).TotalBytes()));
+    }
+    // Large tensors are copied and checksummed in parallel chunks.
+    std::unique_ptr<thread::ThreadPool> io_pool =
+        NewCheckpointIOThreadPool(largest_tensor_bytes);
+    BundleWriter::Options options;
+    options.data_alignment = data_alignment;
+    options.thread_pool = io_pool.get();
+    BundleWriter writer(Env::Default(), prefix_string, options);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
@@ -47,6 +47,7 @@ class RecvOp : public AsyncOpKernel {
   string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
   bool hostmem_sendrecv_;
+  string transfer_codec_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecvOp);
 };
@@ -63,6 +63,36 @@ TEST(ThreadPool, DoWork) {
   }
 }
 
+TEST(ThreadPool, NUMAWorkerGroups) {
+  // Without multiple NUMA nodes the pool falls back to a single group; either
+  // way every closure runs exactly once, including closures scheduled from
+  // inside the pool.
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads++) {
+    fprintf(stderr, "Testing with %d threads\n", num_threads);
+    const int kWorkItems = 15;
+    std::atomic<bool> work[2 * kWorkItems];
+    for (int i = 0; i < 2 * kWorkItems; i++) {
+      work[i] = false;
+    }
+    {
+      ThreadPool pool(Env::Default(), ThreadOptions(), "test", num_threads,
+                      /*low_latency_hint=*/true, /*numa_worker_groups=*/true,
+                      /*allocator=*/nullptr);
+      for (int i = 0; i < kWorkItems; i++) {
+        pool.Schedule([&pool, &work, i]() {
+          ASSERT_FALSE(work[i].exchange(true));
+          pool.Schedule([&work, i]() {
+            ASSERT_FALSE(work[kWorkItems + i].exchange(true));
+          });
+        });
+      }
+    }
+    for (int i = 0; i < 2 * kWorkItems; i++) {
+      ASSERT_TRUE(work[i]);
+    }
+  }
+}
+
 void RunWithFixedBlockSize(int64 block_size, int64 total, ThreadPool* threads) {
   mutex mu;
   int64 num_shards = 0;
@@ -370,8 +400,10 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
-static void BM_Sequential(int iters) {
-  ThreadPool pool(Env::Default(), "test", kNumThreads);
+static void BM_Sequential(int iters, int numa_worker_groups) {
+  ThreadPool pool(Env::Default(), ThreadOptions(), "test", kNumThreads,
+                  /*low_latency_hint=*/true, numa_worker_groups,
+                  /*allocator=*/nullptr);
   // Decrement count sequentially until 0.
   int count = iters;
   mutex done_lock;
@@ -389,10 +421,12 @@ static void BM_Sequential(int iters) {
   mutex_lock l(done_lock);
   done_lock.Await(Condition(&done_flag));
 }
-BENCHMARK(BM_Sequential);
+BENCHMARK(BM_Sequential)->Arg(0)->Arg(1);
 
-static void BM_Parallel(int iters) {
-  ThreadPool pool(Env::Default(), "test", kNumThreads);
+static void BM_Parallel(int iters, int numa_worker_groups) {
+  ThreadPool pool(Env::Default(), ThreadOptions(), "test", kNumThreads,
+                  /*low_latency_hint=*/true, numa_worker_groups,
+                  /*allocator=*/nullptr);
   // Decrement count concurrently until 0.
   std::atomic_int_fast32_t count(iters);
   mutex done_lock;
@@ -408,7 +442,7 @@ static void BM_Parallel(int iters) {
   mutex_lock l(done_lock);
   done_lock.Await(Condition(&done_flag));
 }
-BENCHMARK(BM_Parallel);
+BENCHMARK(BM_Parallel)->Arg(0)->Arg(1);
 
 static void BM_ParallelFor(int iters, int total, int cost_per_unit) {
   ThreadPool pool(Env::Default(), "test", kNumThreads);
@@ -263,6 +263,53 @@ uint32 Extend(uint32 crc, const char *buf, size_t size) {
   return l ^ 0xffffffffu;
 }
 
+// Multiplies the 32x32 matrix over GF(2) "mat" by the vector "vec".
+static uint32 Gf2MatrixTimes(const uint32 *mat, uint32 vec) {
+  uint32 sum = 0;
+  for (; vec != 0; vec >>= 1, ++mat) {
+    if (vec & 1) sum ^= *mat;
+  }
+  return sum;
+}
+
+// Sets "square" to the square of the 32x32 matrix over GF(2) "mat".
+static void Gf2MatrixSquare(uint32 *square, const uint32 *mat) {
+  for (int n = 0; n < 32; n++) {
+    square[n] = Gf2MatrixTimes(mat, mat[n]);
+  }
+}
+
+// Same approach as zlib's crc32_combine(): appending len2 zero bytes to A is a
+// linear operator on its crc, applied here by repeated squaring in O(log len2).
+uint32 Combine(uint32 crc1, uint32 crc2, size_t len2) {
+  if (len2 == 0) return crc1;
+
+  uint32 even[32];  // Operator for 2^n zero bits, n even.
+  uint32 odd[32];   // Operator for 2^n zero bits, n odd.
+
+  // Operator for one zero bit.
+  odd[0] = 0x82f63b78u;  // Reflected Castagnoli polynomial.
+  uint32 row = 1;
+  for (int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+  Gf2MatrixSquare(even, odd);  // Two zero bits.
+  Gf2MatrixSquare(odd, even);  // Four zero bits.
+
+  // Applies len2 zero bytes to crc1; the first square yields one zero byte.
+  do {
+    Gf2MatrixSquare(even, odd);
+    if (len2 & 1) crc1 = Gf2MatrixTimes(even, crc1);
+    len2 >>= 1;
+    if (len2 == 0) break;
+    Gf2MatrixSquare(odd, even);
+    if (len2 & 1) crc1 = Gf2MatrixTimes(odd, crc1);
+    len2 >>= 1;
+  } while (len2 != 0);
+  return crc1 ^ crc2;
+}
+
 #if defined(TF_CORD_SUPPORT)
 uint32 Extend(uint32 crc, const absl::Cord &cord) {
   for (absl::string_view fragment : cord.Chunks()) {
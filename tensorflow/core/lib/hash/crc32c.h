@@ -39,6 +39,11 @@ extern uint32 Extend(uint32 init_crc, const absl::Cord& cord);
 // Return the crc32c of data[0,n-1]
 inline uint32 Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// Return the crc32c of concat(A, B) where crc1 is the crc32c of some string A
+// and crc2 is the crc32c of some string B of length len2.  Lets the checksums
+// of adjacent chunks be computed independently, e.g. in parallel.
+extern uint32 Combine(uint32 crc1, uint32 crc2, size_t len2);
+
 #if defined(TF_CORD_SUPPORT)
 inline uint32 Value(const absl::Cord& cord) { return Extend(0, cord); }
 #endif
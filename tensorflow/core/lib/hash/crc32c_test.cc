@@ -62,6 +62,25 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, Combine) {
+  ASSERT_EQ(Value("hello world", 11),
+            Combine(Value("hello ", 6), Value("world", 5), 5));
+  ASSERT_EQ(Value("hello", 5), Combine(Value("hello", 5), Value("", 0), 0));
+  ASSERT_EQ(Value("world", 5), Combine(Value("", 0), Value("world", 5), 5));
+
+  std::string data(100000, 'x');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i * 7 + (i >> 8));
+  }
+  const uint32 expected = Value(data.data(), data.size());
+  for (size_t split : {1, 3, 4096, 65537, 99999}) {
+    ASSERT_EQ(expected,
+              Combine(Value(data.data(), split),
+                      Value(data.data() + split, data.size() - split),
+                      data.size() - split));
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
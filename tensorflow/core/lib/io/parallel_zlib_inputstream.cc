@@ -0,0 +1,216 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/parallel_zlib_inputstream.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace io {
+
+ParallelZlibInputStream::ParallelZlibInputStream(
+    RandomAccessFile* file, ZlibSegmentIndex index,
+    const ZlibCompressionOptions& zlib_options,
+    thread::ThreadPool* thread_pool, int max_inflight_segments)
+    : file_(file),
+      index_(std::move(index)),
+      zlib_options_(zlib_options),
+      thread_pool_(thread_pool),
+      max_inflight_segments_(std::max(max_inflight_segments, 1)) {}
+
+ParallelZlibInputStream::~ParallelZlibInputStream() {
+  // The scheduled closures write to the segments in flight.
+  for (auto& segment : inflight_) {
+    segment->done.WaitForNotification();
+  }
+}
+
+Status ParallelZlibInputStream::InflateSegment(size_t i,
+                                               Segment* segment) const {
+  const ZlibSegment& begin = index_.segments[i];
+  const bool is_last = i + 1 == index_.segments.size();
+  const int64 compressed_end = is_last
+                                   ? index_.compressed_size
+                                   : index_.segments[i + 1].compressed_offset;
+  const int64 uncompressed_end =
+      is_last ? index_.uncompressed_size
+              : index_.segments[i + 1].uncompressed_offset;
+  const int64 compressed_size = compressed_end - begin.compressed_offset;
+  const int64 uncompressed_size = uncompressed_end - begin.uncompressed_offset;
+  if (compressed_size > std::numeric_limits<uInt>::max() ||
+      uncompressed_size > std::numeric_limits<uInt>::max()) {
+    return errors::Unimplemented("Zlib segment ", i, " is too large");
+  }
+  segment->data.resize_uninitialized(uncompressed_size);
+  if (uncompressed_size == 0) {
+    return Status::OK();
+  }
+
+  std::unique_ptr<char[]> scratch(new char[compressed_size]);
+  StringPiece input;
+  Status s = file_->Read(begin.compressed_offset, compressed_size, &input,
+                         scratch.get());
+  if (errors::IsOutOfRange(s) &&
+      input.size() == static_cast<size_t>(compressed_size)) {
+    s = Status::OK();
+  }
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Truncated zlib segment ", i);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  // Every segment but the first starts after a full flush, and so is raw
+  // deflate data without a header.
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  int error = inflateInit2(
+      &stream, i == 0 ? zlib_options_.window_bits : -MAX_WBITS);
+  if (error != Z_OK) {
+    return errors::Internal("inflateInit2 failed with status ", error);
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&segment->data[0]);
+  stream.avail_out = uncompressed_size;
+  while (stream.avail_out > 0) {
+    error = inflate(&stream, Z_NO_FLUSH);
+    if (error != Z_OK) break;
+  }
+  const int64 inflated = uncompressed_size - stream.avail_out;
+  string message = stream.msg != nullptr ? stream.msg : "";
+  inflateEnd(&stream);
+  if (inflated != uncompressed_size) {
+    return errors::DataLoss("Inflated ", inflated, " bytes of zlib segment ",
+                            i, " instead of ", uncompressed_size,
+                            " (error ", error, " ", message, ")");
+  }
+  return Status::OK();
+}
+
+void ParallelZlibInputStream::ScheduleSegments() {
+  while (inflight_.size() < static_cast<size_t>(max_inflight_segments_) &&
+         next_to_schedule_ < index_.segments.size()) {
+    inflight_.emplace_back(new Segment);
+    Segment* segment = inflight_.back().get();
+    const size_t i = next_to_schedule_++;
+    thread_pool_->Schedule([this, i, segment]() {
+      segment->status = InflateSegment(i, segment);
+      if (!segment->status.ok()) {
+        segment->data.clear();
+      }
+      segment->done.Notify();
+    });
+  }
+}
+
+void ParallelZlibInputStream::Reposition(int64 position) {
+  for (auto& segment : inflight_) {
+    segment->done.WaitForNotification();
+  }
+  inflight_.clear();
+  current_.reset();
+  pos_in_current_ = 0;
+
+  // The last segment that starts at or before `position`.
+  auto it = std::upper_bound(
+      index_.segments.begin(), index_.segments.end(), position,
+      [](int64 position, const ZlibSegment& segment) {
+        return position < segment.uncompressed_offset;
+      });
+  DCHECK(it != index_.segments.begin());
+  next_segment_ = next_to_schedule_ = (it - index_.segments.begin()) - 1;
+  pos_ = index_.segments[next_segment_].uncompressed_offset;
+}
+
+Status ParallelZlibInputStream::NextSegment() {
+  if (next_segment_ >= index_.segments.size()) {
+    return errors::OutOfRange("reached end of file");
+  }
+  ScheduleSegments();
+  current_ = std::move(inflight_.front());
+  inflight_.pop_front();
+  ++next_segment_;
+  pos_in_current_ = 0;
+  current_->done.WaitForNotification();
+  ScheduleSegments();
+  return current_->status;
+}
+
+Status ParallelZlibInputStream::Consume(int64 bytes, tstring* result) {
+  while (bytes > 0) {
+    if (current_ == nullptr || pos_in_current_ == current_->data.size()) {
+      // A segment that failed to inflate keeps failing reads.
+      if (current_ != nullptr && !current_->status.ok()) {
+        return current_->status;
+      }
+      TF_RETURN_IF_ERROR(NextSegment());
+      continue;
+    }
+    const size_t n =
+        std::min<int64>(current_->data.size() - pos_in_current_, bytes);
+    if (result != nullptr) {
+      result->append(current_->data.data() + pos_in_current_, n);
+    }
+    pos_in_current_ += n;
+    pos_ += n;
+    bytes -= n;
+  }
+  return Status::OK();
+}
+
+Status ParallelZlibInputStream::ReadNBytes(int64 bytes_to_read,
+                                           tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  return Consume(bytes_to_read, result);
+}
+
+Status ParallelZlibInputStream::SkipNBytes(int64 bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  const int64 target = pos_ + bytes_to_skip;
+  // Segments that are already inflating are read through. Otherwise jump to
+  // the segment that holds the target.
+  const int64 inflight_end =
+      next_to_schedule_ < index_.segments.size()
+          ? index_.segments[next_to_schedule_].uncompressed_offset
+          : index_.uncompressed_size;
+  if (target > inflight_end) {
+    Reposition(std::min(target, index_.uncompressed_size));
+  }
+  return Consume(target - pos_, nullptr);
+}
+
+int64 ParallelZlibInputStream::Tell() const { return pos_; }
+
+Status ParallelZlibInputStream::Reset() {
+  Reposition(0);
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
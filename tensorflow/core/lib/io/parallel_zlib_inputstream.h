@@ -0,0 +1,112 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/lib/io/zlib_segment_index.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace io {
+
+// Inflates a ZLIB or GZIP compressed file whose segments are described by a
+// ZlibSegmentIndex, with several segments inflated concurrently on a thread
+// pool. The uncompressed data is returned in order, like ZlibInputStream.
+//
+// Since the index locates every segment, SkipNBytes() and Reset() only
+// inflate the segment that contains the new position.
+//
+// The gzip or zlib trailer checksum covers the whole file, so it is not
+// verified.
+//
+// A single instance of ParallelZlibInputStream is NOT safe for concurrent use
+// by multiple threads.
+class ParallelZlibInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file` or `thread_pool`, which must outlive
+  // *this. At most `max_inflight_segments` segments are inflated ahead of
+  // the reader.
+  ParallelZlibInputStream(RandomAccessFile* file, ZlibSegmentIndex index,
+                          const ZlibCompressionOptions& zlib_options,
+                          thread::ThreadPool* thread_pool,
+                          int max_inflight_segments);
+
+  ~ParallelZlibInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64 bytes_to_skip) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  struct Segment {
+    Notification done;
+    // Set before `done` is notified.
+    tstring data;
+    Status status;
+  };
+
+  // Inflates segment `i` of the index into `*segment`.
+  Status InflateSegment(size_t i, Segment* segment) const;
+
+  // Schedules segments until `max_inflight_segments_` are in flight.
+  void ScheduleSegments();
+
+  // Waits for the segments in flight, then starts reading at `position`.
+  void Reposition(int64 position);
+
+  // Advances the stream by `bytes`, appending the data to `*result` unless it
+  // is null.
+  Status Consume(int64 bytes, tstring* result);
+
+  // Makes the next segment the current one. Returns OUT_OF_RANGE at the end
+  // of the file.
+  Status NextSegment();
+
+  RandomAccessFile* const file_;  // Not owned.
+  const ZlibSegmentIndex index_;
+  const ZlibCompressionOptions zlib_options_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+  const int max_inflight_segments_;
+
+  // Segments scheduled for inflation, in file order, starting with segment
+  // `next_segment_`.
+  std::deque<std::unique_ptr<Segment>> inflight_;
+  size_t next_segment_ = 0;
+  // Index of the next segment to schedule.
+  size_t next_to_schedule_ = 0;
+
+  std::unique_ptr<Segment> current_;
+  size_t pos_in_current_ = 0;
+  int64 pos_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ParallelZlibInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_PARALLEL_ZLIB_INPUTSTREAM_H_
@@ -0,0 +1,286 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/parallel_zlib_inputstream.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zlib_segment_index.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Returns `num_records` compressible records of up to `max_record_size`
+// bytes.
+std::vector<string> MakeRecords(int num_records, int max_record_size) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<string> records;
+  for (int i = 0; i < num_records; ++i) {
+    string record(rnd.Uniform(max_record_size), ' ');
+    for (char& c : record) c = 'a' + rnd.Uniform(4);
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+// Writes `records` to `fname` in segments of about `segment_bytes`, and
+// returns the segment index of the file.
+ZlibSegmentIndex WriteRecords(const string& fname,
+                              const std::vector<string>& records,
+                              const ZlibCompressionOptions& zlib_options,
+                              int64 segment_bytes) {
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+  RecordWriterOptions options;
+  options.compression_type = RecordWriterOptions::ZLIB_COMPRESSION;
+  options.zlib_options = zlib_options;
+  options.zlib_segment_bytes = segment_bytes;
+  RecordWriter writer(file.get(), options);
+  for (const string& record : records) {
+    TF_CHECK_OK(writer.WriteRecord(record));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return writer.zlib_segment_index();
+}
+
+// Returns the whole uncompressed contents of `fname`.
+string InflateSerially(const string& fname,
+                       const ZlibCompressionOptions& zlib_options) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  RandomAccessInputStream input(file.get());
+  ZlibInputStream in(&input, zlib_options.input_buffer_size,
+                     zlib_options.output_buffer_size, zlib_options);
+  tstring result;
+  Status s = in.ReadNBytes(1LL << 30, &result);
+  CHECK(errors::IsOutOfRange(s)) << s;
+  return string(result);
+}
+
+std::vector<ZlibCompressionOptions> CompressionOptions() {
+  return {ZlibCompressionOptions::DEFAULT(), ZlibCompressionOptions::GZIP()};
+}
+
+TEST(ParallelZlibInputStream, ReadsSameDataAsZlibInputStream) {
+  const string fname = testing::TmpDir() + "/parallel_zlib_read_test";
+  const std::vector<string> records = MakeRecords(2000, 1000);
+  thread::ThreadPool pool(Env::Default(), "inflate", 4);
+
+  for (const ZlibCompressionOptions& zlib_options : CompressionOptions()) {
+    for (int64 segment_bytes : {1, 10000, 1 << 30}) {
+      ZlibSegmentIndex index =
+          WriteRecords(fname, records, zlib_options, segment_bytes);
+      const string expected = InflateSerially(fname, zlib_options);
+      EXPECT_EQ(expected.size(), index.uncompressed_size);
+      uint64 file_size;
+      TF_ASSERT_OK(Env::Default()->GetFileSize(fname, &file_size));
+      EXPECT_EQ(static_cast<int64>(file_size), index.compressed_size);
+      if (segment_bytes == 1 << 30) {
+        EXPECT_EQ(1, index.segments.size());
+      } else {
+        EXPECT_GT(index.segments.size(), 10);
+      }
+
+      std::unique_ptr<RandomAccessFile> file;
+      TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+      for (int max_inflight : {1, 8}) {
+        ParallelZlibInputStream in(file.get(), index, zlib_options, &pool,
+                                   max_inflight);
+        tstring result;
+        string actual;
+        // Reads in pieces that straddle segment boundaries.
+        Status s;
+        while (s.ok()) {
+          s = in.ReadNBytes(777, &result);
+          actual.append(result.data(), result.size());
+        }
+        EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+        EXPECT_EQ(expected, actual);
+        EXPECT_EQ(expected.size(), in.Tell());
+      }
+    }
+  }
+}
+
+TEST(ParallelZlibInputStream, SkipAndReset) {
+  const string fname = testing::TmpDir() + "/parallel_zlib_skip_test";
+  const ZlibCompressionOptions zlib_options = ZlibCompressionOptions::GZIP();
+  ZlibSegmentIndex index =
+      WriteRecords(fname, MakeRecords(1000, 1000), zlib_options, 4096);
+  const string expected = InflateSerially(fname, zlib_options);
+  thread::ThreadPool pool(Env::Default(), "inflate", 4);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+
+  ParallelZlibInputStream in(file.get(), index, zlib_options, &pool, 2);
+  tstring result;
+  TF_ASSERT_OK(in.SkipNBytes(10));
+  TF_ASSERT_OK(in.ReadNBytes(100, &result));
+  EXPECT_EQ(expected.substr(10, 100), result);
+  // Skips within and far beyond the segments in flight.
+  for (int64 skip : {int64{5}, int64{5000}, int64{200000}}) {
+    const int64 pos = in.Tell();
+    TF_ASSERT_OK(in.SkipNBytes(skip));
+    EXPECT_EQ(pos + skip, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(50, &result));
+    EXPECT_EQ(expected.substr(pos + skip, 50), result);
+  }
+
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(0, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(64, &result));
+  EXPECT_EQ(expected.substr(0, 64), result);
+
+  EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(expected.size())));
+  EXPECT_EQ(expected.size(), in.Tell());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+}
+
+TEST(ParallelZlibInputStream, RecordReaderUsesIndex) {
+  const string fname = testing::TmpDir() + "/parallel_zlib_record_test";
+  const std::vector<string> records = MakeRecords(500, 2000);
+  ZlibSegmentIndex index = WriteRecords(
+      fname, records, ZlibCompressionOptions::DEFAULT(), 8192);
+  TF_ASSERT_OK(WriteZlibSegmentIndex(
+      Env::Default(), ZlibSegmentIndexFilename(fname), index));
+  thread::ThreadPool pool(Env::Default(), "inflate", 4);
+
+  RecordReaderOptions options =
+      RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
+  auto read_index = std::make_shared<ZlibSegmentIndex>();
+  TF_ASSERT_OK(ReadZlibSegmentIndex(
+      Env::Default(), ZlibSegmentIndexFilename(fname), read_index.get()));
+  options.zlib_segment_index = std::move(read_index);
+  options.zlib_thread_pool = &pool;
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  SequentialRecordReader reader(file.get(), options);
+  tstring record;
+  int num_skipped;
+  TF_ASSERT_OK(reader.SkipRecords(100, &num_skipped));
+  for (size_t i = 100; i < records.size(); ++i) {
+    TF_ASSERT_OK(reader.ReadRecord(&record));
+    EXPECT_EQ(records[i], record);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+}
+
+TEST(ParallelZlibInputStream, CorruptedData) {
+  const string fname = testing::TmpDir() + "/parallel_zlib_corrupted_test";
+  const ZlibCompressionOptions zlib_options = ZlibCompressionOptions::DEFAULT();
+  ZlibSegmentIndex index =
+      WriteRecords(fname, MakeRecords(1000, 1000), zlib_options, 4096);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &contents));
+  // Garbles the middle of the second segment.
+  const int64 begin = index.segments[1].compressed_offset;
+  const int64 end = index.segments[2].compressed_offset;
+  for (int64 i = begin + (end - begin) / 4; i < end; ++i) contents[i] ^= 0x55;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, contents));
+
+  thread::ThreadPool pool(Env::Default(), "inflate", 2);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  ParallelZlibInputStream in(file.get(), index, zlib_options, &pool, 4);
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(index.segments[1].uncompressed_offset, &result));
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(1, &result)));
+  // The error sticks until the stream is repositioned.
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(1, &result)));
+  TF_ASSERT_OK(in.Reset());
+  TF_EXPECT_OK(in.ReadNBytes(1, &result));
+}
+
+TEST(ZlibSegmentIndex, EncodeAndParse) {
+  ZlibSegmentIndex index;
+  index.segments = {{0, 0}, {100, 4000}, {250, 9000}};
+  index.compressed_size = 300;
+  index.uncompressed_size = 10000;
+  string encoded;
+  EncodeZlibSegmentIndex(index, &encoded);
+
+  ZlibSegmentIndex parsed;
+  TF_ASSERT_OK(ParseZlibSegmentIndex(encoded, &parsed));
+  ASSERT_EQ(3, parsed.segments.size());
+  EXPECT_EQ(250, parsed.segments[2].compressed_offset);
+  EXPECT_EQ(9000, parsed.segments[2].uncompressed_offset);
+  EXPECT_EQ(300, parsed.compressed_size);
+  EXPECT_EQ(10000, parsed.uncompressed_size);
+
+  string corrupted = encoded;
+  corrupted[40] ^= 1;
+  EXPECT_TRUE(errors::IsDataLoss(ParseZlibSegmentIndex(corrupted, &parsed)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      ParseZlibSegmentIndex(StringPiece(encoded).substr(0, 50), &parsed)));
+
+  index.segments[2].compressed_offset = 50;
+  EncodeZlibSegmentIndex(index, &encoded);
+  EXPECT_TRUE(errors::IsDataLoss(ParseZlibSegmentIndex(encoded, &parsed)));
+}
+
+// Inflates a GZIP file of 64MiB of records with 'num_threads' threads, or
+// with ZlibInputStream when 'num_threads' is 0.
+static void BM_InflateRecords(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const string fname = testing::TmpDir() + "/bm_parallel_zlib";
+  const ZlibCompressionOptions zlib_options = ZlibCompressionOptions::GZIP();
+  const ZlibSegmentIndex index =
+      WriteRecords(fname, MakeRecords(64 << 10, 2 << 10), zlib_options,
+                   4 << 20);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  std::unique_ptr<thread::ThreadPool> pool;
+  if (num_threads > 0) {
+    pool.reset(new thread::ThreadPool(Env::Default(), "inflate", num_threads));
+  }
+
+  tstring result;
+  for (auto s : state) {
+    std::unique_ptr<RandomAccessInputStream> input;
+    std::unique_ptr<InputStreamInterface> in;
+    if (num_threads == 0) {
+      input.reset(new RandomAccessInputStream(file.get()));
+      in.reset(new ZlibInputStream(input.get(), zlib_options.input_buffer_size,
+                                   zlib_options.output_buffer_size,
+                                   zlib_options));
+    } else {
+      in.reset(new ParallelZlibInputStream(file.get(), index, zlib_options,
+                                           pool.get(), 2 * num_threads));
+    }
+    Status status;
+    while (status.ok()) {
+      status = in->ReadNBytes(256 << 10, &result);
+    }
+    CHECK(errors::IsOutOfRange(status)) << status;
+  }
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          index.uncompressed_size);
+}
+BENCHMARK(BM_InflateRecords)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
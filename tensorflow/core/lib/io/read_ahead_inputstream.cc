@@ -0,0 +1,198 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/read_ahead_inputstream.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+ReadAheadInputStream::ReadAheadInputStream(Env* env, RandomAccessFile* file,
+                                           size_t buffer_bytes,
+                                           int num_buffers)
+    : file_(file),
+      buffer_bytes_(std::max<size_t>(buffer_bytes, 1)),
+      num_buffers_(std::max(num_buffers, 1)) {
+  thread_.reset(env->StartThread(ThreadOptions(), "tf_read_ahead",
+                                 [this]() { ReadAheadLoop(); }));
+}
+
+ReadAheadInputStream::~ReadAheadInputStream() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+  }
+  // Joins the background thread, which may be finishing a read.
+  thread_.reset();
+}
+
+void ReadAheadInputStream::ReadAheadLoop() {
+  while (true) {
+    Block block;
+    int64 generation;
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && (done_reading_ || outstanding_ >= num_buffers_)) {
+        cond_var_.wait(l);
+      }
+      if (cancelled_) return;
+      block.offset = next_read_offset_;
+      if (free_buffers_.empty()) {
+        block.data.reset(new char[buffer_bytes_]);
+      } else {
+        block.data = std::move(free_buffers_.back());
+        free_buffers_.pop_back();
+      }
+      generation = generation_;
+      ++outstanding_;
+    }
+
+    StringPiece data;
+    block.status =
+        file_->Read(block.offset, buffer_bytes_, &data, block.data.get());
+    if (data.data() != block.data.get()) {
+      memmove(block.data.get(), data.data(), data.size());
+    }
+    block.size = data.size();
+    if (block.status.ok() && block.size == 0) {
+      block.status = errors::OutOfRange("reached end of file");
+    }
+
+    mutex_lock l(mu_);
+    if (generation != generation_) {
+      // The consumer repositioned the stream while we were reading.
+      --outstanding_;
+      RecycleLocked(&block);
+      continue;
+    }
+    next_read_offset_ = block.offset + block.size;
+    if (!block.status.ok()) {
+      done_reading_ = true;
+    }
+    ready_.push_back(std::move(block));
+    cond_var_.notify_all();
+  }
+}
+
+void ReadAheadInputStream::RecycleLocked(Block* block) {
+  if (block->data != nullptr) {
+    free_buffers_.push_back(std::move(block->data));
+  }
+  block->size = 0;
+  block->status = Status::OK();
+}
+
+void ReadAheadInputStream::NextBlock() {
+  mutex_lock l(mu_);
+  RecycleLocked(&current_);
+  while (ready_.empty()) {
+    cond_var_.wait(l);
+  }
+  current_ = std::move(ready_.front());
+  ready_.pop_front();
+  --outstanding_;
+  pos_in_current_ = 0;
+  cond_var_.notify_all();
+}
+
+void ReadAheadInputStream::Reposition(int64 offset) {
+  mutex_lock l(mu_);
+  ++generation_;
+  RecycleLocked(&current_);
+  for (Block& block : ready_) {
+    RecycleLocked(&block);
+  }
+  outstanding_ -= ready_.size();
+  ready_.clear();
+  next_read_offset_ = offset;
+  done_reading_ = false;
+  current_.offset = offset;
+  pos_in_current_ = 0;
+  pos_ = offset;
+  cond_var_.notify_all();
+}
+
+Status ReadAheadInputStream::Consume(int64 bytes, tstring* result) {
+  while (bytes > 0) {
+    if (pos_in_current_ == current_.size) {
+      // The last block of the file, or of a failed read, keeps its status.
+      if (!current_.status.ok()) {
+        return current_.status;
+      }
+      NextBlock();
+      continue;
+    }
+    const size_t n = std::min<int64>(current_.size - pos_in_current_, bytes);
+    if (result != nullptr) {
+      result->append(current_.data.get() + pos_in_current_, n);
+    }
+    pos_in_current_ += n;
+    pos_ += n;
+    bytes -= n;
+  }
+  return Status::OK();
+}
+
+Status ReadAheadInputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  return Consume(bytes_to_read, result);
+}
+
+Status ReadAheadInputStream::SkipNBytes(int64 bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  // Targets within the read-ahead window are reached through the buffered
+  // data, since those reads have already been issued.
+  const int64 window_end =
+      current_.offset + (num_buffers_ + 1) * static_cast<int64>(buffer_bytes_);
+  if (pos_ + bytes_to_skip <= window_end) {
+    return Consume(bytes_to_skip, nullptr);
+  }
+  // Otherwise restart the reads just before the target, and check that the
+  // file extends that far by consuming the last skipped byte.
+  const int64 start = pos_;
+  Reposition(pos_ + bytes_to_skip - 1);
+  Status s = Consume(1, nullptr);
+  if (!errors::IsOutOfRange(s)) {
+    return s;
+  }
+  // The file ends before the target: skip up to its end so that Tell()
+  // reports the file size.
+  Reposition(start);
+  return Consume(bytes_to_skip, nullptr);
+}
+
+int64 ReadAheadInputStream::Tell() const { return pos_; }
+
+Status ReadAheadInputStream::Reset() {
+  Reposition(0);
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
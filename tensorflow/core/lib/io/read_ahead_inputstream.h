@@ -0,0 +1,117 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace io {
+
+// Reads a RandomAccessFile sequentially, keeping up to `num_buffers` buffers
+// of `buffer_bytes` bytes each filled ahead of the reader by a background
+// thread. This lets the consumer (e.g. a decompressing stream on top of this
+// one) work on one buffer while the next ones are being read.
+//
+// Skipping forward within the read-ahead window reuses the buffered data;
+// skipping further, or calling Reset(), discards it and restarts the
+// background reads at the new position.
+//
+// A single instance of ReadAheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadAheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file`, which must outlive *this.
+  ReadAheadInputStream(Env* env, RandomAccessFile* file, size_t buffer_bytes,
+                       int num_buffers);
+
+  ~ReadAheadInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64 bytes_to_skip) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // A contiguous range of the file read by the background thread.
+  struct Block {
+    int64 offset = 0;
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    // OK, or the error returned by the read. A short block at the end of the
+    // file carries OUT_OF_RANGE.
+    Status status;
+  };
+
+  // Body of the background thread.
+  void ReadAheadLoop();
+
+  // Advances the stream by `bytes`, appending the data to `*result` unless it
+  // is null.
+  Status Consume(int64 bytes, tstring* result);
+
+  // Makes the next block the current one, waiting for it if needed.
+  void NextBlock();
+
+  // Discards all buffered data and restarts reading ahead from `offset`.
+  void Reposition(int64 offset);
+
+  // Returns the data of `block` to the free list.
+  void RecycleLocked(Block* block) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t buffer_bytes_;
+  const int num_buffers_;
+
+  // Consumer-side state, only touched by the reading thread.
+  Block current_;
+  size_t pos_in_current_ = 0;
+  int64 pos_ = 0;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  std::deque<Block> ready_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<char[]>> free_buffers_ TF_GUARDED_BY(mu_);
+  // Number of blocks read, being read or waiting in `ready_`, not including
+  // `current_`.
+  int outstanding_ TF_GUARDED_BY(mu_) = 0;
+  int64 next_read_offset_ TF_GUARDED_BY(mu_) = 0;
+  // Incremented on Reposition() so that reads in flight are discarded.
+  int64 generation_ TF_GUARDED_BY(mu_) = 0;
+  // Set once a read returned a short block or an error.
+  bool done_reading_ TF_GUARDED_BY(mu_) = false;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadAheadInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
@@ -0,0 +1,197 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/read_ahead_inputstream.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/buffered_inputstream.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() {
+  return {1, 2, 3, 4, 5, 7, 10, 11, 64, 65536};
+}
+
+static std::vector<int> NumBuffers() { return {1, 2, 4}; }
+
+// Writes "0123456789" ten times to a temporary file.
+void WriteTestFile(Env* env, string* fname) {
+  ASSERT_TRUE(env->LocalTempFilename(fname));
+  string contents;
+  for (int i = 0; i < 10; ++i) contents += "0123456789";
+  TF_ASSERT_OK(WriteStringToFile(env, *fname, contents));
+}
+
+TEST(ReadAheadInputStream, ReadNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  WriteTestFile(env, &fname);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(env, file.get(), buf_size, num_buffers);
+      tstring read;
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      TF_ASSERT_OK(in.ReadNBytes(14, &read));
+      EXPECT_EQ(read, "34567890123456");
+      EXPECT_EQ(17, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(80, &read));
+      EXPECT_EQ(97, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+      EXPECT_EQ(read, "789");
+      EXPECT_EQ(100, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(100, in.Tell());
+    }
+  }
+}
+
+TEST(ReadAheadInputStream, SkipNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  WriteTestFile(env, &fname);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(env, file.get(), buf_size, num_buffers);
+      tstring read;
+      TF_ASSERT_OK(in.SkipNBytes(1));
+      EXPECT_EQ(1, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_EQ(read, "12");
+      // Skips well past the read-ahead window for small buffers.
+      TF_ASSERT_OK(in.SkipNBytes(70));
+      EXPECT_EQ(73, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "3456");
+      TF_ASSERT_OK(in.SkipNBytes(23));
+      EXPECT_EQ(100, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(1)));
+    }
+  }
+}
+
+TEST(ReadAheadInputStream, SkipPastEndOfFile) {
+  Env* env = Env::Default();
+  string fname;
+  WriteTestFile(env, &fname);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(env, file.get(), buf_size, num_buffers);
+      TF_ASSERT_OK(in.SkipNBytes(5));
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(1000)));
+      EXPECT_EQ(100, in.Tell());
+    }
+  }
+}
+
+TEST(ReadAheadInputStream, Reset) {
+  Env* env = Env::Default();
+  string fname;
+  WriteTestFile(env, &fname);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadAheadInputStream in(env, file.get(), buf_size, num_buffers);
+      tstring read;
+      TF_ASSERT_OK(in.ReadNBytes(95, &read));
+      TF_ASSERT_OK(in.Reset());
+      EXPECT_EQ(0, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "0123");
+      // Reading to the end of the file does not prevent a reset.
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(200, &read)));
+      TF_ASSERT_OK(in.Reset());
+      TF_ASSERT_OK(in.ReadNBytes(100, &read));
+      EXPECT_EQ(StringPiece(read).substr(90), "0123456789");
+    }
+  }
+}
+
+TEST(ReadAheadInputStream, EmptyFile) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, ""));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  ReadAheadInputStream in(env, file.get(), 16, 2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(0, &read));
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+  EXPECT_EQ(read, "");
+  EXPECT_EQ(0, in.Tell());
+}
+
+// Reads a file of 'file_size' bytes in 4KiB pieces through 'num_buffers'
+// read-ahead buffers of 256KiB. With 'num_buffers' = 0, reads through a
+// BufferedInputStream instead.
+static void BM_ReadAhead(::testing::benchmark::State& state) {
+  const int num_buffers = state.range(0);
+  const int64 file_size = state.range(1);
+  const int64 kBufferSize = 256 << 10;
+  Env* env = Env::Default();
+  string fname;
+  CHECK(env->LocalTempFilename(&fname));
+  TF_CHECK_OK(WriteStringToFile(env, fname, string(file_size, 'x')));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+
+  tstring result;
+  for (auto s : state) {
+    std::unique_ptr<InputStreamInterface> in;
+    if (num_buffers == 0) {
+      in.reset(new BufferedInputStream(file.get(), kBufferSize));
+    } else {
+      in.reset(
+          new ReadAheadInputStream(env, file.get(), kBufferSize, num_buffers));
+    }
+    for (int64 i = 0; i < file_size; i += 4096) {
+      TF_CHECK_OK(in->ReadNBytes(std::min<int64>(4096, file_size - i),
+                                 &result));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) * file_size);
+}
+BENCHMARK(BM_ReadAhead)
+    ->ArgPair(0, 64 << 20)
+    ->ArgPair(1, 64 << 20)
+    ->ArgPair(4, 64 << 20)
+    ->ArgPair(16, 64 << 20);
+
+}  // anonymous namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/read_ahead_inputstream.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -59,7 +60,22 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+#if !defined(IS_SLIM_BUILD)
+  if (options.compression_type == RecordReaderOptions::ZLIB_COMPRESSION &&
+      options.zlib_segment_index != nullptr &&
+      options.zlib_thread_pool != nullptr) {
+    // Segments are read straight from the file, so no buffering is needed.
+    input_stream_.reset(new ParallelZlibInputStream(
+        file, *options.zlib_segment_index, options.zlib_options,
+        options.zlib_thread_pool, 2 * options.zlib_thread_pool->NumThreads()));
+    return;
+  }
+#endif
+  if (options.buffer_size > 0 && options.num_read_ahead_buffers > 0) {
+    input_stream_.reset(
+        new ReadAheadInputStream(Env::Default(), file, options.buffer_size,
+                                 options.num_read_ahead_buffers));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
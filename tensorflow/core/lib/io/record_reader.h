@@ -20,10 +20,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/parallel_zlib_inputstream.h"
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zlib_segment_index.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
@@ -47,6 +49,12 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If non-zero and buffer_size is non-zero, up to this many buffers of
+  // buffer_size bytes are read ahead of the reader on a background thread, so
+  // that decompression and parsing overlap with I/O. The same restrictions on
+  // sequential reads as for buffer_size apply.
+  int64 num_read_ahead_buffers = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -54,6 +62,12 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+
+  // If both are set and ZLIB_COMPRESSION is used, the segments of the file
+  // listed in the index are inflated concurrently on the thread pool, which
+  // must outlive the reader. buffer_size is then ignored.
+  std::shared_ptr<const ZlibSegmentIndex> zlib_segment_index;
+  thread::ThreadPool* zlib_thread_pool = nullptr;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -305,6 +305,50 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadAhead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_read_ahead_test";
+
+  for (auto compression_type : {io::RecordWriterOptions::NONE,
+                                io::RecordWriterOptions::ZLIB_COMPRESSION}) {
+    std::vector<string> records;
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options;
+      options.compression_type = compression_type;
+      io::RecordWriter writer(file.get(), options);
+      for (int i = 0; i < 1000; ++i) {
+        records.push_back(string(i, 'a' + i % 26));
+        TF_EXPECT_OK(writer.WriteRecord(records.back()));
+      }
+      TF_CHECK_OK(writer.Flush());
+    }
+
+    for (auto buf_size : {7, 4096}) {
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options =
+          compression_type == io::RecordWriterOptions::NONE
+              ? io::RecordReaderOptions::CreateRecordReaderOptions("")
+              : io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
+      options.buffer_size = buf_size;
+      options.num_read_ahead_buffers = 4;
+      io::SequentialRecordReader reader(read_file.get(), options);
+      tstring record;
+      int num_skipped;
+      TF_CHECK_OK(reader.SkipRecords(10, &num_skipped));
+      EXPECT_EQ(10, num_skipped);
+      for (size_t i = 10; i < records.size(); ++i) {
+        TF_CHECK_OK(reader.ReadRecord(&record));
+        EXPECT_EQ(records[i], record);
+      }
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
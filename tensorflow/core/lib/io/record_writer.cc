@@ -75,6 +75,10 @@ RecordWriter::RecordWriter(WritableFile* dest,
                  << s.ToString();
     }
     dest_ = zlib_output_buffer;
+    zlib_output_buffer_ = zlib_output_buffer;
+    if (options.zlib_segment_bytes > 0) {
+      zlib_segment_index_.segments.push_back(ZlibSegment());
+    }
   } else if (IsSnappyCompressed(options)) {
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
@@ -112,7 +116,12 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+#if !defined(IS_SLIM_BUILD)
+  return MaybeStartZlibSegment(data.size());
+#else
+  return Status::OK();
+#endif
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,7 +141,12 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+#if !defined(IS_SLIM_BUILD)
+  return MaybeStartZlibSegment(data.size());
+#else
+  return Status::OK();
+#endif
 }
 #endif
 
@@ -140,6 +154,14 @@ Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     Status s = dest_->Close();
+#if !defined(IS_SLIM_BUILD)
+    if (zlib_output_buffer_ != nullptr) {
+      zlib_segment_index_.compressed_size =
+          zlib_output_buffer_->CompressedBytes();
+      zlib_segment_index_.uncompressed_size = uncompressed_bytes_;
+      zlib_output_buffer_ = nullptr;
+    }
+#endif
     delete dest_;
     dest_ = nullptr;
     return s;
@@ -147,6 +169,23 @@ Status RecordWriter::Close() {
   return Status::OK();
 }
 
+#if !defined(IS_SLIM_BUILD)
+Status RecordWriter::MaybeStartZlibSegment(size_t record_size) {
+  uncompressed_bytes_ += kHeaderSize + record_size + kFooterSize;
+  if (zlib_output_buffer_ == nullptr || options_.zlib_segment_bytes <= 0 ||
+      uncompressed_bytes_ - segment_start_ < options_.zlib_segment_bytes) {
+    return Status::OK();
+  }
+  ZlibSegment segment;
+  TF_RETURN_IF_ERROR(
+      zlib_output_buffer_->StartSegment(&segment.compressed_offset));
+  segment.uncompressed_offset = uncompressed_bytes_;
+  zlib_segment_index_.segments.push_back(segment);
+  segment_start_ = uncompressed_bytes_;
+  return Status::OK();
+}
+#endif
+
 Status RecordWriter::Flush() {
   if (dest_ == nullptr) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
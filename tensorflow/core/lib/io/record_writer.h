@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/lib/io/zlib_segment_index.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/macros.h"
@@ -52,6 +53,13 @@ struct RecordWriterOptions {
   // Options specific to compression.
   tensorflow::io::ZlibCompressionOptions zlib_options;
   tensorflow::io::SnappyCompressionOptions snappy_options;
+
+  // If non-zero and ZLIB_COMPRESSION is used, the deflate stream is fully
+  // flushed after the first record that brings the uncompressed size of the
+  // current segment to at least this many bytes. Each segment then holds
+  // whole records and can be inflated independently of the others; see
+  // RecordWriter::zlib_segment_index(). This costs a little compression.
+  int64 zlib_segment_bytes = 0;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -94,6 +102,16 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+#if !defined(IS_SLIM_BUILD)
+  // Returns the segments written so far when
+  // RecordWriterOptions::zlib_segment_bytes is set. The sizes of the index
+  // are only filled in by Close(), after which the index can be written
+  // next to the file with WriteZlibSegmentIndex().
+  const ZlibSegmentIndex& zlib_segment_index() const {
+    return zlib_segment_index_;
+  }
+#endif  // IS_SLIM_BUILD
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -112,6 +130,17 @@ class RecordWriter {
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+#if !defined(IS_SLIM_BUILD)
+  // Starts a new zlib segment if the current one is large enough.
+  Status MaybeStartZlibSegment(size_t record_size);
+
+  ZlibOutputBuffer* zlib_output_buffer_ = nullptr;  // Owned through dest_.
+  ZlibSegmentIndex zlib_segment_index_;
+  // Uncompressed bytes written, and where the current segment starts.
+  int64 uncompressed_bytes_ = 0;
+  int64 segment_start_ = 0;
+#endif  // IS_SLIM_BUILD
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
@@ -134,6 +134,7 @@ Status ZlibOutputBuffer::FlushOutputBufferToFile() {
     Status s = file_->Append(StringPiece(
         reinterpret_cast<char*>(z_stream_output_.get()), bytes_to_write));
     if (s.ok()) {
+      bytes_written_ += bytes_to_write;
       z_stream_->next_out = z_stream_output_.get();
       z_stream_->avail_out = output_buffer_capacity_;
     }
@@ -239,5 +240,19 @@ Status ZlibOutputBuffer::Deflate(int flush) {
 
 Status ZlibOutputBuffer::Tell(int64* position) { return file_->Tell(position); }
 
+Status ZlibOutputBuffer::StartSegment(int64* compressed_offset) {
+  if (!z_stream_) {
+    return errors::FailedPrecondition("ZlibOutputBuffer is closed");
+  }
+  TF_RETURN_IF_ERROR(DeflateBuffered(Z_FULL_FLUSH));
+  *compressed_offset = CompressedBytes();
+  return Status::OK();
+}
+
+int64 ZlibOutputBuffer::CompressedBytes() const {
+  if (!z_stream_) return bytes_written_;
+  return bytes_written_ + (output_buffer_capacity_ - z_stream_->avail_out);
+}
+
 }  // namespace io
 }  // namespace tensorflow
@@ -92,9 +92,21 @@ class ZlibOutputBuffer : public WritableFile {
   // reflect buffered, un-flushed data.
   Status Tell(int64* position) override;
 
+  // Deflates any cached input with Z_FULL_FLUSH, which byte-aligns the output
+  // and resets the compression dictionary. The data appended after this call
+  // can then be inflated as raw deflate data starting at
+  // `*compressed_offset`, without the data before it.
+  Status StartSegment(int64* compressed_offset);
+
+  // Returns the number of compressed bytes produced so far, including those
+  // still buffered in z_stream_output_.
+  int64 CompressedBytes() const;
+
  private:
   WritableFile* file_;  // Not owned
   Status init_status_;
+  // Number of compressed bytes appended to `file_`.
+  int64 bytes_written_ = 0;
   size_t input_buffer_capacity_;
   size_t output_buffer_capacity_;
 
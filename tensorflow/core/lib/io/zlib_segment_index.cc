@@ -0,0 +1,129 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zlib_segment_index.h"
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Format of an index file, with all integers in fixed-width little endian:
+//  uint64    kIndexMagic
+//  uint64    number of segments
+//  uint64    compressed size
+//  uint64    uncompressed size
+//  uint64    compressed offset      }
+//  uint64    uncompressed offset    } once per segment
+//  uint32    masked crc of all of the above
+constexpr uint64 kIndexMagic = 0x7a69646e78000001ull;
+constexpr size_t kFixedSize = 4 * sizeof(uint64) + sizeof(uint32);
+constexpr size_t kSegmentSize = 2 * sizeof(uint64);
+
+}  // namespace
+
+string ZlibSegmentIndexFilename(StringPiece fname) {
+  return strings::StrCat(fname, ".zindex");
+}
+
+void EncodeZlibSegmentIndex(const ZlibSegmentIndex& index, string* out) {
+  out->clear();
+  out->reserve(kFixedSize + index.segments.size() * kSegmentSize);
+  core::PutFixed64(out, kIndexMagic);
+  core::PutFixed64(out, index.segments.size());
+  core::PutFixed64(out, index.compressed_size);
+  core::PutFixed64(out, index.uncompressed_size);
+  for (const ZlibSegment& segment : index.segments) {
+    core::PutFixed64(out, segment.compressed_offset);
+    core::PutFixed64(out, segment.uncompressed_offset);
+  }
+  core::PutFixed32(out, crc32c::Mask(crc32c::Value(out->data(), out->size())));
+}
+
+Status ParseZlibSegmentIndex(StringPiece data, ZlibSegmentIndex* index) {
+  if (data.size() < kFixedSize) {
+    return errors::DataLoss("Truncated zlib segment index");
+  }
+  const char* p = data.data();
+  if (core::DecodeFixed64(p) != kIndexMagic) {
+    return errors::DataLoss("Not a zlib segment index (bad magic number)");
+  }
+  const uint64 num_segments = core::DecodeFixed64(p + 8);
+  if ((data.size() - kFixedSize) / kSegmentSize != num_segments ||
+      (data.size() - kFixedSize) % kSegmentSize != 0) {
+    return errors::DataLoss("Zlib segment index has ", data.size(),
+                            " bytes for ", num_segments, " segments");
+  }
+  const size_t crc_offset = data.size() - sizeof(uint32);
+  if (crc32c::Unmask(core::DecodeFixed32(p + crc_offset)) !=
+      crc32c::Value(p, crc_offset)) {
+    return errors::DataLoss("Corrupted zlib segment index");
+  }
+
+  index->compressed_size = core::DecodeFixed64(p + 16);
+  index->uncompressed_size = core::DecodeFixed64(p + 24);
+  index->segments.resize(num_segments);
+  p += 32;
+  for (ZlibSegment& segment : index->segments) {
+    segment.compressed_offset = core::DecodeFixed64(p);
+    segment.uncompressed_offset = core::DecodeFixed64(p + 8);
+    p += kSegmentSize;
+  }
+
+  // Offsets must start at zero and increase within the file sizes.
+  int64 compressed_offset = -1;
+  int64 uncompressed_offset = -1;
+  for (const ZlibSegment& segment : index->segments) {
+    if (segment.compressed_offset <= compressed_offset ||
+        segment.uncompressed_offset < uncompressed_offset ||
+        segment.compressed_offset > index->compressed_size ||
+        segment.uncompressed_offset > index->uncompressed_size) {
+      return errors::DataLoss("Zlib segment index has invalid offsets");
+    }
+    compressed_offset = segment.compressed_offset;
+    uncompressed_offset = segment.uncompressed_offset;
+  }
+  if (index->segments.empty() || index->segments[0].compressed_offset != 0 ||
+      index->segments[0].uncompressed_offset != 0) {
+    return errors::DataLoss("Zlib segment index does not start at offset 0");
+  }
+  return Status::OK();
+}
+
+Status WriteZlibSegmentIndex(Env* env, const string& fname,
+                             const ZlibSegmentIndex& index) {
+  string data;
+  EncodeZlibSegmentIndex(index, &data);
+  return WriteStringToFile(env, fname, data);
+}
+
+Status ReadZlibSegmentIndex(Env* env, const string& fname,
+                            ZlibSegmentIndex* index) {
+  string data;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, fname, &data));
+  Status s = ParseZlibSegmentIndex(data, index);
+  if (!s.ok()) {
+    return errors::DataLoss("Failed to parse ", fname, ": ",
+                            s.error_message());
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,69 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZLIB_SEGMENT_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_ZLIB_SEGMENT_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// A point of a ZLIB or GZIP compressed file at which the deflate stream was
+// fully flushed (see ZlibOutputBuffer::StartSegment()). The compressed data
+// from `compressed_offset` on can be inflated as raw deflate data, without
+// any of the data before it.
+struct ZlibSegment {
+  int64 compressed_offset = 0;
+  int64 uncompressed_offset = 0;
+};
+
+// Splits a compressed file into segments that can be inflated independently,
+// and so in parallel. The first segment starts at offset 0 of both the
+// compressed and the uncompressed data, and includes the zlib or gzip header.
+//
+// The index of a file `fname` is stored next to it, in the file returned by
+// ZlibSegmentIndexFilename(fname).
+struct ZlibSegmentIndex {
+  // Sorted by offset.
+  std::vector<ZlibSegment> segments;
+  int64 compressed_size = 0;
+  int64 uncompressed_size = 0;
+};
+
+// Returns the name of the file holding the segment index of `fname`.
+string ZlibSegmentIndexFilename(StringPiece fname);
+
+// Serializes `index` into `*out`, and parses it back. The encoding carries a
+// checksum, and ParseZlibSegmentIndex returns DATA_LOSS for corrupted data.
+void EncodeZlibSegmentIndex(const ZlibSegmentIndex& index, string* out);
+Status ParseZlibSegmentIndex(StringPiece data, ZlibSegmentIndex* index);
+
+// Writes `index` to, or reads it from, the file `fname`.
+Status WriteZlibSegmentIndex(Env* env, const string& fname,
+                             const ZlibSegmentIndex& index);
+Status ReadZlibSegmentIndex(Env* env, const string& fname,
+                            ZlibSegmentIndex* index);
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZLIB_SEGMENT_INDEX_H_
@@ -460,6 +460,8 @@ REGISTER_OP("ShuffleDataset")
     .Attr("reshuffle_each_iteration: bool = true")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("spill_dir: string = ''")
+    .Attr("spill_memory_limit_bytes: int = 1073741824")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // buffer_size, seed, and seed2 should be scalars.
@@ -476,6 +478,8 @@ REGISTER_OP("ShuffleDatasetV2")
     .Output("handle: variant")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("spill_dir: string = ''")
+    .Attr("spill_memory_limit_bytes: int = 1073741824")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // buffer_size and seed_generator should be scalars.
@@ -494,6 +498,8 @@ REGISTER_OP("ShuffleDatasetV3")
     .Attr("reshuffle_each_iteration: bool = true")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("spill_dir: string = ''")
+    .Attr("spill_memory_limit_bytes: int = 1073741824")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // buffer_size, seed, seed2, and seed_generator should be scalars.
@@ -514,6 +520,8 @@ REGISTER_OP("ShuffleAndRepeatDataset")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("reshuffle_each_iteration: bool = true")
+    .Attr("spill_dir: string = ''")
+    .Attr("spill_memory_limit_bytes: int = 1073741824")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // buffer_size, seed, seed2, and count should be scalars.
@@ -535,6 +543,8 @@ REGISTER_OP("ShuffleAndRepeatDatasetV2")
     .Attr("reshuffle_each_iteration: bool = true")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("spill_dir: string = ''")
+    .Attr("spill_memory_limit_bytes: int = 1073741824")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // buffer_size, seed, seed2, count, and seed_generator should be scalars.
@@ -573,6 +583,8 @@ REGISTER_OP("CacheDataset")
     .Output("handle: variant")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("memory_budget_bytes: int = 0")
+    .Attr("spill_dir: string = ''")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // filename should be a scalar.
@@ -587,6 +599,8 @@ REGISTER_OP("CacheDatasetV2")
     .Output("handle: variant")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("memory_budget_bytes: int = 0")
+    .Attr("spill_dir: string = ''")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // filename should be a scalar.
@@ -664,6 +678,11 @@ REGISTER_OP("TFRecordDataset")
     .Input("compression_type: string")
     .Input("buffer_size: int64")
     .Output("handle: variant")
+    .Attr("num_read_ahead_buffers: int = 0")
+    .Attr("num_inflate_threads: int = 0")
+    .Attr("file_handle_pool_threads: int = 0")
+    .Attr("file_handle_pool_capacity: int = 64")
+    .Attr("file_handle_pool_head_bytes: int = 262144")
     .SetDoNotOptimize()  // TODO(b/123753214): Source dataset ops must
                          // disable constant folding.
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -897,6 +916,7 @@ REGISTER_OP("ModelDataset")
     .Attr("ram_budget: int = 0")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("buffer_ram_budget: int = 0")
     .SetShapeFn(shape_inference::ScalarShape);
 
 // TODO(b/124308749): Add a stateful version of MapDefun and use it when `f`
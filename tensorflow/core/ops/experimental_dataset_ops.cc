@@ -299,6 +299,7 @@ REGISTER_OP("DatasetToTFRecord")
     .Input("input_dataset: variant")
     .Input("filename: string")
     .Input("compression_type: string")
+    .Attr("zlib_segment_bytes: int = 0")
     .SetIsStateful()
     .SetShapeFn(shape_inference::NoOutputs);
 
@@ -950,6 +951,8 @@ REGISTER_OP("SnapshotDataset")
     .Attr("seed2: int = 0")
     .Attr("mode: string = 'auto'")
     .Attr("snapshot_name: string = ''")
+    .Attr("compression_threads: int = 0")
+    .Attr("decompression_threads: int = 0")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // snapshot_path should be a scalar.
@@ -974,6 +977,8 @@ REGISTER_OP("SnapshotDatasetV2")
     .Attr("shard_func: func")
     .Attr("Treader_func_args: list(type) >= 0")
     .Attr("Tshard_func_args: list(type) >= 0")
+    .Attr("compression_threads: int = 0")
+    .Attr("decompression_threads: int = 0")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // `path` should be a scalar.
@@ -1184,6 +1189,8 @@ REGISTER_OP("DataServiceDataset")
     .Attr("task_refresh_interval_hint_ms: int = -1")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("elements_per_request: int = 16")
+    .Attr("local_reads: bool = false")
     .SetIsStateful()
     .SetShapeFn(shape_inference::ScalarShape);
 
@@ -45,19 +45,33 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  // If not empty, the NUMA node of each thread, overriding
+  // `thread_options_.numa_node`.
+  const std::vector<int> thread_numa_nodes_;
+  // Threads are created in the order of their ids by the pool's constructor.
+  size_t num_created_threads_ = 0;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name,
+                   std::vector<int> thread_numa_nodes = {})
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        thread_numa_nodes_(std::move(thread_numa_nodes)) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
+    int numa_node = thread_options_.numa_node;
+    if (num_created_threads_ < thread_numa_nodes_.size()) {
+      numa_node = thread_numa_nodes_[num_created_threads_];
+    }
+    ++num_created_threads_;
     return env_->StartThread(thread_options_, name_, [=]() {
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
       // Set the processor rounding mode to ROUND TO NEAREST.
       port::ScopedSetRound round(FE_TONEAREST);
-      if (thread_options_.numa_node != port::kNUMANoAffinity) {
-        port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
+      if (numa_node != port::kNUMANoAffinity) {
+        port::NUMASetThreadNodeAffinity(numa_node);
       }
       f();
     });
@@ -86,6 +100,28 @@ struct EigenEnvironment {
   }
 };
 
+namespace {
+
+// Splits `num_threads` threads into one contiguous group per NUMA node, if the
+// platform has more than one node. Returns the [start, limit) range of thread
+// ids of each group in `groups`, and the node of each thread in
+// `thread_numa_nodes`.
+void ComputeNUMAWorkerGroups(int num_threads,
+                             std::vector<std::pair<int, int>>* groups,
+                             std::vector<int>* thread_numa_nodes) {
+  if (!port::NUMAEnabled()) return;
+  const int num_nodes = std::min(port::NUMANumNodes(), num_threads);
+  if (num_nodes <= 1) return;
+  for (int node = 0; node < num_nodes; ++node) {
+    const int start = node * num_threads / num_nodes;
+    const int limit = (node + 1) * num_threads / num_nodes;
+    groups->emplace_back(start, limit);
+    thread_numa_nodes->insert(thread_numa_nodes->end(), limit - start, node);
+  }
+}
+
+}  // namespace
+
 ThreadPool::ThreadPool(Env* env, const string& name, int num_threads)
     : ThreadPool(env, ThreadOptions(), name, num_threads, true, nullptr) {}
 
@@ -95,11 +131,36 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
 
 ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                        const string& name, int num_threads,
-                       bool low_latency_hint, Eigen::Allocator* allocator) {
+                       bool low_latency_hint, Eigen::Allocator* allocator)
+    : ThreadPool(env, thread_options, name, num_threads, low_latency_hint,
+                 /*numa_worker_groups=*/false, allocator) {}
+
+ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
+                       const string& name, int num_threads,
+                       bool low_latency_hint, bool numa_worker_groups,
+                       Eigen::Allocator* allocator) {
   CHECK_GE(num_threads, 1);
+  std::vector<int> thread_numa_nodes;
+  if (numa_worker_groups) {
+    ComputeNUMAWorkerGroups(num_threads, &numa_worker_groups_,
+                            &thread_numa_nodes);
+    VLOG(1) << "Thread pool " << name << " uses "
+            << numa_worker_groups_.size() << " NUMA worker groups.";
+  }
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name,
+                       std::move(thread_numa_nodes))));
+  if (!numa_worker_groups_.empty()) {
+    // Idle threads steal from their own group before other groups.
+    std::vector<std::pair<unsigned, unsigned>> partitions(num_threads);
+    for (const auto& group : numa_worker_groups_) {
+      for (int i = group.first; i < group.second; ++i) {
+        partitions[i] = {group.first, group.second};
+      }
+    }
+    eigen_threadpool_->SetStealPartitions(partitions);
+  }
   underlying_threadpool_ = eigen_threadpool_.get();
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
@@ -115,6 +176,20 @@ ThreadPool::~ThreadPool() {}
 
 void ThreadPool::Schedule(std::function<void()> fn) {
   CHECK(fn != nullptr);
+  if (!numa_worker_groups_.empty()) {
+    // Closures scheduled from threads bound to a node run in that node's group,
+    // close to the memory they are likely to touch. Threads of the pool push
+    // onto their own queue regardless of the hint. The affinity is looked up
+    // on every call because the calling thread may be rebound at any time.
+    const int numa_node = port::NUMAGetThreadNodeAffinity();
+    if (numa_node >= 0 &&
+        static_cast<size_t>(numa_node) < numa_worker_groups_.size()) {
+      const auto& group = numa_worker_groups_[numa_node];
+      underlying_threadpool_->ScheduleWithHint(std::move(fn), group.first,
+                                               group.second);
+      return;
+    }
+  }
   underlying_threadpool_->Schedule(std::move(fn));
 }
 
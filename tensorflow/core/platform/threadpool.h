@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "tensorflow/core/platform/env.h"
@@ -112,6 +114,18 @@ class ThreadPool {
              const std::string& name, int num_threads, bool low_latency_hint,
              Eigen::Allocator* allocator = nullptr);
 
+  // Like the constructor above. If "numa_worker_groups" is true and the
+  // platform has more than one NUMA node, the threads are split into one
+  // worker group per node: each thread is bound to its group's node, steals
+  // work from its own group before other groups, and closures scheduled from
+  // a thread bound to a node go to that node's group. Otherwise the pool
+  // behaves as if "numa_worker_groups" were false.
+  //
+  // REQUIRES: num_threads > 0
+  ThreadPool(Env* env, const ThreadOptions& thread_options,
+             const std::string& name, int num_threads, bool low_latency_hint,
+             bool numa_worker_groups, Eigen::Allocator* allocator);
+
   // Constructs a pool for low-latency ops that contains "num_threads" threads
   // with specified "name". env->StartThread() is used to create individual
   // threads.
@@ -234,6 +248,9 @@ class ThreadPool {
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> threadpool_device_;
+  // The [start, limit) range of thread ids of the worker group of each NUMA
+  // node. Empty unless the pool was created with NUMA worker groups.
+  std::vector<std::pair<int, int>> numa_worker_groups_;
   TF_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_tf_data_stats.h"
 
+#include <algorithm>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
@@ -183,6 +185,12 @@ void ProcessIteratorEvent(const EventNode& iterator_event,
   iterator_stat.set_self_time_ps(iterator_stat.self_time_ps() + self_time_ps);
   iterator_stat.set_is_blocking(iterator_stat.is_blocking() || is_blocking);
   iterator_stat.set_num_calls(iterator_stat.num_calls() + 1);
+  auto buffered_bytes_stat = visitor.GetStat(StatType::kBufferedBytes);
+  if (buffered_bytes_stat.has_value()) {
+    iterator_stat.set_max_buffered_bytes(
+        std::max<int64>(iterator_stat.max_buffered_bytes(),
+                        buffered_bytes_stat->IntValue()));
+  }
 }
 
 void SetBottleneckIteratorId(InputPipelineStat* input_pipeline_stat) {
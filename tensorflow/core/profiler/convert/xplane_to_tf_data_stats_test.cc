@@ -411,6 +411,55 @@ TEST(XPlaneToTfDataStatsTest, MapAndBatch) {
       )pb"));
 }
 
+// Test with the following example dataset:
+// dataset = tf.data.Dataset.range(8)
+// dataset = dataset.prefetch(2)
+// dataset = dataset.batch(2)
+// for _ in dataset:
+//   pass
+TEST(XPlaneToTfDataStatsTest, BufferedBytes) {
+  constexpr int64 kBatchIteratorId = 123;
+  constexpr int64 kPrefetchIteratorId = 456;
+  constexpr int64 kFirstBufferedBytes = 500;
+  constexpr int64 kSecondBufferedBytes = 300;
+
+  XPlane host_plane;
+  XPlaneBuilder host_plane_builder(&host_plane);
+  host_plane_builder.ReserveLines(1);
+
+  XLineBuilder consumer_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &consumer_thread, "Iterator::Batch", 0,
+               100000000, {{StatType::kStepId, kBatchIteratorId}});
+  CreateXEvent(&host_plane_builder, &consumer_thread,
+               "Iterator::Batch::Prefetch", 10000000, 10000000,
+               {{StatType::kStepId, kPrefetchIteratorId},
+                {StatType::kParentId, kBatchIteratorId},
+                {StatType::kBufferedBytes, kFirstBufferedBytes}});
+  CreateXEvent(&host_plane_builder, &consumer_thread,
+               "Iterator::Batch::Prefetch", 50000000, 10000000,
+               {{StatType::kStepId, kPrefetchIteratorId},
+                {StatType::kParentId, kBatchIteratorId},
+                {StatType::kBufferedBytes, kSecondBufferedBytes}});
+
+  CombinedTfDataStats combined_tf_data_stats;
+  CombinedTfDataStatsBuilder builder(&combined_tf_data_stats);
+  builder.Add("host1", &host_plane);
+  builder.Finalize();
+  const InputPipelineStats& input_pipeline_stats =
+      combined_tf_data_stats.tf_data_stats()
+          .at("host1")
+          .input_pipelines()
+          .at(kBatchIteratorId);
+  ASSERT_EQ(input_pipeline_stats.stats_size(), 1);
+  const InputPipelineStat& stat = input_pipeline_stats.stats(0);
+  EXPECT_EQ(stat.iterator_stats().at(kBatchIteratorId).max_buffered_bytes(),
+            0);
+  const IteratorStat& prefetch_stat =
+      stat.iterator_stats().at(kPrefetchIteratorId);
+  EXPECT_EQ(prefetch_stat.num_calls(), 2);
+  EXPECT_EQ(prefetch_stat.max_buffered_bytes(), kFirstBufferedBytes);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -161,6 +161,7 @@ const StatTypeMap& GetStatTypeMap() {
       {"kpi_value", kKpiValue},
       {"element_id", kElementId},
       {"parent_id", kParentId},
+      {"buffered_bytes", kBufferedBytes},
       // XPlane semantics related.
       {"_pt", kProducerType},
       {"_ct", kConsumerType},
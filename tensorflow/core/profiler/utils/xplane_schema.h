@@ -150,6 +150,7 @@ enum StatType {
   kKpiValue,
   kElementId,
   kParentId,
+  kBufferedBytes,
   // XPlane semantics related.
   kProducerType,
   kConsumerType,
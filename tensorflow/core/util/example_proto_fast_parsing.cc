@@ -113,6 +113,64 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Decodes the packed varints in [begin, end) and appends them to `result`.
+//
+// The values are counted first so that `result` is resized once, and runs of
+// eight single-byte varints (the common case for ids and small counts) are
+// then decoded a word at a time. Both loops are simple enough for the compiler
+// to vectorize.
+// REQUIRES: begin < end.
+template <typename Result>
+bool ParsePackedVarints(const uint8* begin, const uint8* end, Result* result) {
+  DCHECK_LT(begin, end);
+  // The last byte of a well-formed packed field terminates a varint.
+  if (end[-1] & 0x80) return false;
+  size_t num_values = 0;
+  for (const uint8* pos = begin; pos < end; ++pos) {
+    num_values += (*pos & 0x80) == 0;
+  }
+
+  // Store the initial size to know the offset we have to start writing data
+  // from before resizing the output "vector". In case of a LimitedArraySlice
+  // the size after resizing can be less than requested, in which case the
+  // values that do not fit are dropped.
+  const size_t initial_size = result->size();
+  result->resize(initial_size + num_values);
+  const size_t size = result->size();
+  auto* data = result->data();
+
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  size_t index = initial_size;
+  const uint8* pos = begin;
+  while (pos < end) {
+    if (end - pos >= 8 && index + 8 <= size) {
+      uint64 word;
+      memcpy(&word, pos, sizeof(word));
+      if ((word & kContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          data[index + i] = static_cast<int64>(pos[i]);
+        }
+        pos += 8;
+        index += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    for (int shift = 0;; shift += 7) {
+      // A varint is at most 10 bytes long.
+      if (shift >= 70) return false;
+      const uint8 byte = *pos++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    if (index < size) {
+      data[index] = static_cast<int64>(value);
+    }
+    ++index;
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -299,15 +357,22 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        if (packed_length > 0) {
+          // The stream reads from a flat array, so the packed values can be
+          // decoded in place.
+          const void* packed_data;
+          int buffer_size;
+          if (!stream.GetDirectBufferPointer(&packed_data, &buffer_size) ||
+              static_cast<uint32>(buffer_size) < packed_length) {
+            return false;
+          }
+          const uint8* packed_begin = static_cast<const uint8*>(packed_data);
+          if (!ParsePackedVarints(packed_begin, packed_begin + packed_length,
+                                  int64_list)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
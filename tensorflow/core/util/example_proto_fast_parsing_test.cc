@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
@@ -170,6 +171,34 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64Values) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["int64_list"]
+          .mutable_int64_list();
+  // Runs of single-byte values mixed with multi-byte and negative values.
+  for (int i = 0; i < 20; ++i) {
+    int64_list->add_value(i);
+  }
+  int64_list->add_value(-1);
+  int64_list->add_value(270);
+  for (int i = 0; i < 7; ++i) {
+    int64_list->add_value(127 - i);
+  }
+  int64_list->add_value(std::numeric_limits<int64>::max());
+  int64_list->add_value(std::numeric_limits<int64>::min());
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64) {
+  // The packed int64 list ends in the middle of a varint.
+  Example example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01"
+      "\x8d",
+      &example));
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
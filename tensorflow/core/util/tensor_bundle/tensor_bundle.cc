@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -41,7 +42,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -57,6 +60,10 @@ const int kTensorBundleVersion = 1;
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
 
+// Size of the chunks large tensors are split into when they are read or
+// written with a thread pool.  Only tensors of at least two chunks are split.
+static const size_t kParallelChunkSize = 4 << 20;
+
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
 // bundle.
@@ -64,6 +71,30 @@ const char* const kHeaderEntryKey = "";
 
 namespace {
 
+// A TensorBuffer aliasing part of a memory-mapped data file.  It does not own
+// its memory, which keeps read-only pages from being forwarded to kernels that
+// write in place.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const void* data, size_t size)
+      : TensorBuffer(const_cast<void*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("tensor_bundle_mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -235,6 +266,102 @@ Status WriteTensor(const Tensor& val, FileOutputBuffer* out,
   return out->Append(StringPiece(buf, *bytes_written));
 }
 
+// Like WriteTensor(), but copies and checksums chunks of "val" on "pool" while
+// earlier chunks are appended to "out".  At most two chunks per thread are
+// held in memory at once.
+// REQUIRES: DataTypeCanUseMemcpy(val.dtype())
+Status WriteTensorInParallel(const Tensor& val, FileOutputBuffer* out,
+                             thread::ThreadPool* pool, size_t* bytes_written) {
+  struct Chunk {
+    std::unique_ptr<char[]> copy;
+    size_t size;
+    uint32 crc32c;
+    Notification done;
+  };
+  const char* buf = GetBackingBuffer(val);
+  const size_t total_bytes = val.TotalBytes();
+  const size_t num_chunks =
+      (total_bytes + kParallelChunkSize - 1) / kParallelChunkSize;
+  const size_t max_in_flight = 2 * pool->NumThreads();
+  std::vector<Chunk> chunks(num_chunks);
+  size_t num_scheduled = 0;
+  auto schedule_next = [&]() {
+    Chunk* chunk = &chunks[num_scheduled];
+    const char* src = buf + num_scheduled * kParallelChunkSize;
+    chunk->size = std::min(kParallelChunkSize,
+                           total_bytes - num_scheduled * kParallelChunkSize);
+    ++num_scheduled;
+    pool->Schedule([chunk, src]() {
+      // As in FileOutputBuffer::Append(), checksums the copy rather than the
+      // source, which may be concurrently written.
+      chunk->copy.reset(new char[chunk->size]);
+      memcpy(chunk->copy.get(), src, chunk->size);
+      chunk->crc32c = crc32c::Value(chunk->copy.get(), chunk->size);
+      chunk->done.Notify();
+    });
+  };
+  while (num_scheduled < std::min(num_chunks, max_in_flight)) {
+    schedule_next();
+  }
+
+  VLOG(1) << "Appending " << total_bytes << " bytes to file in " << num_chunks
+          << " chunks";
+  Status status;
+  // On error, stops scheduling but still waits for chunks in flight.
+  for (size_t i = 0; i < num_scheduled; ++i) {
+    Chunk* chunk = &chunks[i];
+    chunk->done.WaitForNotification();
+    if (status.ok()) {
+      status = out->AppendChecksummed(
+          StringPiece(chunk->copy.get(), chunk->size), chunk->crc32c);
+    }
+    chunk->copy.reset();
+    if (status.ok() && num_scheduled < num_chunks) {
+      schedule_next();
+    }
+  }
+  *bytes_written = total_bytes;
+  return status;
+}
+
+// Reads file[offset, offset+size) into "dst" in chunks on "pool", and stores
+// the checksum of the read bytes into "actual_crc32c".
+Status ReadInParallel(RandomAccessFile* file, uint64 offset, size_t size,
+                      char* dst, thread::ThreadPool* pool,
+                      uint32* actual_crc32c) {
+  const size_t num_chunks =
+      (size + kParallelChunkSize - 1) / kParallelChunkSize;
+  std::vector<Status> statuses(num_chunks);
+  std::vector<uint32> crcs(num_chunks);
+  BlockingCounter counter(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    pool->Schedule([&, i]() {
+      const size_t start = i * kParallelChunkSize;
+      const size_t n = std::min(kParallelChunkSize, size - start);
+      StringPiece sp;
+      statuses[i] = file->Read(offset + start, n, &sp, dst + start);
+      if (statuses[i].ok()) {
+        if (sp.data() != dst + start) {
+          memmove(dst + start, sp.data(), n);
+        }
+        crcs[i] = crc32c::Value(dst + start, n);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  uint32 crc = 0;
+  for (size_t i = 0; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    const size_t n =
+        std::min(kParallelChunkSize, size - i * kParallelChunkSize);
+    crc = crc32c::Combine(crc, crcs[i], n);
+  }
+  *actual_crc32c = crc;
+  return Status::OK();
+}
+
 // Serializes string tensor "val".  "bytes_written" is treated in the same
 // fashion as WriteTensor().
 //
@@ -459,6 +586,11 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
     status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
   } else if (val.dtype() == DT_VARIANT) {
     status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
+  } else if (options_.thread_pool != nullptr &&
+             val.TotalBytes() >= 2 * kParallelChunkSize) {
+    status_ = WriteTensorInParallel(val, out_.get(), options_.thread_pool,
+                                    &data_bytes_written);
+    crc32c = out_->crc32c();
   } else {
     status_ = WriteTensor(val, out_.get(), &data_bytes_written);
     crc32c = out_->crc32c();
@@ -741,8 +873,9 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+BundleReader::BundleReader(Env* env, StringPiece prefix, const Options& options)
     : env_(env),
+      options_(options),
       prefix_(prefix),
       metadata_(nullptr),
       table_(nullptr),
@@ -887,20 +1020,26 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
-    if (entry.size() > kBufferSize) {
+    // Note that we compute the checksum *before* byte-swapping. The checksum
+    // should be on the bytes in the order they appear in the file.
+    if (options_.thread_pool != nullptr &&
+        entry.size() >= 2 * kParallelChunkSize) {
+      TF_RETURN_IF_ERROR(ReadInParallel(buffered_file->file(), entry.offset(),
+                                        entry.size(), backing_buffer,
+                                        options_.thread_pool, &actual_crc32c));
+    } else if (entry.size() > kBufferSize) {
       StringPiece sp;
       TF_RETURN_IF_ERROR(buffered_file->file()->Read(
           entry.offset(), entry.size(), &sp, backing_buffer));
       if (sp.data() != backing_buffer) {
         memmove(backing_buffer, sp.data(), entry.size());
       }
+      actual_crc32c = crc32c::Value(backing_buffer, entry.size());
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
                                                    &unused_bytes_read));
+      actual_crc32c = crc32c::Value(backing_buffer, entry.size());
     }
-    // Note that we compute the checksum *before* byte-swapping. The checksum
-    // should be on the bytes in the order they appear in the file.
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
     if (need_to_swap_bytes_) {
       TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
     }
@@ -950,6 +1089,79 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::GetMappedDataFile(
+    int32 shard_id, std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  auto it = mapped_data_.find(shard_id);
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, shard_id, num_shards_), &mapped);
+    if (errors::IsUnimplemented(s)) {
+      VLOG(1) << "Not memory-mapping " << prefix_ << ": " << s;
+    } else {
+      TF_RETURN_IF_ERROR(s);
+    }
+    it = mapped_data_.emplace(shard_id, std::move(mapped)).first;
+  }
+  *region = it->second;
+  return Status::OK();
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape stored_shape(entry.shape());
+
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(GetMappedDataFile(entry.shard_id(), &region));
+  }
+  if (region != nullptr) {
+    const size_t expected_size =
+        stored_shape.num_elements() * DataTypeSize(entry.dtype());
+    if (entry.size() != expected_size) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                              "; stored size ", entry.size(),
+                              "; expected size ", expected_size);
+    }
+    if (entry.offset() < 0 ||
+        static_cast<uint64>(entry.offset()) + entry.size() > region->length()) {
+      return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                              entry.shard_id(), ": entry for ", key,
+                              " extends past the end of the data file");
+    }
+    const char* data =
+        static_cast<const char*>(region->data()) + entry.offset();
+    TensorBuffer* buf = new MappedTensorBuffer(region, data, entry.size());
+    Tensor mapped(entry.dtype(), stored_shape, buf);
+    buf->Unref();
+    // Unaligned entries are copied out below, as Eigen requires alignment.
+    if (mapped.IsAligned()) {
+      const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+      if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+        return errors::DataLoss(
+            "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+            entry.size(), " bytes): Checksum does not match: stored ",
+            strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+            " vs. calculated on the mapped bytes ", actual_crc32c);
+      }
+      *val = std::move(mapped);
+      return Status::OK();
+    }
+  }
+
+  *val = Tensor(entry.dtype(), stored_shape);
+  if (entry.slices().empty()) {
+    return GetValue(entry, val);
+  } else {
+    return GetSliceValue(key, entry,
+                         /* a full slice */ TensorSlice(stored_shape.dims()),
+                         val);
+  }
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1170,6 +1382,14 @@ Status FileOutputBuffer::Append(StringPiece data) {
   return Status::OK();
 }
 
+Status FileOutputBuffer::AppendChecksummed(StringPiece data,
+                                           uint32 data_crc32c) {
+  TF_RETURN_IF_ERROR(FlushBuffer());
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  crc32c_ = crc32c::Combine(crc32c_, data_crc32c, data.size());
+  return Status::OK();
+}
+
 Status FileOutputBuffer::Close() {
   TF_RETURN_IF_ERROR(FlushBuffer());
   return file_->Close();
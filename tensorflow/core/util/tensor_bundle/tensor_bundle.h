@@ -62,6 +62,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -69,6 +70,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
@@ -112,6 +114,10 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // If set, the contents of large tensors are copied and checksummed in
+    // chunks on this pool while earlier chunks are being written.  The data
+    // file is identical either way.  Not owned.
+    thread::ThreadPool* thread_pool = nullptr;
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -182,7 +188,14 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // If set, large tensors are read and checksummed in parallel chunks on
+    // this pool.  Not owned.
+    thread::ThreadPool* thread_pool = nullptr;
+  };
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -219,6 +232,22 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like "Lookup()", but replaces "val" with a tensor of the stored dtype and
+  // shape instead of filling a caller-allocated buffer.
+  //
+  // If "key" refers to a full tensor of a memcpy-able dtype that is stored in
+  // this machine's byte order at a suitably aligned offset (see
+  // BundleWriter::Options::data_alignment), and the data file can be
+  // memory-mapped, the returned tensor aliases the mapped file instead of
+  // being copied out of it.  Such tensors are read-only: their buffers report
+  // !OwnsMemory(), so they are never forwarded to kernels that write in place.
+  // They keep the mapping alive after this reader is destroyed.  All other
+  // entries are read as by "Lookup()".
+  //
+  // Validates the stored crc32c checksum against the restored bytes.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -275,6 +304,12 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Memory-maps data file "shard_id" on first use.  Sets "region" to nullptr
+  // if the file system does not support memory-mapping.
+  Status GetMappedDataFile(int32 shard_id,
+                           std::shared_ptr<ReadOnlyMemoryRegion>* region)
+      TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -284,6 +319,7 @@ class BundleReader {
                        Tensor* val) TF_MUST_USE_RESULT;
 
   Env* env_;  // Not owned.
+  const Options options_;
   const string prefix_;
 
   Status status_;
@@ -293,6 +329,9 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // Memory-mapped data files, shared with the tensors that alias them.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -331,6 +370,11 @@ class FileOutputBuffer {
   // Clears the running crc32c checksum.
   void clear_crc32c() { crc32c_ = 0; }
 
+  // Appends "data", whose crc32c the caller computed as "data_crc32c", straight
+  // to the underlying file after the buffered data.  Unlike Append(), neither
+  // copies nor checksums "data".
+  Status AppendChecksummed(StringPiece data, uint32 data_crc32c);
+
   // Appends the buffered data, then closes the underlying file.
   Status Close();
 
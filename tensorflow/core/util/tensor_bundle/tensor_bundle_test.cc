@@ -1109,6 +1109,102 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("aligned_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("aligned_001", Constant_2x3<int64>(1)));
+    TF_EXPECT_OK(writer.Add("strings", Constant_2x3<tstring>("hello")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // Densely packed, so only the first entry is suitably aligned.
+    BundleWriter writer(Env::Default(), Prefix("packed"));
+    TF_EXPECT_OK(writer.Add("packed_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("packed_001", Constant_2x3<int8>(1)));
+    TF_EXPECT_OK(writer.Add("packed_002", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  Tensor mapped_float, mapped_int64;
+  {
+    BundleReader reader(Env::Default(), Prefix("mapped"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupMapped("aligned_000", &mapped_float));
+    TF_ASSERT_OK(reader.LookupMapped("aligned_001", &mapped_int64));
+    // Mapped tensors do not own their memory.
+    EXPECT_FALSE(mapped_float.RefCountIsOne());
+    EXPECT_FALSE(mapped_int64.RefCountIsOne());
+
+    Tensor strings;
+    TF_ASSERT_OK(reader.LookupMapped("strings", &strings));
+    test::ExpectTensorEqual<tstring>(strings, Constant_2x3<tstring>("hello"));
+
+    Tensor missing;
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("missing", &missing)));
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(mapped_float, Constant_2x3<float>(0));
+  test::ExpectTensorEqual<int64>(mapped_int64, Constant_2x3<int64>(1));
+
+  {
+    BundleReader reader(Env::Default(), Prefix("packed"));
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    TF_ASSERT_OK(reader.LookupMapped("packed_000", &val));
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(0));
+    TF_ASSERT_OK(reader.LookupMapped("packed_001", &val));
+    test::ExpectTensorEqual<int8>(val, Constant_2x3<int8>(1));
+    TF_ASSERT_OK(reader.LookupMapped("packed_002", &val));
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(2));
+    // Unaligned entries are copied.
+    EXPECT_TRUE(val.RefCountIsOne());
+  }
+}
+
+TEST(TensorBundleTest, ParallelReadAndWrite) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  // Large enough to be split into chunks, with a partial last chunk.
+  Tensor large(DT_FLOAT, TensorShape({(13 << 20) / 4 + 3}));
+  for (int64 i = 0; i < large.NumElements(); ++i) {
+    large.flat<float>()(i) = i;
+  }
+  const Tensor small = Constant_2x3<float>(1);
+
+  BundleWriter::Options parallel_opts;
+  parallel_opts.thread_pool = &pool;
+  for (const auto& prefix_and_opts :
+       {std::make_pair(Prefix("serial"), BundleWriter::Options()),
+        std::make_pair(Prefix("parallel"), parallel_opts)}) {
+    BundleWriter writer(Env::Default(), prefix_and_opts.first,
+                        prefix_and_opts.second);
+    TF_EXPECT_OK(writer.Add("large_000", large));
+    TF_EXPECT_OK(writer.Add("small", small));
+    TF_EXPECT_OK(writer.Add("large_001", large));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  // The data files are identical.
+  string serial_data, parallel_data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(),
+                                DataFilename(Prefix("serial"), 0, 1),
+                                &serial_data));
+  TF_ASSERT_OK(ReadFileToString(Env::Default(),
+                                DataFilename(Prefix("parallel"), 0, 1),
+                                &parallel_data));
+  EXPECT_EQ(serial_data, parallel_data);
+
+  BundleReader::Options reader_opts;
+  reader_opts.thread_pool = &pool;
+  BundleReader reader(Env::Default(), Prefix("parallel"), reader_opts);
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "large_000", large);
+  Expect<float>(&reader, "small", small);
+  Expect<float>(&reader, "large_001", large);
+}
+
 static void BM_BundleAlignmentByteOff(::testing::benchmark::State& state,
                                       int alignment, int tensor_size) {
   {
@@ -1141,4 +1237,24 @@ BM_BundleAlignment(4096, 512);
 BM_BundleAlignment(4096, 4096);
 BM_BundleAlignment(4096, 1048576);
 
+static void BM_BundleLookupMapped(::testing::benchmark::State& state) {
+  const int tensor_size = state.range(0);
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 4096;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_CHECK_OK(writer.Add("big", Constant(32.1f, TensorShape({tensor_size}))));
+    TF_CHECK_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_CHECK_OK(reader.status());
+  for (auto s : state) {
+    Tensor t;
+    TF_CHECK_OK(reader.LookupMapped("big", &t));
+  }
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          tensor_size * sizeof(float));
+}
+BENCHMARK(BM_BundleLookupMapped)->Arg(512)->Arg(4096)->Arg(1048576);
+
 }  // namespace tensorflow
@@ -65,6 +65,28 @@ class DataServiceOpsTest(data_service_test_base.TestBase,
     results = [elem.numpy() for elem in ds]
     self.assertEqual(list(range(num_elements)), results)
 
+  @combinations.generate(test_base.eager_only_combinations())
+  def testDistributeWithoutCompression(self):
+    cluster = self.create_cluster(num_workers=1)
+    # Components larger than a slice are sent without being copied.
+    ds = dataset_ops.Dataset.range(5)
+    ds = ds.map(lambda x: (array_ops.fill([64, 64], math_ops.cast(x, "float")),
+                           string_ops.as_string(x), x))
+    ds = self.make_distributed_dataset(ds, cluster, compression=None)
+    results = self.getDatasetOutput(ds)
+    self.assertLen(results, 5)
+    for i, (image, name, index) in enumerate(results):
+      self.assertAllEqual(image, [[float(i)] * 64] * 64)
+      self.assertEqual(name, str(i).encode())
+      self.assertEqual(index, i)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testDistributeInvalidCompression(self):
+    cluster = self.create_cluster(num_workers=1)
+    with self.assertRaisesRegex(ValueError, "not a valid compression"):
+      self.make_distributed_dataset(
+          dataset_ops.Dataset.range(10), cluster, compression="ZLIB")
+
   @combinations.generate(test_base.eager_only_combinations())
   def testDistributeSparse(self):
     cluster = self.create_cluster(num_workers=1)
@@ -191,6 +213,42 @@ class DataServiceOpsTest(data_service_test_base.TestBase,
     self.assertCountEqual(num_workers * list(range(num_elements)),
                           self.getDatasetOutput(ds))
 
+  @combinations.generate(
+      combinations.times(test_base.eager_only_combinations(),
+                         combinations.combine(elements_per_request=[1, 4, 64])))
+  def testElementsPerRequest(self, elements_per_request):
+    num_workers = 2
+    cluster = self.create_cluster(num_workers=num_workers)
+    num_elements = 10
+    ds = self.make_distributed_range_dataset(
+        num_elements, cluster, elements_per_request=elements_per_request)
+    self.assertCountEqual(num_workers * list(range(num_elements)),
+                          self.getDatasetOutput(ds))
+
+  @combinations.generate(
+      combinations.times(test_base.eager_only_combinations(),
+                         combinations.combine(local_reads=[True, False])))
+  def testLocalReads(self, local_reads):
+    # The test cluster runs its workers in this process.
+    cluster = self.create_cluster(num_workers=1)
+    ds = dataset_ops.Dataset.range(5)
+    ds = ds.map(lambda x: array_ops.fill([64, 64], math_ops.cast(x, "float")))
+    ds = self.make_distributed_dataset(
+        ds, cluster, compression=None, local_reads=local_reads)
+    results = self.getDatasetOutput(ds)
+    self.assertLen(results, 5)
+    for i, image in enumerate(results):
+      self.assertAllEqual(image, [[float(i)] * 64] * 64)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testInvalidElementsPerRequest(self):
+    cluster = self.create_cluster(num_workers=1)
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                "elements_per_request must be positive"):
+      ds = self.make_distributed_range_dataset(
+          10, cluster, elements_per_request=0)
+      self.getDatasetOutput(ds)
+
   @combinations.generate(test_base.eager_only_combinations())
   def testInsideFunction(self):
     num_workers = 3
@@ -205,7 +205,10 @@ class TestBase(test_base.DatasetTestBase):
                                cluster,
                                processing_mode="parallel_epochs",
                                job_name=None,
-                               max_outstanding_requests=None):
+                               max_outstanding_requests=None,
+                               compression="AUTO",
+                               elements_per_request=None,
+                               local_reads=False):
     # pylint: disable=protected-access
     return dataset.apply(
         data_service_ops._distribute(
@@ -213,18 +216,23 @@ class TestBase(test_base.DatasetTestBase):
             cluster.target,
             job_name=job_name,
             max_outstanding_requests=max_outstanding_requests,
-            task_refresh_interval_hint_ms=20))
+            task_refresh_interval_hint_ms=20,
+            compression=compression,
+            elements_per_request=elements_per_request,
+            local_reads=local_reads))
 
   def make_distributed_range_dataset(self,
                                      num_elements,
                                      cluster,
                                      processing_mode="parallel_epochs",
                                      job_name=None,
-                                     max_outstanding_requests=None):
+                                     max_outstanding_requests=None,
+                                     elements_per_request=None):
     dataset = dataset_ops.Dataset.range(num_elements)
     return self.make_distributed_dataset(
         dataset,
         cluster,
         processing_mode=processing_mode,
         job_name=job_name,
-        max_outstanding_requests=max_outstanding_requests)
+        max_outstanding_requests=max_outstanding_requests,
+        elements_per_request=elements_per_request)
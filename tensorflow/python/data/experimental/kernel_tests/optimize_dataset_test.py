@@ -576,13 +576,13 @@ class OptimizeDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
       self.assertIn("autotune_buffer_sizes", graph_rewrites.enabled)
       self.assertIn("disable_prefetch_legacy_autotune", graph_rewrites.enabled)
       self.assertEqual(algorithm,
-                       optimization_options._AutotuneAlgorithm.GRADIENT_DESCENT)
+                       optimization_options.AutotuneAlgorithm.GRADIENT_DESCENT)
     else:
       self.assertNotIn("autotune_buffer_sizes", graph_rewrites.enabled)
       self.assertNotIn("disable_prefetch_legacy_autotune",
                        graph_rewrites.enabled)
       self.assertEqual(algorithm,
-                       optimization_options._AutotuneAlgorithm.HILL_CLIMB)
+                       optimization_options.AutotuneAlgorithm.HILL_CLIMB)
 
   @combinations.generate(
       combinations.times(
@@ -606,6 +606,33 @@ class OptimizeDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
       self.assertEqual(cpu_budget, 0)
       self.assertEqual(ram_budget, 0)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(autotune_buffers=[True, False])))
+  def testAutotuneAlgorithmSettings(self, autotune_buffers):
+    options = dataset_ops.Options()
+    options.experimental_optimization.autotune_buffers = autotune_buffers
+    options.experimental_optimization.autotune_algorithm = (
+        optimization_options.AutotuneAlgorithm.BAYESIAN)
+
+    algorithm = options._autotune_settings()[1]
+    self.assertEqual(algorithm,
+                     optimization_options.AutotuneAlgorithm.BAYESIAN)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testBayesianAutotune(self):
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.map(
+        lambda x: x * 2, num_parallel_calls=dataset_ops.AUTOTUNE)
+    dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
+    options = dataset_ops.Options()
+    options.experimental_optimization.autotune_algorithm = (
+        optimization_options.AutotuneAlgorithm.BAYESIAN)
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(
+        dataset, expected_output=[x * 2 for x in range(100)])
+
 
 if __name__ == "__main__":
   test.main()
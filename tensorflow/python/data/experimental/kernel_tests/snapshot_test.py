@@ -153,6 +153,45 @@ class SnapshotDatasetTest(reader_dataset_ops_test_base.TFRecordDatasetTestBase,
         snapshot.snapshot(self._snapshot_dir, compression="SNAPPY"))
     self.assertDatasetProduces(dataset2, expected)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(compression=[
+              snapshot.COMPRESSION_NONE, snapshot.COMPRESSION_GZIP,
+              snapshot.COMPRESSION_SNAPPY
+          ])))
+  def testReadSnapshotDatasetParallelCompression(self, compression):
+    self.createTFRecords()
+    filenames = self._test_filenames
+    expected = [
+        b"Record %d of file %d" % (r, f)  # pylint:disable=g-complex-comprehension
+        for f in range(0, 10)
+        for r in range(0, 100)
+    ]
+
+    dataset = core_readers._TFRecordDataset(filenames)
+    dataset = dataset.apply(
+        snapshot.snapshot(
+            self._snapshot_dir, compression=compression,
+            compression_threads=4))
+    self.assertDatasetProduces(dataset, expected)
+
+    self.removeTFRecords()
+    dataset2 = core_readers._TFRecordDataset(filenames)
+    dataset2 = dataset2.apply(
+        snapshot.snapshot(
+            self._snapshot_dir, compression=compression,
+            decompression_threads=4))
+    self.assertDatasetProduces(dataset2, expected)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testSnapshotDatasetInvalidCompressionThreads(self):
+    dataset = dataset_ops.Dataset.range(10)
+    with self.assertRaises(errors.InvalidArgumentError):
+      dataset = dataset.apply(
+          snapshot.snapshot(self._snapshot_dir, compression_threads=-1))
+      self.evaluate(self.getNext(dataset)())
+
   @combinations.generate(test_base.default_test_combinations())
   def testReadSnapshotDatasetCustomShardFn(self):
     self.createTFRecords()
@@ -847,6 +886,40 @@ class LegacySnapshotDatasetTest(
         snapshot.legacy_snapshot(tmpdir, compression=compression))
     self.assertDatasetProduces(dataset2, expected, assert_items_equal=True)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(compression=[
+              snapshot.COMPRESSION_NONE, snapshot.COMPRESSION_GZIP,
+              snapshot.COMPRESSION_SNAPPY
+          ])))
+  def testReadSnapshotBackAfterParallelCompression(self, compression):
+    self.setUpTFRecord()
+    filenames = self.test_filenames
+
+    expected = [
+        b"Record %d of file %d" % (r, f)  # pylint:disable=g-complex-comprehension
+        for f in range(0, 10)
+        for r in range(0, 10)
+    ]
+
+    tmpdir = self.snapshot_dir
+    dataset = core_readers._TFRecordDataset(filenames)
+    dataset = dataset.apply(
+        snapshot.legacy_snapshot(
+            tmpdir, compression=compression, compression_threads=4))
+    self.assertDatasetProduces(dataset, expected)
+
+    # remove the original files and try to read the data back only from
+    # snapshot
+    self.removeTFRecords()
+
+    dataset2 = core_readers._TFRecordDataset(filenames)
+    dataset2 = dataset2.apply(
+        snapshot.legacy_snapshot(
+            tmpdir, compression=compression, decompression_threads=4))
+    self.assertDatasetProduces(dataset2, expected)
+
   @combinations.generate(test_base.default_test_combinations())
   def testSameFingerprintWithDifferentInitializationOrder(self):
     tmpdir = self.snapshot_dir
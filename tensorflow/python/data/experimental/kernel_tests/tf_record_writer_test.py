@@ -88,6 +88,27 @@ class TFRecordWriterTest(test_base.DatasetTestBase, parameterized.TestCase):
         tf_record.tf_record_iterator(self._outputFilename(), options=options)):
       self.assertAllEqual(self._record(i), r)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(compression_type=["ZLIB", "GZIP"]),
+          combinations.combine(num_inflate_threads=[0, 4])))
+  def testWriteSegmented(self, compression_type, num_inflate_threads):
+    self._num_records = 100
+    input_dataset = readers.TFRecordDataset([self._createFile()])
+    self.evaluate(
+        writers.TFRecordWriter(
+            self._outputFilename(), compression_type,
+            zlib_segment_bytes=64).write(input_dataset))
+    self.assertTrue(os.path.exists(self._outputFilename() + ".zindex"))
+    dataset = readers.TFRecordDataset(
+        self._outputFilename(),
+        compression_type,
+        num_inflate_threads=num_inflate_threads)
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[self._record(i) for i in range(self._num_records)])
+
   @combinations.generate(test_base.default_test_combinations())
   def testFailDataset(self):
     with self.assertRaises(TypeError):
@@ -51,6 +51,22 @@ class ProcessingMode(object):
               mode, valid_modes))
 
 
+# Compression modes for the elements sent by tf.data service workers.
+# "AUTO" snappy-compresses each element. With `None`, the tensor buffers of
+# each element are sent without being compressed or copied into a proto,
+# which is faster when the network is not the bottleneck.
+COMPRESSION_AUTO = "AUTO"
+COMPRESSION_NONE = None
+
+
+def _validate_compression(compression):
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  if compression not in valid_compressions:
+    raise ValueError(
+        "{0} is not a valid compression. Valid compressions: {1}".format(
+            compression, valid_compressions))
+
+
 class _DataServiceDatasetV2(dataset_ops.DatasetSource):
   """A `Dataset` that reads elements from the tf.data service."""
 
@@ -61,7 +77,10 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
                protocol,
                job_name=None,
                max_outstanding_requests=None,
-               task_refresh_interval_hint_ms=None):
+               task_refresh_interval_hint_ms=None,
+               element_spec=None,
+               elements_per_request=None,
+               local_reads=False):
     """Constructs a _DataServiceDatasetV2.
 
     Args:
@@ -83,6 +102,14 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         `element_size` * `max_outstanding_requests` of memory.
       task_refresh_interval_hint_ms: (Optional.) A hint for how often to query
         the dispatcher for task changes.
+      element_spec: (Optional.) The element spec of a dataset registered
+        without compression. Defaults to the spec of compressed elements.
+      elements_per_request: (Optional.) The most elements to fetch from a
+        worker in one request. If `max_outstanding_requests` is autotuned,
+        fewer elements are fetched at a time when they are large, so that each
+        request buffers about 1MB. Defaults to 16.
+      local_reads: (Optional.) Whether to read directly from workers that run
+        in this process instead of through gRPC.
     """
 
     if job_name is None:
@@ -91,6 +118,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
       max_outstanding_requests = dataset_ops.AUTOTUNE
     if task_refresh_interval_hint_ms is None:
       task_refresh_interval_hint_ms = dataset_ops.AUTOTUNE
+    if elements_per_request is None:
+      elements_per_request = 16
 
     self._dataset_id = ops.convert_to_tensor(
         dataset_id, dtype=dtypes.int64, name="dataset_id")
@@ -106,9 +135,11 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         max_outstanding_requests,
         dtype=dtypes.int64,
         name="max_outstanding_requests")
-    # Datasets executed by the tf.data service produce compressed elements
-    # represented by scalar DT_VARIANTs.
-    self._element_spec = tensor_spec.TensorSpec(shape=(), dtype=dtypes.variant)
+    if element_spec is None:
+      # Datasets executed by the tf.data service produce compressed elements
+      # represented by scalar DT_VARIANTs.
+      element_spec = tensor_spec.TensorSpec(shape=(), dtype=dtypes.variant)
+    self._element_spec = element_spec
 
     variant_tensor = gen_experimental_dataset_ops.data_service_dataset(
         dataset_id=self._dataset_id,
@@ -120,6 +151,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
         iteration_counter=gen_experimental_dataset_ops.dummy_iteration_counter(
         ),
+        elements_per_request=elements_per_request,
+        local_reads=local_reads,
         **self._flat_structure)
     super(_DataServiceDatasetV2, self).__init__(variant_tensor)
 
@@ -132,8 +165,17 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
   """A `Dataset` that executes its input through the tf.data service."""
 
   @functools.wraps(_DataServiceDatasetV2.__init__)
-  def __init__(self, dataset_id, processing_mode, address, protocol, job_name,
-               max_outstanding_requests, task_refresh_interval_hint_ms):
+  def __init__(self,
+               dataset_id,
+               processing_mode,
+               address,
+               protocol,
+               job_name,
+               max_outstanding_requests,
+               task_refresh_interval_hint_ms,
+               element_spec=None,
+               elements_per_request=None,
+               local_reads=False):
 
     self._wrapped = _DataServiceDatasetV2(
         dataset_id=dataset_id,
@@ -142,7 +184,10 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
         protocol=protocol,
         job_name=job_name,
         max_outstanding_requests=max_outstanding_requests,
-        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms)
+        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
+        element_spec=element_spec,
+        elements_per_request=elements_per_request,
+        local_reads=local_reads)
     super(_DataServiceDatasetV1, self).__init__(self._wrapped)
 
 
@@ -185,7 +230,10 @@ def _from_dataset_id(processing_mode,
                      element_spec,
                      job_name=None,
                      max_outstanding_requests=None,
-                     task_refresh_interval_hint_ms=None):
+                     task_refresh_interval_hint_ms=None,
+                     compression=COMPRESSION_AUTO,
+                     elements_per_request=None,
+                     local_reads=False):
   """Creates a dataset which reads data from the tf.data service.
 
   This transformation is similar to `from_dataset_id`, but supports additional
@@ -215,11 +263,22 @@ def _from_dataset_id(processing_mode,
       `max_outstanding_requests` of memory.
     task_refresh_interval_hint_ms: (Optional.) A hint for how often to query the
       dispatcher for task changes.
+    compression: (Optional.) How the dataset was compressed when it was
+      registered, either "AUTO" or `None`.
+    elements_per_request: (Optional.) The most elements to fetch from a worker
+      in one request. Larger batches amortize the cost of a round trip over
+      more small elements. If `max_outstanding_requests` is autotuned, fewer
+      elements are fetched at a time when they are large, so that each request
+      buffers about 1MB. Defaults to 16.
+    local_reads: (Optional.) Whether to read directly from tf.data service
+      workers that run in this process, handing tensors over without
+      serializing them, instead of through gRPC.
 
   Returns:
     A `tf.data.Dataset` which reads from the tf.data service.
   """
   ProcessingMode.validate(processing_mode)
+  _validate_compression(compression)
   if job_name is not None:
     if not isinstance(job_name, six.string_types):
       raise ValueError("job_name must be a string, but job_name was of type "
@@ -237,10 +296,14 @@ def _from_dataset_id(processing_mode,
       protocol=protocol,
       job_name=job_name,
       max_outstanding_requests=max_outstanding_requests,
-      task_refresh_interval_hint_ms=task_refresh_interval_hint_ms)
-  dataset = dataset.map(
-      lambda x: compression_ops.uncompress(x, output_spec=element_spec),
-      num_parallel_calls=dataset_ops.AUTOTUNE)
+      task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
+      element_spec=(None if compression == COMPRESSION_AUTO else element_spec),
+      elements_per_request=elements_per_request,
+      local_reads=local_reads)
+  if compression == COMPRESSION_AUTO:
+    dataset = dataset.map(
+        lambda x: compression_ops.uncompress(x, output_spec=element_spec),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
 
   # Disable autosharding for shared jobs.
   if job_name:
@@ -254,7 +317,10 @@ def _distribute(processing_mode,
                 service,
                 job_name=None,
                 max_outstanding_requests=None,
-                task_refresh_interval_hint_ms=None):
+                task_refresh_interval_hint_ms=None,
+                compression=COMPRESSION_AUTO,
+                elements_per_request=None,
+                local_reads=False):
   """A transformation that moves dataset processing to the tf.data service.
 
   This transformation is similar to `distribute`, but supports additional
@@ -278,14 +344,26 @@ def _distribute(processing_mode,
       `max_outstanding_requests` of memory.
     task_refresh_interval_hint_ms: (Optional.) A hint for how often to query the
       dispatcher for task changes.
+    compression: (Optional.) How to compress the dataset's elements, either
+      "AUTO" or `None`. With `None`, the elements' tensor buffers are sent
+      as they are.
+    elements_per_request: (Optional.) The most elements to fetch from a worker
+      in one request. Larger batches amortize the cost of a round trip over
+      more small elements. If `max_outstanding_requests` is autotuned, fewer
+      elements are fetched at a time when they are large, so that each request
+      buffers about 1MB. Defaults to 16.
+    local_reads: (Optional.) Whether to read directly from tf.data service
+      workers that run in this process, handing tensors over without
+      serializing them, instead of through gRPC.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
   """
   ProcessingMode.validate(processing_mode)
+  _validate_compression(compression)
 
   def _apply_fn(dataset):  # pylint: disable=missing-docstring
-    dataset_id = register_dataset(service, dataset)
+    dataset_id = _register_dataset(service, dataset, compression=compression)
     return _from_dataset_id(
         processing_mode,
         service,
@@ -293,7 +371,10 @@ def _distribute(processing_mode,
         dataset.element_spec,
         job_name=job_name,
         max_outstanding_requests=max_outstanding_requests,
-        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms)
+        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
+        compression=compression,
+        elements_per_request=elements_per_request,
+        local_reads=local_reads)
 
   return _apply_fn
 
@@ -483,6 +564,49 @@ def distribute(processing_mode,
       max_outstanding_requests=max_outstanding_requests)
 
 
+def _register_dataset(service, dataset, compression):
+  """Registers a dataset with the tf.data service.
+
+  This is similar to `register_dataset`, but supports additional parameters
+  which we do not yet want to add to the public Python API.
+
+  Args:
+    service: A string indicating how to connect to the tf.data service. The
+      string should be in the format "protocol://address", e.g.
+      "grpc://localhost:5000".
+    dataset: A `tf.data.Dataset` to register with the tf.data service.
+    compression: How to compress the dataset's elements, either "AUTO" or
+      `None`.
+
+  Returns:
+    A scalar int64 tensor of the registered dataset's id.
+  """
+  _validate_compression(compression)
+  protocol, address = _parse_service(service)
+  external_state_policy = dataset.options().experimental_external_state_policy
+  if external_state_policy is None:
+    external_state_policy = ExternalStatePolicy.WARN
+
+  if compression == COMPRESSION_AUTO:
+    # Compress the dataset elements to reduce the amount of data that needs to
+    # be sent over the network.
+    dataset = dataset.map(
+        lambda *x: compression_ops.compress(x),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
+  dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
+  # Apply options so that the dataset executed in the tf.data service will
+  # be optimized and support autotuning.
+  dataset = dataset._apply_options()  # pylint: disable=protected-access
+
+  dataset_id = gen_experimental_dataset_ops.register_dataset(
+      dataset._variant_tensor,  # pylint: disable=protected-access
+      address=address,
+      protocol=protocol,
+      external_state_policy=external_state_policy.value)
+
+  return dataset_id
+
+
 @tf_export("data.experimental.service.register_dataset")
 def register_dataset(service, dataset):
   """Registers a dataset with the tf.data service.
@@ -523,28 +647,7 @@ def register_dataset(service, dataset):
   Returns:
     A scalar int64 tensor of the registered dataset's id.
   """
-  protocol, address = _parse_service(service)
-  external_state_policy = dataset.options().experimental_external_state_policy
-  if external_state_policy is None:
-    external_state_policy = ExternalStatePolicy.WARN
-
-  # Compress the dataset elements to reduce the amount of data that needs to
-  # be sent over the network.
-  dataset = dataset.map(
-      lambda *x: compression_ops.compress(x),
-      num_parallel_calls=dataset_ops.AUTOTUNE)
-  dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
-  # Apply options so that the dataset executed in the tf.data service will
-  # be optimized and support autotuning.
-  dataset = dataset._apply_options()  # pylint: disable=protected-access
-
-  dataset_id = gen_experimental_dataset_ops.register_dataset(
-      dataset._variant_tensor,  # pylint: disable=protected-access
-      address=address,
-      protocol=protocol,
-      external_state_policy=external_state_policy.value)
-
-  return dataset_id
+  return _register_dataset(service, dataset, compression=COMPRESSION_AUTO)
 
 
 @tf_export("data.experimental.service.from_dataset_id")
@@ -26,10 +26,16 @@ from tensorflow.python.util.tf_export import tf_export
 _ENABLE_AUTOTUNE_BUFFERS_BY_DEFAULT = False
 
 
-class _AutotuneAlgorithm(enum.Enum):
-  """Controls what algorithm is used in the autotune implementation."""
+@tf_export("data.experimental.AutotuneAlgorithm")
+class AutotuneAlgorithm(enum.Enum):
+  """Controls what algorithm is used in the autotune implementation.
+
+  See the `tf.data.experimental.OptimizationOptions.autotune_algorithm`
+  documentation for more information.
+  """
   HILL_CLIMB = 0
   GRADIENT_DESCENT = 1
+  BAYESIAN = 2
 
 
 @tf_export("data.experimental.MapVectorizationOptions")
@@ -100,6 +106,28 @@ class OptimizationOptions(options.OptionsBase):
       "Whether to automatically tune performance knobs. If None, defaults to "
       "True.")
 
+  autotune_algorithm = options.create_option(
+      name="autotune_algorithm",
+      ty=AutotuneAlgorithm,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines the "
+      "algorithm used to tune performance knobs. `BAYESIAN` fits a model of "
+      "the measured output time and tries the parameters that it predicts are "
+      "best, which suits pipelines whose analytical model is inaccurate. If "
+      "None, defaults to `GRADIENT_DESCENT` when `autotune_buffers` is "
+      "enabled and to `HILL_CLIMB` otherwise.")
+
+  autotune_buffer_ram_budget = options.create_option(
+      name="autotune_buffer_ram_budget",
+      ty=int,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines the number "
+      "of bytes that the buffers of prefetch, parallel map and parallel "
+      "interleave transformations may hold together. While they hold that "
+      "many, these transformations only refill empty buffers. Other buffers, "
+      "such as those of cache and shuffle transformations, do not count "
+      "towards the budget. If None or 0, buffers are not limited.")
+
   autotune_buffers = options.create_option(
       name="autotune_buffers",
       ty=bool,
@@ -228,14 +256,16 @@ class OptimizationOptions(options.OptionsBase):
     # If autotune_buffers is enabled, we use the GRADIENT_DESCENT algorithm by
     # default, which is more performant for tuning heterogeneous parameters.
     algorithm = (
-        _AutotuneAlgorithm.GRADIENT_DESCENT
-        if self._autotune_buffers() else _AutotuneAlgorithm.HILL_CLIMB)
+        AutotuneAlgorithm.GRADIENT_DESCENT
+        if self._autotune_buffers() else AutotuneAlgorithm.HILL_CLIMB)
     cpu_budget = 0  # Indicates that all CPU cores should be used by default.
     ram_budget = 0  # Indicates that default value of RAM budget should be used.
 
     # Set these options if they are explicitly set by the user.
     if self.autotune is False:  # pylint: disable=g-bool-id-comparison
       autotune = False
+    if self.autotune_algorithm is not None:
+      algorithm = self.autotune_algorithm
     if self.autotune_cpu_budget is not None:
       cpu_budget = self.autotune_cpu_budget
     if self.autotune_ram_budget is not None:
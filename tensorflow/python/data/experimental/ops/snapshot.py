@@ -51,7 +51,9 @@ class _LegacySnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
                shuffle_on_read=None,
                shuffle_seed=None,
                mode=None,
-               snapshot_name=None):
+               snapshot_name=None,
+               compression_threads=None,
+               decompression_threads=None):
 
     self._compression = compression if compression is not None else ""
     self._reader_path_prefix = (
@@ -75,6 +77,10 @@ class _LegacySnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
         shuffle_on_read if shuffle_on_read is not None else False)
     self._mode = (mode if mode is not None else "auto")
     self._snapshot_name = (snapshot_name if snapshot_name is not None else "")
+    self._compression_threads = (
+        compression_threads if compression_threads is not None else 0)
+    self._decompression_threads = (
+        decompression_threads if decompression_threads is not None else 0)
 
     self._seed, self._seed2 = random_seed.get_seed(shuffle_seed)
 
@@ -98,6 +104,8 @@ class _LegacySnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
         seed2=self._seed2,
         mode=self._mode,
         snapshot_name=self._snapshot_name,
+        compression_threads=self._compression_threads,
+        decompression_threads=self._decompression_threads,
         **self._flat_structure)
 
     super(_LegacySnapshotDataset, self).__init__(input_dataset, variant_tensor)
@@ -118,7 +126,9 @@ def legacy_snapshot(path,
                     shuffle_on_read=None,
                     shuffle_seed=None,
                     mode=None,
-                    snapshot_name=None):
+                    snapshot_name=None,
+                    compression_threads=None,
+                    decompression_threads=None):
   """Writes to/reads from a snapshot of a dataset.
 
   This function attempts to determine whether a valid snapshot exists at the
@@ -167,6 +177,13 @@ def legacy_snapshot(path,
     snapshot_name: If set, use the supplied string as a named snapshot name
       instead of introspecting the data pipeline and automatically generating a
       unique identifier for the snapshot.
+    compression_threads: Number of threads used to serialize and compress
+      elements before they are written to a snapshot file. Defaults to 0, which
+      encodes elements on the writer thread. The order of elements within a
+      file is preserved.
+    decompression_threads: Number of threads used to decompress and parse
+      elements read from a snapshot file. Defaults to 0, which decodes elements
+      on the reader thread. The order of elements within a file is preserved.
 
   Returns:
     A `Dataset` transformation function, which can be passed to
@@ -189,7 +206,9 @@ def legacy_snapshot(path,
         shuffle_on_read=shuffle_on_read,
         shuffle_seed=shuffle_seed,
         mode=mode,
-        snapshot_name=snapshot_name)
+        snapshot_name=snapshot_name,
+        compression_threads=compression_threads,
+        decompression_threads=decompression_threads)
 
   return _apply_fn
 
@@ -204,7 +223,9 @@ class _SnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
                compression=None,
                reader_func=None,
                pending_snapshot_expiry_seconds=None,
-               use_legacy_function=False):
+               use_legacy_function=False,
+               compression_threads=None,
+               decompression_threads=None):
 
     if reader_func is None:
       reader_func = lambda datasets: datasets.interleave(  # pylint:disable=g-long-lambda
@@ -244,6 +265,10 @@ class _SnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
         compression=compression,
         reader_func=self._reader_func.function,
         shard_func=self._shard_func.function,
+        compression_threads=(compression_threads
+                             if compression_threads is not None else 0),
+        decompression_threads=(decompression_threads
+                               if decompression_threads is not None else 0),
         **self._flat_structure)
     super(_SnapshotDataset, self).__init__(input_dataset, variant_tensor)
 
@@ -255,7 +280,12 @@ class _SnapshotDataset(dataset_ops.UnaryUnchangedStructureDataset):
 
 
 @tf_export("data.experimental.snapshot")
-def snapshot(path, compression="AUTO", reader_func=None, shard_func=None):
+def snapshot(path,
+             compression="AUTO",
+             reader_func=None,
+             shard_func=None,
+             compression_threads=None,
+             decompression_threads=None):
   """API to persist the output of the input dataset.
 
   The snapshot API allows users to transparently persist the output of their
@@ -326,6 +356,14 @@ def snapshot(path, compression="AUTO", reader_func=None, shard_func=None):
       shards.
     shard_func: Optional. A function to control how to shard data when writing a
       snapshot.
+    compression_threads: Optional. The number of threads each shard writer uses
+      to serialize and compress elements. Defaults to None, which encodes
+      elements on the writer thread. The order of elements within a shard is
+      preserved.
+    decompression_threads: Optional. The number of threads each shard reader
+      uses to decompress and parse elements. Defaults to None, which decodes
+      elements on the reader thread. The order of elements within a shard is
+      preserved.
 
   Returns:
     A `Dataset` transformation function, which can be passed to
@@ -350,6 +388,8 @@ def snapshot(path, compression="AUTO", reader_func=None, shard_func=None):
         path=path,
         compression=compression,
         reader_func=reader_func,
+        compression_threads=compression_threads,
+        decompression_threads=decompression_threads,
         # This will not do the right thing where the graph is built on a
         # different machine than the executor (e.g. Cloud TPUs).
         shard_func=local_shard_func)
@@ -65,7 +65,7 @@ class TFRecordWriter(object):
   ```
   """
 
-  def __init__(self, filename, compression_type=None):
+  def __init__(self, filename, compression_type=None, zlib_segment_bytes=None):
     """Initializes a `TFRecordWriter`.
 
     Args:
@@ -73,6 +73,12 @@ class TFRecordWriter(object):
       compression_type: (Optional.) a string indicating what type of compression
         to use when writing the file. See `tf.io.TFRecordCompressionType` for
         what types of compression are available. Defaults to `None`.
+      zlib_segment_bytes: (Optional.) a Python integer. If positive, `"ZLIB"`
+        and `"GZIP"` files are written in independently inflatable segments of
+        about this many uncompressed bytes, with an index of the segments
+        next to the file, so that `tf.data.TFRecordDataset` can inflate them on
+        several threads. The file remains readable by any TFRecord reader.
+        Defaults to `None`, which writes a single segment and no index.
     """
     self._filename = ops.convert_to_tensor(
         filename, dtypes.string, name="filename")
@@ -81,6 +87,7 @@ class TFRecordWriter(object):
         compression_type,
         argument_default="",
         argument_dtype=dtypes.string)
+    self._zlib_segment_bytes = zlib_segment_bytes or 0
 
   def write(self, dataset):
     """Writes a dataset to a TFRecord file.
@@ -112,4 +119,7 @@ class TFRecordWriter(object):
               dataset_ops.get_legacy_output_shapes(dataset),
               dataset_ops.get_legacy_output_types(dataset)))
     return gen_experimental_dataset_ops.dataset_to_tf_record(
-        dataset._variant_tensor, self._filename, self._compression_type)  # pylint: disable=protected-access
+        dataset._variant_tensor,  # pylint: disable=protected-access
+        self._filename,
+        self._compression_type,
+        zlib_segment_bytes=self._zlib_segment_bytes)
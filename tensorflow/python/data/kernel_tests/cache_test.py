@@ -308,6 +308,30 @@ class MemoryCacheTest(test_base.DatasetTestBase, parameterized.TestCase):
     with self.assertRaises(errors.OutOfRangeError):
       self.evaluate(get_next())
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testCacheMemoryBudget(self):
+    counter = variables.Variable(0)
+    self.evaluate(counter.initializer)
+
+    def increment_fn(x):
+      counter.assign_add(1)
+      return x
+
+    spill_dir = path.join(self.get_temp_dir(), "spill")
+    # Each element takes 8 bytes, so only some of them stay in memory.
+    dataset = dataset_ops.Dataset.range(10).map(increment_fn).cache(
+        memory_budget_bytes=32, spill_dir=spill_dir).repeat(2)
+    get_next = self.getNext(dataset, requires_initialization=True)
+
+    for i in range(10):
+      self.assertEqual(i, self.evaluate(get_next()))
+    # The second epoch reads the cache, including the spilled elements.
+    for i in range(10):
+      self.assertEqual(i, self.evaluate(get_next()))
+      self.assertEqual(10, self.evaluate(counter))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next())
+
   @combinations.generate(combinations.combine(tf_api_version=2, mode="eager"))
   def testCacheIterationEpochs(self):
     counter = variables.Variable(0)
@@ -19,6 +19,7 @@ from __future__ import print_function
 
 import collections
 import functools
+import os
 
 from absl.testing import parameterized
 import numpy as np
@@ -367,6 +368,17 @@ class ShuffleTest(test_base.DatasetTestBase, parameterized.TestCase):
     manager.save()
     ckpt.restore(manager.latest_checkpoint)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testSpillToDisk(self):
+    spill_dir = os.path.join(self.get_temp_dir(), "spill")
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.shuffle(
+        100, seed=42, spill_dir=spill_dir, spill_memory_limit_bytes=1)
+    dataset = dataset.repeat(2)
+    output = self.getDatasetOutput(dataset)
+    self.assertCountEqual(list(range(100)) * 2, output)
+    self.assertNotEqual(list(range(100)) * 2, output)
+
 
 if __name__ == "__main__":
   test.main()
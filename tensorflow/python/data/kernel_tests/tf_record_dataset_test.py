@@ -166,6 +166,36 @@ class TFRecordDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
           [self._record(j, i) for i in range(self._num_records)])
     self.assertDatasetProduces(dataset, expected_output=expected_output)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testReadWithReadAheadBuffers(self):
+    dataset = readers.TFRecordDataset(
+        self.test_filenames, buffer_size=16, num_read_ahead_buffers=4)
+    expected_output = []
+    for j in range(self._num_files):
+      expected_output.extend(
+          [self._record(j, i) for i in range(self._num_records)])
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(num_parallel_reads=[None, 4])))
+  def testReadWithFileHandlePool(self, num_parallel_reads):
+    files = dataset_ops.Dataset.from_tensor_slices(
+        self.test_filenames).repeat(10)
+    expected_output = []
+    for j in range(self._num_files):
+      expected_output.extend(
+          [self._record(j, i) for i in range(self._num_records)])
+    dataset = readers.TFRecordDataset(
+        files,
+        num_parallel_reads=num_parallel_reads,
+        file_handle_pool_threads=2,
+        file_handle_pool_capacity=4,
+        file_handle_pool_head_bytes=16)
+    self.assertDatasetProduces(
+        dataset, expected_output=expected_output * 10, assert_items_equal=True)
+
   @combinations.generate(test_base.default_test_combinations())
   def testReadFromDatasetOfFiles(self):
     files = dataset_ops.Dataset.from_tensor_slices(self.test_filenames)
@@ -376,7 +376,10 @@ class DatasetV2(collections_abc.Iterable, tracking_base.Trackable,
     # (2) Apply autotune options
     autotune, algorithm, cpu_budget, ram_budget = options._autotune_settings()  # pylint: disable=protected-access
     if autotune:
-      dataset = _ModelDataset(dataset, algorithm, cpu_budget, ram_budget)
+      buffer_ram_budget = (
+          options.experimental_optimization.autotune_buffer_ram_budget or 0)
+      dataset = _ModelDataset(dataset, algorithm, cpu_budget, ram_budget,
+                              buffer_ram_budget)
 
     # (3) Apply graph rewrite options
     # pylint: disable=protected-access
@@ -1289,7 +1292,12 @@ class DatasetV2(collections_abc.Iterable, tracking_base.Trackable,
     max_value = np.iinfo(dtypes.int64.as_numpy_dtype).max
     return Dataset.zip((Dataset.range(start, max_value), self))
 
-  def shuffle(self, buffer_size, seed=None, reshuffle_each_iteration=None):
+  def shuffle(self,
+              buffer_size,
+              seed=None,
+              reshuffle_each_iteration=None,
+              spill_dir=None,
+              spill_memory_limit_bytes=None):
     """Randomly shuffles the elements of this dataset.
 
     This dataset fills a buffer with `buffer_size` elements, then randomly
@@ -1343,13 +1351,21 @@ class DatasetV2(collections_abc.Iterable, tracking_base.Trackable,
       reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
         that the dataset should be pseudorandomly reshuffled each time it is
         iterated over. (Defaults to `True`.)
+      spill_dir: (Optional.) A local directory. If set, buffered elements are
+        spilled to files in this directory once they take more than
+        `spill_memory_limit_bytes` of memory, so that `buffer_size` can exceed
+        what fits in memory. (Defaults to keeping the buffer in memory.)
+      spill_memory_limit_bytes: (Optional.) An integer, representing the
+        memory taken by buffered elements beyond which they are spilled to
+        `spill_dir`. (Defaults to 1 GiB.)
 
     Returns:
       Dataset: A `Dataset`.
     """
-    return ShuffleDataset(self, buffer_size, seed, reshuffle_each_iteration)
+    return ShuffleDataset(self, buffer_size, seed, reshuffle_each_iteration,
+                          spill_dir, spill_memory_limit_bytes)
 
-  def cache(self, filename=""):
+  def cache(self, filename="", memory_budget_bytes=None, spill_dir=None):
     """Caches the elements in this dataset.
 
     The first time the dataset is iterated over, its elements will be cached
@@ -1393,11 +1409,17 @@ class DatasetV2(collections_abc.Iterable, tracking_base.Trackable,
       filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
         directory on the filesystem to use for caching elements in this Dataset.
         If a filename is not provided, the dataset will be cached in memory.
+      memory_budget_bytes: (Optional.) An integer. When caching in memory, the
+        number of bytes of elements to keep in memory; the rest are spilled to
+        a local file and read back from it. (Defaults to keeping every element
+        in memory.)
+      spill_dir: (Optional.) A local directory for the spill file of a cache
+        with a `memory_budget_bytes`. (Defaults to a temporary directory.)
 
     Returns:
       Dataset: A `Dataset`.
     """
-    return CacheDataset(self, filename)
+    return CacheDataset(self, filename, memory_budget_bytes, spill_dir)
 
   def take(self, count):
     """Creates a `Dataset` with at most `count` elements from this dataset.
@@ -2592,13 +2614,20 @@ class DatasetV1(DatasetV2):
     return DatasetV1Adapter(super(DatasetV1, self).repeat(count))
 
   @functools.wraps(DatasetV2.shuffle)
-  def shuffle(self, buffer_size, seed=None, reshuffle_each_iteration=None):
+  def shuffle(self,
+              buffer_size,
+              seed=None,
+              reshuffle_each_iteration=None,
+              spill_dir=None,
+              spill_memory_limit_bytes=None):
     return DatasetV1Adapter(super(DatasetV1, self).shuffle(
-        buffer_size, seed, reshuffle_each_iteration))
+        buffer_size, seed, reshuffle_each_iteration, spill_dir,
+        spill_memory_limit_bytes))
 
   @functools.wraps(DatasetV2.cache)
-  def cache(self, filename=""):
-    return DatasetV1Adapter(super(DatasetV1, self).cache(filename))
+  def cache(self, filename="", memory_budget_bytes=None, spill_dir=None):
+    return DatasetV1Adapter(super(DatasetV1, self).cache(
+        filename, memory_budget_bytes, spill_dir))
 
   @functools.wraps(DatasetV2.take)
   def take(self, count):
@@ -3774,21 +3803,33 @@ class RangeDataset(DatasetSource):
 class CacheDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that caches elements of its input."""
 
-  def __init__(self, input_dataset, filename):
+  def __init__(self,
+               input_dataset,
+               filename,
+               memory_budget_bytes=None,
+               spill_dir=None):
     """See `Dataset.cache()` for details."""
     self._input_dataset = input_dataset
     self._filename = ops.convert_to_tensor(
         filename, dtype=dtypes.string, name="filename")
+    if memory_budget_bytes is None:
+      memory_budget_bytes = 0
+    if spill_dir is None:
+      spill_dir = ""
     if tf2.enabled() and (context.executing_eagerly() or ops.inside_function()):
       variant_tensor = gen_dataset_ops.cache_dataset_v2(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
           cache=gen_dataset_ops.dummy_memory_cache(),
+          memory_budget_bytes=memory_budget_bytes,
+          spill_dir=spill_dir,
           **self._flat_structure)
     else:
       variant_tensor = gen_dataset_ops.cache_dataset(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
+          memory_budget_bytes=memory_budget_bytes,
+          spill_dir=spill_dir,
           **self._flat_structure)
     super(CacheDataset, self).__init__(input_dataset, variant_tensor)
 
@@ -3800,7 +3841,9 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
                input_dataset,
                buffer_size,
                seed=None,
-               reshuffle_each_iteration=None):
+               reshuffle_each_iteration=None,
+               spill_dir=None,
+               spill_memory_limit_bytes=None):
     """Randomly shuffles the elements of this dataset.
 
     Args:
@@ -3813,6 +3856,10 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
       reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
         that the dataset should be pseudorandomly reshuffled each time it is
         iterated over. (Defaults to `True`.)
+      spill_dir: (Optional.) A local directory to spill buffered elements to
+        once they take more than `spill_memory_limit_bytes` of memory.
+      spill_memory_limit_bytes: (Optional.) The memory taken by buffered
+        elements beyond which they are spilled to `spill_dir`.
 
     Returns:
       A `Dataset`.
@@ -3827,6 +3874,10 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
     if reshuffle_each_iteration is None:
       reshuffle_each_iteration = True
     self._reshuffle_each_iteration = reshuffle_each_iteration
+    if spill_dir is None:
+      spill_dir = ""
+    if spill_memory_limit_bytes is None:
+      spill_memory_limit_bytes = 1 << 30
 
     if (tf2.enabled() and
         (context.executing_eagerly() or ops.inside_function())):
@@ -3837,6 +3888,8 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
           seed2=self._seed2,
           seed_generator=gen_dataset_ops.dummy_seed_generator(),
           reshuffle_each_iteration=self._reshuffle_each_iteration,
+          spill_dir=spill_dir,
+          spill_memory_limit_bytes=spill_memory_limit_bytes,
           **self._flat_structure)
     else:
       variant_tensor = gen_dataset_ops.shuffle_dataset(
@@ -3845,6 +3898,8 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
           seed=self._seed,
           seed2=self._seed2,
           reshuffle_each_iteration=self._reshuffle_each_iteration,
+          spill_dir=spill_dir,
+          spill_memory_limit_bytes=spill_memory_limit_bytes,
           **self._flat_structure)
     super(ShuffleDataset, self).__init__(input_dataset, variant_tensor)
 
@@ -4538,13 +4593,19 @@ class _OptionsDataset(UnaryUnchangedStructureDataset):
 class _ModelDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that acts as an identity, and models performance."""
 
-  def __init__(self, input_dataset, algorithm, cpu_budget, ram_budget):
+  def __init__(self,
+               input_dataset,
+               algorithm,
+               cpu_budget,
+               ram_budget,
+               buffer_ram_budget=0):
     self._input_dataset = input_dataset
     variant_tensor = gen_dataset_ops.model_dataset(
         input_dataset._variant_tensor,  # pylint: disable=protected-access
         algorithm=algorithm.value,
         cpu_budget=cpu_budget,
         ram_budget=ram_budget,
+        buffer_ram_budget=buffer_ram_budget,
         **self._flat_structure)
     super(_ModelDataset, self).__init__(input_dataset, variant_tensor)
 
@@ -33,6 +33,8 @@ from tensorflow.python.util import nest
 from tensorflow.python.util.tf_export import tf_export
 
 _DEFAULT_READER_BUFFER_SIZE_BYTES = 256 * 1024  # 256 KB
+_DEFAULT_FILE_HANDLE_POOL_CAPACITY = 64
+_DEFAULT_FILE_HANDLE_POOL_HEAD_BYTES = 256 * 1024  # 256 KB
 
 
 def _normalise_fspath(path):
@@ -211,7 +213,15 @@ class TextLineDatasetV1(dataset_ops.DatasetV1Adapter):
 class _TFRecordDataset(dataset_ops.DatasetSource):
   """A `Dataset` comprising records from one or more TFRecord files."""
 
-  def __init__(self, filenames, compression_type=None, buffer_size=None):
+  def __init__(self,
+               filenames,
+               compression_type=None,
+               buffer_size=None,
+               num_read_ahead_buffers=None,
+               num_inflate_threads=None,
+               file_handle_pool_threads=None,
+               file_handle_pool_capacity=None,
+               file_handle_pool_head_bytes=None):
     """Creates a `TFRecordDataset`.
 
     Args:
@@ -220,6 +230,21 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
         `""` (no compression), `"ZLIB"`, or `"GZIP"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. 0 means no buffering.
+      num_read_ahead_buffers: (Optional.) A Python integer representing the
+        number of read buffers filled ahead of the reader on a background
+        thread. 0 means no read-ahead.
+      num_inflate_threads: (Optional.) A Python integer representing the
+        number of threads that inflate compressed files written with a segment
+        index. 0 means inflating on the reader thread, and `tf.data.AUTOTUNE`
+        one thread per CPU. Only with a positive value or `tf.data.AUTOTUNE`
+        do readers look for the segment index of each file.
+      file_handle_pool_threads: (Optional.) A Python integer representing the
+        number of threads that open files ahead of their readers. 0 means
+        opening each file when its reader reaches it.
+      file_handle_pool_capacity: (Optional.) A Python integer representing the
+        maximum number of files kept open ahead of their readers.
+      file_handle_pool_head_bytes: (Optional.) A Python integer representing
+        the number of bytes read from the start of each file opened ahead.
     """
     self._filenames = filenames
     self._compression_type = convert.optional_param_to_tensor(
@@ -231,9 +256,25 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
         "buffer_size",
         buffer_size,
         argument_default=_DEFAULT_READER_BUFFER_SIZE_BYTES)
-    variant_tensor = gen_dataset_ops.tf_record_dataset(self._filenames,
-                                                       self._compression_type,
-                                                       self._buffer_size)
+    if num_read_ahead_buffers is None:
+      num_read_ahead_buffers = 0
+    if num_inflate_threads is None:
+      num_inflate_threads = 0
+    if file_handle_pool_threads is None:
+      file_handle_pool_threads = 0
+    if file_handle_pool_capacity is None:
+      file_handle_pool_capacity = _DEFAULT_FILE_HANDLE_POOL_CAPACITY
+    if file_handle_pool_head_bytes is None:
+      file_handle_pool_head_bytes = _DEFAULT_FILE_HANDLE_POOL_HEAD_BYTES
+    variant_tensor = gen_dataset_ops.tf_record_dataset(
+        self._filenames,
+        self._compression_type,
+        self._buffer_size,
+        num_read_ahead_buffers=num_read_ahead_buffers,
+        num_inflate_threads=num_inflate_threads,
+        file_handle_pool_threads=file_handle_pool_threads,
+        file_handle_pool_capacity=file_handle_pool_capacity,
+        file_handle_pool_head_bytes=file_handle_pool_head_bytes)
     super(_TFRecordDataset, self).__init__(variant_tensor)
 
   @property
@@ -303,7 +344,12 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
                filenames,
                compression_type=None,
                buffer_size=None,
-               num_parallel_reads=None):
+               num_parallel_reads=None,
+               num_read_ahead_buffers=None,
+               num_inflate_threads=None,
+               file_handle_pool_threads=None,
+               file_handle_pool_capacity=None,
+               file_handle_pool_head_bytes=None):
     """Creates a `TFRecordDataset` to read one or more TFRecord files.
 
     Args:
@@ -321,6 +367,29 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
         input pipeline is I/O bottlenecked, consider setting this parameter to a
         value greater than one to parallelize the I/O. If `None`, files will be
         read sequentially.
+      num_read_ahead_buffers: (Optional.) A Python integer representing the
+        number of read buffers of `buffer_size` bytes that each file keeps
+        filled ahead of its reader on a background thread, so that
+        decompression overlaps with I/O. If `None` or 0, each file reads one
+        buffer at a time.
+      num_inflate_threads: (Optional.) A Python integer representing the
+        number of threads that inflate `"ZLIB"` and `"GZIP"` files written with
+        a segment index by `tf.data.experimental.TFRecordWriter`. Datasets with
+        the same value share the threads. If `tf.data.AUTOTUNE`, one thread per
+        CPU is used. If `None` or 0, files are inflated by their reader, which
+        then does not look for their segment index.
+      file_handle_pool_threads: (Optional.) A Python integer representing the
+        number of threads that open upcoming files ahead of their readers and
+        read their first bytes in a single request, which helps pipelines that
+        interleave over many small files. Datasets with the same file handle
+        pool arguments share the threads. If `None` or 0, each file is opened
+        when its reader reaches it.
+      file_handle_pool_capacity: (Optional.) A Python integer representing the
+        maximum number of files kept open ahead of their readers. If `None`,
+        defaults to 64.
+      file_handle_pool_head_bytes: (Optional.) A Python integer representing
+        the number of bytes read from the start of each file opened ahead.
+        Reads within them are served from memory. If `None`, defaults to 256KB.
 
     Raises:
       TypeError: If any argument does not have the expected type.
@@ -332,9 +401,18 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
     self._compression_type = compression_type
     self._buffer_size = buffer_size
     self._num_parallel_reads = num_parallel_reads
+    self._num_read_ahead_buffers = num_read_ahead_buffers
+    self._num_inflate_threads = num_inflate_threads
+    self._file_handle_pool_threads = file_handle_pool_threads
+    self._file_handle_pool_capacity = file_handle_pool_capacity
+    self._file_handle_pool_head_bytes = file_handle_pool_head_bytes
 
     def creator_fn(filename):
-      return _TFRecordDataset(filename, compression_type, buffer_size)
+      return _TFRecordDataset(filename, compression_type, buffer_size,
+                              num_read_ahead_buffers, num_inflate_threads,
+                              file_handle_pool_threads,
+                              file_handle_pool_capacity,
+                              file_handle_pool_head_bytes)
 
     self._impl = _create_dataset_reader(creator_fn, filenames,
                                         num_parallel_reads)
@@ -345,11 +423,24 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
              filenames=None,
              compression_type=None,
              buffer_size=None,
-             num_parallel_reads=None):
-    return TFRecordDatasetV2(filenames or self._filenames, compression_type or
-                             self._compression_type, buffer_size or
-                             self._buffer_size, num_parallel_reads or
-                             self._num_parallel_reads)
+             num_parallel_reads=None,
+             num_read_ahead_buffers=None,
+             num_inflate_threads=None,
+             file_handle_pool_threads=None,
+             file_handle_pool_capacity=None,
+             file_handle_pool_head_bytes=None):
+    if num_inflate_threads is None:
+      num_inflate_threads = self._num_inflate_threads
+    return TFRecordDatasetV2(
+        filenames or self._filenames,
+        compression_type or self._compression_type,
+        buffer_size or self._buffer_size,
+        num_parallel_reads or self._num_parallel_reads,
+        num_read_ahead_buffers or self._num_read_ahead_buffers,
+        num_inflate_threads,
+        file_handle_pool_threads or self._file_handle_pool_threads,
+        file_handle_pool_capacity or self._file_handle_pool_capacity,
+        file_handle_pool_head_bytes or self._file_handle_pool_head_bytes)
 
   def _inputs(self):
     return self._impl._inputs()  # pylint: disable=protected-access
@@ -367,9 +458,17 @@ class TFRecordDatasetV1(dataset_ops.DatasetV1Adapter):
                filenames,
                compression_type=None,
                buffer_size=None,
-               num_parallel_reads=None):
+               num_parallel_reads=None,
+               num_read_ahead_buffers=None,
+               num_inflate_threads=None,
+               file_handle_pool_threads=None,
+               file_handle_pool_capacity=None,
+               file_handle_pool_head_bytes=None):
     wrapped = TFRecordDatasetV2(filenames, compression_type, buffer_size,
-                                num_parallel_reads)
+                                num_parallel_reads, num_read_ahead_buffers,
+                                num_inflate_threads, file_handle_pool_threads,
+                                file_handle_pool_capacity,
+                                file_handle_pool_head_bytes)
     super(TFRecordDatasetV1, self).__init__(wrapped)
 
   __init__.__doc__ = TFRecordDatasetV2.__init__.__doc__
@@ -378,13 +477,25 @@ class TFRecordDatasetV1(dataset_ops.DatasetV1Adapter):
              filenames=None,
              compression_type=None,
              buffer_size=None,
-             num_parallel_reads=None):
+             num_parallel_reads=None,
+             num_read_ahead_buffers=None,
+             num_inflate_threads=None,
+             file_handle_pool_threads=None,
+             file_handle_pool_capacity=None,
+             file_handle_pool_head_bytes=None):
     # pylint: disable=protected-access
+    if num_inflate_threads is None:
+      num_inflate_threads = self._dataset._num_inflate_threads
     return TFRecordDatasetV1(
         filenames or self._dataset._filenames, compression_type or
         self._dataset._compression_type, buffer_size or
         self._dataset._buffer_size, num_parallel_reads or
-        self._dataset._num_parallel_reads)
+        self._dataset._num_parallel_reads, num_read_ahead_buffers or
+        self._dataset._num_read_ahead_buffers, num_inflate_threads,
+        file_handle_pool_threads or self._dataset._file_handle_pool_threads,
+        file_handle_pool_capacity or self._dataset._file_handle_pool_capacity,
+        file_handle_pool_head_bytes or
+        self._dataset._file_handle_pool_head_bytes)
 
   @property
   def _filenames(self):